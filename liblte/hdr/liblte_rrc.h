@@ -3635,6 +3635,7 @@ static const char liblte_rrc_on_duration_timer_text[LIBLTE_RRC_ON_DURATION_TIMER
                                                                                                    "psf5",   "psf6",   "psf8",  "psf10",
                                                                                                   "psf20",  "psf30",  "psf40",  "psf50",
                                                                                                   "psf60",  "psf80", "psf100", "psf200"};
+static int liblte_rrc_on_duration_timer_num[LIBLTE_RRC_ON_DURATION_TIMER_N_ITEMS] = {1, 2, 3, 4, 5, 6, 8, 10, 20, 30, 40, 50, 60, 80, 100, 200};
 typedef enum{
     LIBLTE_RRC_DRX_INACTIVITY_TIMER_PSF1 = 0,
     LIBLTE_RRC_DRX_INACTIVITY_TIMER_PSF2,
@@ -3678,6 +3679,10 @@ static const char liblte_rrc_drx_inactivity_timer_text[LIBLTE_RRC_DRX_INACTIVITY
                                                                                                        "psf1920", "psf2560",   "SPARE",   "SPARE",
                                                                                                          "SPARE",   "SPARE",   "SPARE",   "SPARE",
                                                                                                          "SPARE",   "SPARE",   "SPARE",   "SPARE"};
+static int liblte_rrc_drx_inactivity_timer_num[LIBLTE_RRC_DRX_INACTIVITY_TIMER_N_ITEMS] = {   1,    2,    3,    4,    5,    6,    8,   10,
+                                                                                           20,   30,   40,   50,   60,   80,  100,  200,
+                                                                                          300,  500,  750, 1280, 1920, 2560,   -1,   -1,
+                                                                                           -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1};
 typedef enum{
     LIBLTE_RRC_DRX_RETRANSMISSION_TIMER_PSF1 = 0,
     LIBLTE_RRC_DRX_RETRANSMISSION_TIMER_PSF2,
@@ -3691,6 +3696,7 @@ typedef enum{
 }LIBLTE_RRC_DRX_RETRANSMISSION_TIMER_ENUM;
 static const char liblte_rrc_drx_retransmission_timer_text[LIBLTE_RRC_DRX_RETRANSMISSION_TIMER_N_ITEMS][20] = { "psf1",  "psf2",  "psf4",  "psf6",
                                                                                                                 "psf8", "psf16", "psf24", "psf33"};
+static int liblte_rrc_drx_retransmission_timer_num[LIBLTE_RRC_DRX_RETRANSMISSION_TIMER_N_ITEMS] = {1, 2, 4, 6, 8, 16, 24, 33};
 typedef enum{
     LIBLTE_RRC_LONG_DRX_CYCLE_START_OFFSET_SF10 = 0,
     LIBLTE_RRC_LONG_DRX_CYCLE_START_OFFSET_SF20,
@@ -3714,6 +3720,8 @@ static const char liblte_rrc_long_drx_cycle_start_offset_choice_text[LIBLTE_RRC_
                                                                                                                               "sf64",   "sf80",  "sf128",  "sf160",
                                                                                                                              "sf256",  "sf320",  "sf512",  "sf640",
                                                                                                                             "sf1024", "sf1280", "sf2048", "sf2560"};
+static int liblte_rrc_long_drx_cycle_start_offset_choice_num[LIBLTE_RRC_LONG_DRX_CYCLE_START_OFFSET_N_ITEMS] = {  10,   20,   32,   40,   64,   80,  128,  160,
+                                                                                                             256,  320,  512,  640, 1024, 1280, 2048, 2560};
 typedef enum{
     LIBLTE_RRC_SHORT_DRX_CYCLE_SF2 = 0,
     LIBLTE_RRC_SHORT_DRX_CYCLE_SF5,
@@ -3737,6 +3745,8 @@ static const char liblte_rrc_short_drx_cycle_text[LIBLTE_RRC_SHORT_DRX_CYCLE_N_I
                                                                                               "sf16",  "sf20",  "sf32",  "sf40",
                                                                                               "sf64",  "sf80", "sf128", "sf160",
                                                                                              "sf256", "sf320", "sf512", "sf640"};
+static int liblte_rrc_short_drx_cycle_num[LIBLTE_RRC_SHORT_DRX_CYCLE_N_ITEMS] = {  2,   5,   8,  10,  16,  20,  32,  40,
+                                                                               64,  80, 128, 160, 256, 320, 512, 640};
 typedef enum{
     LIBLTE_RRC_TIME_ALIGNMENT_TIMER_SF500 = 0,
     LIBLTE_RRC_TIME_ALIGNMENT_TIMER_SF750,
@@ -32,17 +32,51 @@
 *******************************************************************************/
 
 #include "common/common.h"
+#include <pthread.h>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/lock_guard.hpp>
 
 namespace srsue{
 
+/******************************************************************************
+ * Buffer pool size classes
+ *
+ * Buffers are grouped in size classes so that small PDUs (e.g. RLC status
+ * PDUs, RRC/NAS signalling) do not each pin a maximum-size TB buffer.
+ *****************************************************************************/
+typedef enum{
+  BUFFER_POOL_CLASS_SMALL = 0,
+  BUFFER_POOL_CLASS_MEDIUM,
+  BUFFER_POOL_CLASS_LARGE,
+  BUFFER_POOL_N_CLASSES,
+}buffer_pool_class_t;
+static const char buffer_pool_class_text[BUFFER_POOL_N_CLASSES][20] = {"Small",
+                                                                      "Medium",
+                                                                      "Large"};
+
+typedef struct{
+  uint32_t nof_buffers;
+  uint32_t buffer_size;
+  uint32_t allocated;
+  uint32_t high_water_mark;
+  uint32_t alloc_failures;
+}buffer_pool_class_metrics_t;
+
+typedef struct{
+  buffer_pool_class_metrics_t size_class[BUFFER_POOL_N_CLASSES];
+}buffer_pool_metrics_t;
+
 /******************************************************************************
  * Buffer pool
  *
- * Preallocates a large number of srsue_byte_buffer_t and provides allocate and
- * deallocate functions. Provides quick object creation and deletion as well
- * as object reuse. Uses a linked list to keep track of available buffers.
+ * Preallocates a large number of byte_buffer_t in several size classes and
+ * provides allocate and deallocate functions. Provides quick object creation
+ * and deletion as well as object reuse. Each size class keeps its available
+ * buffers in a lock-free stack. Each thread additionally keeps a small
+ * magazine of buffers per size class, so that most allocate/deallocate calls
+ * do not touch shared state at all. Magazines are refilled from and flushed
+ * to the shared stacks in batches.
  * Singleton class - only one exists for the UE.
  *****************************************************************************/
 class buffer_pool{
@@ -53,21 +87,52 @@ public:
   static buffer_pool*   get_instance(void);
   static void           cleanup(void);
 
+  // Allocates a buffer able to hold at least nof_bytes after the headroom
+  byte_buffer_t*        allocate(uint32_t nof_bytes);
+  // Allocates a maximum size buffer
   byte_buffer_t*        allocate();
   void                  deallocate(byte_buffer_t *b);
 
+  void                  get_metrics(buffer_pool_metrics_t &m);
+
 private:
   buffer_pool();
-  ~buffer_pool(){ delete [] pool; }
+  ~buffer_pool();
   buffer_pool(buffer_pool const&);    // Disabled
   void operator=(buffer_pool const&); // Disabled
 
-  static const int      POOL_SIZE = 2048;
-  byte_buffer_t        *pool;
-  byte_buffer_t        *first_available;
-  boost::mutex          mutex;
+  static const uint32_t MAGAZINE_SIZE = 32;
+
+  typedef struct{
+    uint32_t       count[BUFFER_POOL_N_CLASSES];
+    byte_buffer_t *bufs[BUFFER_POOL_N_CLASSES][MAGAZINE_SIZE];
+  }thread_cache_t;
+
+  typedef struct{
+    uint32_t          nof_buffers;
+    uint32_t          buffer_size;
+    uint32_t          headroom;
+    uint8_t          *storage;
+    byte_buffer_t   **bufs;
+    // Lock-free stack head: ABA tag in upper 32 bits, index+1 in lower 32 bits
+    volatile uint64_t head;
+    volatile uint32_t allocated;
+    volatile uint32_t high_water_mark;
+    volatile uint32_t alloc_failures;
+  }size_class_t;
+
+  byte_buffer_t*        allocate_class(uint32_t c);
+  byte_buffer_t*        pop(size_class_t *sc);
+  void                  push(size_class_t *sc, byte_buffer_t *b);
+  thread_cache_t*       get_thread_cache();
+  void                  flush_thread_cache(thread_cache_t *cache);
+  static void           thread_cache_destructor(void *cache);
+
+  size_class_t          classes[BUFFER_POOL_N_CLASSES];
+  pthread_key_t         cache_key;
+  boost::mutex          cache_mutex;
+  std::vector<thread_cache_t*> caches;
   static boost::mutex   instance_mutex;
-  int                   allocated;
 };
 
 
@@ -100,44 +100,100 @@ static const char rb_id_text[RB_ID_N_ITEMS][20] = { "SRB0",
 /******************************************************************************
  * Byte and Bit buffers
  *
- * Generic buffers with headroom to accommodate packet headers and custo
+ * Generic buffers with headroom to accommodate packet headers and custom
  * copy constructors & assignment operators for quick copying. Byte buffer
- * holds a next pointer to support linked lists.
+ * storage is either owned by the buffer (default constructor, maximum size)
+ * or provided by the buffer pool, which carves buffers of several size
+ * classes out of preallocated slabs. Byte buffer holds a next pointer to
+ * support linked lists.
  *****************************************************************************/
 class byte_buffer_t{
 public:
     uint32_t  N_bytes;
-    uint8_t   buffer[SRSUE_MAX_BUFFER_SIZE_BYTES];
+    uint8_t  *buffer;
     uint8_t  *msg;
 
-    byte_buffer_t():N_bytes(0)
+    byte_buffer_t()
+      :N_bytes(0)
+      ,capacity(SRSUE_MAX_BUFFER_SIZE_BYTES)
+      ,headroom(SRSUE_BUFFER_HEADER_OFFSET)
+      ,owner(true)
+      ,size_class(0)
+      ,pool_idx(0)
+      ,next(NULL)
     {
-      msg = &buffer[SRSUE_BUFFER_HEADER_OFFSET];
+      buffer = new uint8_t[capacity];
+      msg    = &buffer[headroom];
+    }
+    byte_buffer_t(uint8_t *storage, uint32_t capacity_, uint32_t headroom_)
+      :N_bytes(0)
+      ,buffer(storage)
+      ,capacity(capacity_)
+      ,headroom(headroom_)
+      ,owner(false)
+      ,size_class(0)
+      ,pool_idx(0)
+      ,next(NULL)
+    {
+      msg = &buffer[headroom];
     }
     byte_buffer_t(const byte_buffer_t& buf)
+      :capacity(SRSUE_MAX_BUFFER_SIZE_BYTES)
+      ,headroom(SRSUE_BUFFER_HEADER_OFFSET)
+      ,owner(true)
+      ,size_class(0)
+      ,pool_idx(0)
+      ,next(NULL)
     {
+      buffer  = new uint8_t[capacity];
+      msg     = &buffer[headroom];
       N_bytes = buf.N_bytes;
       memcpy(msg, buf.msg, N_bytes);
     }
+    ~byte_buffer_t()
+    {
+      if(owner)
+        delete [] buffer;
+    }
     byte_buffer_t & operator= (const byte_buffer_t & buf)
     {
-      N_bytes = buf.N_bytes;
-      memcpy(msg, buf.msg, N_bytes);
+      // Pool buffers may be smaller than the source, copy what fits from msg on
+      if(&buf != this)
+      {
+        uint32_t space = capacity-get_headroom();
+        N_bytes = (buf.N_bytes > space) ? space : buf.N_bytes;
+        memcpy(msg, buf.msg, N_bytes);
+      }
+      return *this;
     }
     void reset()
     {
-      msg     = &buffer[SRSUE_BUFFER_HEADER_OFFSET];
+      msg     = &buffer[headroom];
       N_bytes = 0;
     }
     uint32_t get_headroom()
     {
       return msg-buffer;
     }
+    uint32_t get_tailroom()
+    {
+      return capacity-(msg-buffer)-N_bytes;
+    }
+    uint32_t get_capacity()
+    {
+      return capacity;
+    }
 
     // Linked list support
     byte_buffer_t*  get_next() { return next; }
     void set_next(byte_buffer_t *b) { next = b; }
 private:
+    friend class buffer_pool;
+    uint32_t       capacity;
+    uint32_t       headroom;
+    bool           owner;
+    uint32_t       size_class;
+    uint32_t       pool_idx;
     byte_buffer_t *next;
 };
 
@@ -0,0 +1,107 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         helper_pool.h
+ *  Description:  Fork/join pool for splitting one task into independent
+ *                jobs, e.g. the code blocks of a transport block. run()
+ *                publishes a batch of jobs and the calling thread works on
+ *                it together with the helper threads, returning once every
+ *                job has finished. Several threads may call run() at the
+ *                same time; idle helpers take jobs from any open batch.
+ *                Jobs are claimed with a compare-and-swap on a per-batch
+ *                (generation, next job) word, so no locks are taken on the
+ *                job path. Idle helpers, and callers waiting for jobs taken
+ *                by helpers, spin for a short time and then sleep on a futex.
+ *****************************************************************************/
+
+#ifndef HELPER_POOL_H
+#define HELPER_POOL_H
+
+#include <stdint.h>
+#include "common/threads.h"
+
+namespace srslte {
+
+class helper_pool
+{
+public:
+  // Runs job idx of a batch. slot identifies the calling thread: 0 to 
+  // nof_helpers-1 for the helpers and the caller_slot passed to run().
+  typedef void (*job_fn_t)(void *arg, uint32_t idx, uint32_t slot);
+
+  class helper : public thread
+  {
+  public:
+    void setup(uint32_t id, helper_pool *parent);
+    uint32_t get_id();
+  private:
+    void run_thread();
+    uint32_t     my_id;
+    helper_pool *my_parent;
+  };
+
+  // max_callers is the number of threads that may call run() concurrently
+  helper_pool(uint32_t max_callers);
+  ~helper_pool();
+
+  bool     init(uint32_t nof_helpers, int prio = -1, uint32_t spin_us = 20);
+  void     stop();
+  void     run(job_fn_t fn, void *arg, uint32_t nof_jobs, uint32_t caller_slot);
+  uint32_t get_nof_helpers();
+  helper*  get_helper(uint32_t id);
+
+private:
+  // Padded so that batches do not share cache lines
+  typedef struct {
+    volatile uint64_t state;      // Generation in the high word, next job in the low word
+    volatile uint32_t done;
+    volatile uint32_t busy;       // Owned by a caller
+    volatile uint32_t waiting;    // Caller sleeps on done
+    job_fn_t          fn;
+    void             *arg;
+    uint32_t          nof_jobs;
+    uint8_t           pad[20];
+  }batch_t;
+
+  bool     claim_and_run(batch_t *b, uint32_t slot);
+  bool     work(uint32_t slot);
+  void     helper_loop(uint32_t id);
+  static uint64_t now_ns();
+
+  helper             *helpers;
+  uint32_t            nof_helpers;
+  batch_t            *batches;
+  uint32_t            nof_batches;
+  uint64_t            spin_ns;
+  volatile bool       running;
+  volatile uint32_t   work_seq;     // Incremented every time a batch is published
+  volatile uint32_t   nof_sleeping;
+};
+
+}
+
+#endif // HELPER_POOL_H
@@ -0,0 +1,80 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         latency_hist.h
+ *  Description:  Lock-free latency histogram with log-linear buckets (HDR
+ *                style): 8 linear sub-buckets per power of two, giving a
+ *                relative error below 12.5% from 1 ns up to 4 s. add() may
+ *                be called concurrently from any number of threads and
+ *                only uses atomic increments. Readers see a consistent
+ *                enough view for monitoring; reset() racing with add() may
+ *                drop a few samples.
+ *****************************************************************************/
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+namespace srsue {
+
+#define LATENCY_HIST_SUB_BITS   3
+#define LATENCY_HIST_SUB        (1<<LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BITS   32
+#define LATENCY_HIST_NOF_BINS   ((LATENCY_HIST_MAX_BITS-LATENCY_HIST_SUB_BITS+1)*LATENCY_HIST_SUB)
+
+class latency_hist
+{
+public:
+  latency_hist();
+
+  void     add(uint64_t value);
+  void     reset();
+
+  uint64_t count();
+  uint64_t max();
+  double   mean();
+  // Upper bound of the bucket holding the p-th percentile (0 < p <= 100)
+  uint64_t percentile(float p);
+
+  // One line per non-empty bucket: upper bound, count and cumulative fraction
+  void     print(FILE *f, const char *name, double scale = 1e-3, const char *unit = "us");
+
+  static uint32_t bin(uint64_t value);
+  static uint64_t bin_max(uint32_t idx);
+
+private:
+  volatile uint32_t bins[LATENCY_HIST_NOF_BINS];
+  volatile uint64_t nof_samples;
+  volatile uint64_t sum;
+  volatile uint64_t max_value;
+};
+
+} // namespace srsue
+
+#endif // LATENCY_HIST_H
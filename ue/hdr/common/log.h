@@ -123,5 +123,39 @@ protected:
 
 } // namespace srslte
 
+/******************************************************************************
+ * Log statements which check the level before evaluating their arguments,
+ * e.g. log_debug(log_h, "%s\n", to_string(pdu).c_str()).
+ * Statements below the compile-time minimum level are removed entirely.
+ * The minimum level is set with -DSRSUE_LOG_MIN_LEVEL=<NONE|ERROR|WARNING|
+ * INFO|DEBUG>, DEBUG by default.
+ *****************************************************************************/
+#ifndef SRSUE_LOG_MIN_LEVEL
+#define SRSUE_LOG_MIN_LEVEL DEBUG
+#endif
+
+#define SRSUE_LOG_CAT_(a, b)  a##b
+#define SRSUE_LOG_CAT(a, b)   SRSUE_LOG_CAT_(a, b)
+#define SRSUE_LOG_COMPILED    SRSUE_LOG_CAT(srslte::LOG_LEVEL_, SRSUE_LOG_MIN_LEVEL)
+
+#define SRSUE_LOG_ENABLED(log_, lvl_) \
+  (srslte::LOG_LEVEL_##lvl_ <= SRSUE_LOG_COMPILED && (log_)->get_level() >= srslte::LOG_LEVEL_##lvl_)
+
+#define SRSUE_LOG(log_, lvl_, fn_, ...) \
+  do { \
+    if (SRSUE_LOG_ENABLED(log_, lvl_)) \
+      (log_)->fn_(__VA_ARGS__); \
+  } while(0)
+
+#define log_error(log_, ...)        SRSUE_LOG(log_, ERROR,   error,       __VA_ARGS__)
+#define log_warning(log_, ...)      SRSUE_LOG(log_, WARNING, warning,     __VA_ARGS__)
+#define log_info(log_, ...)         SRSUE_LOG(log_, INFO,    info,        __VA_ARGS__)
+#define log_debug(log_, ...)        SRSUE_LOG(log_, DEBUG,   debug,       __VA_ARGS__)
+
+#define log_error_hex(log_, ...)    SRSUE_LOG(log_, ERROR,   error_hex,   __VA_ARGS__)
+#define log_warning_hex(log_, ...)  SRSUE_LOG(log_, WARNING, warning_hex, __VA_ARGS__)
+#define log_info_hex(log_, ...)     SRSUE_LOG(log_, INFO,    info_hex,    __VA_ARGS__)
+#define log_debug_hex(log_, ...)    SRSUE_LOG(log_, DEBUG,   debug_hex,   __VA_ARGS__)
+
 #endif // LOG_H
 
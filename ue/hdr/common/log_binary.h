@@ -0,0 +1,139 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        log_binary.h
+ * Description: Binary log record format. In binary mode, log filters store
+ *              the format string id, timestamp, TTI, layer, level, raw
+ *              printf arguments and hex dump bytes of each message instead
+ *              of a formatted string. Formatting is deferred to the
+ *              offline decoder (srsue_log_decoder).
+ *****************************************************************************/
+
+#ifndef LOG_BINARY_H
+#define LOG_BINARY_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <string>
+#include <boost/thread/mutex.hpp>
+
+namespace srsue {
+
+#define LOG_BINARY_MAGIC          "SRSUE_BINLOG_1"
+#define LOG_BINARY_MAX_RECORD     8192
+#define LOG_BINARY_MAX_ARGS_LEN   2048
+#define LOG_BINARY_MAX_FORMATS    4096
+#define LOG_BINARY_MAX_LAYERS     256
+
+// Ids given by a full table, never defined. The decoder prints them as an overflow
+#define LOG_BINARY_FORMAT_OVERFLOW  (LOG_BINARY_MAX_FORMATS-1)
+#define LOG_BINARY_LAYER_OVERFLOW   (LOG_BINARY_MAX_LAYERS-1)
+
+typedef enum{
+  LOG_BINARY_REC_PAD = 0,
+  LOG_BINARY_REC_TEXT,    // Preformatted text
+  LOG_BINARY_REC_FORMAT,  // Format string definition
+  LOG_BINARY_REC_LAYER,   // Layer name definition
+  LOG_BINARY_REC_MSG,     // Log message
+}log_binary_rec_t;
+
+#define LOG_BINARY_FLAG_TTI 0x1
+#define LOG_BINARY_FLAG_HEX 0x2
+
+// All records start with this header. len includes the header.
+typedef struct{
+  uint16_t type;
+  uint16_t len;
+}log_binary_hdr_t;
+
+// Followed by args_len bytes of arguments and hex_len bytes of hex dump
+typedef struct{
+  log_binary_hdr_t hdr;
+  uint32_t         fmt_id;
+  uint32_t         tti;
+  uint64_t         time_us;
+  uint8_t          level;
+  uint8_t          layer_id;
+  uint8_t          flags;
+  uint8_t          reserved;
+  uint16_t         args_len;
+  uint16_t         hex_len;
+}log_binary_msg_t;
+
+// Format and layer definitions. Followed by a NULL-terminated string.
+typedef struct{
+  log_binary_hdr_t hdr;
+  uint32_t         id;
+}log_binary_def_t;
+
+/******************************************************************************
+ * Interning table for format strings and layer names. Lookups are lock-free,
+ * new entries are added under a mutex. Entries are never removed. The last
+ * id is reserved: intern() returns it, and counts an overflow, once the
+ * other max_entries-1 are taken.
+ *****************************************************************************/
+class log_binary_table
+{
+public:
+  log_binary_table(uint32_t max_entries_);
+  ~log_binary_table();
+  uint32_t    intern(const char *str);
+  const char* get(uint32_t id);
+  uint32_t    size();
+  uint32_t    overflow_id();
+  uint32_t    get_nof_overflows();
+
+private:
+  typedef struct{
+    uint32_t             hash;
+    uint32_t             id;
+    const char *volatile str;
+  }entry_t;
+
+  uint32_t              max_entries;
+  uint32_t              nof_slots;
+  entry_t              *slots;
+  const char          **strings;
+  volatile uint32_t     nof_entries;
+  volatile uint32_t     nof_overflows;
+  boost::mutex          mutex;
+};
+
+// Serializes the arguments of a printf-style format. Returns the number of bytes written.
+uint32_t    log_binary_encode_args(const char *fmt, va_list args, uint8_t *buf, uint32_t max_len);
+// Formats previously serialized arguments
+std::string log_binary_format_args(const char *fmt, const uint8_t *buf, uint32_t len);
+// Formats a hex dump in the same way as the text log
+std::string log_binary_hex_string(const uint8_t *hex, int size);
+// Formats a time in us in the same way as the text log
+std::string log_binary_time_string(uint64_t time_us);
+// Formats a MSG record into the text log line
+std::string log_binary_format_msg(const log_binary_msg_t *msg, const char *fmt, const char *layer);
+
+} // namespace srsue
+
+#endif // LOG_BINARY_H
@@ -68,12 +68,14 @@ public:
   void debug_line(std::string file, int line, std::string message, ...);
 
 private:
-  logger *logger_h;
-  bool    do_tti;
+  logger  *logger_h;
+  bool     do_tti;
+  uint32_t layer_id;
 
   void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, char *msg);
   void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, char *msg, uint8_t *hex, int size);
-  void all_log_line(srslte::LOG_LEVEL_ENUM level, uint32_t tti, std::string file, int line, char *msg);
+  void all_log_va(srslte::LOG_LEVEL_ENUM level, uint32_t tti, const char *fmt, va_list args, uint8_t *hex=NULL, int size=0);
+  void all_log_binary(srslte::LOG_LEVEL_ENUM level, uint32_t tti, const char *fmt, va_list args, uint8_t *hex, int size);
   std::string now_time();
   std::string hex_string(uint8_t *hex, int size);
 };
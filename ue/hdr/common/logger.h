@@ -26,50 +26,140 @@
 
 /******************************************************************************
  * File:        logger.h
- * Description: Common log object. Maintains a queue of log messages
- *              and runs a thread to read messages and write to file.
- *              Multiple producers, single consumer. If full, producers
- *              increase queue size. If empty, consumer blocks.
+ * Description: Common log object. Each producer thread writes log records
+ *              to its own fixed-size single-producer/single-consumer
+ *              ring, and a writer thread drains all rings to file.
+ *              Memory use is bounded. When a ring is full, the overflow
+ *              policy decides whether the producer blocks, drops its new
+ *              message or drops the oldest messages in the ring. Dropped
+ *              messages are counted per layer, reported in the log and
+ *              available through get_metrics().
+ *              In binary mode, records are the binary records in
+ *              log_binary.h, otherwise preformatted text.
  *****************************************************************************/
 
 #ifndef LOGGER_H
 #define LOGGER_H
 
 #include <stdio.h>
+#include <pthread.h>
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
-#include <boost/circular_buffer.hpp>
+#include "common/log_binary.h"
 
 namespace srsue {
 
+#define LOG_RING_SIZE           1024*256
+#define LOG_METRICS_MAX_LAYERS  16
+
 typedef boost::shared_ptr<std::string> str_ptr;
 
+typedef enum{
+  LOG_OVERFLOW_BLOCK = 0,
+  LOG_OVERFLOW_DROP_NEWEST,
+  LOG_OVERFLOW_DROP_OLDEST,
+  LOG_OVERFLOW_N_ITEMS,
+}log_overflow_t;
+static const char log_overflow_text[LOG_OVERFLOW_N_ITEMS][20] = {"block",
+                                                                 "drop_newest",
+                                                                 "drop_oldest"};
+
+typedef struct{
+  char     name[16];
+  uint32_t dropped;        // Since the previous get_metrics() call
+  uint32_t total_dropped;
+}log_layer_metrics_t;
+
+typedef struct{
+  uint32_t            nof_layers;
+  log_layer_metrics_t layer[LOG_METRICS_MAX_LAYERS];
+}log_metrics_t;
+
 class logger
 {
 public:
   logger();
   logger(std::string file);
   ~logger();
-  void init(std::string file);
+  void init(std::string file,
+            bool           binary_    = false,
+            log_overflow_t overflow_  = LOG_OVERFLOW_BLOCK,
+            uint32_t       ring_size_ = LOG_RING_SIZE);
   void log(const char *msg);
   void log(str_ptr msg);
+  void log(uint32_t layer_id, const std::string &msg);
+  void get_metrics(log_metrics_t &m);
+
+  // Binary mode
+  bool     is_binary();
+  uint32_t register_format(const char *fmt);
+  uint32_t register_layer(const char *layer);
+  void     log_binary(const uint8_t *rec, uint32_t len);
 
 private:
+  // Entries in the rings start with this header. len is the total entry
+  // length, or 0 for padding up to the end of the ring.
+  typedef struct{
+    uint32_t len;
+    uint32_t layer_id;
+  }ring_hdr_t;
+
+  typedef struct{
+    uint8_t          *buf;
+    uint32_t          size;
+    volatile uint32_t wr;       // Written by the producer thread only
+    volatile uint32_t rd;       // Written by the writer thread, and by the producer when dropping the oldest
+    volatile bool     closed;   // Producer thread has exited
+  }ring_t;
+
   static void* start(void *input);
+  static void  ring_destructor(void *arg);
+  void setup();
+  ring_t* get_ring();
+  void push(uint32_t layer_id, const uint8_t *rec, uint32_t len);
+  void push_text(uint32_t layer_id, const char *str, uint32_t len);
+  void count_drop(uint32_t layer_id);
   void reader_loop();
+  bool drain(ring_t *r);
+  bool drain_all();
+  bool all_empty();
   void flush();
+  void report_drops(bool force);
+  void write_text(const char *str, uint32_t len);
+  void write_record(const uint8_t *rec);
+  void write_defs(log_binary_rec_t type, log_binary_table *table, uint32_t *nof_written, uint32_t id);
 
   FILE*                               logfile;
   bool                                inited;
-  bool                                not_done;
+  volatile bool                       not_done;
   std::string                         filename;
   boost::condition                    not_empty;
   boost::condition                    not_full;
   boost::mutex                        mutex;
   pthread_t                           thread;
-  boost::circular_buffer<str_ptr>     buffer;
+
+  bool                                binary;
+  log_overflow_t                      overflow;
+  uint32_t                            ring_size;
+  pthread_key_t                       ring_key;
+  boost::mutex                        rings_mutex;
+  std::vector<ring_t*>                rings;
+  volatile uint32_t                   writer_waiting;
+  volatile uint32_t                   nof_blocked;
+
+  log_binary_table                    formats;
+  log_binary_table                    layers;
+  uint32_t                            nof_formats_written;
+  uint32_t                            nof_layers_written;
+
+  uint32_t                            dropped[LOG_BINARY_MAX_LAYERS];
+  uint32_t                            dropped_reported[LOG_BINARY_MAX_LAYERS];
+  uint32_t                            dropped_metrics[LOG_BINARY_MAX_LAYERS];
+  time_t                              last_report;
+  uint32_t                            overflows_reported;
 };
 
 } // namespace srsue
@@ -40,6 +40,8 @@
 #include "common/timers.h"
 
 namespace srsue {
+
+class softbuffer_fx;
   
 /* Interface PHY -> MAC */
 class mac_interface_phy
@@ -70,6 +72,8 @@ public:
     void                   *generate_ack_callback_arg;
     uint8_t                *payload_ptr; 
     srslte_softbuffer_rx_t *softbuffer;
+    // If non-null, softbuffer is not used and the soft bits are kept in fixed point
+    softbuffer_fx          *fx_softbuffer;
     srslte_phy_grant_t      phy_grant;
   } tb_action_dl_t;
 
@@ -159,6 +163,15 @@ public:
       
       HARQ_MAXTX,
       HARQ_MAXMSG3TX,
+      HARQ_SOFTBUFFER_BITS,   // 16 or 8 for fixed-point DL soft bits, float otherwise
+      
+      DRX_ON_DURATION_TIMER,
+      DRX_INACTIVITY_TIMER,
+      DRX_RETX_TIMER,
+      DRX_LONG_CYCLE,         // 0 if DRX is not configured
+      DRX_LONG_CYCLE_OFFSET,
+      DRX_SHORT_CYCLE,        // 0 if the short cycle is not configured
+      DRX_SHORT_CYCLE_TIMER,  // In short cycles
       
       NOF_PARAMS,    
     } mac_param_t;
@@ -27,7 +27,13 @@
 /******************************************************************************
  *  File:         msg_queue.h
  *  Description:  Thread-safe bounded circular buffer of srsue_byte_buffer pointers.
- *  Reference:
+ *                Lock-free multi-producer/multi-consumer ring with per-slot
+ *                sequence numbers. The number of messages and bytes queued
+ *                are kept in atomic counters so that size() and size_bytes()
+ *                never block. try_write(), try_read() and read_batch() never
+ *                block, write() and read() wait while the queue is full or
+ *                empty.
+ *  Reference:    D. Vyukov, Bounded MPMC queue.
  *****************************************************************************/
 
 #ifndef MSG_QUEUE_H
@@ -42,14 +48,24 @@ namespace srsue {
 class msg_queue
 {
 public:
+  // Capacity is rounded up to a power of 2
   msg_queue(uint32_t capacity_ = 128)
     :head(0)
     ,tail(0)
     ,unread(0)
     ,unread_bytes(0)
-    ,capacity(capacity_)
+    ,nof_waiting_readers(0)
+    ,nof_waiting_writers(0)
   {
-    buf = new byte_buffer_t*[capacity];
+    capacity = 1;
+    while(capacity < capacity_)
+      capacity *= 2;
+    buf = new slot_t[capacity];
+    for(uint32_t i=0;i<capacity;i++)
+    {
+      buf[i].seq = i;
+      buf[i].msg = NULL;
+    }
   }
 
   ~msg_queue()
@@ -57,78 +73,164 @@ public:
     delete [] buf;
   }
 
+  // Blocks while the queue is full
   void write(byte_buffer_t *msg)
   {
+    if(try_write(msg))
+      return;
     boost::mutex::scoped_lock lock(mutex);
-    while(is_full()) not_full.wait(lock);
-    buf[head] = msg;
-    head = (head+1)%capacity;
-    unread++;
-    unread_bytes += msg->N_bytes;
-    lock.unlock();
-    not_empty.notify_one();
+    __sync_fetch_and_add(&nof_waiting_writers, 1);
+    while(!push(msg)) not_full.wait(lock);
+    __sync_fetch_and_sub(&nof_waiting_writers, 1);
+    if(nof_waiting_readers)
+      not_empty.notify_one();
+  }
+
+  // Returns false if the queue is full
+  bool try_write(byte_buffer_t *msg)
+  {
+    if(!push(msg))
+      return false;
+    if(nof_waiting_readers)
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      not_empty.notify_one();
+    }
+    return true;
   }
 
+  // Blocks while the queue is empty
   void read(byte_buffer_t **msg)
   {
+    if(try_read(msg))
+      return;
     boost::mutex::scoped_lock lock(mutex);
-    while(is_empty()) not_empty.wait(lock);
-    *msg = buf[tail];
-    tail = (tail+1)%capacity;
-    unread--;
-    unread_bytes -= (*msg)->N_bytes;
-    lock.unlock();
-    not_full.notify_one();
+    __sync_fetch_and_add(&nof_waiting_readers, 1);
+    while(!pop(msg)) not_empty.wait(lock);
+    __sync_fetch_and_sub(&nof_waiting_readers, 1);
+    if(nof_waiting_writers)
+      not_full.notify_one();
   }
 
   bool try_read(byte_buffer_t **msg)
   {
-    boost::mutex::scoped_lock lock(mutex);
-    if(is_empty())
-    {
+    if(!pop(msg))
       return false;
-    }else{
-      *msg = buf[tail];
-      tail = (tail+1)%capacity;
-      unread--;
-      unread_bytes -= (*msg)->N_bytes;
-      lock.unlock();
+    if(nof_waiting_writers)
+    {
+      boost::mutex::scoped_lock lock(mutex);
       not_full.notify_one();
-      return true;
     }
+    return true;
+  }
+
+  // Reads up to max_msgs messages without blocking. Returns the number read.
+  uint32_t read_batch(byte_buffer_t **msgs, uint32_t max_msgs)
+  {
+    uint32_t n = 0;
+    while(n < max_msgs && try_read(&msgs[n]))
+      n++;
+    return n;
   }
 
+  // Counters are updated after the ring, so a reader may briefly see -1
   uint32_t size()
   {
-    boost::mutex::scoped_lock lock(mutex);
-    return unread;
+    int32_t n = (int32_t) unread;
+    return (n > 0) ? n : 0;
   }
 
   uint32_t size_bytes()
   {
-    boost::mutex::scoped_lock lock(mutex);
-    return unread_bytes;
+    int32_t n = (int32_t) unread_bytes;
+    return (n > 0) ? n : 0;
   }
 
+  // Size of the next message to be read, 0 if empty. Consumer side only.
   uint32_t size_tail_bytes()
   {
-    boost::mutex::scoped_lock lock(mutex);
-    return buf[tail]->N_bytes;
+    uint32_t pos = tail;
+    slot_t  *s   = &buf[pos&(capacity-1)];
+    if(s->seq != pos+1)
+      return 0;
+    return s->msg->N_bytes;
   }
 
 private:
-  bool     is_empty() const { return unread == 0; }
-  bool     is_full() const { return unread == capacity; }
+  typedef struct{
+    volatile uint32_t seq;
+    byte_buffer_t    *msg;
+  }slot_t;
+
+  // Lock-free enqueue, no wakeup
+  bool push(byte_buffer_t *msg)
+  {
+    uint32_t pos = head;
+    slot_t  *s;
+    while(true)
+    {
+      s = &buf[pos&(capacity-1)];
+      int32_t dif = (int32_t) (s->seq - pos);
+      if(dif == 0)
+      {
+        if(__sync_bool_compare_and_swap(&head, pos, pos+1))
+          break;
+        pos = head;
+      }else if(dif < 0){
+        return false;
+      }else{
+        pos = head;
+      }
+    }
+    s->msg = msg;
+    __sync_fetch_and_add(&unread_bytes, msg->N_bytes);
+    __sync_fetch_and_add(&unread, 1);
+    __sync_synchronize();
+    s->seq = pos+1;
+    __sync_synchronize();
+    return true;
+  }
+
+  // Lock-free dequeue, no wakeup
+  bool pop(byte_buffer_t **msg)
+  {
+    uint32_t pos = tail;
+    slot_t  *s;
+    while(true)
+    {
+      s = &buf[pos&(capacity-1)];
+      int32_t dif = (int32_t) (s->seq - (pos+1));
+      if(dif == 0)
+      {
+        if(__sync_bool_compare_and_swap(&tail, pos, pos+1))
+          break;
+        pos = tail;
+      }else if(dif < 0){
+        return false;
+      }else{
+        pos = tail;
+      }
+    }
+    *msg = s->msg;
+    __sync_fetch_and_sub(&unread_bytes, (*msg)->N_bytes);
+    __sync_fetch_and_sub(&unread, 1);
+    __sync_synchronize();
+    s->seq = pos+capacity;
+    __sync_synchronize();
+    return true;
+  }
 
   boost::condition      not_empty;
   boost::condition      not_full;
   boost::mutex          mutex;
-  byte_buffer_t **buf;
+  slot_t               *buf;
   uint32_t              capacity;
-  uint32_t              unread;
-  uint32_t              unread_bytes;
-  uint32_t              head;
-  uint32_t              tail;
+  volatile uint32_t     head;
+  volatile uint32_t     tail;
+  volatile uint32_t     unread;
+  volatile uint32_t     unread_bytes;
+  volatile uint32_t     nof_waiting_readers;
+  volatile uint32_t     nof_waiting_writers;
 };
 
 } // namespace srsue
@@ -138,6 +138,24 @@ public:
     
     CONTINUOUS_TX,
     PDSCH_MAX_ITS,
+    PDSCH_ADAPTIVE_ITS,     // Lowers the iteration cap of late TTIs to meet the HARQ deadline
+    
+    WORKERS_SPIN_US,  // 0 uses condition variables for worker handoff
+    
+    PDSCH_HELPERS,          // 0 decodes all PDSCH code blocks in the worker
+    PDSCH_HELPERS_MIN_PRB,
+    
+    LAZY_PDSCH_FFT,         // Demodulates the data region only after a DL grant is found
+    
+    WORKERS_SCALING,        // Starts all workers and activates as many as the subframe load needs
+    
+    PDSCH_FIXED_POINT,      // int16 demodulation and soft combining of C-RNTI grants with 16-bit HARQ storage
+    
+    SIGNAL_CACHE_MB,        // Cap of the PRACH preambles and C-RNTI sequences kept for reuse, 0 disables
+    
+    RX_RING_SF,             // Subframes received ahead of an idle worker, 0 waits for a worker before reading
+    
+    MEAS_FILTER_COEFF,      // RSRP L3 filter coefficient k (filterCoefficientRSRP), set by RRC
     
     NOF_PARAMS,    
   } phy_param_t;
@@ -179,8 +197,16 @@ public:
   virtual void pdcch_ul_search_reset() = 0;
   virtual void pdcch_dl_search_reset() = 0;
   
+  /* Connected mode DRX. C-RNTI searches are only active in the on-duration, starting in the TTIs 
+   * where tti%cycle equals offset, and up to and including the active_until TTI. Cycle 0 disables DRX */
+  virtual void drx_set_cycle(uint32_t cycle, uint32_t offset, uint32_t on_duration) = 0;
+  virtual void drx_set_active_until(uint32_t tti) = 0;
+  
   virtual uint32_t get_current_tti() = 0;
   
+  /* Cell the PHY is synchronized to, valid once the MIB is decoded */
+  virtual void get_current_cell(srslte_cell_t *cell) = 0;
+  
   virtual float get_phr() = 0; 
   
   virtual void reset() = 0;
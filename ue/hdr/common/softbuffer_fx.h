@@ -0,0 +1,108 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         softbuffer_fx.h
+ *  Description:  Fixed-point storage of the DL HARQ soft bits of a transport
+ *                block. Each code block keeps its rate dematching circular
+ *                buffer as int16 or int8 soft bits, a half or a quarter of
+ *                the float srslte_softbuffer_rx_t, sized for the code blocks
+ *                of the largest transport block of the cell bandwidth.
+ *                Before decoding, the code blocks of a transport block are
+ *                expanded into a float softbuffer shared by all the HARQ
+ *                processes of a worker, soft combining is done there by
+ *                srslte_rm_turbo_rx() and, if the CRC fails, the result is
+ *                saturated back into the fixed-point storage.
+ *                Resetting only clears a flag per code block.
+ *                int16 buffers can also be combined in place by the
+ *                fixed-point PDSCH path (pdsch_fx).
+ *  Reference:    3GPP TS 36.212 5.1.4.1.2
+ *****************************************************************************/
+
+#ifndef UESOFTBUFFERFX_H
+#define UESOFTBUFFERFX_H
+
+#include <stdint.h>
+#include <vector>
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+class softbuffer_fx
+{
+public:
+  // Entries of the circular buffer of the largest code block, 3 sub-blocks of 32 columns
+  const static uint32_t CB_LEN = 3*32*((SRSLTE_TCOD_MAX_LEN_CB+4+31)/32);
+
+  // Fixed-point soft bit = round(float*scale). The lowest value marks untransmitted bits (SRSLTE_RX_NULL)
+  const static int      SCALE_16 = 256;
+  const static int      SCALE_8  = 2;
+  const static int      NULL_16  = -32768;
+  const static int      NULL_8   = -128;
+
+  softbuffer_fx();
+  ~softbuffer_fx();
+
+  // nof_bits is 16 or 8
+  bool     init(uint32_t nof_prb, uint32_t nof_bits);
+  void     free_buffers();
+
+  void     reset();
+
+  // Float softbuffer sb must hold the code blocks of cb_segm. Both return 0 on success.
+  int      expand(srslte_cbsegm_t *cb_segm, srslte_softbuffer_rx_t *sb);
+  int      compress(srslte_cbsegm_t *cb_segm, srslte_softbuffer_rx_t *sb);
+
+  /* int16 circular buffer of code block i, of cb_len bits, for combining in place. Code blocks 
+   * emptied by reset() are filled with nulls first. Different code blocks may be used concurrently */
+  int16_t *get_cb_16(uint32_t i, uint32_t cb_len);
+
+  uint32_t get_max_cb();
+  uint32_t get_nof_bits();
+  size_t   get_nof_bytes();
+
+  // Code blocks of the largest transport block of a nof_prb cell, like srslte_softbuffer_rx_init()
+  static uint32_t max_cb_prb(uint32_t nof_prb);
+
+  // Circular buffer entries used by a code block of cb_len bits
+  static uint32_t cb_w_len(uint32_t cb_len);
+
+private:
+  static void load_16(int16_t *in, float *out, uint32_t len);
+  static void load_8(int8_t *in, float *out, uint32_t len);
+  static void save_16(float *in, int16_t *out, uint32_t len);
+  static void save_8(float *in, int8_t *out, uint32_t len);
+  static void fill_null(float *out, uint32_t len);
+
+  uint8_t             *buffer;
+  uint32_t             nof_bits;
+  uint32_t             max_cb;
+  std::vector<uint8_t> empty;
+};
+
+} // namespace srsue
+
+#endif // UESOFTBUFFERFX_H
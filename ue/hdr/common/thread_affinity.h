@@ -0,0 +1,136 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         thread_affinity.h
+ *  Description:  Maps named UE threads to a CPU set and a real-time priority
+ *                offset. Threads register with a configuration key (e.g.
+ *                "phy_worker") and a thread name (e.g. "PHY_WORKER0"). The
+ *                name is set with pthread_setname_np and the placement for
+ *                the key is applied once configure() has been called, so
+ *                threads created before the configuration is parsed are
+ *                placed as well.
+ *                Placement specs have the format "<cpus>[@<prio_offset>]",
+ *                e.g. "2", "0-1,4" or "3@0". The priority offset follows
+ *                threads_new_rt_prio(): SCHED_FIFO with maximum priority
+ *                minus the offset, -1 for the default scheduler.
+ *                Also reports the CPU load of every registered thread and,
+ *                for threads derived from the thread class, their context
+ *                switches and wake-up latency.
+ *                Singleton class - only one exists for the UE.
+ *****************************************************************************/
+
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include "common/threads.h"
+
+namespace srsue{
+
+#define THREAD_METRICS_MAX_THREADS 16
+
+// Rates and averages since the previous get_metrics() call
+typedef struct{
+  char  name[16];
+  float cpu_load;             // % of one CPU
+  bool  has_sched;            // Context switches and wake latency available
+  float nvcsw;                // Voluntary context switches per second
+  float nivcsw;               // Involuntary context switches per second
+  int   nof_wakes;
+  float wake_avg_us;
+  float wake_max_us;
+}thread_metrics_t;
+
+typedef struct{
+  uint32_t         nof_threads;
+  thread_metrics_t thread[THREAD_METRICS_MAX_THREADS];
+}threads_metrics_t;
+
+class thread_affinity{
+public:
+  // Singleton
+  static thread_affinity   *instance;
+
+  static thread_affinity*   get_instance(void);
+  static void               cleanup(void);
+
+  // Sets the placement for all threads registered with key. Empty spec keeps the defaults.
+  bool                      set(std::string key, std::string spec);
+  // Applies the placement of all registered threads and of those added later
+  void                      configure();
+  // Names the thread and applies its placement. prio is the offset the thread was created with.
+  void                      add(pthread_t thread, std::string key, std::string name, int prio = -1);
+  void                      add(::thread *t, std::string key, std::string name, int prio = -1);
+  // Prints the effective CPU set and scheduling of all registered threads
+  void                      print();
+  void                      get_metrics(threads_metrics_t &m);
+
+  static bool               parse(std::string spec, cpu_set_t *cpus, bool *has_cpus, int *prio, bool *has_prio);
+
+private:
+  thread_affinity();
+  thread_affinity(thread_affinity const&);    // Disabled
+  void operator=(thread_affinity const&);     // Disabled
+
+  typedef struct{
+    cpu_set_t cpus;
+    bool      has_cpus;
+    int       prio;
+    bool      has_prio;
+  }placement_t;
+
+  typedef struct{
+    pthread_t      thread;
+    ::thread      *t;          // NULL for threads not derived from the thread class
+    std::string    key;
+    std::string    name;
+    int            prio;
+    uint64_t       last_cpu_ns;
+    thread_usage_t last_usage;
+  }entry_t;
+
+  void                      add_entry(pthread_t thread, ::thread *t, std::string key, std::string name, int prio);
+  void                      apply(entry_t *e);
+  static uint64_t           cpu_time_ns(pthread_t thread);
+
+  std::map<std::string, placement_t> placements;
+  std::vector<entry_t>      threads;
+  bool                      configured;
+  uint64_t                  last_metrics_ns;
+  boost::mutex              mutex;
+  static boost::mutex       instance_mutex;
+};
+
+} // namespace srsue
+
+#endif // THREAD_AFFINITY_H
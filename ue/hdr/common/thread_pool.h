@@ -28,6 +28,15 @@
  *  File:         thread_pool.h
  *  Description:  Implements a pool of threads. Pending tasks to execute are 
  *                identified by a pointer. 
+ *                In HANDOFF_SPIN mode, workers are handed over with atomic
+ *                status words instead of mutexes and condition variables.
+ *                Waiters spin for a short time and then sleep on a futex,
+ *                which is only woken if someone is actually sleeping.
+ *                Idle workers are selected in the order they were last
+ *                started, so consecutive TTIs go to workers round-robin.
+ *                Only the first nof_active workers are handed work. The rest
+ *                are parked: they sleep without spinning and drop to
+ *                SCHED_OTHER until they are made active again.
  *  Reference:
  *****************************************************************************/
 
@@ -59,27 +68,48 @@ public:
   private: 
     uint32_t my_id; 
     thread_pool *my_parent;
-    bool running; 
+    volatile bool running; 
     void run_thread();  
+    void park();
     void wait_to_start();
     void finished();    
   };
     
   
+  typedef enum {
+    HANDOFF_COND = 0,   // Mutexes and condition variables
+    HANDOFF_SPIN        // Atomics, spin then futex wait
+  }handoff_mode_t;
+
   thread_pool(uint32_t nof_workers);  
+  ~thread_pool();
+  void    set_handoff_mode(handoff_mode_t mode, uint32_t spin_us = 50);  // Call before init_worker()
   void    init_worker(uint32_t id, worker*, uint32_t prio = 0);              
   void    stop();
   worker* wait_worker();              
   worker* wait_worker(uint32_t tti);              
+  // Returns NULL instead of waiting if no worker is idle
+  worker* try_wait_worker(uint32_t tti);
   void    start_worker(worker*);              
   void    start_worker(uint32_t id);              
   worker* get_worker(uint32_t id);
   uint32_t get_nof_workers();
+  // Number of workers handed work, 1..get_nof_workers(). Any thread, takes effect on the next wait_worker()
+  void     set_nof_active(uint32_t n);
+  uint32_t get_nof_active();
   
 
 private:
 
   bool find_finished_worker(uint32_t tti, uint32_t *id);
+  void park_worker(uint32_t id, pthread_t t);
+
+  // HANDOFF_SPIN implementation
+  uint64_t now_ns();
+  worker* wait_worker_spin(uint32_t tti);
+  worker* take_idle_spin(uint32_t tti);
+  void    start_worker_spin(uint32_t id);
+  void    finished_spin(uint32_t id);
   
   typedef enum {
     IDLE, 
@@ -98,6 +128,28 @@ private:
   std::vector<pthread_cond_t> cvar;
   std::vector<pthread_mutex_t> mutex;
   std::stack<worker*> available_workers;
+
+  // Parked workers keep the scheduling they had before in sched_policy/sched_prio
+  volatile uint32_t  nof_active;
+  pthread_mutex_t    mutex_sched;
+  std::vector<bool>  parked;
+  std::vector<int>   sched_policy;
+  std::vector<int>   sched_prio;
+
+  // Padded to keep the status of each worker on its own cache line
+  typedef struct {
+    volatile uint32_t status;
+    volatile uint32_t sleeping;
+    uint64_t          order;
+    uint8_t           pad[48];
+  }spin_state_t;
+
+  handoff_mode_t    mode;
+  uint64_t          spin_ns;
+  spin_state_t     *spin_state;
+  volatile uint32_t idle_seq;        // Incremented every time a worker becomes idle
+  volatile uint32_t pool_sleeping;
+  volatile uint64_t next_order;      // Idle order of the spin workers, atomic
 };
 }
   
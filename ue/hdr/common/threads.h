@@ -41,10 +41,23 @@
   
 #ifndef THREADS_
 #define THREADS_   
+
+#include <time.h>
+#include <sys/resource.h>
+
+// Cumulative counters, except wake_max_ns which is reset by get_usage()
+typedef struct {
+  uint64_t nvcsw;             // Voluntary context switches
+  uint64_t nivcsw;            // Involuntary context switches
+  uint64_t nof_wakes;
+  uint64_t wake_sum_ns;
+  uint64_t wake_max_ns;
+}thread_usage_t;
   
 class thread
 {
 public: 
+  thread() : nvcsw(0), nivcsw(0), wake_time_ns(0), nof_wakes(0), wake_sum_ns(0), wake_max_ns(0) {}
   bool start(int prio = -1) {
     return threads_new_rt_prio(&_thread, thread_function_entry, this, prio);    
   }
@@ -60,11 +73,62 @@ public:
   void thread_cancel() {
     pthread_cancel(_thread);
   }
+  pthread_t get_pthread() {
+    return _thread;
+  }
+
+  // Called by the thread that wakes this one, just before signalling it
+  void wake_stamp() {
+    wake_time_ns = now_ns();
+  }
+  void get_usage(thread_usage_t *u) {
+    u->nvcsw       = nvcsw;
+    u->nivcsw      = nivcsw;
+    u->nof_wakes   = nof_wakes;
+    u->wake_sum_ns = wake_sum_ns;
+    u->wake_max_ns = __sync_lock_test_and_set(&wake_max_ns, 0);
+  }
 protected:
   virtual void run_thread() = 0; 
+
+  // Samples the context switches of the calling thread. Called by the thread itself.
+  void update_usage() {
+    struct rusage r;
+    if (!getrusage(RUSAGE_THREAD, &r)) {
+      nvcsw  = r.ru_nvcsw;
+      nivcsw = r.ru_nivcsw;
+    }
+  }
+  // Called by this thread when it resumes after wake_stamp()
+  void wake_sample() {
+    uint64_t t = wake_time_ns;
+    if (t) {
+      wake_record(now_ns() - t);
+      wake_time_ns = 0;
+    }
+  }
+  void wake_record(uint64_t latency_ns) {
+    wake_sum_ns += latency_ns;
+    nof_wakes++;
+    if (latency_ns > wake_max_ns) {
+      wake_max_ns = latency_ns;
+    }
+  }
+  static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+  }
 private:
-  static void *thread_function_entry(void *_this)  { ((thread*) _this)->run_thread();}
+  static void *thread_function_entry(void *_this)  { ((thread*) _this)->run_thread(); return NULL; }
   pthread_t _thread;
+
+  volatile uint64_t nvcsw;
+  volatile uint64_t nivcsw;
+  volatile uint64_t wake_time_ns;
+  volatile uint64_t nof_wakes;
+  volatile uint64_t wake_sum_ns;
+  volatile uint64_t wake_max_ns;
 };
   
 
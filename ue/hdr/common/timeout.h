@@ -26,8 +26,10 @@
 
 /******************************************************************************
  *  File:         timeout.h
- *  Description:  Millisecond resolution timeouts. Uses a dedicated thread to
- *                call an optional callback function upon timeout expiry.
+ *  Description:  Millisecond resolution timeouts. Timeouts are kept in the
+ *                shared timer wheel service, which calls an optional
+ *                callback function upon timeout expiry. Expiry can also be
+ *                polled without reading the clock.
  *  Reference:
  *****************************************************************************/
 
@@ -35,9 +37,7 @@
 #define TIMEOUT_H
 
 #include <stdint.h>
-#include <pthread.h>
-#include <unistd.h>
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include "common/timer_wheel.h"
 
 namespace srsue {
   
@@ -48,66 +48,60 @@ class timeout_callback
 }; 
   
 class timeout
+    :public timer_wheel_entry
 {
 public:
-  timeout():running(false),callback(NULL){}
+  timeout()
+    :running(false)
+    ,has_expired(false)
+    ,timeout_id(0)
+    ,callback(NULL)
+  {
+    wheel = timer_wheel::get_instance();
+  }
   ~timeout()
   {
-    if(running && callback)
-      pthread_join(thread, NULL);
+    wheel->remove(this);
   }
   void start(int duration_msec_, uint32_t timeout_id_=0,timeout_callback *callback_=NULL)
   {
     if(duration_msec_ < 0)
       return;
     reset();
-    stop_time     = boost::posix_time::microsec_clock::local_time() + boost::posix_time::milliseconds(duration_msec_);
-    running       = true;
     timeout_id    = timeout_id_;
     callback      = callback_;
-    if(callback)
-      pthread_create(&thread, NULL, &thread_start, this);
+    running       = true;
+    wheel->add(this, duration_msec_);
   }
   void reset()
   {
-    if(callback)
-      pthread_cancel(thread);
-    running = false;
-  }
-  static void* thread_start(void *t_)
-  {
-    timeout *t = (timeout*)t_;
-    t->thread_func();
-  }
-  void thread_func()
-  {
-    boost::posix_time::time_duration diff;
-    boost::posix_time::ptime now = boost::posix_time::microsec_clock::local_time();
-    diff = stop_time - now;
-    int32_t usec = diff.total_microseconds();
-    if(usec > 0)
-      usleep(usec);
-    if(callback && running)
-        callback->timeout_expired(timeout_id);
+    wheel->remove(this);
+    running     = false;
+    has_expired = false;
   }
   bool expired()
   {
-    if(running)
-      return boost::posix_time::microsec_clock::local_time() > stop_time;
-    else
-      return false;
+    return running && has_expired;
   }
   bool is_running()
   {
     return running;
   }
 
+protected:
+  void expire()
+  {
+    has_expired = true;
+    if(callback && running)
+      callback->timeout_expired(timeout_id);
+  }
+
 private:
-  boost::posix_time::ptime  stop_time;
-  pthread_t                 thread;
+  timer_wheel              *wheel;
+  volatile bool             running;
+  volatile bool             has_expired;
   uint32_t                  timeout_id;
   timeout_callback         *callback;
-  bool                      running;
 };
 
 } // namespace srsue
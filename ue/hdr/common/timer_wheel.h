@@ -0,0 +1,112 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         timer_wheel.h
+ *  Description:  Millisecond resolution hierarchical timer wheel. A single
+ *                service thread advances the wheel using the monotonic clock
+ *                and expires entries. Start and stop are O(1). Entries never
+ *                expire before their duration has elapsed, durations beyond
+ *                the wheel range (about 17 min) cascade more than once.
+ *  Reference:    Varghese & Lauck, "Hashed and Hierarchical Timing Wheels"
+ *****************************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <boost/thread/mutex.hpp>
+
+namespace srsue {
+
+class timer_wheel;
+
+class timer_wheel_entry
+{
+public:
+  timer_wheel_entry():prev(NULL),next(NULL),head(NULL),expiry(0){}
+  virtual ~timer_wheel_entry(){}
+protected:
+  // Called from the timer wheel thread upon expiry
+  virtual void expire() = 0;
+private:
+  friend class timer_wheel;
+  timer_wheel_entry  *prev;
+  timer_wheel_entry  *next;
+  timer_wheel_entry **head; // Slot list the entry is linked into, NULL if none
+  uint64_t            expiry;
+};
+
+class timer_wheel
+{
+public:
+  // Singleton
+  static timer_wheel*   get_instance(void);
+  static void           cleanup(void);
+
+  void     add(timer_wheel_entry *e, uint32_t duration_msec);
+  void     remove(timer_wheel_entry *e);
+  uint64_t now();
+
+private:
+  timer_wheel();
+  ~timer_wheel();
+  timer_wheel(timer_wheel const&);    // Disabled
+  void operator=(timer_wheel const&); // Disabled
+
+  static const uint32_t LEVEL0_BITS  = 8;
+  static const uint32_t LEVELN_BITS  = 6;
+  static const uint32_t NOF_LEVELS   = 3;
+  static const uint32_t LEVEL0_SLOTS = 1<<LEVEL0_BITS;
+  static const uint32_t LEVELN_SLOTS = 1<<LEVELN_BITS;
+  static const uint64_t MAX_DELTA    = (1ULL<<(LEVEL0_BITS+(NOF_LEVELS-1)*LEVELN_BITS))-1;
+
+  static timer_wheel   *instance;
+  static boost::mutex   instance_mutex;
+
+  static void* thread_start(void *w);
+  void         thread_func();
+  void         insert(timer_wheel_entry *e);
+  void         unlink(timer_wheel_entry *e);
+  void         cascade(uint32_t level, uint32_t slot);
+  uint32_t     level_slot(uint64_t t, uint32_t level);
+  void         tick();
+  uint64_t     monotonic_ns();
+
+  timer_wheel_entry  *slots[NOF_LEVELS][LEVEL0_SLOTS];
+  uint64_t            start_ns;
+  volatile uint64_t   current;
+  bool                running;
+  pthread_t           thread;
+  pthread_mutex_t     mutex;
+  pthread_cond_t      cvar;
+  timer_wheel_entry  *firing;
+};
+
+} // namespace srsue
+
+#endif // TIMER_WHEEL_H
@@ -28,16 +28,21 @@
 /******************************************************************************
  *  File:         timers.h
  *  Description:  Manually incremented timers. Call a callback function upon
- *                expiry.
+ *                expiry. Running timers are kept in a TTI-indexed timing
+ *                wheel so that step_all() only visits the timers expiring
+ *                in the current TTI.
  *  Reference:
  *****************************************************************************/
 
 #ifndef TIMERS_H
 #define TIMERS_H
 
+#include <stdio.h>
 #include <stdint.h>
+#include <strings.h>
 #include <vector>
 #include <time.h>
+#include <pthread.h>
 
 namespace srslte {
   
@@ -46,6 +51,13 @@ class timer_callback
   public: 
     virtual void timer_expired(uint32_t timer_id) = 0; 
 }; 
+
+typedef struct {
+  uint32_t nof_steps;
+  uint32_t nof_expired;
+  float    avg_step_us;
+  float    max_step_us;
+}timers_metrics_t;
   
 class timers
 {
@@ -53,7 +65,10 @@ public:
   class timer
   {
   public:
-    timer(uint32_t id_=0) {id = id_; counter = 0; timeout = 0; running = false; }
+    timer(uint32_t id_=0) {
+      id = id_; counter = 0; timeout = 0; running = false; callback = NULL;
+      parent = NULL; start_tti = 0; expiry_tti = 0; prev = NULL; next = NULL; linked = false;
+    }
     void set(timer_callback *callback_, uint32_t timeout_) {
       callback = callback_; 
       timeout = timeout_; 
@@ -61,14 +76,23 @@ public:
       run();
     }
     bool is_running() {
-      return (counter < timeout) && running; 
+      return (get_counter() < timeout) && running; 
     }
     bool is_expired() {
-      return counter == timeout || !running; 
+      return get_counter() == timeout || !running; 
     }
     void reset() {
-      counter = 0; 
+      if (parent) {
+        pthread_mutex_lock(&parent->mutex);
+        counter   = 0;
+        start_tti = parent->now;
+        parent->schedule(this);
+        pthread_mutex_unlock(&parent->mutex);
+      } else {
+        counter = 0; 
+      }
     }
+    // Only used by timers which do not belong to a timers object
     void step() {
       if (running) {
         counter++; 
@@ -78,31 +102,104 @@ public:
       }
     }
     void stop() {
-      running = false; 
+      if (parent) {
+        pthread_mutex_lock(&parent->mutex);
+        counter = get_counter();
+        running = false;
+        parent->schedule(this);
+        pthread_mutex_unlock(&parent->mutex);
+      } else {
+        running = false; 
+      }
     }
     void run() {
-      running = true; 
+      if (parent) {
+        pthread_mutex_lock(&parent->mutex);
+        if (!running) {
+          start_tti = parent->now - counter;
+        }
+        running = true;
+        parent->schedule(this);
+        pthread_mutex_unlock(&parent->mutex);
+      } else {
+        running = true; 
+      }
     }
     uint32_t id; 
   private: 
+    friend class timers;
+    // While running, the counter is derived from the parent's TTI counter
+    uint32_t get_counter() {
+      return (parent && running) ? parent->now - start_tti : counter;
+    }
     timer_callback *callback; 
     uint32_t timeout; 
     uint32_t counter; 
     bool running; 
+    // Timing wheel state
+    timers  *parent;
+    uint32_t start_tti;
+    uint32_t expiry_tti;
+    timer   *prev;
+    timer   *next;
+    bool     linked;
   };
   
   timers(uint32_t nof_timers_) : timer_list(nof_timers_) {
     nof_timers = nof_timers_; 
     next_timer = 0;
+    now = 0;
+    bzero(wheel, sizeof(wheel));
+    bzero(&metrics, sizeof(timers_metrics_t));
+    total_step_us = 0;
+    expired.reserve(nof_timers);
+    pthread_mutex_init(&mutex, NULL);
     for (uint32_t i=0;i<nof_timers;i++) {
       timer_list[i].id = i; 
+      timer_list[i].parent = this;
     }
   }
+  ~timers() {
+    pthread_mutex_destroy(&mutex);
+  }
   
+  // Advances one TTI. Only timers expiring in this TTI are visited.
   void step_all() {
-    for (int i=0;i<nof_timers;i++) {
-      get(i)->step();
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    pthread_mutex_lock(&mutex);
+    now++;
+    timer *t = wheel[now%WHEEL_SIZE];
+    while (t) {
+      timer *n = t->next;
+      if (t->expiry_tti == now) {
+        unlink(t);
+        expired.push_back(t);
+      }
+      t = n;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    // Callbacks may re-arm timers
+    for (uint32_t i=0;i<expired.size();i++) {
+      if (expired[i]->callback) {
+        expired[i]->callback->timer_expired(expired[i]->id);
+      }
     }
+    uint32_t nof_expired = expired.size();
+    expired.clear();
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    float us = (t1.tv_sec-t0.tv_sec)*1e6 + (t1.tv_nsec-t0.tv_nsec)/1e3;
+    pthread_mutex_lock(&mutex);
+    metrics.nof_expired += nof_expired;
+    total_step_us += us;
+    metrics.nof_steps++;
+    if (us > metrics.max_step_us) {
+      metrics.max_step_us = us;
+    }
+    pthread_mutex_unlock(&mutex);
   }
   void stop_all() {
     for (int i=0;i<nof_timers;i++) {
@@ -134,10 +231,59 @@ public:
     }
     return next_timer++;
   }
+  // Per-TTI step_all() cost since the last call
+  void get_metrics(timers_metrics_t &m) {
+    pthread_mutex_lock(&mutex);
+    metrics.avg_step_us = metrics.nof_steps ? total_step_us/metrics.nof_steps : 0;
+    m = metrics;
+    bzero(&metrics, sizeof(timers_metrics_t));
+    total_step_us = 0;
+    pthread_mutex_unlock(&mutex);
+  }
 private:
+  static const uint32_t WHEEL_SIZE = 256;
+
+  // Places a timer in its expiry slot if it is running. Called with mutex held.
+  void schedule(timer *t) {
+    if (t->linked) {
+      unlink(t);
+    }
+    uint32_t counter = now - t->start_tti;
+    if (t->running && counter < t->timeout) {
+      t->expiry_tti = t->start_tti + t->timeout;
+      timer **head  = &wheel[t->expiry_tti%WHEEL_SIZE];
+      t->prev = NULL;
+      t->next = *head;
+      if (t->next) {
+        t->next->prev = t;
+      }
+      *head     = t;
+      t->linked = true;
+    }
+  }
+  void unlink(timer *t) {
+    if (t->prev) {
+      t->prev->next = t->next;
+    } else {
+      wheel[t->expiry_tti%WHEEL_SIZE] = t->next;
+    }
+    if (t->next) {
+      t->next->prev = t->prev;
+    }
+    t->prev   = NULL;
+    t->next   = NULL;
+    t->linked = false;
+  }
+
   uint32_t nof_timers; 
   uint32_t next_timer;
+  uint32_t now;
   std::vector<timer>   timer_list;   
+  timer               *wheel[WHEEL_SIZE];
+  std::vector<timer*>  expired;
+  pthread_mutex_t      mutex;
+  timers_metrics_t     metrics;
+  float                total_step_us;
 };
 
 } // namespace srslte
@@ -34,6 +34,7 @@
 #include "common/timers.h"
 #include "mac/mac_params.h"
 #include "mac/pdu.h"
+#include "mac/proc_drx.h"
 
 /* Logical Channel Demultiplexing and MAC CE dissassemble */   
 
@@ -44,7 +45,7 @@ class demux
 {
 public:
   demux();
-  void init(phy_interface* phy_h_, rlc_interface_mac *rlc, srslte::log* log_h_, srslte::timers* timers_db_);
+  void init(phy_interface* phy_h_, rlc_interface_mac *rlc, srslte::log* log_h_, srslte::timers* timers_db_, drx_proc *drx_);
 
   bool     process_pdus();
   uint8_t* request_buffer(uint32_t pid, uint32_t len);
@@ -79,6 +80,7 @@ private:
   srslte::log       *log_h;
   srslte::timers    *timers_db;
   rlc_interface_mac *rlc;
+  drx_proc          *drx;
 };
 
 } // namespace srsue
@@ -34,6 +34,7 @@
 #include "mac/demux.h"
 #include "mac/dl_sps.h"
 #include "mac/mac_pcap.h"
+#include "common/softbuffer_fx.h"
 
 /* Downlink HARQ entity as defined in 5.3.2 of 36.321 */
 
@@ -50,6 +51,9 @@ public:
   dl_harq_entity();
   bool init(srslte::log *log_h_, mac_params *params_db, srslte::timers *timers_, demux *demux_unit);
   
+  /* Sizes the soft buffers for the cell bandwidth, in the format set by HARQ_SOFTBUFFER_BITS */
+  bool init_cell(uint32_t nof_prb);
+  
   
   /***************** PHY->MAC interface for DL processes **************************/
   void new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_interface_phy::tb_action_dl_t *action);
@@ -67,6 +71,7 @@ private:
   public:
     dl_harq_process();
     bool init(uint32_t pid, dl_harq_entity *parent);
+    bool init_cell(uint32_t nof_prb, uint32_t nof_bits);
     void reset();
     bool is_sps(); 
     bool is_new_transmission(mac_interface_phy::mac_grant_t grant); 
@@ -86,6 +91,9 @@ private:
     
     mac_interface_phy::mac_grant_t cur_grant;    
     srslte_softbuffer_rx_t         softbuffer; 
+    softbuffer_fx                  fx_softbuffer; 
+    uint32_t                       softbuffer_prb;   // 0 until the cell is known
+    uint32_t                       softbuffer_bits;  // 32 for float
     
   };
   static bool      generate_ack_callback(void *arg);
@@ -38,6 +38,7 @@
 #include "mac/proc_sr.h"
 #include "mac/proc_bsr.h"
 #include "mac/proc_phr.h"
+#include "mac/proc_drx.h"
 #include "mac/mux.h"
 #include "mac/demux.h"
 #include "mac/mac_pcap.h"
@@ -137,6 +138,7 @@ private:
   sr_proc       sr_procedure; 
   bsr_proc      bsr_procedure; 
   phr_proc      phr_procedure; 
+  drx_proc      drx_procedure; 
   
   /* Functions for MAC Timers */
   srslte::timers  timers_db;
@@ -39,6 +39,8 @@ struct mac_metrics_t
   int rx_errors;
   int rx_brate;
   int ul_buffer;
+  float timers_avg_us; // Average per-TTI MAC timer processing time
+  float timers_max_us; // Maximum per-TTI MAC timer processing time
 };
 
 } // namespace srsue
@@ -0,0 +1,107 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef PROCDRX_H
+#define PROCDRX_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "mac/proc.h"
+#include "common/log.h"
+#include "common/phy_interface.h"
+#include "mac/mac_params.h"
+
+/* Discontinuous Reception (DRX) as defined in 5.7 of 36.321 
+ * 
+ * The on-duration of each DRX cycle is evaluated by the PHY from the cycle, offset and onDurationTimer 
+ * given with drx_set_cycle(). drx-InactivityTimer, drx-RetransmissionTimer and the other conditions 
+ * of the active time are tracked here and given to the PHY as the last TTI of the active time. 
+ * Methods are called by the MAC thread, the PHY workers and the PDU thread. 
+ */
+
+namespace srsue {
+
+class drx_proc : public proc
+{
+public:
+  drx_proc();
+  ~drx_proc();
+  void init(phy_interface *phy_h, srslte::log *log_h, mac_params *params_db);
+  void step(uint32_t tti);
+  void reset();
+  
+  // Applies the DRX parameters written by RRC
+  void configure(uint32_t tti);
+  
+  // Keeps the PDCCH monitored in this TTI (pending SR, random access)
+  void keep_active(uint32_t tti);
+  
+  // PDCCH for the C-RNTI received in TTI tti
+  void pdcch_dl(uint32_t tti, uint32_t pid);
+  void pdcch_ul(uint32_t tti);
+  // A NACK starts the retransmission timer after the HARQ RTT
+  void dl_tb_decoded(uint32_t pid, bool ack);
+  // DRX Command MAC CE
+  void drx_command(uint32_t tti);
+  
+private:
+  const static uint32_t HARQ_RTT    = 8;   // FDD
+  const static uint32_t NOF_HARQ_PID = 8; 
+  
+  static bool tti_after(uint32_t a, uint32_t b);
+  void        extend(uint32_t tti);
+  void        hold(uint32_t tti);
+  void        set_cycle(bool is_short);
+  void        start_inactivity(uint32_t tti);
+  void        start_short_cycle(uint32_t tti);
+  
+  pthread_mutex_t mutex; 
+  phy_interface  *phy_h; 
+  srslte::log    *log_h;
+  mac_params     *params_db;
+  bool            initiated;
+  
+  uint32_t on_duration;
+  uint32_t inactivity_timer;
+  uint32_t retx_timer;
+  uint32_t long_cycle;
+  uint32_t offset;
+  uint32_t short_cycle;
+  uint32_t short_cycle_timer; 
+  
+  uint32_t active_until;        // Last TTI of the active time, other than on-durations
+  uint32_t hold_until;          // Part of it a DRX Command does not stop: retransmission timers, keep_active()
+  bool     inactivity_running;
+  uint32_t inactivity_end;
+  bool     short_cycle_running;
+  uint32_t short_cycle_end;
+  uint32_t dl_tti[NOF_HARQ_PID];
+};
+
+} // namespace srsue
+
+#endif // PROCDRX_H
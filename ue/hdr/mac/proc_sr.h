@@ -47,6 +47,7 @@ public:
   void reset();
   void start();
   bool need_random_access(); 
+  bool is_pending(); 
   
 private:
   uint32_t      sr_counter;
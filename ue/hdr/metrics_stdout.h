@@ -53,6 +53,8 @@ public:
 
 private:
   void        print_metrics();
+  void        print_threads();
+  void        print_latency();
   void        print_disconnect();
   std::string float_to_string(float f, int digits);
   std::string float_to_eng_string(float f, int digits);
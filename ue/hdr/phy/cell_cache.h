@@ -0,0 +1,59 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         cell_cache.h
+ *  Description:  Last cell the PHY synchronized to, saved to a small text
+ *                file so that the next start can try a MIB sync on it
+ *                before a full cell search.
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef UECELLCACHE_H
+#define UECELLCACHE_H
+
+#include <string>
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+typedef struct {
+  float         dl_freq;      // Hz
+  srslte_cell_t cell;         // id, cp, nof_prb and nof_ports are saved
+  float         cfo;          // Hz
+  float         gain;         // dB, AGC gain or fixed RX gain
+} cell_cache_t;
+
+class cell_cache
+{
+public:
+  static bool load(std::string filename, cell_cache_t *c);
+  static bool save(std::string filename, cell_cache_t *c);
+};
+
+} // namespace srsue
+
+#endif // UECELLCACHE_H
@@ -0,0 +1,123 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         cell_search_par.h
+ *  Description:  PSS cell search that correlates the three N_id_2 hypotheses
+ *                in parallel over the same samples, instead of receiving a
+ *                new set of frames for each of them. Each hypothesis runs
+ *                its own srslte_ue_cellsearch_t on a thread, reading from a
+ *                sample_fanout. The fanout receives every sample from the
+ *                radio once into a ring, and each reader keeps its own read
+ *                position. Only the first hypothesis drives the AGC.
+ *  Reference:    3GPP TS 36.211 6.11.1
+ *****************************************************************************/
+
+#ifndef UECELLSEARCHPAR_H
+#define UECELLSEARCHPAR_H
+
+#include <pthread.h>
+#include <vector>
+#include "srslte/srslte.h"
+#include "radio/radio.h"
+#include "common/threads.h"
+
+namespace srsue {
+
+/* Single producer ring shared by nof_readers readers. The reader that runs out of samples reads the 
+ * next block from the radio. Readers ahead of the slowest by more than the ring length wait. */
+class sample_fanout
+{
+public:
+  sample_fanout();
+  ~sample_fanout();
+
+  bool init(srslte::radio *radio, uint32_t nof_readers, uint32_t ring_len, double srate);
+
+  // Same arguments and return as the srslte_ue_sync receive callback
+  int  recv(uint32_t reader, cf_t *data, uint32_t nsamples, srslte_timestamp_t *t);
+
+  // The reader will not call recv() again, it no longer holds samples in the ring
+  void done(uint32_t reader);
+
+  // Samples received from the radio
+  uint64_t get_nof_received();
+
+private:
+  bool     read_radio(uint64_t pos, uint32_t nsamples);
+  uint64_t min_pos();
+
+  srslte::radio        *radio_h;
+  cf_t                 *ring;
+  uint32_t              ring_len;
+  double                srate;
+  std::vector<uint64_t> pos;        // Next sample of each reader
+  std::vector<bool>     active;
+  uint64_t              head;       // Samples written to the ring
+  bool                  reading;    // A reader is receiving from the radio outside the lock
+  bool                  error;
+  srslte_timestamp_t    t0;         // Time of sample t0_pos
+  uint64_t              t0_pos;
+  pthread_mutex_t       mutex;
+  pthread_cond_t        cvar;
+};
+
+class cell_search_par
+{
+public:
+  cell_search_par();
+
+  /* Scans the 3 N_id_2 at 1.92 MHz for nof_frames 5 ms frames. The radio must be tuned and 
+   * streaming. gain is the initial AGC gain if do_agc is set, and is updated with the final one. 
+   * Returns the number of N_id_2 where a cell was found, max_N_id_2 is the strongest, or -1 */
+  int scan(srslte::radio *radio, uint32_t nof_frames, float threshold, bool do_agc, float *gain, 
+           srslte_ue_cellsearch_result_t found_cells[3], uint32_t *max_N_id_2);
+
+  const static uint32_t RING_FRAMES = 8;       // 5 ms frames buffered for the slower hypotheses
+
+private:
+  class searcher : public thread
+  {
+  public:
+    int                           N_id_2;
+    srslte_ue_cellsearch_t        cs;
+    srslte_ue_cellsearch_result_t result;
+    int                           ret;
+    sample_fanout                *fanout;
+    void                          search();
+  private:
+    void run_thread();
+  };
+
+  static int recv_callback(void *h, void *data, uint32_t nsamples, srslte_timestamp_t *t);
+
+  sample_fanout fanout;
+  searcher      searchers[3];
+};
+
+} // namespace srsue
+
+#endif // UECELLSEARCHPAR_H
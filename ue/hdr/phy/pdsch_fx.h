@@ -0,0 +1,114 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         pdsch_fx.h
+ *  Description:  Fixed-point PDSCH soft bit kernels. Equalized symbols are
+ *                demapped to int16 LLRs, descrambled and rate dematched
+ *                with saturating soft combining straight into the int16
+ *                circular buffers of a softbuffer_fx. Only the turbo
+ *                decoder input is converted back to float.
+ *                LLRs are positive for bit 1, in units of
+ *                1/softbuffer_fx::SCALE_16, using the max-log metrics of
+ *                the Gray mapped constellations (Tosato-Bisaglia) with a
+ *                noise variance of 0.5 like the float path.
+ *                Generic, SSE4.1 (LV_HAVE_SSE) and AVX2 (LV_HAVE_AVX)
+ *                kernels give the same results; the best one supported by
+ *                the CPU is chosen at run time.
+ *  Reference:    3GPP TS 36.211 7.1, 7.2; TS 36.212 5.1.4.1
+ *****************************************************************************/
+
+#ifndef UEPDSCHFX_H
+#define UEPDSCHFX_H
+
+#include <stdint.h>
+#include <vector>
+#include "srslte/srslte.h"
+#include "common/softbuffer_fx.h"
+
+namespace srsue {
+
+class pdsch_fx
+{
+public:
+  typedef enum {
+    ISA_GENERIC = 0, 
+    ISA_SSE41, 
+    ISA_AVX2, 
+    NOF_ISA
+  } isa_t;
+
+  pdsch_fx();
+
+  // Builds the rate dematching tables of all code block sizes. Returns false if isa is not supported
+  bool     init(isa_t isa);
+  isa_t    get_isa();
+
+  static isa_t       best_isa();
+  static bool        isa_supported(isa_t isa);
+  static const char *isa_string(isa_t isa);
+
+  void     demod(srslte_mod_t mod, cf_t *symbols, int16_t *llr, uint32_t nof_symbols);
+
+  // Flips the LLRs where the scrambling sequence c is 1
+  void     descramble(int16_t *llr, uint8_t *c, uint32_t len);
+
+  /* Adds the n_e soft bits e of a code block of cb_len bits, F filler bits and redundancy version rv 
+   * to its circular buffer w, of softbuffer_fx::cb_w_len(cb_len) entries */
+  int      rm_combine(int16_t *w, int16_t *e, uint32_t n_e, uint32_t cb_len, uint32_t rv, uint32_t F);
+
+  // Turbo decoder input, 3*cb_len+12 soft bits, from the circular buffer. Untransmitted bits are 0
+  int      rm_output(int16_t *w, float *d, uint32_t cb_len);
+
+  // Float reference of demod() before rounding to int16
+  static void demod_ref(srslte_mod_t mod, cf_t *symbols, float *llr, uint32_t nof_symbols);
+
+private:
+  typedef void (*demod_fn_t)(const float *in, int16_t *out, uint32_t nof_symbols);
+  typedef void (*descramble_fn_t)(int16_t *llr, const uint8_t *c, uint32_t len);
+  typedef void (*combine_fn_t)(int16_t *w, const int16_t *e, uint32_t len);
+
+  // Circular buffer layout of one code block size
+  typedef struct {
+    uint32_t              cb_len; 
+    uint32_t              R;           // Sub-block interleaver rows
+    uint32_t              N_cb; 
+    std::vector<uint16_t> d_idx;       // Position in w of soft bit i of the turbo decoder input
+    std::vector<uint32_t> nulls;       // Positions of the dummy bits in w, ascending
+  } rm_table_t;
+
+  rm_table_t *get_table(uint32_t cb_len);
+
+  isa_t                   isa; 
+  demod_fn_t              demod_fn[3];   // QPSK, 16QAM, 64QAM
+  descramble_fn_t         descramble_fn; 
+  combine_fn_t            combine_fn; 
+  std::vector<rm_table_t> tables; 
+};
+
+} // namespace srsue
+
+#endif // UEPDSCHFX_H
@@ -0,0 +1,148 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         pdsch_par.h
+ *  Description:  PDSCH decoder that splits the code blocks of a transport
+ *                block across a helper_pool. The calling worker extracts
+ *                the PDSCH resource elements, equalizes, demodulates and
+ *                descrambles, then rate dematching and turbo decoding of
+ *                each code block (with CRC-based early stopping) run as
+ *                independent jobs. The transport block CRC is checked once
+ *                all code blocks have been joined.
+ *                decode_fx() does the same with the int16 soft bits of
+ *                pdsch_fx, combined in place in a 16-bit softbuffer_fx.
+ *                Only single antenna port cells, C-RNTI scrambling and
+ *                subframes without PSS/SSS/PBCH are handled, the caller
+ *                falls back to srslte_pdsch_decode_rnti() otherwise.
+ *  Reference:    3GPP TS 36.211 6.3.5, 6.10.1; TS 36.212 5.1.2, 5.1.4.1.2
+ *****************************************************************************/
+
+#ifndef UEPDSCHPAR_H
+#define UEPDSCHPAR_H
+
+#include <vector>
+#include "srslte/srslte.h"
+#include "common/helper_pool.h"
+#include "common/log.h"
+#include "phy/pdsch_fx.h"
+#include "common/softbuffer_fx.h"
+
+namespace srsue {
+
+class pdsch_par
+{
+public:
+  pdsch_par();
+  ~pdsch_par();
+
+  // Up to max_callers threads call decode(), each with its own caller index. Errors go to log_h
+  bool  init(srslte::helper_pool *pool, srslte::log *log_h, uint32_t max_callers, uint32_t max_its);
+  void  free_buffers();
+
+  static bool is_supported(srslte_cell_t *cell, uint32_t sf_idx);
+
+  // Returns 0 if the transport block CRC is correct, like srslte_pdsch_decode_rnti()
+  int   decode(uint32_t caller, srslte_pdsch_t *pdsch, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffer, 
+               cf_t *sf_symbols, cf_t *ce, float noise_estimate, uint8_t *data);
+
+  // Fixed-point demodulation and soft combining, softbuffer must use 16-bit soft bits
+  int   decode_fx(uint32_t caller, srslte_pdsch_t *pdsch, srslte_pdsch_cfg_t *cfg, softbuffer_fx *softbuffer, 
+                  cf_t *sf_symbols, cf_t *ce, float noise_estimate, uint8_t *data);
+
+  // Rate dematching, turbo decoding and CRC check of a transport block from its soft bits
+  int   decode_tb(uint32_t caller, srslte_cbsegm_t *cb_segm, uint32_t Qm, uint32_t rv, uint32_t nof_e_bits, 
+                  float *e_bits, srslte_softbuffer_rx_t *softbuffer, uint8_t *data);
+
+  // Average turbo iterations per code block of the last transport block decoded by caller
+  float last_noi(uint32_t caller);
+
+  // Iteration cap of the next transport blocks of caller, between 1 and the init() value
+  void  set_max_its(uint32_t caller, uint32_t max_its);
+
+  // Instruction set of the fixed-point kernels, the best one of the CPU
+  pdsch_fx::isa_t get_fx_isa();
+
+private:
+  // Per thread turbo decoder state, helpers first then callers
+  typedef struct {
+    srslte_tdec_t tdec;
+    srslte_crc_t  crc_cb;
+    srslte_crc_t  crc_tb;
+    float        *cb_out;
+    uint8_t      *cb_in;
+  } slot_t;
+
+  // Per caller PDSCH buffers
+  typedef struct {
+    cf_t    *symbols;
+    cf_t    *ce;
+    cf_t    *d;
+    float   *e;
+    int16_t *e16;
+    uint8_t *tb_bits;
+    float    last_noi;
+    uint32_t max_its;
+  } caller_t;
+
+  // Shared by the jobs of one transport block
+  typedef struct {
+    pdsch_par              *q;
+    srslte_cbsegm_t        *cb_segm;
+    uint32_t                Qm;
+    uint32_t                rv;
+    uint32_t                max_its;
+    uint32_t                Gp;
+    uint32_t                gamma;
+    float                  *e_bits;
+    int16_t                *e16_bits;   // Fixed-point path if not NULL
+    srslte_softbuffer_rx_t *softbuffer;
+    softbuffer_fx          *softbuffer_16;
+    uint8_t                *tb_bits;
+    volatile uint32_t       nof_its;
+    volatile uint32_t       crc_ok;     // Single code block only
+    volatile uint32_t       error;
+  } tb_job_t;
+
+  int         run_tb(uint32_t caller, tb_job_t *j);
+  static void cb_job(void *arg, uint32_t idx, uint32_t slot);
+  void        decode_cb(tb_job_t *j, uint32_t i, slot_t *s);
+  static uint32_t get_re(srslte_cell_t *cell, cf_t *input, cf_t *output, srslte_ra_dl_grant_t *grant, 
+                         uint32_t lstart);
+
+  srslte::helper_pool  *pool;
+  srslte::log          *log_h;
+  std::vector<slot_t>   slots;
+  std::vector<caller_t> callers;
+  pdsch_fx              fx;
+  uint32_t              nof_helpers;
+  uint32_t              max_its;
+  bool                  initiated;
+};
+
+} // namespace srsue
+
+#endif // UEPDSCHPAR_H
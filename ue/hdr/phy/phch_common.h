@@ -34,8 +34,14 @@
 #include "common/mac_interface.h"
 #include "radio/radio.h"
 #include "common/log.h"
+#include "common/latency_hist.h"
+#include "phy/pdsch_par.h"
+#include "phy/phch_tx.h"
+#include "phy/phch_meas.h"
 #include "phy/phy_params.h"
 #include "phy/phy_metrics.h"
+#include "phy/worker_scaler.h"
+#include "phy/signal_cache.h"
 
 //#define CONTINUOUS_TX
 
@@ -46,42 +52,28 @@ namespace srsue {
   class phch_common {
   public:
     
-    phch_common() {
-      pathloss = 0; 
-      cur_pathloss = 0; 
-      rsrp_filtered = 0; 
-      cur_pusch_power = 0; 
-      p0_preamble = 0; 
-      cur_radio_power = 0; 
-      rx_gain_offset = 0;
-      bzero(&dl_metrics, sizeof(dl_metrics_t));
-      dl_metrics_read = true;
-      dl_metrics_count = 0;
-      bzero(&ul_metrics, sizeof(ul_metrics_t));
-      ul_metrics_read = true;
-      ul_metrics_count = 0;
-      bzero(&sync_metrics, sizeof(sync_metrics_t));
-      sync_metrics_read = true;
-      sync_metrics_count = 0;
-    }
-    
     /* Common variables used by all phy workers */
     phy_params        *params_db; 
     srslte::log       *log_h;
     mac_interface_phy *mac;
     srslte_ue_ul_t     ue_ul; 
-    
-    /* Power control variables */
-    float pathloss;
+    pdsch_par         *pdsch_dec;   // NULL if PDSCH helpers and the fixed-point path are disabled
+    worker_scaler     *scaler;      // NULL if the number of workers is fixed
+    signal_cache      *sig_cache;   // C-RNTI sequences generated once for all workers, NULL if disabled
+    phch_meas         *meas;        // Workers push their DL measurements here
+    
+    /* Power control variables. pathloss, rsrp_filtered and rx_gain_offset are written by the 
+     * measurement thread only */
+    volatile float pathloss;
     float cur_pathloss;
     float p0_preamble;     
     float cur_radio_power; 
     float cur_pusch_power;
-    float rsrp_filtered;
-    float rx_gain_offset;
+    volatile float rsrp_filtered;
+    volatile float rx_gain_offset;
 
-    phch_common(uint32_t max_mutex);
-    void init(phy_params *_params, srslte::log *_log, srslte::radio *_radio, mac_interface_phy *_mac);
+    phch_common();
+    void init(phy_params *_params, srslte::log *_log, srslte::radio *_radio, mac_interface_phy *_mac, phch_tx *_tx);
     
     /* For RNTI searches, -1 means now or forever */    
     void               set_ul_rnti(srslte_rnti_type_t type, uint16_t rnti_value, int tti_start = -1, int tti_end = -1);
@@ -92,6 +84,12 @@ namespace srsue {
     uint16_t           get_dl_rnti(uint32_t tti);
     srslte_rnti_type_t get_dl_rnti_type();
     
+    /* Connected mode DRX, see phy_interface. C-RNTI searches are skipped outside the active time, 
+     * except UL searches in subframes with a PHICH pending */
+    void               drx_set_cycle(uint32_t cycle, uint32_t offset, uint32_t on_duration);
+    void               drx_set_active_until(uint32_t tti);
+    bool               drx_active(uint32_t tti);
+    
     void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]);
     bool get_pending_rar(uint32_t tti, srslte_dci_rar_grant_t *rar_grant = NULL);
     
@@ -100,9 +98,16 @@ namespace srsue {
     bool get_pending_ack(uint32_t tti);    
     bool get_pending_ack(uint32_t tti, uint32_t *I_lowest, uint32_t *n_dmrs);
         
-    void worker_end(uint32_t tti, bool tx_enable, cf_t *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time);
+    /* Sync thread reserves the TX slot of each dispatched subframe, in reception order. Workers 
+     * hand the UL subframe to the TX thread with the returned sequence number, without blocking */
+    uint32_t tx_reserve(srslte_timestamp_t tx_time, uint32_t nof_samples, uint64_t deadline_ns);
+    void     worker_end(uint32_t tx_seq, uint32_t tti, bool tx_enable, cf_t *buffer, uint32_t nof_samples);
     
-    void set_nof_mutex(uint32_t nof_mutex);
+    /* The UL subframe of a TTI goes on air 3 ms after its DL subframe is received (rx_ns), minus 
+     * the time advance. The TX thread needs it TX_MARGIN_NS before that, the deadline of the 
+     * workers, the TX thread and the turbo iteration cap */
+    static uint64_t tx_deadline_ns(uint64_t rx_ns, float time_adv_sec);
+    const static uint64_t TX_MARGIN_NS = 200000;
     
     bool sr_enabled; 
     int  sr_last_tx_tti; 
@@ -118,14 +123,28 @@ namespace srsue {
     void set_sync_metrics(const sync_metrics_t &m);
     void get_sync_metrics(sync_metrics_t &m);
 
+    /* Stage times of one TTI in ns, only stages whose bit is set in mask are recorded. 
+     * slack_ns is the margin left to tx_deadline_ns(), negative if missed. The total time is 
+     * also passed to the worker scaler. Lock-free. */
+    void add_latency(uint64_t stage_ns[PHY_NOF_STAGES], uint32_t mask, int64_t slack_ns);
+    void get_latency_metrics(latency_metrics_t &m);
+    // Histograms since the previous dump 
+    void print_latency(FILE *f);
+
+    /* Turbo iteration cap and average iterations per code block of a decoded TB. 
+     * met is false if its TTI missed the HARQ deadline. Lock-free. */
+    void add_pdsch_its(uint32_t granted, float used, bool capped, bool met);
+
+    /* Subframe with a C-RNTI configured, whether its PDCCH was monitored and the time spent in 
+     * FFT and PDCCH decoding. Lock-free. */
+    void add_drx_tti(bool monitored, uint64_t pdcch_ns);
+
     void reset_ul();
     
   private: 
     
-    std::vector<pthread_mutex_t>    tx_mutex; 
-    
-    bool               is_first_of_burst;
     srslte::radio      *radio_h;
+    phch_tx            *tx_h;
     float              cfo;
     
     
@@ -148,11 +167,7 @@ namespace srsue {
     } pending_ack_t;
     pending_ack_t pending_ack[10];
     
-    bool            is_first_tx;
-
     uint32_t        nof_workers;
-    uint32_t        nof_mutex;
-    uint32_t        max_mutex;
 
     srslte_cell_t   cell;
 
@@ -165,6 +180,28 @@ namespace srsue {
     sync_metrics_t  sync_metrics;
     uint32_t        sync_metrics_count;
     bool            sync_metrics_read;
+
+    // Interval histograms are reset by get_latency_metrics(), total ones are never reset
+    latency_hist      stage_hist[2][PHY_NOF_STAGES];
+    latency_hist      slack_hist[2];
+    volatile uint32_t deadline_miss[2];
+
+    // Read and reset by get_dl_metrics(), used iterations in 1/100
+    volatile uint32_t its_nof_tb;
+    volatile uint32_t its_granted_sum;
+    volatile uint32_t its_used_sum;
+    volatile uint32_t its_capped;
+    volatile uint32_t its_miss_avoided;
+    
+    volatile uint32_t drx_cycle;
+    volatile uint32_t drx_offset;
+    volatile uint32_t drx_on_duration;
+    volatile uint32_t drx_until;
+    
+    // Read and reset by get_dl_metrics()
+    volatile uint32_t drx_nof_tti;
+    volatile uint32_t drx_monitored;
+    volatile uint32_t drx_pdcch_us;
   };
   
 } // namespace srsue
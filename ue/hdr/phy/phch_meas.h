@@ -0,0 +1,116 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         phch_meas.h
+ *  Description:  Downlink measurement stage of the PHY. Workers push the raw
+ *                linear RSRP, RSRQ, RSSI, noise and SNR of each subframe,
+ *                with their DL/UL metrics, into a lock-free queue and never
+ *                wait. A normal priority thread drains it periodically and
+ *                is the only writer of the RX gain offset, the L3 filtered
+ *                RSRP and the pathloss in phch_common, and of the DL/UL
+ *                metric averages.
+ *  Reference:    3GPP TS 36.331 5.5.3.2
+ *****************************************************************************/
+
+#ifndef UEPHYMEAS_H
+#define UEPHYMEAS_H
+
+#include "srslte/srslte.h"
+#include "common/threads.h"
+#include "common/log.h"
+#include "radio/radio.h"
+#include "phy/phy_params.h"
+#include "phy/phy_metrics.h"
+
+namespace srsue {
+
+class phch_common; 
+
+class phch_meas : public thread
+{
+public:
+  typedef struct {
+    uint32_t     tti;
+    float        rsrp;          // Linear, as returned by the channel estimator
+    float        rsrq;
+    float        rssi;
+    float        noise;
+    float        snr;
+    float        turbo_iters;
+    float        dl_mcs;
+    ul_metrics_t ul;
+  } sample_t;
+
+  phch_meas();
+  ~phch_meas();
+  // prio -1 runs at normal priority
+  bool     init(phch_common *common, srslte::radio *radio_h, phy_params *params_db, srslte::log *log_h, int prio = -1);
+  void     stop();
+
+  // Workers. Never blocks, the sample is dropped if the queue is full
+  bool     push(const sample_t &s);
+
+  // Filters all pending samples, returns their number. Measurement thread only.
+  uint32_t process();
+
+  // Samples dropped since the last call
+  uint32_t get_dropped();
+
+  // Samples are drained every PERIOD_US, the queue holds several periods
+  const static uint32_t PERIOD_US   = 5000;
+  const static uint32_t NOF_SAMPLES = 64;
+  // RX gain offset update period, in subframes
+  const static uint32_t GAIN_OFFSET_PERIOD = 20;
+
+private:
+  typedef struct {
+    volatile uint32_t seq;
+    sample_t          s;
+  } slot_t;
+
+  void     run_thread();
+  bool     pop(sample_t *s);
+  void     update_gain_offset(sample_t *s);
+  void     update_filter(sample_t *s);
+
+  phch_common      *common;
+  srslte::radio    *radio_h;
+  phy_params       *params_db;
+  srslte::log      *log_h;
+  bool              running;
+
+  slot_t            slots[NOF_SAMPLES];
+  volatile uint32_t head;           // Next slot to write
+  uint32_t          tail;           // Next slot to read
+  volatile uint32_t nof_dropped;
+
+  int               last_offset_tti;
+};
+
+} // namespace srsue
+
+#endif // UEPHYMEAS_H
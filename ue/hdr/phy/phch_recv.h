@@ -35,6 +35,9 @@
 #include "phy/prach.h"
 #include "phy/phch_worker.h"
 #include "phy/phch_common.h"
+#include "phy/cell_search_par.h"
+#include "phy/cell_cache.h"
+#include "phy/rx_ring.h"
 
 namespace srsue {
     
@@ -56,13 +59,24 @@ public:
 
   void    set_time_adv_sec(float time_adv_sec);
   void    get_current_cell(srslte_cell_t *cell);
-  
-  const static int MUTEX_X_WORKER = 4; 
+
+  /* Carriers scanned in order by the cell search, until a MIB is decoded. Call before sync_start(). 
+   * If empty, the cell is searched in the frequency the radio is tuned to */
+  void    set_frequencies(const std::vector<float> &dl_freq, const std::vector<float> &ul_freq);
+  // The cached cell is tried before the first full search, and updated every time SFN sync is achieved. "" disables it
+  void    set_cell_cache(std::string filename);
 
 private:
   
   void   run_thread();
   int    sync_sfn();
+  bool   search_pss(int force_N_id_2);
+  bool   decode_mib();
+  bool   search_cached();
+  void   set_frequency(uint32_t idx);
+  void   save_cell();
+  void   dispatch_ring();
+  void   skip_ring(uint32_t nof_sf);
   
   bool   running; 
   
@@ -94,8 +108,15 @@ private:
   
   float         last_gain;
   float         cellsearch_cfo;
-  uint32_t      nof_tx_mutex;
-  uint32_t      tx_mutex_cnt;
+  uint64_t      last_tti_ns;    // Return time of the previous subframe, for TTI lateness
+  rx_ring       rx_buffers;     // Subframes received while no worker was idle
+
+  cell_search_par    searcher;
+  std::vector<float> dl_freqs;
+  std::vector<float> ul_freqs;
+  uint32_t           cur_freq;        // Index in dl_freqs of the current cell
+  std::string        cache_file;
+  bool               cache_pending;   // The cached cell has not been tried yet
     
   bool          cell_search(int force_N_id_2 = -1);
   bool          init_cell();
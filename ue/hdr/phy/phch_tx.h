@@ -0,0 +1,113 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         phch_tx.h
+ *  Description:  Radio transmit thread of the PHY. The sync thread reserves
+ *                one slot per dispatched subframe in a lock-free ring, in
+ *                reception order. Workers copy their UL subframe into the
+ *                slot and return to the pool without waiting for earlier 
+ *                subframes. This thread hands the slots to the radio in
+ *                order. A slot whose worker misses the HARQ deadline is 
+ *                dropped (or zero-filled in continuous TX mode) and counted,
+ *                and later slots go out on time.
+ *****************************************************************************/
+
+#ifndef UEPHYTX_H
+#define UEPHYTX_H
+
+#include "srslte/srslte.h"
+#include "common/threads.h"
+#include "common/log.h"
+#include "radio/radio.h"
+#include "phy/phy_params.h"
+
+namespace srsue {
+
+class phch_tx : public thread
+{
+public:
+  phch_tx();
+  ~phch_tx();
+  bool     init(srslte::radio *radio_h, phy_params *params_db, srslte::log *log_h, int prio);
+  void     stop();
+
+  // Sync thread only. Returns the sequence number passed to push() by the worker
+  uint32_t reserve(srslte_timestamp_t tx_time, uint32_t nof_samples, uint64_t deadline_ns);
+
+  // Workers. Copies the subframe if tx_enable, never blocks
+  void     push(uint32_t seq, uint32_t tti, bool tx_enable, cf_t *buffer, uint32_t nof_samples);
+
+  // Ends the current burst, e.g. after losing synchronization
+  void     reset();
+
+  // Since the last call
+  uint32_t get_late();
+  uint32_t get_overflow();
+
+  const static uint32_t NOF_SLOTS = 8;
+
+private:
+  typedef enum {
+    SLOT_FREE = 0,
+    SLOT_RESERVED,    // Worker running
+    SLOT_READY,       // Subframe copied by the worker
+    SLOT_DROPPED      // Missed its deadline, released by the worker
+  } slot_state_t;
+
+  typedef struct {
+    volatile uint32_t  state;
+    uint32_t           seq;
+    uint32_t           tti;
+    bool               tx_enable;
+    uint32_t           nof_samples;
+    srslte_timestamp_t tx_time;
+    uint64_t           deadline_ns;
+    cf_t              *buffer;
+  } slot_t;
+
+  void     run_thread();
+  bool     wait_slot(slot_t *s);
+  void     tx_slot(slot_t *s);
+  void     tx_late(slot_t *s);
+
+  srslte::radio    *radio_h;
+  phy_params       *params_db;
+  srslte::log      *log_h;
+  slot_t            slots[NOF_SLOTS];
+  cf_t             *zeros;
+  bool              is_first_of_burst;
+  bool              running;
+  volatile uint32_t reserved_seq;   // Next sequence number to reserve
+  uint32_t          next_seq;       // Next sequence number to transmit
+  volatile uint32_t reset_pending;
+  volatile uint32_t nof_late;
+  volatile uint32_t nof_overflow;
+};
+
+} // namespace srsue
+
+#endif // UEPHYTX_H
@@ -33,6 +33,8 @@
 #include "common/phy_interface.h"
 #include "common/trace.h"
 #include "phy/phch_common.h"
+#include "phy/ue_dl_ctrl.h"
+#include "common/softbuffer_fx.h"
 
 #define LOG_EXECTIME
 
@@ -49,8 +51,10 @@ public:
   
   /* Functions used by main PHY thread */
   cf_t *get_buffer();
-  void  set_tti(uint32_t tti, uint32_t tx_tti); 
-  void  set_tx_time(srslte_timestamp_t tx_time);
+  // Gives the worker another buffer of the same size, returns the one it had
+  cf_t *swap_buffer(cf_t *buffer);
+  // rx_ns is when the subframe was received, deadline_ns from phch_common::tx_deadline_ns()
+  void  set_tti(uint32_t tti, uint32_t tx_seq, uint64_t rx_ns, uint64_t deadline_ns); 
   void  set_cfo(float cfo);
   
   void  set_ul_params();
@@ -62,18 +66,24 @@ public:
   void write_trace(std::string filename);
   
 private: 
+  /* C-RNTI scrambling sequences of the PDSCH and PUSCH, copied from or to an entry of the signal cache */
+  bool  load_crnti_seqs(signal_cache::entry_t *e, uint16_t rnti);
+  void  store_crnti_seqs(signal_cache::key_t *key);
+  
   /* Inherited from thread_pool::worker. Function called every subframe to run the DL/UL processing */
   void work_imp();
 
   
   /* Internal methods */
   bool extract_fft_and_pdcch_llr(); 
+  bool extract_fft_data(); 
   
   /* ... for DL */
   bool decode_pdcch_ul(mac_interface_phy::mac_grant_t *grant);
   bool decode_pdcch_dl(mac_interface_phy::mac_grant_t *grant);
   bool decode_phich(bool *ack); 
-  bool decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, srslte_softbuffer_rx_t* softbuffer, uint32_t rv, uint16_t rnti, uint32_t pid);
+  bool decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, srslte_softbuffer_rx_t* softbuffer, 
+                    softbuffer_fx *fx_softbuffer, uint32_t rv, uint16_t rnti, uint32_t pid);
 
   /* ... for UL */
   void encode_pusch(srslte_ra_ul_grant_t *grant, uint8_t *payload, uint32_t current_tx_nb, srslte_softbuffer_tx_t *softbuffer, 
@@ -92,6 +102,24 @@ private:
   
   void tr_log_start();
   void tr_log_end();
+
+  /* Per-stage latency. Time since the previous stage_end() is accounted to the given stage */
+  void stage_end(phy_stage_t stage);
+  uint64_t stage_ns[PHY_NOF_STAGES];
+  uint32_t stage_mask;
+  uint64_t stage_t0;
+  uint64_t rx_ns;       // When the subframe was received, set by set_tti()
+  uint64_t deadline_ns; // UL subframe handed to the TX thread before this, set by set_tti()
+
+  /* Turbo iteration cap that leaves time to hand the UL subframe to the TX thread by deadline_ns */
+  uint32_t pdsch_its_budget(uint32_t nof_cb, bool helpers);
+  float    its_cost_ns[2];  // Decoding time per code block iteration, worker only and with helpers
+  float    its_tail_ns;     // Time from the end of PDSCH decoding to the UL handoff
+  uint32_t its_granted;     // Cap of the TB decoded in this TTI, 0 if none
+  bool     its_capped;
+  float    last_noi;
+  uint64_t pdsch_end_ns;
+
   struct timeval tr_time[3];
   srslte::trace<uint32_t> tr_exec;
   bool trace_enabled; 
@@ -102,19 +130,22 @@ private:
   bool           cell_initiated; 
   cf_t          *signal_buffer; 
   uint32_t       tti; 
-  uint32_t       tx_tti;
+  uint32_t       tx_seq;      // TX slot reserved by the sync thread
   bool           pregen_enabled;
+  bool           pregen_valid;    // UL signals pregenerated for pregen_dmrs_cfg and pregen_srs_cfg in this cell
   uint32_t       last_dl_pdcch_ncce;
   bool           rnti_is_set; 
+  uint16_t       crnti;
   
   /* Objects for DL */
   srslte_ue_dl_t ue_dl; 
+  srslte_softbuffer_rx_t softbuffer_tmp;  // Soft combining of HARQ processes stored in fixed point
   uint32_t       cfi; 
+  uint32_t       ctrl_symbols;  // Symbols demodulated by ue_dl_ctrl, 0 if the whole subframe is
   uint16_t       dl_rnti;
   
   /* Objects for UL */
   srslte_ue_ul_t     ue_ul; 
-  srslte_timestamp_t tx_time; 
   srslte_uci_data_t  uci_data; 
   uint16_t           ul_rnti;
   
@@ -128,6 +159,8 @@ private:
   srslte_cqi_periodic_cfg_t         period_cqi; 
   srslte_ue_ul_powerctrl_t          power_ctrl;           
   uint32_t                          I_sr; 
+  srslte_refsignal_dmrs_pusch_cfg_t pregen_dmrs_cfg; 
+  srslte_refsignal_srs_cfg_t        pregen_srs_cfg; 
   float                             cfo;
   bool                              rar_cqi_request;
   double snr;
@@ -36,8 +36,14 @@
 #include "phy/phy_params.h"
 #include "phy/phch_worker.h"
 #include "phy/phch_common.h"
+#include "phy/phch_tx.h"
+#include "phy/phch_meas.h"
+#include "phy/pdsch_par.h"
+#include "phy/worker_scaler.h"
+#include "phy/signal_cache.h"
 #include "radio/radio.h"
 #include "common/task_dispatcher.h"
+#include "common/helper_pool.h"
 #include "common/trace.h"
 #include "common/mac_interface.h"
 
@@ -67,8 +73,14 @@ public:
 
   void enable_pregen_signals(bool enable); 
   
+  // Carriers scanned in order by the cell search, and file of the cached cell. Call before sync_start()
+  void set_frequencies(const std::vector<float> &dl_freq, const std::vector<float> &ul_freq);
+  void set_cell_cache(std::string filename);
+
   void start_trace();
   void write_trace(std::string filename); 
+  // Per-stage subframe latency histograms since the previous call
+  void print_latency(FILE *f);
   
   /********** MAC INTERFACE ********************/
   /* Instructs the PHY to configure using the parameters written by set_param() */
@@ -99,6 +111,9 @@ public:
   void    pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
   void    pdcch_ul_search_reset();
   void    pdcch_dl_search_reset();
+  
+  void    drx_set_cycle(uint32_t cycle, uint32_t offset, uint32_t on_duration);
+  void    drx_set_active_until(uint32_t tti);
 
   /* Get/Set PHY parameters */  
   void    set_param(phy_param_t param, int64_t value); 
@@ -113,20 +128,31 @@ public:
   
 private:
     
-  uint32_t nof_workers; 
+  uint32_t nof_workers;   // Worker threads started, not all of them active if WORKERS_SCALING is set
   
   const static int MAX_WORKERS         = 4;
+  const static int MIN_WORKERS         = 2;
   const static int DEFAULT_WORKERS     = 2;
+  const static int DEFAULT_PDSCH_MAX_ITS = 4;
+  const static int DEFAULT_MEAS_FILTER_COEFF = 4;   // fc4, 36.331 default quantityConfig
   
   const static int SF_RECV_THREAD_PRIO = 1;
   const static int WORKERS_THREAD_PRIO = 0; 
+  const static int TX_THREAD_PRIO      = 0; 
+  const static int MEAS_THREAD_PRIO    = -1;    // Normal priority
   
   srslte::radio         *radio_handler;
   srslte::log           *log_h;
 
+  signal_cache             sig_cache;       // Before its users, destroyed after them
   srslte::thread_pool      workers_pool;
   std::vector<phch_worker> workers;
+  srslte::helper_pool      pdsch_helpers;
+  pdsch_par                pdsch_dec; 
+  worker_scaler            workers_scaler; 
   phch_common              workers_common; 
+  phch_tx                  tx_thread; 
+  phch_meas                meas_thread; 
   phch_recv                sf_recv; 
   prach                    prach_buffer; 
   
@@ -34,6 +34,9 @@ struct sync_metrics_t
 {
   float cfo;
   float sfo;
+  float nof_workers;     // Average number of active PHY workers
+  uint32_t sf_late;      // Subframes held in the RX ring until a worker was idle
+  uint32_t sf_skipped;   // Subframes dropped from the RX ring, full or on sync loss
 };
 
 struct dl_metrics_t
@@ -46,6 +49,16 @@ struct dl_metrics_t
   float turbo_iters;
   float mcs;
   float pathloss;
+
+  // Deadline-aware turbo iteration cap, per decoded TB since the last read
+  float    its_granted;    // Average iteration cap
+  float    its_used;       // Average iterations per code block
+  uint32_t its_capped;     // TBs decoded with a cap below PDSCH_MAX_ITS
+  uint32_t miss_avoided;   // Capped TBs whose TTI still met the HARQ deadline
+
+  // Connected mode DRX, since the last read
+  float    drx_sleep;      // Fraction of subframes with the C-RNTI PDCCH not monitored
+  float    drx_saved_us;   // FFT and PDCCH decoding time saved, average per subframe
 };
 
 struct ul_metrics_t
@@ -54,11 +67,49 @@ struct ul_metrics_t
   float power;
 };
 
+// Processing stages of a subframe in phch_worker
+typedef enum {
+  PHY_STAGE_FFT = 0,      // FFT and channel estimation
+  PHY_STAGE_PDCCH_LLR,
+  PHY_STAGE_DL_DCI,
+  PHY_STAGE_PDSCH,
+  PHY_STAGE_PHICH,
+  PHY_STAGE_UL_DCI,
+  PHY_STAGE_UL_ENCODE,    // PUSCH, PUCCH or SRS
+  PHY_STAGE_MAC,          // Calls into the MAC
+  PHY_STAGE_TX_WAIT,      // Handing the UL subframe to the TX thread
+  PHY_STAGE_TOTAL,
+  PHY_NOF_STAGES
+} phy_stage_t;
+
+static const char phy_stage_text[PHY_NOF_STAGES][10] = {"fft", "pdcch_llr", "dl_dci", "pdsch", 
+                                                        "phich", "ul_dci", "ul_enc", "mac", 
+                                                        "tx_wait", "total"};
+
+struct stage_metrics_t
+{
+  uint32_t n;
+  float    avg_us;
+  float    p99_us;
+  float    max_us;
+};
+
+// Since the last read
+struct latency_metrics_t
+{
+  stage_metrics_t stage[PHY_NOF_STAGES];
+  float    slack_p1_us;     // Margin to the HARQ deadline exceeded by 99% of TTIs
+  uint32_t deadline_miss; 
+  uint32_t tx_late;         // UL subframes dropped or zero-filled by the TX thread
+  uint32_t tx_overflow;     // Subframes dispatched while the TX ring was full
+};
+
 struct phy_metrics_t
 {
-  sync_metrics_t sync;
-  dl_metrics_t   dl;
-  ul_metrics_t   ul;
+  sync_metrics_t    sync;
+  dl_metrics_t      dl;
+  ul_metrics_t      ul;
+  latency_metrics_t latency;
   float mabr;
 };
 
@@ -32,6 +32,7 @@
 #include "common/log.h"
 #include "common/phy_interface.h"
 #include "phy/phy_params.h"
+#include "phy/signal_cache.h"
 
 namespace srsue {
 
@@ -41,8 +42,13 @@ namespace srsue {
       params_db = NULL; 
       initiated = false; 
       signal_buffer = NULL; 
+      cache = NULL; 
+      cached = NULL; 
+      prach_initiated = false; 
+      bzero(buffer, sizeof(buffer));
     }
-    void           init(phy_params *params_db, srslte::log *log_h);
+    // Preambles are shared through cache if not NULL
+    void           init(phy_params *params_db, srslte::log *log_h, signal_cache *cache = NULL);
     bool           init_cell(srslte_cell_t cell);
     void           free_cell();
     bool           prepare_to_send(uint32_t preamble_idx, int allowed_subframe = -1, float target_power_dbm = -1);
@@ -59,8 +65,11 @@ namespace srsue {
     int            preamble_idx;  
     int            allowed_subframe; 
     bool           initiated;   
+    bool           prach_initiated; 
     uint32_t       len; 
-    cf_t          *buffer[64]; 
+    cf_t          *buffer[64];        // Point into the cached entry if there is one
+    signal_cache  *cache; 
+    signal_cache::entry_t *cached; 
     srslte_prach_t prach_obj; 
     int            transmitted_tti;
     srslte_cell_t  cell;
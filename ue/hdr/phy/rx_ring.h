@@ -0,0 +1,86 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         rx_ring.h
+ *  Description:  Preallocated ring of received subframes waiting for a PHY
+ *                worker. When no worker is idle the sync thread still reads
+ *                the radio, into the next free slot, and hands the pending
+ *                slots to workers in reception order as they become idle.
+ *                Slot buffers are swapped with the worker buffer instead
+ *                of copied, so they move between the ring and the workers.
+ *                Used by the sync thread only.
+ *****************************************************************************/
+
+#ifndef UERXRING_H
+#define UERXRING_H
+
+#include <stdint.h>
+#include <vector>
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+class rx_ring
+{
+public:
+  typedef struct {
+    cf_t     *buffer;
+    uint32_t  tti;
+    uint32_t  tx_seq;   // TX slot reserved when the subframe was received
+    float     cfo;
+    uint64_t  rx_ns;
+    uint64_t  deadline_ns;
+  } slot_t;
+
+  rx_ring();
+  ~rx_ring();
+
+  // buffer_len in samples. 0 slots disables the ring
+  bool     init(uint32_t nof_slots, uint32_t buffer_len);
+  void     free_buffers();
+
+  uint32_t get_nof_slots();
+  uint32_t get_nof_pending();
+  bool     is_full();
+
+  // Slot for the next subframe, valid while not full. push() queues it
+  slot_t  *next();
+  void     push();
+
+  // Oldest pending subframe, NULL if none. pop() frees its slot
+  slot_t  *front();
+  void     pop();
+
+private:
+  std::vector<slot_t> slots;
+  uint32_t            head;       // Oldest pending
+  uint32_t            nof_pending;
+};
+
+} // namespace srsue
+
+#endif // UERXRING_H
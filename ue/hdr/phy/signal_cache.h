@@ -0,0 +1,125 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         signal_cache.h
+ *  Description:  Content-addressed cache of precomputed PHY signals shared
+ *                by the PRACH and the PHY workers: the 64 PRACH preambles
+ *                of a configuration and the C-RNTI scrambling sequences of
+ *                a cell. Entries are keyed by everything the signal depends
+ *                on, so reattaching, retrying random access or reselecting
+ *                a cell already seen reuses them instead of generating them
+ *                again. Total size is capped, the least recently used
+ *                entries not in use are evicted first.
+ *****************************************************************************/
+
+#ifndef UESIGNALCACHE_H
+#define UESIGNALCACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <list>
+#include <map>
+
+namespace srsue {
+
+class signal_cache
+{
+public:
+  typedef enum {
+    PRACH_PREAMBLES = 0,
+    CRNTI_SEQUENCES,
+  } signal_t;
+
+  // Fields a signal does not depend on are left 0
+  typedef struct {
+    uint32_t type;
+    uint32_t cell_id;
+    uint32_t nof_prb;
+    uint32_t cp;            // srslte_cp_t, the number of PUSCH/PUCCH symbols depends on it
+    uint32_t prach_config;  // Configuration index, high speed flag, zero correlation zone and frequency offset
+    uint32_t root_seq;
+    uint32_t rnti;
+  } key_t;
+
+  typedef struct {
+    key_t    key;
+    uint8_t *data;
+    uint32_t nof_bytes;
+    uint32_t refs;
+    bool     ready;
+  } entry_t;
+
+  signal_cache();
+  ~signal_cache();
+
+  void     set_max_bytes(uint64_t max_bytes);
+
+  // A ready entry of key, held until release(). NULL if there is none
+  entry_t *acquire(key_t *key);
+
+  /* New entry of nof_bytes for key, held by the caller to fill its data and publish() it. NULL if key 
+   * is already cached or being filled, or if nof_bytes does not fit the cap even after evicting. 
+   * Entries released before they are published are dropped */
+  entry_t *insert(key_t *key, uint32_t nof_bytes);
+  void     publish(entry_t *e);
+  void     release(entry_t *e);
+
+  // Evicts all the entries not in use
+  void     clear();
+
+  uint64_t get_nof_bytes();
+  uint32_t get_nof_entries();
+  uint32_t get_nof_hits();
+  uint32_t get_nof_misses();
+  uint32_t get_nof_evicted();
+
+  static key_t prach_key(uint32_t nof_prb, uint32_t config_idx, bool high_speed, uint32_t zc_config, 
+                         uint32_t freq_offset, uint32_t root_seq);
+  static key_t crnti_key(uint32_t cell_id, uint32_t nof_prb, uint32_t cp, uint16_t rnti);
+
+private:
+  struct key_cmp {
+    bool operator()(const key_t &a, const key_t &b) const;
+  };
+  typedef std::map<key_t, entry_t*, key_cmp> map_t;
+
+  bool     evict(uint64_t nof_bytes);
+  void     remove(map_t::iterator it);
+
+  map_t               entries;
+  std::list<entry_t*> lru;      // Most recently used first
+  uint64_t            max_bytes;
+  uint64_t            nof_bytes;
+  uint32_t            nof_hits;
+  uint32_t            nof_misses;
+  uint32_t            nof_evicted;
+  pthread_mutex_t     mutex;
+};
+
+} // namespace srsue
+
+#endif // UESIGNALCACHE_H
@@ -0,0 +1,67 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         ue_dl_ctrl.h
+ *  Description:  Two stage demodulation of a DL subframe. The first stage
+ *                runs the FFT of the control region only: symbol 0 is
+ *                transformed, the channel is estimated from its CRS and the
+ *                CFI decoded from the PCFICH, then the remaining PDCCH/PHICH
+ *                symbols are transformed and given the symbol 0 estimate.
+ *                The second stage transforms the data region and runs the
+ *                full subframe channel estimator, and is only needed once a
+ *                DL grant has been found.
+ *                Up to 2 antenna ports. The full estimator is not run in the
+ *                first stage, so RSRP/RSRQ/SNR are not updated by it.
+ *  Reference:    3GPP TS 36.211 6.7, 6.10.1, 6.12
+ *****************************************************************************/
+
+#ifndef UEDLCTRL_H
+#define UEDLCTRL_H
+
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+class ue_dl_ctrl
+{
+public:
+  static bool is_supported(srslte_cell_t *cell);
+
+  // Returns the number of OFDM symbols demodulated or -1 on error
+  static int  fft_estimate_ctrl(srslte_ue_dl_t *q, cf_t *input, uint32_t sf_idx, uint32_t *cfi);
+
+  // Demodulates the symbols after the first nof_symbols and estimates the whole subframe
+  static int  fft_estimate_data(srslte_ue_dl_t *q, cf_t *input, uint32_t sf_idx, uint32_t nof_symbols);
+
+private:
+  static void  fft_symbols(srslte_ue_dl_t *q, cf_t *input, uint32_t l0, uint32_t l1);
+  static float estimate_symbol0(srslte_ue_dl_t *q, uint32_t sf_idx);
+};
+
+} // namespace srsue
+
+#endif // UEDLCTRL_H
@@ -0,0 +1,90 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         worker_scaler.h
+ *  Description:  Chooses the number of active PHY workers from a moving
+ *                window of per-TTI processing times. A worker is busy for
+ *                the subframe it receives (1 ms) plus its processing time,
+ *                and subframes arrive every 1 ms, so 1+ceil(t/1ms) workers
+ *                are needed for a processing time t. Workers beyond the
+ *                pipeline depth allowed by the TX advance (TTI+4 minus the
+ *                time advance) cannot help and are not used.
+ *                Grows as soon as a recent TTI needs it or the sync thread
+ *                had to wait for a worker, shrinks one worker at a time
+ *                once a whole window fits in fewer.
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef UEWORKERSCALER_H
+#define UEWORKERSCALER_H
+
+#include <stdint.h>
+
+namespace srsue {
+
+class worker_scaler
+{
+public:
+  worker_scaler();
+
+  void     init(uint32_t min_workers, uint32_t max_workers, uint32_t nof_workers);
+
+  // Time from reception of a subframe to handing its UL subframe to the TX thread. Workers, lock-free.
+  void     add_tti(uint64_t busy_ns);
+
+  /* Called by the sync thread every TTI with the time it waited for an idle worker. 
+   * Returns the number of workers that should be active */
+  uint32_t step(float time_adv_sec, uint64_t wait_ns);
+
+  uint32_t get_nof_workers();
+
+  // Workers needed for a processing time and the most that can meet the TX advance
+  static uint32_t workers_needed(uint32_t busy_us);
+  uint32_t        workers_max(float time_adv_sec);
+
+  const static uint32_t WINDOW      = 512;      // TTIs, power of 2
+  const static uint32_t EVAL_PERIOD = 16;       // TTIs between grow decisions
+  const static uint32_t MARGIN_US   = 100;      // Added to the processing time before rounding
+  const static uint32_t STARVED_NS  = 100000;   // Sync thread wait that triggers a grow
+  const static uint32_t STARVED_HOLD = 8;       // Windows without shrinking after a starvation
+
+private:
+  uint32_t max_busy_us(uint32_t nof_tti);
+
+  volatile uint32_t busy_us[WINDOW];
+  volatile uint32_t wr_idx;
+
+  uint32_t min_workers;
+  uint32_t max_workers;
+  uint32_t nof_workers;
+  uint32_t tti_cnt;
+  uint32_t hold;         // TTIs left before shrinking is allowed
+};
+
+} // namespace srsue
+
+#endif // UEWORKERSCALER_H
@@ -0,0 +1,144 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         radio_file.h
+ *  Description:  File-backed radio. RX samples are read from a memory-mapped
+ *                IQ capture (complex float or interleaved int16) and time
+ *                stamped with the number of samples delivered. TX bursts are
+ *                written to a file, each chunk preceded by a
+ *                radio_file_tx_hdr_t with its timestamp. A chunk with zero
+ *                samples marks the end of a burst.
+ *                If the capture sample rate is a multiple of the requested RX
+ *                rate, samples are decimated by averaging, so that a single
+ *                capture at the cell rate can be used for cell search too.
+ *                RX is either paced in real time or delivered as fast as the
+ *                PHY reads it.
+ *****************************************************************************/
+
+#ifndef RADIO_FILE_H
+#define RADIO_FILE_H
+
+#include <stdio.h>
+#include <string>
+#include "radio/radio.h"
+
+namespace srslte {
+
+typedef enum {
+  RADIO_FILE_FC32 = 0,    // Complex float
+  RADIO_FILE_SC16,        // Interleaved int16 I/Q, full scale 32768
+} radio_file_format_t;
+
+typedef struct {
+  int64_t  full_secs;
+  double   frac_secs;
+  uint32_t nof_samples;   // Complex float samples following the header, 0 marks end of burst
+  uint32_t reserved;
+} radio_file_tx_hdr_t;
+
+  class radio_file : public radio
+  {
+    public: 
+      radio_file();
+      ~radio_file();
+
+      // file_srate is the capture sample rate, 0 delivers samples at any requested rate
+      bool init(std::string rx_filename, std::string tx_filename, radio_file_format_t format, 
+                double file_srate, bool loop, bool realtime);
+
+      void get_time(srslte_timestamp_t *now);
+      bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time);
+      bool tx_end();
+      bool rx_now(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time);
+      bool rx_at(void *buffer, uint32_t nof_samples, srslte_timestamp_t rx_time);
+
+      void set_tx_gain(float gain);
+      void set_rx_gain(float gain);
+      double set_rx_gain_th(float gain);
+
+      void set_tx_freq(float freq);
+      void set_rx_freq(float freq);
+
+      void set_master_clock_rate(float rate);
+      void set_tx_srate(float srate);
+      void set_rx_srate(float srate);
+
+      float get_tx_gain();
+      float get_rx_gain();
+      
+      float get_max_tx_power();
+      float set_tx_power(float power);
+      float get_rssi();
+      bool  has_rssi();
+      
+      void start_rx();
+      void stop_rx();
+      
+      void set_tti(uint32_t tti);
+      void tx_offset(int offset);
+      void set_tti_len(uint32_t sf_len);
+      uint32_t get_tti_len();
+
+      // Number of file samples consumed, including loops
+      uint64_t get_nof_rx_samples();
+
+    private:
+      void     read_sample(uint64_t idx, cf_t *s);
+      void     pace(double secs);
+      static double now_secs();
+
+      uint8_t            *rx_map; 
+      size_t              rx_map_len;
+      uint64_t            rx_nof_samples;   // Samples in the capture
+      uint64_t            rx_pos;           // Next sample to read from the capture
+      uint64_t            rx_total;         // Samples consumed, including loops
+      radio_file_format_t format;
+      bool                loop; 
+      bool                realtime;
+      bool                eof;
+      double              file_srate;
+      double              rx_srate;
+      double              tx_srate;
+      uint32_t            decim;
+
+      srslte_timestamp_t  rx_time;          // Timestamp of the next sample delivered
+      double              pace_start;       // Wall clock time of start_rx()
+      double              pace_secs;        // Sample time delivered since start_rx()
+      
+      FILE               *tx_file;
+      srslte_timestamp_t  end_of_burst_time; 
+      bool                in_burst;
+
+      float               rx_gain;
+      float               tx_gain;
+      uint32_t            tti;
+      int                 offset;
+      uint32_t            sf_len;
+  }; 
+}
+
+#endif // RADIO_FILE_H
@@ -0,0 +1,184 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         radio_sim.h
+ *  Description:  Simulated eNodeB radio. The downlink is synthesized one
+ *                subframe at a time with the srsLTE eNodeB primitives: PSS,
+ *                SSS, CRS, PBCH, PCFICH and, every grant_period subframes, a
+ *                PDCCH DCI format 1 grant with its PDSCH carrying the next
+ *                MAC PDU of a scripted stream. Optional AWGN and frequency
+ *                offset are applied on the time-domain signal.
+ *                Two generators run side by side: a 6 PRB one at 1.92 MHz
+ *                used during cell search and one at the cell bandwidth,
+ *                selected by the requested RX sample rate.
+ *                Uplink bursts are checked for length and timing against the
+ *                downlink timestamps instead of being transmitted.
+ *****************************************************************************/
+
+#ifndef RADIO_SIM_H
+#define RADIO_SIM_H
+
+#include <string>
+#include <vector>
+#include "srslte/srslte.h"
+#include "radio/radio.h"
+
+namespace srslte {
+
+typedef struct {
+  uint32_t    nof_prb;
+  uint32_t    cell_id;
+  uint32_t    cfi;
+  uint16_t    rnti;
+  uint32_t    mcs;
+  uint32_t    grant_period;   // Subframes between PDSCH grants, 0 disables PDSCH
+  bool        awgn; 
+  float       snr_db;
+  float       cfo_hz;
+  std::string pdu_file;       // Length-prefixed (uint16) MAC PDUs, empty generates them
+  bool        realtime;
+} radio_sim_args_t;
+
+typedef struct {
+  uint64_t dl_sf;
+  uint64_t dl_grants;
+  uint64_t dl_bytes;
+  uint64_t ul_chunks;         // Calls to tx() 
+  uint64_t ul_bursts;         // Calls to tx_end() closing a burst 
+  uint64_t ul_late;           // Chunks timed before the samples already received
+  uint64_t ul_bad_len;        // Chunks whose length is not a subframe
+} radio_sim_metrics_t;
+
+  class radio_sim : public radio
+  {
+    public: 
+      radio_sim();
+      ~radio_sim();
+
+      bool init(radio_sim_args_t *args);
+      void get_metrics(radio_sim_metrics_t *m);
+
+      // Returns true if a PDU produced by the built-in generator is intact
+      static bool check_pdu(uint8_t *payload, uint32_t nof_bytes);
+
+      void get_time(srslte_timestamp_t *now);
+      bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time);
+      bool tx_end();
+      bool rx_now(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time);
+      bool rx_at(void *buffer, uint32_t nof_samples, srslte_timestamp_t rx_time);
+
+      void set_tx_gain(float gain);
+      void set_rx_gain(float gain);
+      double set_rx_gain_th(float gain);
+
+      void set_tx_freq(float freq);
+      void set_rx_freq(float freq);
+
+      void set_master_clock_rate(float rate);
+      void set_tx_srate(float srate);
+      void set_rx_srate(float srate);
+
+      float get_tx_gain();
+      float get_rx_gain();
+      
+      float get_max_tx_power();
+      float set_tx_power(float power);
+      float get_rssi();
+      bool  has_rssi();
+      
+      void start_rx();
+      void stop_rx();
+      
+      void set_tti(uint32_t tti);
+      void tx_offset(int offset);
+      void set_tti_len(uint32_t sf_len);
+      uint32_t get_tti_len();
+
+    private:
+      typedef struct {
+        srslte_cell_t           cell; 
+        srslte_ofdm_t           ifft; 
+        srslte_pbch_t           pbch; 
+        srslte_regs_t           regs; 
+        srslte_pcfich_t         pcfich; 
+        srslte_pdcch_t          pdcch; 
+        srslte_pdsch_t          pdsch; 
+        srslte_chest_dl_t       est; 
+        srslte_softbuffer_tx_t  softbuffer; 
+        cf_t                    pss_signal[SRSLTE_PSS_LEN];
+        float                   sss_signal0[SRSLTE_SSS_LEN];
+        float                   sss_signal5[SRSLTE_SSS_LEN];
+        cf_t                   *sf_symbols[SRSLTE_MAX_PORTS];
+        cf_t                   *slot1_symbols[SRSLTE_MAX_PORTS];
+        cf_t                   *output; 
+        uint32_t                sf_len; 
+        double                  srate; 
+        bool                    has_pdsch; 
+        bool                    initiated; 
+      } enb_dl_t;
+
+      bool     init_dl(enb_dl_t *q, srslte_cell_t cell, bool has_pdsch);
+      void     free_dl(enb_dl_t *q);
+      void     gen_sf(enb_dl_t *q, uint32_t tti);
+      void     impair(enb_dl_t *q);
+      uint32_t next_pdu(uint8_t *payload, uint32_t nof_bytes);
+      bool     load_pdus(std::string filename);
+      void     pace(double secs);
+      static double now_secs();
+
+      radio_sim_args_t    args; 
+      enb_dl_t            dl_search;        // 6 PRB at 1.92 MHz
+      enb_dl_t            dl_cell;          // Full cell bandwidth
+      enb_dl_t           *dl;               // Generator matching the RX rate
+
+      uint32_t            tti;              // TTI being delivered
+      uint32_t            sf_pos;           // Next sample of the current subframe
+      uint32_t            pdu_seq; 
+      uint32_t            pdu_idx; 
+      std::vector<std::vector<uint8_t> > pdus; 
+      uint8_t             bch_payload[SRSLTE_BCH_PAYLOAD_LEN];
+      uint8_t            *data; 
+      bool                ndi[8]; 
+      double              cfo_phase; 
+
+      srslte_timestamp_t  rx_time;          // Timestamp of the next sample delivered
+      double              pace_start; 
+      double              pace_secs; 
+      double              rx_srate; 
+      double              tx_srate; 
+      bool                in_burst; 
+      radio_sim_metrics_t metrics; 
+
+      float               rx_gain;
+      float               tx_gain;
+      uint32_t            cur_tti;
+      int                 offset;
+      uint32_t            sf_len;
+  }; 
+}
+
+#endif // RADIO_SIM_H
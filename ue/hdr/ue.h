@@ -38,6 +38,8 @@
 #include <pthread.h>
 
 #include "radio/radio_uhd.h"
+#include "radio/radio_file.h"
+#include "radio/radio_sim.h"
 #include "phy/phy.h"
 #include "mac/mac.h"
 #include "upper/rlc.h"
@@ -63,8 +65,16 @@ namespace srsue {
 typedef struct {
   float         dl_freq;
   float         ul_freq;
+  std::string   dl_earfcn;
   float         rx_gain;
   float         tx_gain;
+  std::string   device;
+  std::string   file_rx;
+  std::string   file_tx;
+  std::string   file_format;
+  double        file_srate;
+  bool          file_loop;
+  bool          file_realtime;
 }rf_args_t;
 
 typedef struct {
@@ -98,6 +108,9 @@ typedef struct {
   int           usim_hex_limit;
   int           all_hex_limit;
   std::string   filename;
+  bool          binary;
+  std::string   overflow;
+  int           ring_size;
 }log_args_t;
 
 typedef struct {
@@ -106,6 +119,7 @@ typedef struct {
   float ul_pwr_ctrl_offset;
   float rx_gain_offset;
   int pdsch_max_its;
+  bool pdsch_adaptive_its;
   float sync_track_th;
   float sync_track_avg_coef;
   float sync_find_th;
@@ -113,16 +127,44 @@ typedef struct {
   bool enable_64qam_attach; 
   bool continuous_tx;
   int nof_phy_threads;  
+  int phy_spin_us;
+  int pdsch_helpers;
+  int pdsch_helpers_min_prb;
+  bool lazy_pdsch_fft;
+  bool phy_worker_scaling;
+  std::string cell_cache;
+  int harq_softbuffer_bits;
+  bool pdsch_fixed_point;
+  int signal_cache_mb;
+  int rx_ring_sf;
 }expert_args_t;
 
+// Thread placement specs, "<cpus>[@<prio_offset>]" (see common/thread_affinity.h)
+typedef struct {
+  std::string phy_worker;
+  std::string phy_helper;
+  std::string phy_tx;
+  std::string phy_meas;
+  std::string sync;
+  std::string mac;
+  std::string mac_pdu;
+  std::string mac_timers;
+  std::string gw;
+  std::string logger;
+  std::string timeout;
+  std::string metrics;
+}affinity_args_t;
+
 typedef struct {
   std::string   usrp_args;
   rf_args_t     rf;
+  srslte::radio_sim_args_t sim;
   pcap_args_t   pcap;
   trace_args_t  trace;
   log_args_t    log;
   usim_args_t   usim;
   expert_args_t expert;
+  affinity_args_t affinity;
 }all_args_t;
 
 /*******************************************************************************
@@ -144,13 +186,18 @@ public:
 
   // UE metrics interface
   bool get_metrics(ue_metrics_t &m);
+  // Dumps the PHY latency histograms to stdout
+  void print_latency();
 
 private:
   static ue *instance;
   ue();
   ~ue();
 
-  srslte::radio_uhd radio_uhd;
+  srslte::radio_uhd  radio_uhd;
+  srslte::radio_file radio_file;
+  srslte::radio_sim  radio_sim;
+  srslte::radio     *radio;
   srsue::phy        phy;
   srsue::mac        mac;
   srsue::mac_pcap   mac_pcap;
@@ -179,9 +226,13 @@ private:
   uhd_metrics_t     uhd_metrics;
 
   srslte::LOG_LEVEL_ENUM level(std::string l);
+  bool                   overflow(std::string o, srsue::log_overflow_t *policy);
   
   bool check_srslte_version();
   void set_expert_parameters();
+  bool set_thread_affinity();
+  bool get_frequencies(std::vector<float> &dl_freqs, std::vector<float> &ul_freqs);
+  bool init_radio();
 };
 
 } // namespace srsue
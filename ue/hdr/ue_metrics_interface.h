@@ -29,6 +29,9 @@
 
 #include "mac/mac_metrics.h"
 #include "phy/phy_metrics.h"
+#include "common/buffer_pool.h"
+#include "common/logger.h"
+#include "common/thread_affinity.h"
 
 namespace srsue {
 
@@ -43,6 +46,9 @@ typedef struct {
   uhd_metrics_t uhd;
   phy_metrics_t phy;
   mac_metrics_t mac;
+  buffer_pool_metrics_t pool;
+  log_metrics_t log;
+  threads_metrics_t threads;
 }ue_metrics_t;
 
 // UE interface
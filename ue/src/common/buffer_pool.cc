@@ -27,9 +27,22 @@
 
 #include "common/buffer_pool.h"
 #include <stdio.h>
+#include <algorithm>
 
 namespace srsue{
 
+/* Size class configuration. Every class keeps the SRSUE_BUFFER_HEADER_OFFSET
+ * headroom of the original fixed-size buffers, which the RLC, PDCP and MAC
+ * header prepends rely on. Classes differ in the payload after it.
+ */
+static const uint32_t class_size[BUFFER_POOL_N_CLASSES]     = {SRSUE_BUFFER_HEADER_OFFSET+512,
+                                                               SRSUE_BUFFER_HEADER_OFFSET+2048,
+                                                               SRSUE_MAX_BUFFER_SIZE_BYTES};
+static const uint32_t class_headroom[BUFFER_POOL_N_CLASSES] = {SRSUE_BUFFER_HEADER_OFFSET,
+                                                               SRSUE_BUFFER_HEADER_OFFSET,
+                                                               SRSUE_BUFFER_HEADER_OFFSET};
+static const uint32_t class_nof_bufs[BUFFER_POOL_N_CLASSES] = {1024, 1024, 1024};
+
 buffer_pool* buffer_pool::instance = NULL;
 boost::mutex buffer_pool::instance_mutex;
 
@@ -53,45 +66,223 @@ void buffer_pool::cleanup(void)
 
 buffer_pool::buffer_pool()
 {
-  pool = new byte_buffer_t[POOL_SIZE];
-  first_available = &pool[0];
-  for(int i=0;i<POOL_SIZE-1;i++)
+  for(uint32_t c=0;c<BUFFER_POOL_N_CLASSES;c++)
+  {
+    size_class_t *sc    = &classes[c];
+    sc->nof_buffers     = class_nof_bufs[c];
+    sc->buffer_size     = class_size[c];
+    sc->headroom        = class_headroom[c];
+    sc->storage         = new uint8_t[sc->nof_buffers*sc->buffer_size];
+    sc->bufs            = new byte_buffer_t*[sc->nof_buffers];
+    sc->head            = 0;
+    sc->allocated       = 0;
+    sc->high_water_mark = 0;
+    sc->alloc_failures  = 0;
+    for(uint32_t i=0;i<sc->nof_buffers;i++)
+    {
+      sc->bufs[i] = new byte_buffer_t(&sc->storage[i*sc->buffer_size], sc->buffer_size, sc->headroom);
+      sc->bufs[i]->size_class = c;
+      sc->bufs[i]->pool_idx   = i;
+    }
+    // Push in reverse order so that the first allocations return the first buffers
+    for(int i=sc->nof_buffers-1;i>=0;i--)
+    {
+      push(sc, sc->bufs[i]);
+    }
+  }
+  pthread_key_create(&cache_key, thread_cache_destructor);
+}
+
+buffer_pool::~buffer_pool()
+{
+  pthread_key_delete(cache_key);
   {
-    pool[i].set_next(&pool[i+1]);
+    boost::lock_guard<boost::mutex> lock(cache_mutex);
+    for(uint32_t i=0;i<caches.size();i++)
+      delete caches[i];
+    caches.clear();
+  }
+  for(uint32_t c=0;c<BUFFER_POOL_N_CLASSES;c++)
+  {
+    for(uint32_t i=0;i<classes[c].nof_buffers;i++)
+      delete classes[c].bufs[i];
+    delete [] classes[c].bufs;
+    delete [] classes[c].storage;
   }
-  pool[POOL_SIZE-1].set_next(NULL);
-  allocated = 0;
 }
 
 byte_buffer_t* buffer_pool::allocate()
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
+  return allocate_class(BUFFER_POOL_CLASS_LARGE);
+}
+
+byte_buffer_t* buffer_pool::allocate(uint32_t nof_bytes)
+{
+  for(uint32_t c=0;c<BUFFER_POOL_N_CLASSES;c++)
+  {
+    if(nof_bytes <= class_size[c]-class_headroom[c])
+      return allocate_class(c);
+  }
+  printf("Error - buffer pool can't allocate %d bytes\n", nof_bytes);
+  return NULL;
+}
+
+void buffer_pool::deallocate(byte_buffer_t *b)
+{
+  if(!b)
+    return;
+
+  b->reset();
+
+  // Buffers which own their storage were not allocated by the pool
+  if(b->owner)
+    return;
 
-  if(first_available == NULL)
+  uint32_t        c     = b->size_class;
+  size_class_t   *sc    = &classes[c];
+  thread_cache_t *cache = get_thread_cache();
+
+  __sync_fetch_and_sub(&sc->allocated, 1);
+
+  if(cache)
   {
-    printf("Error - buffer pool is empty");
-    return NULL;
+    // Magazine full - return half of it to the shared stack
+    if(cache->count[c] == MAGAZINE_SIZE)
+    {
+      while(cache->count[c] > MAGAZINE_SIZE/2)
+        push(sc, cache->bufs[c][--cache->count[c]]);
+    }
+    cache->bufs[c][cache->count[c]++] = b;
+  }else{
+    push(sc, b);
   }
+}
 
-  // Remove from available list
-  byte_buffer_t* b = first_available;
-  first_available = b->get_next();
-  allocated++;
+void buffer_pool::get_metrics(buffer_pool_metrics_t &m)
+{
+  for(uint32_t c=0;c<BUFFER_POOL_N_CLASSES;c++)
+  {
+    m.size_class[c].nof_buffers     = classes[c].nof_buffers;
+    m.size_class[c].buffer_size     = classes[c].buffer_size;
+    m.size_class[c].allocated       = classes[c].allocated;
+    m.size_class[c].high_water_mark = classes[c].high_water_mark;
+    m.size_class[c].alloc_failures  = classes[c].alloc_failures;
+  }
+}
 
+/*******************************************************************************
+  Helpers
+*******************************************************************************/
+
+byte_buffer_t* buffer_pool::allocate_class(uint32_t c)
+{
+  thread_cache_t *cache = get_thread_cache();
+  byte_buffer_t  *b     = NULL;
+
+  // Fall back to larger classes if a class is exhausted
+  for(uint32_t i=c;i<BUFFER_POOL_N_CLASSES && !b;i++)
+  {
+    size_class_t *sc = &classes[i];
+    if(cache)
+    {
+      // Magazine empty - refill half of it from the shared stack
+      if(cache->count[i] == 0)
+      {
+        byte_buffer_t *r;
+        while(cache->count[i] < MAGAZINE_SIZE/2 && (r = pop(sc)) != NULL)
+          cache->bufs[i][cache->count[i]++] = r;
+      }
+      if(cache->count[i] > 0)
+        b = cache->bufs[i][--cache->count[i]];
+    }else{
+      b = pop(sc);
+    }
+    if(b)
+    {
+      uint32_t n   = __sync_add_and_fetch(&sc->allocated, 1);
+      uint32_t hwm = sc->high_water_mark;
+      while(n > hwm && !__sync_bool_compare_and_swap(&sc->high_water_mark, hwm, n))
+        hwm = sc->high_water_mark;
+    }
+  }
+
+  // Only a request that no class could serve is a failure, counted on the requested class
+  if(!b)
+  {
+    __sync_fetch_and_add(&classes[c].alloc_failures, 1);
+    printf("Error - buffer pool is empty\n");
+  }
   return b;
 }
 
-void buffer_pool::deallocate(byte_buffer_t *b)
+byte_buffer_t* buffer_pool::pop(size_class_t *sc)
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
+  uint64_t old_head, new_head;
+  uint32_t idx;
+  do{
+    old_head = sc->head;
+    idx      = (uint32_t) old_head;
+    if(idx == 0)
+      return NULL;
+    byte_buffer_t *next = sc->bufs[idx-1]->get_next();
+    new_head = ((old_head>>32)+1)<<32 | (next ? next->pool_idx+1 : 0);
+  }while(!__sync_bool_compare_and_swap(&sc->head, old_head, new_head));
+  return sc->bufs[idx-1];
+}
 
-  // Add to front of available list
-  b->reset();
-  b->set_next(first_available);
-  first_available = b;
-  allocated--;
+void buffer_pool::push(size_class_t *sc, byte_buffer_t *b)
+{
+  uint64_t old_head, new_head;
+  do{
+    old_head = sc->head;
+    uint32_t idx = (uint32_t) old_head;
+    b->set_next(idx ? sc->bufs[idx-1] : NULL);
+    new_head = ((old_head>>32)+1)<<32 | (b->pool_idx+1);
+  }while(!__sync_bool_compare_and_swap(&sc->head, old_head, new_head));
 }
 
+buffer_pool::thread_cache_t* buffer_pool::get_thread_cache()
+{
+  thread_cache_t *cache = (thread_cache_t*) pthread_getspecific(cache_key);
+  if(NULL == cache)
+  {
+    cache = new thread_cache_t;
+    memset(cache->count, 0, sizeof(cache->count));
+    if(pthread_setspecific(cache_key, cache))
+    {
+      delete cache;
+      return NULL;
+    }
+    boost::lock_guard<boost::mutex> lock(cache_mutex);
+    caches.push_back(cache);
+  }
+  return cache;
+}
+
+void buffer_pool::flush_thread_cache(thread_cache_t *cache)
+{
+  for(uint32_t c=0;c<BUFFER_POOL_N_CLASSES;c++)
+  {
+    while(cache->count[c] > 0)
+      push(&classes[c], cache->bufs[c][--cache->count[c]]);
+  }
+}
 
+// Called on thread exit - return the magazines of the exiting thread
+void buffer_pool::thread_cache_destructor(void *cache_)
+{
+  thread_cache_t *cache = (thread_cache_t*) cache_;
+  boost::lock_guard<boost::mutex> lock(instance_mutex);
+  if(NULL == instance)
+    return;
+  boost::lock_guard<boost::mutex> cache_lock(instance->cache_mutex);
+  std::vector<thread_cache_t*>::iterator it = std::find(instance->caches.begin(), instance->caches.end(), cache);
+  if(it != instance->caches.end())
+  {
+    instance->flush_thread_cache(cache);
+    instance->caches.erase(it);
+    delete cache;
+  }
+}
 
 } // namespace srsue
@@ -0,0 +1,266 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "common/helper_pool.h"
+
+// Low word of batch_t::state while the batch is being set up or torn down
+#define BATCH_CLOSED 0xffffffffULL
+
+namespace srslte {
+
+static void futex_wait(volatile uint32_t *addr, uint32_t val)
+{
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(volatile uint32_t *addr, int n)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+static inline void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause" ::: "memory");
+#else
+  __sync_synchronize();
+#endif
+}
+
+void helper_pool::helper::setup(uint32_t id, helper_pool *parent)
+{
+  my_id     = id;
+  my_parent = parent;
+}
+
+uint32_t helper_pool::helper::get_id()
+{
+  return my_id;
+}
+
+void helper_pool::helper::run_thread()
+{
+  my_parent->helper_loop(my_id);
+}
+
+helper_pool::helper_pool(uint32_t max_callers)
+{
+  nof_batches  = max_callers;
+  batches      = new batch_t[nof_batches];
+  bzero(batches, sizeof(batch_t)*nof_batches);
+  for (uint32_t i=0;i<nof_batches;i++) {
+    batches[i].state = BATCH_CLOSED;
+  }
+  helpers      = NULL;
+  nof_helpers  = 0;
+  spin_ns      = 0;
+  running      = false;
+  work_seq     = 0;
+  nof_sleeping = 0;
+}
+
+helper_pool::~helper_pool()
+{
+  stop();
+  delete [] batches;
+}
+
+bool helper_pool::init(uint32_t nof_helpers_, int prio, uint32_t spin_us)
+{
+  spin_ns     = (uint64_t) spin_us*1000;
+  running     = true;
+  nof_helpers = nof_helpers_;
+  helpers     = new helper[nof_helpers];
+  for (uint32_t i=0;i<nof_helpers;i++) {
+    helpers[i].setup(i, this);
+    if (!helpers[i].start(prio)) {
+      nof_helpers = i;
+      return false;
+    }
+  }
+  return true;
+}
+
+void helper_pool::stop()
+{
+  if (!helpers) {
+    return;
+  }
+  running = false;
+  __sync_fetch_and_add(&work_seq, 1);
+  futex_wake(&work_seq, INT_MAX);
+  for (uint32_t i=0;i<nof_helpers;i++) {
+    helpers[i].wait_thread_finish();
+  }
+  delete [] helpers;
+  helpers     = NULL;
+  nof_helpers = 0;
+}
+
+uint32_t helper_pool::get_nof_helpers()
+{
+  return nof_helpers;
+}
+
+helper_pool::helper* helper_pool::get_helper(uint32_t id)
+{
+  return id < nof_helpers ? &helpers[id] : NULL;
+}
+
+uint64_t helper_pool::now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+/* Claims the next job of the batch and runs it. The batch fields are only 
+ * rewritten while the batch is closed, and every close/open cycle changes 
+ * the generation, so a successful CAS on the state word read before the 
+ * fields proves the fields belong to the claimed job. 
+ * Returns false if the batch has no jobs left to claim. 
+ */
+bool helper_pool::claim_and_run(batch_t *b, uint32_t slot)
+{
+  uint64_t s   = b->state;
+  uint32_t idx = (uint32_t) s;
+  if (idx == BATCH_CLOSED) {
+    return false;
+  }
+  __sync_synchronize();
+  job_fn_t fn  = b->fn;
+  void    *arg = b->arg;
+  uint32_t n   = b->nof_jobs;
+  __sync_synchronize();
+  if (idx >= n) {
+    return false;
+  }
+  if (__sync_bool_compare_and_swap(&b->state, s, s+1)) {
+    fn(arg, idx, slot);
+    if (__sync_add_and_fetch(&b->done, 1) == n && b->waiting) {
+      futex_wake(&b->done, 1);
+    }
+  }
+  return true;
+}
+
+// Runs one job of any open batch, starting at a different batch for each helper
+bool helper_pool::work(uint32_t slot)
+{
+  for (uint32_t i=0;i<nof_batches;i++) {
+    if (claim_and_run(&batches[(slot+i)%nof_batches], slot)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void helper_pool::helper_loop(uint32_t id)
+{
+  while (running) {
+    uint32_t seq = work_seq;
+    if (work(id)) {
+      continue;
+    }
+    bool     found = false;
+    uint64_t t0    = now_ns();
+    while (running && now_ns() - t0 < spin_ns) {
+      if (work(id)) {
+        found = true;
+        break;
+      }
+      cpu_relax();
+    }
+    if (found) {
+      continue;
+    }
+    // A batch published after reading seq changes work_seq, so the wait returns at once
+    __sync_fetch_and_add(&nof_sleeping, 1);
+    if (running) {
+      futex_wait(&work_seq, seq);
+    }
+    __sync_fetch_and_sub(&nof_sleeping, 1);
+  }
+}
+
+void helper_pool::run(job_fn_t fn, void *arg, uint32_t nof_jobs, uint32_t caller_slot)
+{
+  batch_t *b = NULL;
+  if (nof_helpers > 0 && nof_jobs > 1) {
+    for (uint32_t i=0;i<nof_batches && !b;i++) {
+      if (!batches[i].busy && __sync_bool_compare_and_swap(&batches[i].busy, 0, 1)) {
+        b = &batches[i];
+      }
+    }
+  }
+  // No helpers or more concurrent callers than batches: run serially
+  if (!b) {
+    for (uint32_t i=0;i<nof_jobs;i++) {
+      fn(arg, i, caller_slot);
+    }
+    return;
+  }
+
+  uint64_t gen = (b->state>>32) + 1;
+  b->fn       = fn;
+  b->arg      = arg;
+  b->nof_jobs = nof_jobs;
+  b->done     = 0;
+  __sync_synchronize();
+  b->state    = gen<<32;
+  __sync_synchronize();
+  __sync_fetch_and_add(&work_seq, 1);
+  if (nof_sleeping) {
+    futex_wake(&work_seq, nof_jobs-1);
+  }
+
+  // Work on our own batch, then wait for the jobs taken by helpers
+  while (claim_and_run(b, caller_slot));
+  uint64_t t0 = now_ns();
+  while (b->done < nof_jobs && now_ns() - t0 < spin_ns) {
+    cpu_relax();
+  }
+  if (b->done < nof_jobs) {
+    b->waiting = 1;
+    __sync_synchronize();
+    uint32_t d;
+    while ((d = b->done) < nof_jobs) {
+      futex_wait(&b->done, d);
+    }
+    b->waiting = 0;
+  }
+
+  b->state = (gen<<32) | BATCH_CLOSED;
+  __sync_synchronize();
+  b->busy  = 0;
+}
+
+}
@@ -0,0 +1,133 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "common/latency_hist.h"
+
+namespace srsue {
+
+latency_hist::latency_hist()
+{
+  reset();
+}
+
+// Values below LATENCY_HIST_SUB map 1:1, larger ones keep their top 
+// LATENCY_HIST_SUB_BITS+1 bits
+uint32_t latency_hist::bin(uint64_t value)
+{
+  if(value < LATENCY_HIST_SUB)
+    return (uint32_t) value;
+  uint32_t msb = 63 - __builtin_clzll(value);
+  if(msb >= LATENCY_HIST_MAX_BITS)
+    return LATENCY_HIST_NOF_BINS-1;
+  uint32_t shift = msb - LATENCY_HIST_SUB_BITS;
+  return (shift+1)*LATENCY_HIST_SUB + (uint32_t) ((value>>shift)&(LATENCY_HIST_SUB-1));
+}
+
+uint64_t latency_hist::bin_max(uint32_t idx)
+{
+  if(idx < LATENCY_HIST_SUB)
+    return idx;
+  uint32_t shift = idx/LATENCY_HIST_SUB - 1;
+  uint64_t sub   = idx%LATENCY_HIST_SUB + LATENCY_HIST_SUB;
+  return ((sub+1)<<shift) - 1;
+}
+
+void latency_hist::add(uint64_t value)
+{
+  __sync_fetch_and_add(&bins[bin(value)], 1);
+  __sync_fetch_and_add(&nof_samples, 1);
+  __sync_fetch_and_add(&sum, value);
+  uint64_t m = max_value;
+  while(value > m && !__sync_bool_compare_and_swap(&max_value, m, value))
+    m = max_value;
+}
+
+void latency_hist::reset()
+{
+  for(uint32_t i=0;i<LATENCY_HIST_NOF_BINS;i++)
+    bins[i] = 0;
+  nof_samples = 0;
+  sum         = 0;
+  max_value   = 0;
+  __sync_synchronize();
+}
+
+uint64_t latency_hist::count()
+{
+  return nof_samples;
+}
+
+uint64_t latency_hist::max()
+{
+  return max_value;
+}
+
+double latency_hist::mean()
+{
+  uint64_t n = nof_samples;
+  return n ? (double) sum/n : 0;
+}
+
+uint64_t latency_hist::percentile(float p)
+{
+  uint64_t total = 0;
+  for(uint32_t i=0;i<LATENCY_HIST_NOF_BINS;i++)
+    total += bins[i];
+  if(total == 0)
+    return 0;
+  uint64_t target = (uint64_t) (p*total/100);
+  if(target < 1)
+    target = 1;
+  uint64_t acc = 0;
+  for(uint32_t i=0;i<LATENCY_HIST_NOF_BINS;i++) {
+    acc += bins[i];
+    if(acc >= target) {
+      uint64_t m = max_value;
+      uint64_t b = bin_max(i);
+      return (m && m < b) ? m : b;
+    }
+  }
+  return max_value;
+}
+
+void latency_hist::print(FILE *f, const char *name, double scale, const char *unit)
+{
+  uint64_t total = 0;
+  for(uint32_t i=0;i<LATENCY_HIST_NOF_BINS;i++)
+    total += bins[i];
+  fprintf(f, "%s: n=%lu, mean=%.1f %s, p50=%.1f %s, p99=%.1f %s, max=%.1f %s\n", name, (unsigned long) total,
+          mean()*scale, unit, percentile(50)*scale, unit, percentile(99)*scale, unit, max()*scale, unit);
+  uint64_t acc = 0;
+  for(uint32_t i=0;i<LATENCY_HIST_NOF_BINS;i++) {
+    if(bins[i]) {
+      acc += bins[i];
+      fprintf(f, "  <= %10.1f %s %10u %7.3f\n", bin_max(i)*scale, unit, bins[i], (double) acc/total);
+    }
+  }
+}
+
+} // namespace srsue
@@ -0,0 +1,455 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sstream>
+#include <iomanip>
+#include <boost/thread/lock_guard.hpp>
+#include "common/log.h"
+#include "common/log_binary.h"
+
+namespace srsue{
+
+/*******************************************************************************
+  Interning table
+*******************************************************************************/
+
+log_binary_table::log_binary_table(uint32_t max_entries_)
+  :max_entries(max_entries_)
+  ,nof_slots(2*max_entries_)
+  ,nof_entries(0)
+  ,nof_overflows(0)
+{
+  slots   = new entry_t[nof_slots];
+  strings = new const char*[max_entries];
+  memset(slots, 0, nof_slots*sizeof(entry_t));
+}
+
+log_binary_table::~log_binary_table()
+{
+  for(uint32_t i=0;i<nof_entries;i++)
+    free((void*) strings[i]);
+  delete [] slots;
+  delete [] strings;
+}
+
+// FNV-1a
+static uint32_t str_hash(const char *str)
+{
+  uint32_t h = 2166136261u;
+  while(*str)
+  {
+    h ^= (uint8_t) *str++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+uint32_t log_binary_table::intern(const char *str)
+{
+  uint32_t h = str_hash(str);
+  uint32_t i = h%nof_slots;
+
+  // Lock-free lookup
+  while(slots[i].str)
+  {
+    if(slots[i].hash == h && !strcmp(slots[i].str, str))
+      return slots[i].id;
+    i = (i+1)%nof_slots;
+  }
+
+  // Not found - insert, checking again for concurrent inserts
+  boost::lock_guard<boost::mutex> lock(mutex);
+  i = h%nof_slots;
+  while(slots[i].str)
+  {
+    if(slots[i].hash == h && !strcmp(slots[i].str, str))
+      return slots[i].id;
+    i = (i+1)%nof_slots;
+  }
+  if(nof_entries == overflow_id())
+  {
+    if(__sync_fetch_and_add(&nof_overflows, 1) == 0)
+      printf("Error - binary log table full (%d entries)\n", nof_entries);
+    return overflow_id();
+  }
+  const char *s = strdup(str);
+  slots[i].hash = h;
+  slots[i].id   = nof_entries;
+  strings[nof_entries] = s;
+  __sync_synchronize();
+  slots[i].str  = s;
+  nof_entries++;
+  return slots[i].id;
+}
+
+const char* log_binary_table::get(uint32_t id)
+{
+  return (id < nof_entries) ? strings[id] : NULL;
+}
+
+uint32_t log_binary_table::size()
+{
+  return nof_entries;
+}
+
+uint32_t log_binary_table::overflow_id()
+{
+  return max_entries-1;
+}
+
+uint32_t log_binary_table::get_nof_overflows()
+{
+  return nof_overflows;
+}
+
+/*******************************************************************************
+  printf argument serialization
+*******************************************************************************/
+
+typedef enum{
+  ARG_NONE = 0,
+  ARG_INT,
+  ARG_DOUBLE,
+  ARG_STRING,
+  ARG_POINTER,
+  ARG_COUNT,
+}arg_class_t;
+
+typedef struct{
+  uint32_t    len;          // Length of the conversion specification
+  bool        star_width;
+  bool        star_precision;
+  char        length[3];    // Length modifier
+  char        conv;
+  arg_class_t arg;
+}conv_spec_t;
+
+// Parses the conversion specification starting at the '%' in p
+static bool parse_spec(const char *p, conv_spec_t *s)
+{
+  const char *start = p++;
+  memset(s, 0, sizeof(conv_spec_t));
+
+  while(*p && strchr("-+ #0'", *p)) p++;
+  if(*p == '*') {
+    s->star_width = true;
+    p++;
+  }
+  while(*p >= '0' && *p <= '9') p++;
+  if(*p == '.') {
+    p++;
+    if(*p == '*') {
+      s->star_precision = true;
+      p++;
+    }
+    while(*p >= '0' && *p <= '9') p++;
+  }
+  int l = 0;
+  while(*p && strchr("hlLqjzt", *p) && l < 2)
+    s->length[l++] = *p++;
+  if(!*p)
+    return false;
+  s->conv = *p++;
+  s->len  = p-start;
+
+  switch(s->conv)
+  {
+  case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+    s->arg = ARG_INT;
+    break;
+  case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+    s->arg = ARG_DOUBLE;
+    break;
+  case 's':
+    s->arg = ARG_STRING;
+    break;
+  case 'p':
+    s->arg = ARG_POINTER;
+    break;
+  case 'n':
+    s->arg = ARG_COUNT;
+    break;
+  case '%':
+    s->arg = ARG_NONE;
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+static bool is_long(const conv_spec_t *s)
+{
+  return s->length[0] == 'l' || s->length[0] == 'q' || s->length[0] == 'j' ||
+         s->length[0] == 'z' || s->length[0] == 't';
+}
+
+template<class T>
+static bool put(uint8_t **p, uint8_t *end, T v)
+{
+  if(*p + sizeof(T) > end)
+    return false;
+  memcpy(*p, &v, sizeof(T));
+  *p += sizeof(T);
+  return true;
+}
+
+template<class T>
+static bool get(const uint8_t **p, const uint8_t *end, T *v)
+{
+  if(*p + sizeof(T) > end)
+    return false;
+  memcpy(v, *p, sizeof(T));
+  *p += sizeof(T);
+  return true;
+}
+
+uint32_t log_binary_encode_args(const char *fmt, va_list args, uint8_t *buf, uint32_t max_len)
+{
+  uint8_t    *p   = buf;
+  uint8_t    *end = buf+max_len;
+  conv_spec_t s;
+
+  while(*fmt)
+  {
+    if(*fmt != '%') {
+      fmt++;
+      continue;
+    }
+    if(!parse_spec(fmt, &s))
+      break;
+    fmt += s.len;
+
+    if(s.star_width && !put<int32_t>(&p, end, va_arg(args, int)))
+      break;
+    if(s.star_precision && !put<int32_t>(&p, end, va_arg(args, int)))
+      break;
+
+    bool ok = true;
+    switch(s.arg)
+    {
+    case ARG_INT:
+      if(s.length[0] == 'l' && s.length[1] == 'l')
+        ok = put<int64_t>(&p, end, va_arg(args, long long));
+      else if(is_long(&s))
+        ok = put<int64_t>(&p, end, va_arg(args, long));
+      else
+        ok = put<int64_t>(&p, end, va_arg(args, int));
+      break;
+    case ARG_DOUBLE:
+      if(s.length[0] == 'L')
+        ok = put<double>(&p, end, (double) va_arg(args, long double));
+      else
+        ok = put<double>(&p, end, va_arg(args, double));
+      break;
+    case ARG_STRING:
+    {
+      const char *str = va_arg(args, const char*);
+      if(!str)
+        str = "(null)";
+      uint16_t n = strlen(str);
+      if(p+sizeof(uint16_t)+n > end)
+        n = (end-p > (int) sizeof(uint16_t)) ? end-p-sizeof(uint16_t) : 0;
+      ok = put<uint16_t>(&p, end, n);
+      if(ok) {
+        memcpy(p, str, n);
+        p += n;
+      }
+      break;
+    }
+    case ARG_POINTER:
+      ok = put<uint64_t>(&p, end, (uint64_t) (uintptr_t) va_arg(args, void*));
+      break;
+    case ARG_COUNT:
+      va_arg(args, void*); // Not supported, argument is discarded
+      break;
+    default:
+      break;
+    }
+    if(!ok)
+      break;
+  }
+  return p-buf;
+}
+
+// Formats a single conversion with up to two star arguments
+template<class T>
+static void format_one(std::string &out, const char *spec, int n_star, int32_t *star, T v)
+{
+  char tmp[1024];
+  switch(n_star)
+  {
+  case 0:  snprintf(tmp, sizeof(tmp), spec, v); break;
+  case 1:  snprintf(tmp, sizeof(tmp), spec, star[0], v); break;
+  default: snprintf(tmp, sizeof(tmp), spec, star[0], star[1], v); break;
+  }
+  out += tmp;
+}
+
+std::string log_binary_format_args(const char *fmt, const uint8_t *buf, uint32_t len)
+{
+  std::string    out;
+  const uint8_t *p   = buf;
+  const uint8_t *end = buf+len;
+  conv_spec_t    s;
+
+  while(*fmt)
+  {
+    if(*fmt != '%') {
+      out += *fmt++;
+      continue;
+    }
+    if(!parse_spec(fmt, &s)) {
+      out += fmt;
+      break;
+    }
+    std::string spec(fmt, s.len);
+    fmt += s.len;
+
+    int32_t star[2];
+    int     n_star = 0;
+    bool    ok     = true;
+    if(s.star_width)
+      ok = ok && get<int32_t>(&p, end, &star[n_star++]);
+    if(s.star_precision)
+      ok = ok && get<int32_t>(&p, end, &star[n_star++]);
+
+    switch(s.arg)
+    {
+    case ARG_INT:
+    {
+      int64_t v;
+      if((ok = ok && get<int64_t>(&p, end, &v))) {
+        if(s.length[0] == 'l' && s.length[1] == 'l')
+          format_one<long long>(out, spec.c_str(), n_star, star, v);
+        else if(is_long(&s))
+          format_one<long>(out, spec.c_str(), n_star, star, v);
+        else
+          format_one<int>(out, spec.c_str(), n_star, star, v);
+      }
+      break;
+    }
+    case ARG_DOUBLE:
+    {
+      double v;
+      if(s.length[0] == 'L')
+        spec.erase(spec.find('L'), 1);
+      if((ok = ok && get<double>(&p, end, &v)))
+        format_one<double>(out, spec.c_str(), n_star, star, v);
+      break;
+    }
+    case ARG_STRING:
+    {
+      uint16_t n;
+      if((ok = ok && get<uint16_t>(&p, end, &n) && p+n <= end)) {
+        std::string str((const char*) p, n);
+        p += n;
+        format_one<const char*>(out, spec.c_str(), n_star, star, str.c_str());
+      }
+      break;
+    }
+    case ARG_POINTER:
+    {
+      uint64_t v;
+      if((ok = ok && get<uint64_t>(&p, end, &v)))
+        format_one<void*>(out, spec.c_str(), n_star, star, (void*) (uintptr_t) v);
+      break;
+    }
+    case ARG_NONE:
+      out += '%';
+      break;
+    default:
+      break;
+    }
+    if(!ok) {
+      // Truncated record - print the rest of the format as is
+      out += spec;
+      out += fmt;
+      break;
+    }
+  }
+  return out;
+}
+
+std::string log_binary_hex_string(const uint8_t *hex, int size)
+{
+  std::stringstream ss;
+  int c = 0;
+
+  ss << std::hex << std::setfill('0');
+  while(c < size) {
+    ss << "             " << std::setw(4) << static_cast<unsigned>(c) << ": ";
+    int tmp = (size-c < 16) ? size-c : 16;
+    for(int i=0;i<tmp;i++) {
+      ss << std::setw(2) << static_cast<unsigned>(hex[c++]) << " ";
+    }
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+std::string log_binary_time_string(uint64_t time_us)
+{
+  char      buf[16];
+  struct tm t;
+  time_t    secs = time_us/1000000;
+  localtime_r(&secs, &t);
+  snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%03d",
+           t.tm_hour, t.tm_min, t.tm_sec, (int) ((time_us%1000000)/1000));
+  return std::string(buf);
+}
+
+std::string log_binary_format_msg(const log_binary_msg_t *msg, const char *fmt, const char *layer)
+{
+  std::stringstream ss;
+  const uint8_t    *args = (const uint8_t*) msg + sizeof(log_binary_msg_t);
+  uint32_t          lvl  = (msg->level < srslte::LOG_LEVEL_N_ITEMS) ? msg->level : srslte::LOG_LEVEL_NONE;
+
+  ss << log_binary_time_string(msg->time_us) << " ";
+  if(!layer && msg->layer_id == LOG_BINARY_LAYER_OVERFLOW)
+    layer = "OVFL";
+  ss << "[" << (layer ? layer : "????") << "] ";
+  ss << srslte::log_level_text[lvl] << " ";
+  if(msg->flags & LOG_BINARY_FLAG_TTI)
+    ss << "[" << std::setfill('0') << std::setw(5) << msg->tti << "] ";
+  if(fmt)
+    ss << log_binary_format_args(fmt, args, msg->args_len);
+  else if(msg->fmt_id == LOG_BINARY_FORMAT_OVERFLOW)
+    ss << "<format table overflow>\n";
+  else
+    ss << "<unknown format " << msg->fmt_id << ">\n";
+  if(msg->flags & LOG_BINARY_FLAG_HEX) {
+    ss << std::endl;
+    ss << log_binary_hex_string(args+msg->args_len, msg->hex_len);
+  }
+  return ss.str();
+}
+
+} // namespace srsue
@@ -25,6 +25,8 @@
  */
 
 
+#include <string.h>
+#include <sys/time.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "common/log_filter.h"
 
@@ -33,6 +35,9 @@ using namespace srslte;
 namespace srsue{
 
 log_filter::log_filter()
+  :logger_h(NULL)
+  ,do_tti(false)
+  ,layer_id(0)
 {}
 
 log_filter::log_filter(std::string layer, logger *logger_, bool tti)
@@ -45,6 +50,7 @@ void log_filter::init(std::string layer, logger *logger_, bool tti)
   service_name  = layer;
   logger_h      = logger_;
   do_tti        = tti;
+  layer_id      = logger_h ? logger_h->register_layer(layer.c_str()) : 0;
 }
 
 void log_filter::all_log(srslte::LOG_LEVEL_ENUM level,
@@ -61,8 +67,7 @@ void log_filter::all_log(srslte::LOG_LEVEL_ENUM level,
       ss << "[" << std::setfill('0') << std::setw(5) << tti << "] ";
     ss << msg;
 
-    str_ptr s_ptr(new std::string(ss.str()));
-    logger_h->log(s_ptr);
+    logger_h->log(layer_id, ss.str());
   }
 }
 
@@ -83,30 +88,74 @@ void log_filter::all_log(srslte::LOG_LEVEL_ENUM level,
     ss << msg << std::endl;
     ss << hex_string(hex, size);
 
-    str_ptr s_ptr(new std::string(ss.str()));
-    logger_h->log(s_ptr);
+    logger_h->log(layer_id, ss.str());
   }
 }
 
-void log_filter::all_log_line(srslte::LOG_LEVEL_ENUM level,
-                              uint32_t               tti,
-                              std::string            file,
-                              int                    line,
-                              char                  *msg)
+void log_filter::all_log_va(srslte::LOG_LEVEL_ENUM level,
+                            uint32_t               tti,
+                            const char            *fmt,
+                            va_list                args,
+                            uint8_t               *hex,
+                            int                    size)
 {
-  if(logger_h) {
-    std::stringstream ss;
+  if(!logger_h)
+    return;
+  if(logger_h->is_binary()) {
+    all_log_binary(level, tti, fmt, args, hex, size);
+    return;
+  }
+  char *args_msg;
+  if(vasprintf(&args_msg, fmt, args) >= 0) {
+    if(hex)
+      all_log(level, tti, args_msg, hex, size);
+    else
+      all_log(level, tti, args_msg);
+    free(args_msg);
+  }
+}
 
-    ss << now_time() << " ";
-    ss << "[" <<get_service_name() << "] ";
-    ss << log_level_text[level] << " ";
-    if(do_tti)
-      ss << "[" << std::setfill('0') << std::setw(5) << tti << "] ";
-    ss << msg;
+// Stores the raw arguments only, formatting is done by srsue_log_decoder
+void log_filter::all_log_binary(srslte::LOG_LEVEL_ENUM level,
+                                uint32_t               tti,
+                                const char            *fmt,
+                                va_list                args,
+                                uint8_t               *hex,
+                                int                    size)
+{
+  uint8_t           rec[LOG_BINARY_MAX_RECORD];
+  log_binary_msg_t *msg = (log_binary_msg_t*) rec;
+  uint8_t          *ptr = &rec[sizeof(log_binary_msg_t)];
+  struct timeval    tv;
+
+  gettimeofday(&tv, NULL);
+  msg->hdr.type = LOG_BINARY_REC_MSG;
+  msg->fmt_id   = logger_h->register_format(fmt);
+  msg->tti      = tti;
+  msg->time_us  = (uint64_t) tv.tv_sec*1000000 + tv.tv_usec;
+  msg->level    = level;
+  msg->layer_id = layer_id;
+  msg->flags    = do_tti ? LOG_BINARY_FLAG_TTI : 0;
+  msg->reserved = 0;
+  msg->args_len = log_binary_encode_args(fmt, args, ptr, LOG_BINARY_MAX_ARGS_LEN);
+  msg->hex_len  = 0;
+  ptr += msg->args_len;
 
-    str_ptr s_ptr(new std::string(ss.str()));
-    logger_h->log(s_ptr);
+  if(hex) {
+    int max = LOG_BINARY_MAX_RECORD-(ptr-rec);
+    if(hex_limit >= 0 && size > hex_limit)
+      size = hex_limit;
+    if(size > max)
+      size = max;
+    if(size < 0)
+      size = 0;
+    memcpy(ptr, hex, size);
+    ptr          += size;
+    msg->hex_len  = size;
+    msg->flags   |= LOG_BINARY_FLAG_HEX;
   }
+  msg->hdr.len = ptr-rec;
+  logger_h->log_binary(rec, msg->hdr.len);
 }
 
 void log_filter::console(std::string message, ...) {
@@ -121,143 +170,107 @@ void log_filter::console(std::string message, ...) {
 
 void log_filter::error(std::string message, ...) {
   if (level >= LOG_LEVEL_ERROR) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_ERROR, tti, args_msg);
+    all_log_va(LOG_LEVEL_ERROR, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::warning(std::string message, ...) {
   if (level >= LOG_LEVEL_WARNING) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_WARNING, tti, args_msg);
+    all_log_va(LOG_LEVEL_WARNING, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::info(std::string message, ...) {
   if (level >= LOG_LEVEL_INFO) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_INFO, tti, args_msg);
+    all_log_va(LOG_LEVEL_INFO, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::debug(std::string message, ...) {
   if (level >= LOG_LEVEL_DEBUG) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_DEBUG, tti, args_msg);
+    all_log_va(LOG_LEVEL_DEBUG, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 
 void log_filter::error_hex(uint8_t *hex, int size, std::string message, ...) {
   if (level >= LOG_LEVEL_ERROR) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_ERROR, tti, args_msg, hex, size);
+    all_log_va(LOG_LEVEL_ERROR, tti, message.c_str(), args, hex, size);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::warning_hex(uint8_t *hex, int size, std::string message, ...) {
   if (level >= LOG_LEVEL_WARNING) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_WARNING, tti, args_msg, hex, size);
+    all_log_va(LOG_LEVEL_WARNING, tti, message.c_str(), args, hex, size);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::info_hex(uint8_t *hex, int size, std::string message, ...) {
   if (level >= LOG_LEVEL_INFO) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_INFO, tti, args_msg, hex, size);
+    all_log_va(LOG_LEVEL_INFO, tti, message.c_str(), args, hex, size);
     va_end(args);
-    free(args_msg);
   }
 }
 void log_filter::debug_hex(uint8_t *hex, int size, std::string message, ...) {
   if (level >= LOG_LEVEL_DEBUG) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log(LOG_LEVEL_DEBUG, tti, args_msg, hex, size);
+    all_log_va(LOG_LEVEL_DEBUG, tti, message.c_str(), args, hex, size);
     va_end(args);
-    free(args_msg);
   }
 }
 
 void log_filter::error_line(std::string file, int line, std::string message, ...)
 {
   if (level >= LOG_LEVEL_ERROR) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log_line(LOG_LEVEL_ERROR, tti, file, line, args_msg);
+    all_log_va(LOG_LEVEL_ERROR, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 
 void log_filter::warning_line(std::string file, int line, std::string message, ...)
 {
   if (level >= LOG_LEVEL_WARNING) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log_line(LOG_LEVEL_WARNING, tti, file, line, args_msg);
+    all_log_va(LOG_LEVEL_WARNING, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 
 void log_filter::info_line(std::string file, int line, std::string message, ...)
 {
   if (level >= LOG_LEVEL_INFO) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log_line(LOG_LEVEL_INFO, tti, file, line, args_msg);
+    all_log_va(LOG_LEVEL_INFO, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 
 void log_filter::debug_line(std::string file, int line, std::string message, ...)
 {
   if (level >= LOG_LEVEL_DEBUG) {
-    char     *args_msg;
     va_list   args;
     va_start(args, message);
-    if(vasprintf(&args_msg, message.c_str(), args) > 0);
-      all_log_line(LOG_LEVEL_DEBUG, tti, file, line, args_msg);
+    all_log_va(LOG_LEVEL_DEBUG, tti, message.c_str(), args);
     va_end(args);
-    free(args_msg);
   }
 }
 
@@ -271,22 +284,10 @@ std::string log_filter::now_time()
 
 std::string log_filter::hex_string(uint8_t *hex, int size)
 {
-  std::stringstream ss;
-  int c = 0;
-
-  ss << std::hex << std::setfill('0');
   if(hex_limit >= 0) {
     size = (size > hex_limit) ? hex_limit : size;
   }
-  while(c < size) {
-    ss << "             " << std::setw(4) << static_cast<unsigned>(c) << ": ";
-    int tmp = (size-c < 16) ? size-c : 16;
-    for(int i=0;i<tmp;i++) {
-      ss << std::setw(2) << static_cast<unsigned>(hex[c++]) << " ";
-    }
-    ss << "\n";
-  }
-  return ss.str();
+  return log_binary_hex_string(hex, size);
 }
 
 } // namespace srsue
@@ -25,86 +25,425 @@
  */
 
 
-#define LOG_BUFFER_SIZE 1024*32
-
+#include <string.h>
+#include <time.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include "common/logger.h"
+#include "common/thread_affinity.h"
 
 using namespace std;
 
 namespace srsue{
 
+static uint32_t align8(uint32_t len) {
+  return (len+7)&~7;
+}
+
 logger::logger()
-  :buffer(LOG_BUFFER_SIZE)
+  :logfile(NULL)
   ,inited(false)
   ,not_done(true)
-{}
+  ,binary(false)
+  ,overflow(LOG_OVERFLOW_BLOCK)
+  ,ring_size(LOG_RING_SIZE)
+  ,writer_waiting(0)
+  ,nof_blocked(0)
+  ,formats(LOG_BINARY_MAX_FORMATS)
+  ,layers(LOG_BINARY_MAX_LAYERS)
+  ,nof_formats_written(0)
+  ,nof_layers_written(0)
+  ,last_report(0)
+  ,overflows_reported(0)
+{
+  setup();
+}
 
-logger::logger(std::string file) {
+logger::logger(std::string file)
+  :logfile(NULL)
+  ,inited(false)
+  ,not_done(true)
+  ,binary(false)
+  ,overflow(LOG_OVERFLOW_BLOCK)
+  ,ring_size(LOG_RING_SIZE)
+  ,writer_waiting(0)
+  ,nof_blocked(0)
+  ,formats(LOG_BINARY_MAX_FORMATS)
+  ,layers(LOG_BINARY_MAX_LAYERS)
+  ,nof_formats_written(0)
+  ,nof_layers_written(0)
+  ,last_report(0)
+  ,overflows_reported(0)
+{
+  setup();
   init(file);
 }
 
+void logger::setup() {
+  pthread_key_create(&ring_key, ring_destructor);
+  bzero(dropped, sizeof(dropped));
+  bzero(dropped_reported, sizeof(dropped_reported));
+  bzero(dropped_metrics, sizeof(dropped_metrics));
+  // Layer 0 is used for messages which do not come from a log_filter
+  layers.intern("");
+}
+
 logger::~logger() {
   not_done = false;
   log("Closing log");
   if(inited) {
     pthread_join(thread, NULL);
     flush();
-    fclose(logfile);
+    if(logfile)
+      fclose(logfile);
+  }
+  pthread_key_delete(ring_key);
+  for(uint32_t i=0;i<rings.size();i++) {
+    delete [] rings[i]->buf;
+    delete rings[i];
   }
 }
 
-void logger::init(std::string file) {
+void logger::init(std::string file, bool binary_, log_overflow_t overflow_, uint32_t ring_size_) {
   filename = file;
   logfile = fopen(filename.c_str(), "w");
   if(logfile==NULL) {
     printf("Error: could not create log file, no messages will be logged");
   }
+  binary   = binary_;
+  overflow = overflow_;
+  // Ring size is a power of 2 that fits several maximum size records
+  ring_size = 1;
+  while(ring_size < ring_size_ || ring_size < 4*(sizeof(ring_hdr_t)+LOG_BINARY_MAX_RECORD))
+    ring_size *= 2;
+  if(binary && logfile)
+    fwrite(LOG_BINARY_MAGIC, 1, strlen(LOG_BINARY_MAGIC), logfile);
   pthread_create(&thread, NULL, &start, this);
+  thread_affinity::get_instance()->add(thread, "logger", "LOGGER");
   inited = true;
 }
 
 void logger::log(const char *msg) {
-  str_ptr s_ptr(new std::string(msg));
-  log(s_ptr);
+  push_text(0, msg, strlen(msg));
 }
 
 void logger::log(str_ptr msg) {
-    boost::mutex::scoped_lock lock(mutex);
-    if(buffer.full()) {
-      buffer.set_capacity(buffer.capacity()*2);
-      if(logfile)
-        fprintf(logfile, "Log queue full, doubling capacity\n");
+  push_text(0, msg->c_str(), msg->length());
+}
+
+void logger::log(uint32_t layer_id, const std::string &msg) {
+  push_text(layer_id, msg.c_str(), msg.length());
+}
+
+bool logger::is_binary() {
+  return binary;
+}
+
+uint32_t logger::register_format(const char *fmt) {
+  return formats.intern(fmt);
+}
+
+uint32_t logger::register_layer(const char *layer) {
+  return layers.intern(layer);
+}
+
+void logger::log_binary(const uint8_t *rec, uint32_t len) {
+  const log_binary_hdr_t *hdr = (const log_binary_hdr_t*) rec;
+  if(len < sizeof(log_binary_hdr_t) || len > LOG_BINARY_MAX_RECORD)
+    return;
+  if(hdr->type == LOG_BINARY_REC_MSG)
+    push(((const log_binary_msg_t*) rec)->layer_id, rec, len);
+  else
+    push(0, rec, len);
+}
+
+void logger::get_metrics(log_metrics_t &m) {
+  m.nof_layers = 0;
+  for(uint32_t i=0;i<layers.size() && m.nof_layers<LOG_METRICS_MAX_LAYERS;i++) {
+    log_layer_metrics_t *l = &m.layer[m.nof_layers++];
+    const char *name = layers.get(i);
+    strncpy(l->name, name[0] ? name : "None", sizeof(l->name)-1);
+    l->name[sizeof(l->name)-1] = '\0';
+    l->total_dropped   = dropped[i];
+    l->dropped         = l->total_dropped-dropped_metrics[i];
+    dropped_metrics[i] = l->total_dropped;
+  }
+}
+
+/*******************************************************************************
+  Producer side
+*******************************************************************************/
+
+logger::ring_t* logger::get_ring() {
+  ring_t *r = (ring_t*) pthread_getspecific(ring_key);
+  if(!r) {
+    r         = new ring_t;
+    r->buf    = new uint8_t[ring_size];
+    r->size   = ring_size;
+    r->wr     = 0;
+    r->rd     = 0;
+    r->closed = false;
+    pthread_setspecific(ring_key, r);
+    boost::mutex::scoped_lock lock(rings_mutex);
+    rings.push_back(r);
+  }
+  return r;
+}
+
+// Called on producer thread exit. The writer thread frees the ring once drained.
+void logger::ring_destructor(void *arg) {
+  ring_t *r = (ring_t*) arg;
+  __sync_synchronize();
+  r->closed = true;
+}
+
+void logger::count_drop(uint32_t layer_id) {
+  if(layer_id < LOG_BINARY_MAX_LAYERS)
+    __sync_fetch_and_add(&dropped[layer_id], 1);
+}
+
+void logger::push_text(uint32_t layer_id, const char *str, uint32_t len) {
+  uint8_t           rec[LOG_BINARY_MAX_RECORD];
+  log_binary_hdr_t *hdr = (log_binary_hdr_t*) rec;
+  uint32_t          max = LOG_BINARY_MAX_RECORD-sizeof(log_binary_hdr_t);
+  while(len > 0) {
+    uint32_t n = (len > max) ? max : len;
+    hdr->type = LOG_BINARY_REC_TEXT;
+    hdr->len  = sizeof(log_binary_hdr_t)+n;
+    memcpy(&rec[sizeof(log_binary_hdr_t)], str, n);
+    push(layer_id, rec, hdr->len);
+    str += n;
+    len -= n;
+  }
+}
+
+void logger::push(uint32_t layer_id, const uint8_t *rec, uint32_t len) {
+  if(!inited)
+    return;
+  ring_t   *r    = get_ring();
+  uint32_t  mask = r->size-1;
+  uint32_t  n    = align8(sizeof(ring_hdr_t)+len);
+  uint32_t  wr   = r->wr;
+  uint32_t  pos  = wr&mask;
+  // Entries are contiguous, skip the end of the ring if there is no room
+  uint32_t  pad  = (r->size-pos < n) ? r->size-pos : 0;
+
+  while(r->size-(wr-r->rd) < n+pad) {
+    if(overflow == LOG_OVERFLOW_DROP_NEWEST) {
+      count_drop(layer_id);
+      return;
+    } else if(overflow == LOG_OVERFLOW_DROP_OLDEST) {
+      // Entries are only written by this thread, so the header at rd is
+      // stable. If the writer thread moved rd meanwhile, the CAS fails.
+      uint32_t    rd = r->rd;
+      ring_hdr_t *h  = (ring_hdr_t*) &r->buf[rd&mask];
+      uint32_t    l  = h->len ? h->len : r->size-(rd&mask);
+      if(__sync_bool_compare_and_swap(&r->rd, rd, rd+l) && h->len)
+        count_drop(h->layer_id);
+    } else {
+      __sync_fetch_and_add(&nof_blocked, 1);
+      boost::mutex::scoped_lock lock(mutex);
+      not_empty.notify_one();
+      not_full.timed_wait(lock, boost::posix_time::milliseconds(1));
+      __sync_fetch_and_sub(&nof_blocked, 1);
     }
-    buffer.push_back(msg);
-    lock.unlock();
+  }
+
+  if(pad) {
+    ((ring_hdr_t*) &r->buf[pos])->len = 0;
+    wr += pad;
+    pos = 0;
+  }
+  ring_hdr_t *h = (ring_hdr_t*) &r->buf[pos];
+  h->len      = n;
+  h->layer_id = layer_id;
+  memcpy(&r->buf[pos+sizeof(ring_hdr_t)], rec, len);
+  __sync_synchronize();
+  r->wr = wr+n;
+  __sync_synchronize();
+
+  if(writer_waiting) {
+    boost::mutex::scoped_lock lock(mutex);
     not_empty.notify_one();
+  }
 }
 
+/*******************************************************************************
+  Writer side
+*******************************************************************************/
+
 void* logger::start(void *input) {
   logger *l = (logger*)input;
   l->reader_loop();
+  return NULL;
 }
 
 void logger::reader_loop() {
   while(not_done) {
-    boost::mutex::scoped_lock lock(mutex);
-    while(buffer.empty()) not_empty.wait(lock);
-    str_ptr s = buffer.front();
-    buffer.pop_front();
-    lock.unlock();
-    not_full.notify_one();
-    if(logfile)
-      fprintf(logfile, "%s", s.get()->c_str());
+    if(!drain_all()) {
+      boost::mutex::scoped_lock lock(mutex);
+      writer_waiting = 1;
+      __sync_synchronize();
+      // Producers only notify when writer_waiting is set, check again before sleeping
+      if(all_empty() && not_done)
+        not_empty.timed_wait(lock, boost::posix_time::milliseconds(100));
+      writer_waiting = 0;
+    }
+    if(nof_blocked) {
+      boost::mutex::scoped_lock lock(mutex);
+      not_full.notify_all();
+    }
+    report_drops(false);
   }
 }
 
-void logger::flush() {
-  boost::circular_buffer<str_ptr>::iterator it;
-  for(it=buffer.begin();it!=buffer.end();it++)
-  {
-    if(logfile)
-      fprintf(logfile, "%s", it->get()->c_str());
+bool logger::all_empty() {
+  boost::mutex::scoped_lock lock(rings_mutex);
+  for(uint32_t i=0;i<rings.size();i++) {
+    if(rings[i]->rd != rings[i]->wr)
+      return false;
+  }
+  return true;
+}
+
+bool logger::drain_all() {
+  bool any = false;
+  boost::mutex::scoped_lock lock(rings_mutex);
+  for(uint32_t i=0;i<rings.size();i++) {
+    ring_t *r = rings[i];
+    if(drain(r))
+      any = true;
+    if(r->closed) {
+      __sync_synchronize();
+      if(r->rd == r->wr) {
+        delete [] r->buf;
+        delete r;
+        rings.erase(rings.begin()+i);
+        i--;
+      }
+    }
   }
+  return any;
+}
+
+// Writes out the entries present in the ring when called
+bool logger::drain(ring_t *r) {
+  uint8_t  entry[sizeof(ring_hdr_t)+LOG_BINARY_MAX_RECORD+8];
+  uint32_t mask = r->size-1;
+  uint32_t wr   = r->wr;
+  bool     any  = false;
+  __sync_synchronize();
+
+  while(true) {
+    uint32_t rd = r->rd;
+    __sync_synchronize();
+    if((int32_t) (wr-rd) <= 0)
+      break;
+    uint32_t    pos = rd&mask;
+    ring_hdr_t *h   = (ring_hdr_t*) &r->buf[pos];
+    uint32_t    len = h->len;
+    if(len == 0) {
+      __sync_bool_compare_and_swap(&r->rd, rd, rd+r->size-pos);
+      continue;
+    }
+    if(overflow == LOG_OVERFLOW_DROP_OLDEST) {
+      // The producer may drop this entry and reuse its space while we read
+      // it. It moves rd before writing, so copy first and then check rd.
+      if(len < sizeof(ring_hdr_t) || len > sizeof(entry) || len > wr-rd)
+        continue;
+      memcpy(entry, h, len);
+      __sync_synchronize();
+      if(!__sync_bool_compare_and_swap(&r->rd, rd, rd+len))
+        continue;
+      write_record(&entry[sizeof(ring_hdr_t)]);
+    } else {
+      write_record(&r->buf[pos+sizeof(ring_hdr_t)]);
+      __sync_synchronize();
+      r->rd = rd+len;
+    }
+    any = true;
+  }
+  return any;
+}
+
+void logger::report_drops(bool force) {
+  time_t now = time(NULL);
+  if(!force && now == last_report)
+    return;
+  last_report = now;
+  for(uint32_t i=0;i<layers.size() && i<LOG_BINARY_MAX_LAYERS;i++) {
+    uint32_t d = dropped[i];
+    if(d != dropped_reported[i]) {
+      char        buf[128];
+      const char *name = layers.get(i);
+      int n = snprintf(buf, sizeof(buf), "Log overflow: dropped %d messages from [%s], policy %s\n",
+                       d-dropped_reported[i], name[0] ? name : "None", log_overflow_text[overflow]);
+      write_text(buf, n);
+      dropped_reported[i] = d;
+    }
+  }
+  // Messages logged with the reserved ids of a full format or layer table
+  uint32_t o = formats.get_nof_overflows()+layers.get_nof_overflows();
+  if(o != overflows_reported) {
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "Log table overflow: %d more messages without their format or layer\n",
+                     o-overflows_reported);
+    write_text(buf, n);
+    overflows_reported = o;
+  }
+}
+
+void logger::write_text(const char *str, uint32_t len) {
+  if(!logfile)
+    return;
+  if(binary) {
+    log_binary_hdr_t hdr;
+    hdr.type = LOG_BINARY_REC_TEXT;
+    hdr.len  = sizeof(log_binary_hdr_t)+len;
+    fwrite(&hdr, 1, sizeof(log_binary_hdr_t), logfile);
+  }
+  fwrite(str, 1, len, logfile);
+}
+
+void logger::write_defs(log_binary_rec_t type, log_binary_table *table, uint32_t *nof_written, uint32_t id) {
+  while(*nof_written <= id && *nof_written < table->size()) {
+    const char       *str = table->get(*nof_written);
+    log_binary_def_t  def;
+    uint32_t          len = strlen(str)+1;
+    def.hdr.type = type;
+    def.hdr.len  = sizeof(log_binary_def_t)+len;
+    def.id       = *nof_written;
+    fwrite(&def, 1, sizeof(log_binary_def_t), logfile);
+    fwrite(str, 1, len, logfile);
+    (*nof_written)++;
+  }
+}
+
+void logger::write_record(const uint8_t *rec) {
+  const log_binary_hdr_t *hdr = (const log_binary_hdr_t*) rec;
+  if(!logfile)
+    return;
+  if(!binary) {
+    if(hdr->type == LOG_BINARY_REC_TEXT)
+      fwrite(&rec[sizeof(log_binary_hdr_t)], 1, hdr->len-sizeof(log_binary_hdr_t), logfile);
+    return;
+  }
+  // Definitions are written before the first message using them
+  if(hdr->type == LOG_BINARY_REC_MSG) {
+    const log_binary_msg_t *msg = (const log_binary_msg_t*) rec;
+    if(msg->fmt_id >= nof_formats_written)
+      write_defs(LOG_BINARY_REC_FORMAT, &formats, &nof_formats_written, msg->fmt_id);
+    if(msg->layer_id >= nof_layers_written)
+      write_defs(LOG_BINARY_REC_LAYER, &layers, &nof_layers_written, msg->layer_id);
+  }
+  fwrite(rec, 1, hdr->len, logfile);
+}
+
+// Called after the writer thread has exited
+void logger::flush() {
+  drain_all();
+  report_drops(true);
+  if(logfile)
+    fflush(logfile);
 }
 
 } // namespace srsue
@@ -0,0 +1,278 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#ifdef LV_HAVE_SSE
+#include <smmintrin.h>
+#endif
+#include "common/softbuffer_fx.h"
+
+
+namespace srsue {
+
+softbuffer_fx::softbuffer_fx()
+{
+  buffer   = NULL; 
+  nof_bits = 0; 
+  max_cb   = 0; 
+}
+
+softbuffer_fx::~softbuffer_fx()
+{
+  free_buffers();
+}
+
+bool softbuffer_fx::init(uint32_t nof_prb, uint32_t nof_bits_)
+{
+  free_buffers();
+  if (nof_bits_ != 16 && nof_bits_ != 8) {
+    return false; 
+  }
+  nof_bits = nof_bits_; 
+  max_cb   = max_cb_prb(nof_prb); 
+  buffer   = (uint8_t*) srslte_vec_malloc(get_nof_bytes());
+  if (!buffer) {
+    max_cb = 0; 
+    return false; 
+  }
+  empty.assign(max_cb, 1);
+  return true; 
+}
+
+void softbuffer_fx::free_buffers()
+{
+  if (buffer) {
+    free(buffer);
+  }
+  buffer = NULL; 
+  max_cb = 0; 
+  empty.clear();
+}
+
+void softbuffer_fx::reset()
+{
+  for (uint32_t i=0;i<max_cb;i++) {
+    empty[i] = 1; 
+  }
+}
+
+int softbuffer_fx::expand(srslte_cbsegm_t *cb_segm, srslte_softbuffer_rx_t *sb)
+{
+  if (cb_segm->C > max_cb || cb_segm->C > sb->max_cb) {
+    return SRSLTE_ERROR; 
+  }
+  for (uint32_t i=0;i<cb_segm->C;i++) {
+    uint32_t len = cb_w_len(i < cb_segm->C2 ? cb_segm->K2 : cb_segm->K1); 
+    if (empty[i]) {
+      fill_null(sb->buffer_f[i], len);
+    } else if (nof_bits == 16) {
+      load_16((int16_t*) buffer + i*CB_LEN, sb->buffer_f[i], len);
+    } else {
+      load_8((int8_t*) buffer + i*CB_LEN, sb->buffer_f[i], len);
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+int softbuffer_fx::compress(srslte_cbsegm_t *cb_segm, srslte_softbuffer_rx_t *sb)
+{
+  if (cb_segm->C > max_cb || cb_segm->C > sb->max_cb) {
+    return SRSLTE_ERROR; 
+  }
+  for (uint32_t i=0;i<cb_segm->C;i++) {
+    uint32_t len = cb_w_len(i < cb_segm->C2 ? cb_segm->K2 : cb_segm->K1); 
+    if (nof_bits == 16) {
+      save_16(sb->buffer_f[i], (int16_t*) buffer + i*CB_LEN, len);
+    } else {
+      save_8(sb->buffer_f[i], (int8_t*) buffer + i*CB_LEN, len);
+    }
+    empty[i] = 0; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+int16_t* softbuffer_fx::get_cb_16(uint32_t i, uint32_t cb_len)
+{
+  if (nof_bits != 16 || i >= max_cb) {
+    return NULL; 
+  }
+  int16_t *w = (int16_t*) buffer + i*CB_LEN; 
+  if (empty[i]) {
+    uint32_t len = cb_w_len(cb_len); 
+    for (uint32_t j=0;j<len;j++) {
+      w[j] = NULL_16; 
+    }
+    empty[i] = 0; 
+  }
+  return w; 
+}
+
+uint32_t softbuffer_fx::get_max_cb()
+{
+  return max_cb; 
+}
+
+uint32_t softbuffer_fx::get_nof_bits()
+{
+  return nof_bits; 
+}
+
+size_t softbuffer_fx::get_nof_bytes()
+{
+  return (size_t) max_cb*CB_LEN*nof_bits/8; 
+}
+
+uint32_t softbuffer_fx::max_cb_prb(uint32_t nof_prb)
+{
+  return (uint32_t) srslte_ra_tbs_from_idx(26, nof_prb)/(SRSLTE_TCOD_MAX_LEN_CB-24)+1; 
+}
+
+uint32_t softbuffer_fx::cb_w_len(uint32_t cb_len)
+{
+  return 3*32*((cb_len+4+31)/32); 
+}
+
+/* Lengths are multiples of 3*32 entries, so the SIMD loops have no tail */
+
+void softbuffer_fx::fill_null(float *out, uint32_t len)
+{
+  for (uint32_t i=0;i<len;i++) {
+    out[i] = SRSLTE_RX_NULL; 
+  }
+}
+
+void softbuffer_fx::load_16(int16_t *in, float *out, uint32_t len)
+{
+  const float k = 1.0/SCALE_16; 
+#ifdef LV_HAVE_SSE
+  __m128  vk    = _mm_set1_ps(k);
+  __m128  vnull = _mm_set1_ps(SRSLTE_RX_NULL);
+  __m128i inull = _mm_set1_epi32(NULL_16);
+  for (uint32_t i=0;i<len;i+=8) {
+    __m128i v  = _mm_loadu_si128((__m128i*) &in[i]);
+    __m128i lo = _mm_cvtepi16_epi32(v);
+    __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+    __m128  flo = _mm_mul_ps(_mm_cvtepi32_ps(lo), vk);
+    __m128  fhi = _mm_mul_ps(_mm_cvtepi32_ps(hi), vk);
+    flo = _mm_blendv_ps(flo, vnull, _mm_castsi128_ps(_mm_cmpeq_epi32(lo, inull)));
+    fhi = _mm_blendv_ps(fhi, vnull, _mm_castsi128_ps(_mm_cmpeq_epi32(hi, inull)));
+    _mm_storeu_ps(&out[i],   flo);
+    _mm_storeu_ps(&out[i+4], fhi);
+  }
+#else
+  for (uint32_t i=0;i<len;i++) {
+    out[i] = in[i] == NULL_16 ? SRSLTE_RX_NULL : k*in[i]; 
+  }
+#endif
+}
+
+void softbuffer_fx::load_8(int8_t *in, float *out, uint32_t len)
+{
+  const float k = 1.0/SCALE_8; 
+#ifdef LV_HAVE_SSE
+  __m128  vk    = _mm_set1_ps(k);
+  __m128  vnull = _mm_set1_ps(SRSLTE_RX_NULL);
+  __m128i inull = _mm_set1_epi32(NULL_8);
+  for (uint32_t i=0;i<len;i+=16) {
+    __m128i v = _mm_loadu_si128((__m128i*) &in[i]);
+    for (uint32_t j=0;j<4;j++) {
+      __m128i w = _mm_cvtepi8_epi32(v);
+      __m128  f = _mm_mul_ps(_mm_cvtepi32_ps(w), vk);
+      f = _mm_blendv_ps(f, vnull, _mm_castsi128_ps(_mm_cmpeq_epi32(w, inull)));
+      _mm_storeu_ps(&out[i+4*j], f);
+      v = _mm_srli_si128(v, 4);
+    }
+  }
+#else
+  for (uint32_t i=0;i<len;i++) {
+    out[i] = in[i] == NULL_8 ? SRSLTE_RX_NULL : k*in[i]; 
+  }
+#endif
+}
+
+// Saturates to +-INT16_MAX, INT16_MIN is the null marker
+void softbuffer_fx::save_16(float *in, int16_t *out, uint32_t len)
+{
+#ifdef LV_HAVE_SSE
+  __m128  vk    = _mm_set1_ps(SCALE_16);
+  __m128  vnull = _mm_set1_ps(SRSLTE_RX_NULL);
+  __m128  vmax  = _mm_set1_ps(INT16_MAX);
+  __m128  vmin  = _mm_set1_ps(-INT16_MAX);
+  __m128i inull = _mm_set1_epi16(NULL_16);
+  for (uint32_t i=0;i<len;i+=8) {
+    __m128  flo = _mm_loadu_ps(&in[i]);
+    __m128  fhi = _mm_loadu_ps(&in[i+4]);
+    __m128i m   = _mm_packs_epi32(_mm_castps_si128(_mm_cmpeq_ps(flo, vnull)), 
+                                  _mm_castps_si128(_mm_cmpeq_ps(fhi, vnull)));
+    flo = _mm_max_ps(_mm_min_ps(_mm_mul_ps(flo, vk), vmax), vmin);
+    fhi = _mm_max_ps(_mm_min_ps(_mm_mul_ps(fhi, vk), vmax), vmin);
+    __m128i v = _mm_packs_epi32(_mm_cvtps_epi32(flo), _mm_cvtps_epi32(fhi));
+    _mm_storeu_si128((__m128i*) &out[i], _mm_blendv_epi8(v, inull, m));
+  }
+#else
+  for (uint32_t i=0;i<len;i++) {
+    if (in[i] == SRSLTE_RX_NULL) {
+      out[i] = NULL_16; 
+    } else {
+      out[i] = (int16_t) lrintf(fmaxf(fminf(in[i]*SCALE_16, INT16_MAX), -INT16_MAX));
+    }
+  }
+#endif
+}
+
+// Saturates to +-INT8_MAX, INT8_MIN is the null marker
+void softbuffer_fx::save_8(float *in, int8_t *out, uint32_t len)
+{
+#ifdef LV_HAVE_SSE
+  __m128  vk    = _mm_set1_ps(SCALE_8);
+  __m128  vnull = _mm_set1_ps(SRSLTE_RX_NULL);
+  __m128  vmax  = _mm_set1_ps(INT8_MAX);
+  __m128  vmin  = _mm_set1_ps(-INT8_MAX);
+  __m128i inull = _mm_set1_epi8(NULL_8);
+  for (uint32_t i=0;i<len;i+=16) {
+    __m128i v[4], m[4]; 
+    for (uint32_t j=0;j<4;j++) {
+      __m128 f = _mm_loadu_ps(&in[i+4*j]);
+      m[j] = _mm_castps_si128(_mm_cmpeq_ps(f, vnull));
+      v[j] = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(f, vk), vmax), vmin));
+    }
+    __m128i mm = _mm_packs_epi16(_mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3]));
+    __m128i vv = _mm_packs_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+    _mm_storeu_si128((__m128i*) &out[i], _mm_blendv_epi8(vv, inull, mm));
+  }
+#else
+  for (uint32_t i=0;i<len;i++) {
+    if (in[i] == SRSLTE_RX_NULL) {
+      out[i] = NULL_8; 
+    } else {
+      out[i] = (int8_t) lrintf(fmaxf(fminf(in[i]*SCALE_8, INT8_MAX), -INT8_MAX));
+    }
+  }
+#endif
+}
+
+} // namespace srsue
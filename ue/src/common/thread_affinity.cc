@@ -0,0 +1,281 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "common/thread_affinity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+
+namespace srsue{
+
+thread_affinity* thread_affinity::instance = NULL;
+boost::mutex thread_affinity::instance_mutex;
+
+thread_affinity* thread_affinity::get_instance(void)
+{
+  boost::lock_guard<boost::mutex> lock(instance_mutex);
+  if(NULL == instance)
+    instance = new thread_affinity();
+  return instance;
+}
+
+void thread_affinity::cleanup(void)
+{
+  boost::lock_guard<boost::mutex> lock(instance_mutex);
+  if(NULL != instance)
+  {
+    delete instance;
+    instance = NULL;
+  }
+}
+
+thread_affinity::thread_affinity()
+  :configured(false)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  last_metrics_ns = (uint64_t) now.tv_sec*1000000000 + now.tv_nsec;
+}
+
+bool thread_affinity::parse(std::string spec, cpu_set_t *cpus, bool *has_cpus, int *prio, bool *has_prio)
+{
+  CPU_ZERO(cpus);
+  *has_cpus = false;
+  *has_prio = false;
+  *prio     = -1;
+
+  std::string cpu_spec  = spec;
+  size_t      at        = spec.find('@');
+  if(at != std::string::npos)
+  {
+    std::string prio_spec = spec.substr(at+1);
+    char *end;
+    long  p = strtol(prio_spec.c_str(), &end, 10);
+    if(prio_spec.empty() || *end != '\0' || p < -1 || p > 99)
+      return false;
+    *prio     = p;
+    *has_prio = true;
+    cpu_spec  = spec.substr(0, at);
+  }
+
+  // Comma separated list of CPUs and CPU ranges
+  std::stringstream ss(cpu_spec);
+  std::string       item;
+  while(std::getline(ss, item, ','))
+  {
+    if(item.empty())
+      continue;
+    char *end;
+    long  first = strtol(item.c_str(), &end, 10);
+    long  last  = first;
+    if(end == item.c_str())
+      return false;
+    if(*end == '-')
+    {
+      char *start = end+1;
+      last = strtol(start, &end, 10);
+      if(end == start)
+        return false;
+    }
+    if(*end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE)
+      return false;
+    for(long c=first;c<=last;c++)
+      CPU_SET(c, cpus);
+    *has_cpus = true;
+  }
+  return true;
+}
+
+bool thread_affinity::set(std::string key, std::string spec)
+{
+  placement_t p;
+  if(!parse(spec, &p.cpus, &p.has_cpus, &p.prio, &p.has_prio))
+    return false;
+  boost::lock_guard<boost::mutex> lock(mutex);
+  placements[key] = p;
+  return true;
+}
+
+void thread_affinity::configure()
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  configured = true;
+  for(uint32_t i=0;i<threads.size();i++)
+    apply(&threads[i]);
+}
+
+void thread_affinity::add(pthread_t thread, std::string key, std::string name, int prio)
+{
+  add_entry(thread, NULL, key, name, prio);
+}
+
+void thread_affinity::add(::thread *t, std::string key, std::string name, int prio)
+{
+  add_entry(t->get_pthread(), t, key, name, prio);
+}
+
+void thread_affinity::add_entry(pthread_t thread, ::thread *t, std::string key, std::string name, int prio)
+{
+  entry_t e;
+  e.thread      = thread;
+  e.t           = t;
+  e.key         = key;
+  e.name        = name.substr(0, 15);   // Kernel limit is 16 bytes including the terminator
+  e.prio        = prio;
+  e.last_cpu_ns = cpu_time_ns(thread);
+  memset(&e.last_usage, 0, sizeof(thread_usage_t));
+
+  int err = pthread_setname_np(thread, e.name.c_str());
+  if(err)
+    fprintf(stderr, "Error setting name of thread %s: %s\n", e.name.c_str(), strerror(err));
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+  threads.push_back(e);
+  if(configured)
+    apply(&threads.back());
+}
+
+void thread_affinity::apply(entry_t *e)
+{
+  std::map<std::string, placement_t>::iterator it = placements.find(e->key);
+  if(it == placements.end())
+    return;
+  placement_t *p = &it->second;
+
+  if(p->has_cpus)
+  {
+    int err = pthread_setaffinity_np(e->thread, sizeof(cpu_set_t), &p->cpus);
+    if(err)
+      fprintf(stderr, "Error setting CPU affinity of thread %s: %s\n", e->name.c_str(), strerror(err));
+  }
+  if(p->has_prio && p->prio != e->prio)
+  {
+    struct sched_param param;
+    int                policy;
+    if(p->prio >= 0)
+    {
+      policy               = SCHED_FIFO;
+      param.sched_priority = sched_get_priority_max(SCHED_FIFO) - p->prio;
+    } else {
+      policy               = SCHED_OTHER;
+      param.sched_priority = 0;
+    }
+    int err = pthread_setschedparam(e->thread, policy, &param);
+    if(err)
+      fprintf(stderr, "Error setting priority of thread %s: %s\n", e->name.c_str(), strerror(err));
+    else
+      e->prio = p->prio;
+  }
+}
+
+void thread_affinity::print()
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  printf("Thread placement:\n");
+  for(uint32_t i=0;i<threads.size();i++)
+  {
+    cpu_set_t          cpus;
+    struct sched_param param;
+    int                policy;
+    std::stringstream  ss;
+
+    if(pthread_getaffinity_np(threads[i].thread, sizeof(cpu_set_t), &cpus))
+      continue;
+    if(pthread_getschedparam(threads[i].thread, &policy, &param))
+      continue;
+
+    // Print CPU ranges, e.g. 0-3,6
+    int first = -1;
+    for(int c=0;c<=CPU_SETSIZE;c++)
+    {
+      bool set = (c < CPU_SETSIZE) && CPU_ISSET(c, &cpus);
+      if(set && first < 0)
+        first = c;
+      if(!set && first >= 0)
+      {
+        if(ss.tellp() > 0)
+          ss << ",";
+        ss << first;
+        if(c-1 > first)
+          ss << "-" << c-1;
+        first = -1;
+      }
+    }
+    printf("  %-15s cpus=%-12s %s prio=%d\n", threads[i].name.c_str(), ss.str().c_str(),
+           policy==SCHED_FIFO?"SCHED_FIFO ":(policy==SCHED_RR?"SCHED_RR   ":"SCHED_OTHER"),
+           param.sched_priority);
+  }
+}
+
+uint64_t thread_affinity::cpu_time_ns(pthread_t thread)
+{
+  clockid_t       cid;
+  struct timespec t;
+  if(pthread_getcpuclockid(thread, &cid) || clock_gettime(cid, &t))
+    return 0;
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+void thread_affinity::get_metrics(threads_metrics_t &m)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t now_ns     = (uint64_t) now.tv_sec*1000000000 + now.tv_nsec;
+  double   elapsed_ns = (double) (now_ns - last_metrics_ns);
+  last_metrics_ns     = now_ns;
+
+  m.nof_threads = 0;
+  for(uint32_t i=0;i<threads.size() && m.nof_threads<THREAD_METRICS_MAX_THREADS;i++)
+  {
+    entry_t          *e = &threads[i];
+    thread_metrics_t *t = &m.thread[m.nof_threads++];
+    memset(t, 0, sizeof(thread_metrics_t));
+    strncpy(t->name, e->name.c_str(), sizeof(t->name)-1);
+
+    uint64_t cpu_ns = cpu_time_ns(e->thread);
+    t->cpu_load     = 100*(cpu_ns - e->last_cpu_ns)/elapsed_ns;
+    e->last_cpu_ns  = cpu_ns;
+
+    if(e->t)
+    {
+      thread_usage_t u;
+      e->t->get_usage(&u);
+      t->has_sched   = true;
+      t->nvcsw       = 1e9*(u.nvcsw  - e->last_usage.nvcsw)/elapsed_ns;
+      t->nivcsw      = 1e9*(u.nivcsw - e->last_usage.nivcsw)/elapsed_ns;
+      t->nof_wakes   = u.nof_wakes - e->last_usage.nof_wakes;
+      if(t->nof_wakes > 0)
+        t->wake_avg_us = (float) (u.wake_sum_ns - e->last_usage.wake_sum_ns)/t->nof_wakes/1000;
+      t->wake_max_us = (float) u.wake_max_ns/1000;
+      e->last_usage  = u;
+    }
+  }
+}
+
+} // namespace srsue
@@ -52,6 +52,12 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <limits.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include "common/thread_pool.h"
 
 #define DEBUG 0
@@ -60,7 +66,25 @@
 #define USE_QUEUE
 
 namespace srslte {
- 
+
+static void futex_wait(volatile uint32_t *addr, uint32_t val)
+{
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(volatile uint32_t *addr, int n)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+static inline void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause" ::: "memory");
+#else
+  __sync_synchronize();
+#endif
+}
   
 void thread_pool::worker::setup(uint32_t id, thread_pool *parent, uint32_t prio)
 {
@@ -73,14 +97,30 @@ void thread_pool::worker::run_thread()
 {
   running = true;   
   while(running)  {
+    if (my_id >= my_parent->nof_active) {
+      park();
+    }
     wait_to_start();
     if (running) {
+      wake_sample();
       work_imp();
       finished();
+      update_usage();
     }
   }
 }
 
+/* Called by the worker itself before waiting for work. nof_active is checked again under the lock, 
+ * so a concurrent set_nof_active() either sees the worker parked and restores it, or it never parks */
+void thread_pool::worker::park()
+{
+  pthread_mutex_lock(&my_parent->mutex_sched);
+  if (my_id >= my_parent->nof_active) {
+    my_parent->park_worker(my_id, pthread_self());
+  }
+  pthread_mutex_unlock(&my_parent->mutex_sched);
+}
+
 uint32_t thread_pool::worker::get_id()
 {
   return my_id;
@@ -89,7 +129,12 @@ uint32_t thread_pool::worker::get_id()
 void thread_pool::worker::stop()
 {
   running = false; 
-  pthread_cond_signal(&my_parent->cvar[my_id]);
+  if (my_parent->mode == HANDOFF_SPIN) {
+    // Changing the status word guarantees a sleeping worker sees the wakeup
+    my_parent->start_worker_spin(my_id);
+  } else {
+    pthread_cond_signal(&my_parent->cvar[my_id]);
+  }
   wait_thread_finish();
 }
 
@@ -97,8 +142,10 @@ thread_pool::thread_pool(uint32_t max_workers_)  :
                                   workers(max_workers_),
                                   status(max_workers_),
                                   cvar(max_workers_),
-                                  mutex(max_workers_)
-                                  
+                                  mutex(max_workers_),
+                                  parked(max_workers_),
+                                  sched_policy(max_workers_),
+                                  sched_prio(max_workers_)
 {
   max_workers = max_workers_;
   for (int i=0;i<max_workers;i++) {
@@ -106,11 +153,44 @@ thread_pool::thread_pool(uint32_t max_workers_)  :
     status[i] = IDLE; 
     pthread_mutex_init(&mutex[i], NULL);
     pthread_cond_init(&cvar[i], NULL);
+    parked[i] = false; 
   }
   pthread_mutex_init(&mutex_queue, NULL);
+  pthread_mutex_init(&mutex_sched, NULL);
   pthread_cond_init(&cvar_queue, NULL);
   running = true; 
   nof_workers = 0; 
+  nof_active  = 0; 
+
+  mode          = HANDOFF_COND;
+  spin_ns       = 0;
+  idle_seq      = 0;
+  pool_sleeping = 0;
+  next_order    = 0;
+  spin_state    = new spin_state_t[max_workers];
+  for (uint32_t i=0;i<max_workers;i++) {
+    spin_state[i].status   = IDLE;
+    spin_state[i].sleeping = 0;
+    spin_state[i].order    = 0;
+  }
+}
+
+thread_pool::~thread_pool()
+{
+  delete [] spin_state;
+}
+
+void thread_pool::set_handoff_mode(handoff_mode_t mode_, uint32_t spin_us)
+{
+  mode    = mode_;
+  spin_ns = (uint64_t) spin_us*1000;
+}
+
+uint64_t thread_pool::now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
 }
 
 void thread_pool::init_worker(uint32_t id, worker *obj, uint32_t prio)
@@ -118,6 +198,7 @@ void thread_pool::init_worker(uint32_t id, worker *obj, uint32_t prio)
   if (id < max_workers) {
     if (id >= nof_workers) {
       nof_workers = id+1;
+      nof_active  = nof_workers; 
     }
     pthread_mutex_lock(&mutex_queue);   
     workers[id] = obj; 
@@ -132,6 +213,10 @@ void thread_pool::stop()
 {
   /* Stop any thread waiting for available worker */
   running = false; 
+  if (mode == HANDOFF_SPIN) {
+    __sync_fetch_and_add(&idle_seq, 1);
+    futex_wake(&idle_seq, INT_MAX);
+  }
   
   /* Now stop all workers */
   for (uint32_t i=0;i<nof_workers;i++) {
@@ -146,6 +231,7 @@ void thread_pool::stop()
   }
   pthread_cond_destroy(&cvar_queue);
   pthread_mutex_destroy(&mutex_queue);
+  pthread_mutex_destroy(&mutex_sched);
 }
 
 
@@ -156,7 +242,28 @@ void thread_pool::worker::release()
 
 void thread_pool::worker::wait_to_start()
 {
-  
+  if (my_parent->mode == HANDOFF_SPIN) {
+    spin_state_t *s = &my_parent->spin_state[my_id];
+    // Parked workers go straight to sleep
+    uint64_t deadline = my_parent->now_ns() + (my_id < my_parent->nof_active ? my_parent->spin_ns : 0);
+    uint32_t cur;
+    while((cur = s->status) != START_WORK && running) {
+      if (my_parent->now_ns() < deadline) {
+        cpu_relax();
+        continue;
+      }
+      s->sleeping = 1;
+      __sync_synchronize();
+      if (s->status == cur && running) {
+        futex_wait(&s->status, cur);
+      }
+      s->sleeping = 0;
+    }
+    s->status = WORKING;
+    __sync_synchronize();
+    return;
+  }
+
   debug_thread("wait_to_start() id=%d, status=%d, enter\n", my_id, my_parent->status[my_id]);
 
   pthread_mutex_lock(&my_parent->mutex[my_id]); 
@@ -171,6 +278,10 @@ void thread_pool::worker::wait_to_start()
 
 void thread_pool::worker::finished()
 {
+  if (my_parent->mode == HANDOFF_SPIN) {
+    my_parent->finished_spin(my_id);
+    return;
+  }
 #ifdef USE_QUEUE
   pthread_mutex_lock(&my_parent->mutex[my_id]); 
   my_parent->status[my_id] = IDLE; 
@@ -190,11 +301,11 @@ void thread_pool::worker::finished()
 
 thread_pool::worker* thread_pool::wait_worker()
 {
-  wait_worker(0);
+  return wait_worker(0);
 }
 
 bool thread_pool::find_finished_worker(uint32_t tti, uint32_t *id) {
-  for(int i=0;i<nof_workers;i++) {
+  for(uint32_t i=0;i<nof_active;i++) {
     if (status[i] == IDLE) {
       *id = i; 
       return true; 
@@ -207,6 +318,9 @@ thread_pool::worker* thread_pool::wait_worker(uint32_t tti)
 {
   thread_pool::worker *x; 
   
+  if (mode == HANDOFF_SPIN) {
+    return wait_worker_spin(tti);
+  }
 #ifdef USE_QUEUE
   debug_thread("wait_worker() - enter - tti=%d, state0=%d, state1=%d\n", tti, status[0], status[1]);
   pthread_mutex_lock(&mutex_queue); 
@@ -243,8 +357,44 @@ thread_pool::worker* thread_pool::wait_worker(uint32_t tti)
 }
 
 
+thread_pool::worker* thread_pool::try_wait_worker(uint32_t tti)
+{
+  if (!running) {
+    return NULL; 
+  }
+  if (mode == HANDOFF_SPIN) {
+    return take_idle_spin(tti);
+  }
+  uint32_t id    = 0;
+  bool     found = false; 
+#ifdef USE_QUEUE
+  pthread_mutex_lock(&mutex_queue); 
+  found = find_finished_worker(tti, &id);
+  pthread_mutex_unlock(&mutex_queue);
+#else
+  id    = tti%nof_workers;
+  found = true; 
+#endif  
+  if (!found) {
+    return NULL; 
+  }
+  pthread_mutex_lock(&mutex[id]); 
+  found = status[id] == IDLE; 
+  if (found) {
+    status[id] = WORKER_READY;
+  }
+  pthread_mutex_unlock(&mutex[id]);
+  debug_thread("try_wait_worker() - tti=%d, id=%d, found=%d\n", tti, id, found);
+  return found ? workers[id] : NULL; 
+}
+
 void thread_pool::start_worker(uint32_t id) {
-  if (id < nof_workers) {
+  if (id < nof_workers && workers[id]) {
+    workers[id]->wake_stamp();
+  }
+  if (id < nof_workers && mode == HANDOFF_SPIN) {
+    start_worker_spin(id);
+  } else if (id < nof_workers) {
     pthread_mutex_lock(&mutex[id]); 
     status[id] = START_WORK;
     pthread_cond_signal(&cvar[id]);
@@ -269,6 +419,7 @@ thread_pool::worker* thread_pool::get_worker(uint32_t id)
   if (id < nof_workers) {
     return workers[id];
   }
+  return NULL; 
 }
 
 uint32_t thread_pool::get_nof_workers()
@@ -276,6 +427,150 @@ uint32_t thread_pool::get_nof_workers()
   return nof_workers;
 }
 
+void thread_pool::set_nof_active(uint32_t n)
+{
+  if (n < 1) {
+    n = 1; 
+  }
+  if (n > nof_workers) {
+    n = nof_workers; 
+  }
+  pthread_mutex_lock(&mutex_sched);
+  // Idle workers are parked now, busy ones when they finish their subframe
+  for (uint32_t i=n;i<nof_workers;i++) {
+    bool idle = mode == HANDOFF_SPIN ? spin_state[i].status == IDLE : status[i] == IDLE; 
+    if (idle && workers[i]) {
+      park_worker(i, workers[i]->get_pthread());
+    }
+  }
+  // Restore the scheduling of unparked workers before they can be handed work
+  for (uint32_t i=0;i<n;i++) {
+    if (parked[i]) {
+      struct sched_param param;
+      param.sched_priority = sched_prio[i];
+      pthread_setschedparam(workers[i]->get_pthread(), sched_policy[i], &param);
+      parked[i] = false; 
+    }
+  }
+  nof_active = n; 
+  pthread_mutex_unlock(&mutex_sched);
+
+  // A thread in wait_worker() may be waiting for one of the new workers 
+  if (mode == HANDOFF_SPIN) {
+    __sync_fetch_and_add(&idle_seq, 1);
+    if (pool_sleeping) {
+      futex_wake(&idle_seq, INT_MAX);
+    }
+  } else {
+    pthread_mutex_lock(&mutex_queue);
+    pthread_cond_signal(&cvar_queue);
+    pthread_mutex_unlock(&mutex_queue);
+  }
+}
+
+uint32_t thread_pool::get_nof_active()
+{
+  return nof_active;
+}
+
+// Called with mutex_sched locked
+void thread_pool::park_worker(uint32_t id, pthread_t t)
+{
+  struct sched_param param;
+  int policy;
+  if (!parked[id] && !pthread_getschedparam(t, &policy, &param)) {
+    sched_policy[id] = policy;
+    sched_prio[id]   = param.sched_priority;
+    if (policy != SCHED_OTHER) {
+      param.sched_priority = 0;
+      pthread_setschedparam(t, SCHED_OTHER, &param);
+    }
+    parked[id] = true;
+    debug_thread("park_worker() id=%d, policy=%d\n", id, policy);
+  }
+}
+
+
+/* HANDOFF_SPIN: the status of each worker is an atomic word. Only the thread 
+ * that moves a worker out of IDLE (wait_worker) may start it, so transitions 
+ * need no lock. A waiter spins for spin_ns before sleeping on the futex of the 
+ * word it waits on, and announces it through a sleeping flag so that the 
+ * other side only enters the kernel when needed. 
+ */
+thread_pool::worker* thread_pool::wait_worker_spin(uint32_t tti)
+{
+  uint64_t deadline = now_ns() + spin_ns;
+  while(running) {
+    // Snapshot before scanning so that a worker finishing afterwards changes it
+    uint32_t seq = idle_seq;
+    __sync_synchronize();
+
+    // Take the idle worker that was started least recently
+    int32_t  id    = -1;
+    uint64_t order = 0;
+    for (uint32_t i=0;i<nof_active;i++) {
+      if (spin_state[i].status == IDLE && (id < 0 || spin_state[i].order < order)) {
+        id    = i;
+        order = spin_state[i].order;
+      }
+    }
+    if (id >= 0 && __sync_bool_compare_and_swap(&spin_state[id].status, IDLE, WORKER_READY)) {
+      spin_state[id].order = __sync_add_and_fetch(&next_order, 1);
+      debug_thread("wait_worker_spin() - tti=%d, id=%d\n", tti, id);
+      return workers[id];
+    }
+    if (id >= 0 || now_ns() < deadline) {
+      cpu_relax();
+      continue;
+    }
+    pool_sleeping = 1;
+    __sync_synchronize();
+    if (idle_seq == seq && running) {
+      futex_wait(&idle_seq, seq);
+    }
+    pool_sleeping = 0;
+  }
+  return NULL;
+}
+
+// Single pass of wait_worker_spin(), without spinning
+thread_pool::worker* thread_pool::take_idle_spin(uint32_t tti)
+{
+  int32_t  id    = -1;
+  uint64_t order = 0;
+  for (uint32_t i=0;i<nof_active;i++) {
+    if (spin_state[i].status == IDLE && (id < 0 || spin_state[i].order < order)) {
+      id    = i;
+      order = spin_state[i].order;
+    }
+  }
+  if (id >= 0 && __sync_bool_compare_and_swap(&spin_state[id].status, IDLE, WORKER_READY)) {
+    spin_state[id].order = __sync_add_and_fetch(&next_order, 1);
+    debug_thread("take_idle_spin() - tti=%d, id=%d\n", tti, id);
+    return workers[id];
+  }
+  return NULL;
+}
+
+void thread_pool::start_worker_spin(uint32_t id)
+{
+  spin_state_t *s = &spin_state[id];
+  s->status = START_WORK;
+  __sync_synchronize();
+  if (s->sleeping) {
+    futex_wake(&s->status, 1);
+  }
+}
+
+void thread_pool::finished_spin(uint32_t id)
+{
+  spin_state[id].status = IDLE;
+  __sync_fetch_and_add(&idle_seq, 1);
+  if (pool_sleeping) {
+    futex_wake(&idle_seq, INT_MAX);
+  }
+}
+
 }
 
 
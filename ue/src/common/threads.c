@@ -74,9 +74,11 @@ bool threads_new_rt_cpu(pthread_t *thread, void *(*start_routine) (void*), void
   pthread_attr_t attr;
   struct sched_param param;
 
+  if (prio_offset >= 0 || cpu != -1) {
+    pthread_attr_init(&attr);
+  }
   if (prio_offset >= 0) {
     param.sched_priority = sched_get_priority_max(SCHED_FIFO) - prio_offset;  
-    pthread_attr_init(&attr);
     if (pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)) {
       perror("pthread_attr_setinheritsched");
     }
@@ -97,7 +99,7 @@ bool threads_new_rt_cpu(pthread_t *thread, void *(*start_routine) (void*), void
       perror("pthread_attr_setaffinity_np");
     }
   } 
-  int err = pthread_create(thread, prio_offset >= 0 ? &attr : NULL, start_routine, arg);
+  int err = pthread_create(thread, (prio_offset >= 0 || cpu != -1) ? &attr : NULL, start_routine, arg);
   if (err) {
     if (EPERM == err) {
       perror("Failed to create thread - permission error. Running with root permissions?");
@@ -106,7 +108,7 @@ bool threads_new_rt_cpu(pthread_t *thread, void *(*start_routine) (void*), void
   } else {
     ret = true; 
   }
-  if (prio_offset >= 0) {
+  if (prio_offset >= 0 || cpu != -1) {
     pthread_attr_destroy(&attr);
   }
   return ret; 
@@ -0,0 +1,235 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "common/timer_wheel.h"
+#include "common/thread_affinity.h"
+#include <boost/thread/lock_guard.hpp>
+#include <string.h>
+#include <time.h>
+
+namespace srsue{
+
+timer_wheel* timer_wheel::instance = NULL;
+boost::mutex timer_wheel::instance_mutex;
+
+timer_wheel* timer_wheel::get_instance(void)
+{
+  boost::lock_guard<boost::mutex> lock(instance_mutex);
+  if(NULL == instance)
+    instance = new timer_wheel();
+  return instance;
+}
+
+void timer_wheel::cleanup(void)
+{
+  boost::lock_guard<boost::mutex> lock(instance_mutex);
+  if(NULL != instance)
+  {
+    delete instance;
+    instance = NULL;
+  }
+}
+
+timer_wheel::timer_wheel()
+  :current(0)
+  ,running(true)
+  ,firing(NULL)
+{
+  memset(slots, 0, sizeof(slots));
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cvar, NULL);
+  start_ns = monotonic_ns();
+  pthread_create(&thread, NULL, &thread_start, this);
+  thread_affinity::get_instance()->add(thread, "timeout", "TIMEOUT");
+}
+
+timer_wheel::~timer_wheel()
+{
+  running = false;
+  pthread_join(thread, NULL);
+  pthread_mutex_destroy(&mutex);
+  pthread_cond_destroy(&cvar);
+}
+
+void timer_wheel::add(timer_wheel_entry *e, uint32_t duration_msec)
+{
+  pthread_mutex_lock(&mutex);
+  if(e->head)
+    unlink(e);
+  // Round up to the first tick after the requested duration
+  e->expiry = (monotonic_ns()-start_ns + duration_msec*1000000ULL + 999999)/1000000;
+  // The current slot has already been processed
+  if(e->expiry <= current)
+    e->expiry = current+1;
+  insert(e);
+  pthread_mutex_unlock(&mutex);
+}
+
+// Removes an entry. If the entry is being expired by the wheel thread, waits
+// for it to finish so that the entry can be safely destroyed afterwards.
+void timer_wheel::remove(timer_wheel_entry *e)
+{
+  pthread_mutex_lock(&mutex);
+  if(e->head)
+    unlink(e);
+  while(firing == e && !pthread_equal(pthread_self(), thread))
+    pthread_cond_wait(&cvar, &mutex);
+  pthread_mutex_unlock(&mutex);
+}
+
+// Current wheel time in ms since the service was started. Does not read the clock.
+uint64_t timer_wheel::now()
+{
+  return current;
+}
+
+/*******************************************************************************
+  Wheel thread
+*******************************************************************************/
+
+void* timer_wheel::thread_start(void *w)
+{
+  ((timer_wheel*)w)->thread_func();
+  return NULL;
+}
+
+void timer_wheel::thread_func()
+{
+  struct timespec next;
+  while(running)
+  {
+    // Ticks are aligned to the wheel start time
+    uint64_t next_ns = start_ns + (current+1)*1000000;
+    next.tv_sec  = next_ns/1000000000;
+    next.tv_nsec = next_ns%1000000000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+    // Catch up if the thread was delayed
+    uint64_t target = (monotonic_ns()-start_ns)/1000000;
+    pthread_mutex_lock(&mutex);
+    while(current < target)
+      tick();
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+// Advances the wheel by one ms and expires due entries. Called with mutex held.
+void timer_wheel::tick()
+{
+  current++;
+  uint64_t t = current;
+  if((t & (LEVEL0_SLOTS-1)) == 0)
+  {
+    // Find the highest level that wrapped and cascade from there downwards
+    uint32_t l = 1;
+    while(l < NOF_LEVELS-1 && level_slot(t, l) == 0)
+      l++;
+    for(;l>0;l--)
+      cascade(l, level_slot(t, l));
+  }
+
+  uint32_t slot = t & (LEVEL0_SLOTS-1);
+  while(slots[0][slot])
+  {
+    timer_wheel_entry *e = slots[0][slot];
+    unlink(e);
+    firing = e;
+    pthread_mutex_unlock(&mutex);
+    e->expire();
+    pthread_mutex_lock(&mutex);
+    firing = NULL;
+    pthread_cond_broadcast(&cvar);
+  }
+}
+
+// Moves all entries of a higher level slot down the hierarchy
+void timer_wheel::cascade(uint32_t level, uint32_t slot)
+{
+  timer_wheel_entry *e = slots[level][slot];
+  slots[level][slot] = NULL;
+  while(e)
+  {
+    timer_wheel_entry *n = e->next;
+    e->head = NULL;
+    insert(e);
+    e = n;
+  }
+}
+
+void timer_wheel::insert(timer_wheel_entry *e)
+{
+  uint64_t delta = (e->expiry > current) ? e->expiry-current : 0;
+  uint32_t level = 0;
+  uint32_t slot;
+  if(delta > MAX_DELTA)
+  {
+    // Beyond the wheel range. The top level slot of the current time cascades again after a full
+    // turn, MAX_DELTA+1 ms at most, so never after the expiry. The entry is inserted again then
+    level = NOF_LEVELS-1;
+    slot  = level_slot(current, level);
+  }else if(delta < LEVEL0_SLOTS)
+  {
+    slot = e->expiry & (LEVEL0_SLOTS-1);
+  }else{
+    level = 1;
+    while(level < NOF_LEVELS-1 && delta >= (1ULL<<(LEVEL0_BITS+level*LEVELN_BITS)))
+      level++;
+    slot = level_slot(e->expiry, level);
+  }
+  e->head = &slots[level][slot];
+  e->prev = NULL;
+  e->next = *e->head;
+  if(e->next)
+    e->next->prev = e;
+  *e->head = e;
+}
+
+void timer_wheel::unlink(timer_wheel_entry *e)
+{
+  if(e->prev)
+    e->prev->next = e->next;
+  else
+    *e->head = e->next;
+  if(e->next)
+    e->next->prev = e->prev;
+  e->prev = NULL;
+  e->next = NULL;
+  e->head = NULL;
+}
+
+uint32_t timer_wheel::level_slot(uint64_t t, uint32_t level)
+{
+  return (t>>(LEVEL0_BITS+(level-1)*LEVELN_BITS)) & (LEVELN_SLOTS-1);
+}
+
+uint64_t timer_wheel::monotonic_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+} // namespace srsue
@@ -0,0 +1,141 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        log_decoder.cc
+ * Description: Decodes a binary log file written with log.binary = true
+ *              into the text log format.
+ *              Usage: srsue_log_decoder <binary log> [<text log>]
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "common/log_binary.h"
+
+using namespace srsue;
+
+static bool read_bytes(FILE *f, void *buf, uint32_t len)
+{
+  return fread(buf, 1, len, f) == len;
+}
+
+static void set_def(std::vector<std::string> &table, const uint8_t *rec)
+{
+  const log_binary_def_t *def = (const log_binary_def_t*) rec;
+  if(def->hdr.len <= sizeof(log_binary_def_t))
+    return;
+  if(def->id >= table.size())
+    table.resize(def->id+1);
+  table[def->id] = std::string((const char*) &rec[sizeof(log_binary_def_t)],
+                               strnlen((const char*) &rec[sizeof(log_binary_def_t)],
+                                       def->hdr.len-sizeof(log_binary_def_t)));
+}
+
+int main(int argc, char *argv[])
+{
+  if(argc < 2) {
+    printf("Usage: %s <binary log> [<text log>]\n", argv[0]);
+    return -1;
+  }
+  FILE *in = fopen(argv[1], "r");
+  if(!in) {
+    printf("Error: could not open %s\n", argv[1]);
+    return -1;
+  }
+  FILE *out = stdout;
+  if(argc > 2) {
+    out = fopen(argv[2], "w");
+    if(!out) {
+      printf("Error: could not create %s\n", argv[2]);
+      fclose(in);
+      return -1;
+    }
+  }
+
+  char magic[sizeof(LOG_BINARY_MAGIC)] = {0};
+  if(!read_bytes(in, magic, strlen(LOG_BINARY_MAGIC)) || strcmp(magic, LOG_BINARY_MAGIC)) {
+    printf("Error: %s is not a binary log file\n", argv[1]);
+    fclose(in);
+    return -1;
+  }
+
+  std::vector<std::string> formats;
+  std::vector<std::string> layers;
+  uint8_t                  rec[LOG_BINARY_MAX_RECORD];
+  log_binary_hdr_t        *hdr = (log_binary_hdr_t*) rec;
+  uint32_t                 nof_records = 0;
+  uint32_t                 nof_overflows = 0;
+
+  while(read_bytes(in, hdr, sizeof(log_binary_hdr_t))) {
+    if(hdr->len < sizeof(log_binary_hdr_t) || hdr->len > LOG_BINARY_MAX_RECORD) {
+      printf("Error: invalid record length %d after %d records\n", hdr->len, nof_records);
+      break;
+    }
+    if(!read_bytes(in, &rec[sizeof(log_binary_hdr_t)], hdr->len-sizeof(log_binary_hdr_t))) {
+      printf("Warning: truncated record after %d records\n", nof_records);
+      break;
+    }
+    switch(hdr->type)
+    {
+    case LOG_BINARY_REC_TEXT:
+      fwrite(&rec[sizeof(log_binary_hdr_t)], 1, hdr->len-sizeof(log_binary_hdr_t), out);
+      break;
+    case LOG_BINARY_REC_FORMAT:
+      set_def(formats, rec);
+      break;
+    case LOG_BINARY_REC_LAYER:
+      set_def(layers, rec);
+      break;
+    case LOG_BINARY_REC_MSG:
+    {
+      log_binary_msg_t *msg = (log_binary_msg_t*) rec;
+      if(sizeof(log_binary_msg_t)+msg->args_len+msg->hex_len > hdr->len) {
+        printf("Error: invalid message record after %d records\n", nof_records);
+        break;
+      }
+      const char *fmt   = (msg->fmt_id < formats.size())  ? formats[msg->fmt_id].c_str()  : NULL;
+      const char *layer = (msg->layer_id < layers.size()) ? layers[msg->layer_id].c_str() : NULL;
+      if(msg->fmt_id == LOG_BINARY_FORMAT_OVERFLOW || msg->layer_id == LOG_BINARY_LAYER_OVERFLOW)
+        nof_overflows++;
+      std::string line  = log_binary_format_msg(msg, fmt, layer);
+      fwrite(line.c_str(), 1, line.length(), out);
+      break;
+    }
+    default:
+      break;
+    }
+    nof_records++;
+  }
+
+  if(nof_overflows)
+    printf("Warning: %d messages logged after the format or layer table was full\n", nof_overflows);
+  fclose(in);
+  if(out != stdout)
+    fclose(out);
+  return 0;
+}
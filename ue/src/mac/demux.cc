@@ -25,10 +25,10 @@
  */
 
 
-#define Error(fmt, ...)   log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 #include "mac/mac.h"
 #include "mac/demux.h"
@@ -43,12 +43,13 @@ demux::demux() : mac_msg(20), pending_mac_msg(20)
   }
 }
 
-void demux::init(phy_interface* phy_h_, rlc_interface_mac *rlc_, srslte::log* log_h_, srslte::timers* timers_db_)
+void demux::init(phy_interface* phy_h_, rlc_interface_mac *rlc_, srslte::log* log_h_, srslte::timers* timers_db_, drx_proc *drx_)
 {
   phy_h     = phy_h_; 
   log_h     = log_h_; 
   rlc       = rlc_;  
   timers_db = timers_db_;
+  drx       = drx_; 
 }
 
 void demux::set_uecrid_callback(bool (*callback)(void*,uint64_t), void *arg) {
@@ -217,6 +218,9 @@ bool demux::process_ce(sch_subh *subh) {
       timers_db->get(mac::TIME_ALIGNMENT)->run();
       Info("Received time advance command %d\n", subh->get_ta_cmd());
       break;
+    case sch_subh::DRX_CMD:
+      drx->drx_command(phy_h->get_current_tti());
+      break;
     case sch_subh::PADDING:
       break;
     default:
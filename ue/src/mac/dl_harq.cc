@@ -24,10 +24,10 @@
  *
  */
 
-#define Error(fmt, ...)   log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 #include "phy/phy.h"
 #include "mac/mac.h"
@@ -62,6 +62,21 @@ bool dl_harq_entity::init(srslte::log* log_h_, mac_params *params_db_, srslte::t
 
 }
 
+bool dl_harq_entity::init_cell(uint32_t nof_prb)
+{
+  uint32_t nof_bits = (uint32_t) params_db->get_param(mac_interface_params::HARQ_SOFTBUFFER_BITS); 
+  if (nof_bits != 16 && nof_bits != 8) {
+    nof_bits = 32; 
+  }
+  for (uint32_t i=0;i<NOF_HARQ_PROC+1;i++) {
+    if (!proc[i].init_cell(nof_prb, nof_bits)) {
+      return false; 
+    }
+  }
+  Info("DL HARQ soft buffers for %d PRB, %d-bit soft bits\n", nof_prb, nof_bits);
+  return true; 
+}
+
 void dl_harq_entity::start_pcap(mac_pcap* pcap_)
 {
   pcap = pcap_; 
@@ -156,8 +171,10 @@ bool dl_harq_entity::generate_ack_callback(void *arg)
   *********************************************************/
           
 dl_harq_entity::dl_harq_process::dl_harq_process() {
-  is_initiated = false; 
-  ack = false; 
+  is_initiated    = false; 
+  ack             = false; 
+  softbuffer_prb  = 0; 
+  softbuffer_bits = 0; 
   bzero(&cur_grant, sizeof(mac_interface_phy::mac_grant_t));
 }  
   
@@ -165,22 +182,41 @@ void dl_harq_entity::dl_harq_process::reset() {
   ack = false; 
   payload_buffer_ptr = NULL; 
   bzero(&cur_grant, sizeof(mac_interface_phy::mac_grant_t));
-  if (is_initiated) {
+  if (softbuffer_bits == 32) {
     srslte_softbuffer_rx_reset(&softbuffer);
+  } else if (softbuffer_prb) {
+    fx_softbuffer.reset();
   }
 }
 
+// Soft buffers are allocated by init_cell(), once the bandwidth is known
 bool dl_harq_entity::dl_harq_process::init(uint32_t pid_, dl_harq_entity *parent) {
-  if (srslte_softbuffer_rx_init(&softbuffer, 100)) {
+  pid = pid_;
+  is_initiated = true; 
+  harq_entity = parent; 
+  log_h = harq_entity->log_h; 
+  return true;
+}
+
+bool dl_harq_entity::dl_harq_process::init_cell(uint32_t nof_prb, uint32_t nof_bits) {
+  if (nof_prb == softbuffer_prb && nof_bits == softbuffer_bits) {
+    return true; 
+  }
+  if (softbuffer_bits == 32) {
+    srslte_softbuffer_rx_free(&softbuffer);
+  }
+  fx_softbuffer.free_buffers();
+  softbuffer_prb  = 0; 
+  softbuffer_bits = 0; 
+  
+  bool ok = nof_bits == 32 ? !srslte_softbuffer_rx_init(&softbuffer, nof_prb) : fx_softbuffer.init(nof_prb, nof_bits);
+  if (!ok) {
     Error("Error initiating soft buffer\n");
     return false; 
-  } else {
-    pid = pid_;
-    is_initiated = true; 
-    harq_entity = parent; 
-    log_h = harq_entity->log_h; 
-    return true;
-  }     
+  }
+  softbuffer_prb  = nof_prb; 
+  softbuffer_bits = nof_bits; 
+  return true; 
 }
 
 bool dl_harq_entity::dl_harq_process::is_sps()
@@ -229,7 +265,11 @@ void dl_harq_entity::dl_harq_process::new_grant_dl(mac_interface_phy::mac_grant_
   
   if (is_new_transmission(grant)) {
     ack = false; 
-    srslte_softbuffer_rx_reset_tbs(&softbuffer, cur_grant.n_bytes*8);
+    if (softbuffer_bits == 32) {
+      srslte_softbuffer_rx_reset_tbs(&softbuffer, cur_grant.n_bytes*8);
+    } else if (softbuffer_prb) {
+      fx_softbuffer.reset();
+    }
   }
   
   // Save grant 
@@ -244,6 +284,11 @@ void dl_harq_entity::dl_harq_process::new_grant_dl(mac_interface_phy::mac_grant_
   // If data has not yet been successfully decoded
   if (ack == false) {
     
+    if (!softbuffer_prb) {
+      Error("DL PID %d: Soft buffer not initiated\n", pid);
+      return; 
+    }
+    
     // Instruct the PHY To combine the received data and attempt to decode it
     payload_buffer_ptr = harq_entity->demux_unit->request_buffer(pid, cur_grant.n_bytes);
     action->payload_ptr = payload_buffer_ptr;
@@ -255,7 +300,11 @@ void dl_harq_entity::dl_harq_process::new_grant_dl(mac_interface_phy::mac_grant_
     action->decode_enabled = true;     
     action->rv = cur_grant.rv; 
     action->rnti = cur_grant.rnti; 
-    action->softbuffer = &softbuffer;     
+    if (softbuffer_bits == 32) {
+      action->softbuffer = &softbuffer;     
+    } else {
+      action->fx_softbuffer = &fx_softbuffer; 
+    }
     memcpy(&action->phy_grant, &cur_grant.phy_grant, sizeof(srslte_phy_grant_t));
     
   } else {
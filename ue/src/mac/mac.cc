@@ -24,10 +24,10 @@
  *
  */
 
-#define Error(fmt, ...)   log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 #include <string.h>
 #include <strings.h>
@@ -35,6 +35,7 @@
 #include <unistd.h>
 
 #include "common/log.h"
+#include "common/thread_affinity.h"
 #include "mac/mac.h"
 #include "mac/pcap.h"
 
@@ -67,9 +68,10 @@ bool mac::init(phy_interface *phy, rlc_interface_mac *rlc, srslte::log *log_h_)
   bsr_procedure.init(       rlc_h, log_h, &params_db, &timers_db);
   phr_procedure.init(phy_h,        log_h, &params_db, &timers_db);
   mux_unit.init     (       rlc_h, log_h,                          &bsr_procedure, &phr_procedure);
-  demux_unit.init   (phy_h, rlc_h, log_h,             &timers_db);
+  demux_unit.init   (phy_h, rlc_h, log_h,             &timers_db, &drx_procedure);
   ra_procedure.init (phy_h,        log_h, &params_db, &timers_db, &mux_unit, &demux_unit);
   sr_procedure.init (phy_h,        log_h, &params_db);
+  drx_procedure.init(phy_h,        log_h, &params_db);
   ul_harq.init      (              log_h, &params_db, &timers_db, &mux_unit);
   dl_harq.init      (              log_h, &params_db, &timers_db, &demux_unit);
 
@@ -77,6 +79,12 @@ bool mac::init(phy_interface *phy, rlc_interface_mac *rlc, srslte::log *log_h_)
   
   started = true; 
   start(MAC_MAIN_THREAD_PRIO);
+
+  // Timer and PDU threads are started by their constructors
+  thread_affinity *affinity = thread_affinity::get_instance();
+  affinity->add(this,                 "mac",        "MAC",        MAC_MAIN_THREAD_PRIO);
+  affinity->add(&pdu_process_thread,  "mac_pdu",    "MAC_PDU",    MAC_PDU_THREAD_PRIO);
+  affinity->add(&upper_timers_thread, "mac_timers", "MAC_TIMERS");
   
   
   return started; 
@@ -102,7 +110,7 @@ void mac::start_pcap(mac_pcap* pcap_)
 // Implement Section 5.8
 void mac::reconfiguration()
 {
-
+  drx_procedure.configure(phy_h->get_current_tti());
 }
 
 // Implement Section 5.9
@@ -127,6 +135,7 @@ void mac::reset()
   bsr_procedure.reset();
   phr_procedure.stop();
   phr_procedure.reset();
+  drx_procedure.reset();
   
   dl_harq.reset();
   phy_h->pdcch_dl_search_reset();
@@ -154,6 +163,7 @@ void mac::run_thread() {
 
     /* Warning: Here order of invocation of procedures is important!! */
     tti = ttisync.wait();
+    wake_sample();
     
     if (started) {
       log_h->step(tti);
@@ -191,6 +201,12 @@ void mac::run_thread() {
       
       ra_procedure.step(tti);
       //phr_procedure.step(tti);
+      
+      // A pending SR or random access procedure is part of the DRX active time
+      if (sr_procedure.is_pending() || ra_procedure.in_progress()) {
+        drx_procedure.keep_active(tti);
+      }
+      drx_procedure.step(tti);
 
       // FIXME: Do here DTX and look for UL grants only when needed
       if (ra_procedure.is_successful() && !signals_pregenerated) {
@@ -208,6 +224,7 @@ void mac::run_thread() {
       }
       
       timers_db.step_all();          
+      update_usage();
     }
   }  
 }
@@ -245,12 +262,20 @@ void mac::search_si_rnti()
 
 void mac::tti_clock(uint32_t tti)
 {
+  wake_stamp();
   ttisync.increase();
   upper_timers_thread.tti_clock();
 }
 
 void mac::bch_decoded_ok(uint8_t* payload, uint32_t len)
 {
+  // The PHY sets up the cell from this MIB, size the DL HARQ soft buffers for its bandwidth
+  srslte_cell_t cell; 
+  phy_h->get_current_cell(&cell);
+  if (!dl_harq.init_cell(cell.nof_prb)) {
+    Error("Initiating DL HARQ soft buffers for %d PRB\n", cell.nof_prb);
+  }
+  
   // Send MIB to RRC 
   rlc_h->write_pdu_bcch_bch(payload, len);
   
@@ -280,6 +305,7 @@ void mac::new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_interface_phy::
       if (ra_procedure.is_contention_resolution()) {
         ra_procedure.pdcch_to_crnti(false);
       }
+      drx_procedure.pdcch_dl(grant.tti, grant.pid);
     }
     dl_harq.new_grant_dl(grant, action);
   }
@@ -302,6 +328,7 @@ void mac::new_grant_ul(mac_interface_phy::mac_grant_t grant, mac_interface_phy::
     if (ra_procedure.is_contention_resolution()) {
       ra_procedure.pdcch_to_crnti(true);
     }
+    drx_procedure.pdcch_ul(grant.tti);
   }
   ul_harq.new_grant_ul(grant, action);
   metrics.tx_pkts++;
@@ -310,6 +337,9 @@ void mac::new_grant_ul(mac_interface_phy::mac_grant_t grant, mac_interface_phy::
 void mac::new_grant_ul_ack(mac_interface_phy::mac_grant_t grant, bool ack, mac_interface_phy::tb_action_ul_t* action)
 {
   int tbs = ul_harq.get_current_tbs(tti);
+  if (grant.rnti_type == SRSLTE_RNTI_USER) {
+    drx_procedure.pdcch_ul(grant.tti);
+  }
   ul_harq.new_grant_ul_ack(grant, ack, action);
   if (!ack) {
     metrics.tx_errors++;
@@ -326,6 +356,9 @@ void mac::tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid)
     }
   } else {
     dl_harq.tb_decoded(ack, rnti_type, harq_pid);
+    if (rnti_type == SRSLTE_RNTI_USER) {
+      drx_procedure.dl_tb_decoded(harq_pid, ack);
+    }
     if (ack) {
       pdu_process_thread.notify();
       metrics.rx_brate += dl_harq.get_current_tbs(harq_pid);
@@ -394,6 +427,10 @@ srslte::timers::timer* mac::get(uint32_t timer_id)
 
 void mac::get_metrics(mac_metrics_t &m)
 {
+  srslte::timers_metrics_t timers_metrics;
+  timers_db.get_metrics(timers_metrics);
+  metrics.timers_avg_us = timers_metrics.avg_step_us;
+  metrics.timers_max_us = timers_metrics.max_step_us;
   metrics.ul_buffer = (int) bsr_procedure.get_buffer_state();
   m = metrics;  
   bzero(&metrics, sizeof(mac_metrics_t));
@@ -412,7 +449,9 @@ void mac::upper_timers::run_thread()
   ttisync.resync();
   while(running) {
     ttisync.wait();
+    wake_sample();
     timers_db.step_all();
+    update_usage();
   }
 }
 srslte::timers::timer* mac::upper_timers::get(uint32_t timer_id)
@@ -438,6 +477,7 @@ void mac::upper_timers::reset()
 
 void mac::upper_timers::tti_clock()
 {
+  wake_stamp();
   ttisync.increase();
 }
 
@@ -471,6 +511,7 @@ void mac::pdu_process::stop()
 
 void mac::pdu_process::notify()
 {
+  wake_stamp();
   pthread_mutex_lock(&mutex);
   have_data = true; 
   pthread_cond_signal(&cvar);
@@ -481,7 +522,9 @@ void mac::pdu_process::run_thread()
 {
   running = true; 
   while(running) {
+    wake_sample();
     have_data = demux_unit->process_pdus();
+    update_usage();
     if (!have_data) {
       pthread_mutex_lock(&mutex);
       while(!have_data && running) {
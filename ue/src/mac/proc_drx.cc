@@ -0,0 +1,252 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define Error(fmt, ...)   SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+#include <strings.h>
+#include "mac/proc_drx.h"
+
+
+namespace srsue {
+
+drx_proc::drx_proc()
+{
+  initiated = false; 
+  phy_h     = NULL; 
+  log_h     = NULL; 
+  params_db = NULL; 
+  pthread_mutex_init(&mutex, NULL);
+  on_duration       = 0; 
+  inactivity_timer  = 0; 
+  retx_timer        = 0; 
+  long_cycle        = 0; 
+  offset            = 0; 
+  short_cycle       = 0; 
+  short_cycle_timer = 0; 
+  active_until      = 0; 
+  hold_until        = 0; 
+  inactivity_running  = false; 
+  inactivity_end      = 0; 
+  short_cycle_running = false; 
+  short_cycle_end     = 0; 
+  bzero(dl_tti, sizeof(dl_tti));
+}
+
+drx_proc::~drx_proc()
+{
+  pthread_mutex_destroy(&mutex);
+}
+
+void drx_proc::init(phy_interface* phy_h_, srslte::log* log_h_, mac_params* params_db_)
+{
+  phy_h     = phy_h_; 
+  log_h     = log_h_; 
+  params_db = params_db_; 
+  initiated = true; 
+}
+
+// DRX is off until RRC configures it again
+void drx_proc::reset()
+{
+  if (initiated) {
+    pthread_mutex_lock(&mutex);
+    stop();
+    inactivity_running  = false; 
+    short_cycle_running = false; 
+    phy_h->drx_set_cycle(0, 0, 0);
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+void drx_proc::configure(uint32_t tti)
+{
+  if (!initiated) {
+    return; 
+  }
+  pthread_mutex_lock(&mutex);
+  on_duration       = params_db->get_param(mac_interface_params::DRX_ON_DURATION_TIMER);
+  inactivity_timer  = params_db->get_param(mac_interface_params::DRX_INACTIVITY_TIMER);
+  retx_timer        = params_db->get_param(mac_interface_params::DRX_RETX_TIMER);
+  long_cycle        = params_db->get_param(mac_interface_params::DRX_LONG_CYCLE);
+  offset            = params_db->get_param(mac_interface_params::DRX_LONG_CYCLE_OFFSET);
+  short_cycle       = params_db->get_param(mac_interface_params::DRX_SHORT_CYCLE);
+  short_cycle_timer = params_db->get_param(mac_interface_params::DRX_SHORT_CYCLE_TIMER);
+  
+  inactivity_running  = false; 
+  short_cycle_running = false; 
+  if (long_cycle > 0 && on_duration > 0) {
+    run();
+    // Stay active until the inactivity timer expires, as if a PDCCH had been received now
+    start_inactivity(tti);
+    set_cycle(false);
+    Info("DRX configured: onDuration=%d, inactivity=%d, retx=%d, long cycle=%d, offset=%d, short cycle=%d x %d\n",
+         on_duration, inactivity_timer, retx_timer, long_cycle, offset, short_cycle, short_cycle_timer);
+  } else {
+    stop();
+    phy_h->drx_set_cycle(0, 0, 0);
+    Info("DRX released\n");
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void drx_proc::step(uint32_t tti)
+{
+  if (!initiated) {
+    return; 
+  }
+  pthread_mutex_lock(&mutex);
+  if (is_running()) {
+    if (inactivity_running && tti_after(tti, inactivity_end)) {
+      inactivity_running = false; 
+      if (short_cycle) {
+        start_short_cycle(tti);
+      }
+    }
+    if (short_cycle_running && tti_after(tti, short_cycle_end)) {
+      short_cycle_running = false; 
+      set_cycle(false);
+    }
+    // Keep active_until behind tti by less than half the TTI range, or the PHY would see it ahead
+    if (tti_after(tti, (active_until + 2048)%10240)) {
+      active_until = (tti + 10240 - 1024)%10240; 
+      phy_h->drx_set_active_until(active_until);
+    }
+    if (tti_after(tti, (hold_until + 2048)%10240)) {
+      hold_until = (tti + 10240 - 1024)%10240; 
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void drx_proc::keep_active(uint32_t tti)
+{
+  pthread_mutex_lock(&mutex);
+  if (is_running()) {
+    hold(tti);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void drx_proc::pdcch_dl(uint32_t tti, uint32_t pid)
+{
+  pthread_mutex_lock(&mutex);
+  if (is_running()) {
+    start_inactivity(tti);
+  }
+  dl_tti[pid%NOF_HARQ_PID] = tti; 
+  pthread_mutex_unlock(&mutex);
+}
+
+void drx_proc::pdcch_ul(uint32_t tti)
+{
+  pthread_mutex_lock(&mutex);
+  if (is_running()) {
+    start_inactivity(tti);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/* drx-RetransmissionTimer starts when the HARQ RTT timer expires. The PDCCH is also monitored 
+ * during the HARQ RTT, the eNodeB may not schedule the retransmission earlier anyway */
+void drx_proc::dl_tb_decoded(uint32_t pid, bool ack)
+{
+  pthread_mutex_lock(&mutex);
+  if (is_running() && !ack) {
+    hold((dl_tti[pid%NOF_HARQ_PID] + HARQ_RTT + retx_timer - 1)%10240);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/* Stops drx-InactivityTimer. The onDurationTimer of the current cycle is evaluated by the PHY 
+ * and keeps running, as do the retransmission timers and the other conditions of the active time */
+void drx_proc::drx_command(uint32_t tti)
+{
+  pthread_mutex_lock(&mutex);
+  if (is_running()) {
+    inactivity_running = false; 
+    active_until       = tti_after(hold_until, tti) ? hold_until : tti; 
+    phy_h->drx_set_active_until(active_until);
+    if (short_cycle) {
+      start_short_cycle(tti);
+    } else {
+      set_cycle(false);
+    }
+    Info("DRX Command received\n");
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void drx_proc::start_inactivity(uint32_t tti)
+{
+  inactivity_running = true; 
+  inactivity_end     = (tti + inactivity_timer)%10240; 
+  extend(inactivity_end);
+}
+
+void drx_proc::start_short_cycle(uint32_t tti)
+{
+  short_cycle_running = true; 
+  short_cycle_end     = (tti + short_cycle*short_cycle_timer)%10240; 
+  set_cycle(true);
+}
+
+void drx_proc::set_cycle(bool is_short)
+{
+  if (is_short) {
+    phy_h->drx_set_cycle(short_cycle, offset%short_cycle, on_duration);
+  } else {
+    phy_h->drx_set_cycle(long_cycle, offset, on_duration);
+  }
+}
+
+void drx_proc::extend(uint32_t tti)
+{
+  if (tti_after(tti, active_until)) {
+    active_until = tti; 
+    phy_h->drx_set_active_until(active_until);
+  }
+}
+
+// Active time that only ends on its own, not with a DRX Command
+void drx_proc::hold(uint32_t tti)
+{
+  if (tti_after(tti, hold_until)) {
+    hold_until = tti; 
+  }
+  extend(tti);
+}
+
+// True if a is later than b, for TTIs less than half the TTI range apart
+bool drx_proc::tti_after(uint32_t a, uint32_t b)
+{
+  uint32_t d = (a + 10240 - b)%10240; 
+  return d > 0 && d < 5120; 
+}
+
+}
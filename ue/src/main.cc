@@ -39,6 +39,7 @@
 #include "version.h"
 #include "ue.h"
 #include "metrics_stdout.h"
+#include "common/thread_affinity.h"
 
 using namespace std;
 using namespace srsue;
@@ -64,8 +65,28 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         ("usrp_args",         bpo::value<string>(&args->usrp_args),   "USRP args")
         ("rf.dl_freq",        bpo::value<float>(&args->rf.dl_freq)->default_value(2680000000),  "Downlink centre frequency")
         ("rf.ul_freq",        bpo::value<float>(&args->rf.ul_freq)->default_value(2560000000),  "Uplink centre frequency")
+        ("rf.dl_earfcn",      bpo::value<string>(&args->rf.dl_earfcn)->default_value(""),       "Downlink EARFCNs scanned in order, comma separated (replaces dl_freq)")
         ("rf.rx_gain",        bpo::value<float>(&args->rf.rx_gain)->default_value(-1),          "Front-end receiver gain")
         ("rf.tx_gain",        bpo::value<float>(&args->rf.tx_gain)->default_value(-1),          "Front-end transmitter gain")
+        ("rf.device",         bpo::value<string>(&args->rf.device)->default_value("uhd"),       "RF device: uhd, file or sim")
+        ("rf.file_rx",        bpo::value<string>(&args->rf.file_rx)->default_value("ue.iq"),    "IQ capture read by the file device")
+        ("rf.file_tx",        bpo::value<string>(&args->rf.file_tx)->default_value(""),         "File where the file device writes TX bursts (empty discards them)")
+        ("rf.file_format",    bpo::value<string>(&args->rf.file_format)->default_value("fc32"), "IQ capture format: fc32 or sc16")
+        ("rf.file_srate",     bpo::value<double>(&args->rf.file_srate)->default_value(0),       "IQ capture sample rate (0 if recorded at the rate the PHY requests)")
+        ("rf.file_loop",      bpo::value<bool>(&args->rf.file_loop)->default_value(true),       "Replay the IQ capture in a loop")
+        ("rf.file_realtime",  bpo::value<bool>(&args->rf.file_realtime)->default_value(true),   "Pace the IQ capture in real time, otherwise as fast as possible")
+
+        ("sim.nof_prb",       bpo::value<uint32_t>(&args->sim.nof_prb)->default_value(25),      "Simulated eNodeB bandwidth in PRB")
+        ("sim.cell_id",       bpo::value<uint32_t>(&args->sim.cell_id)->default_value(1),       "Simulated eNodeB physical cell ID")
+        ("sim.cfi",           bpo::value<uint32_t>(&args->sim.cfi)->default_value(2),           "Simulated eNodeB control format indicator")
+        ("sim.rnti",          bpo::value<uint16_t>(&args->sim.rnti)->default_value(0x46),       "C-RNTI of the scripted PDSCH grants")
+        ("sim.mcs",           bpo::value<uint32_t>(&args->sim.mcs)->default_value(10),          "MCS of the scripted PDSCH grants")
+        ("sim.grant_period",  bpo::value<uint32_t>(&args->sim.grant_period)->default_value(1),  "Subframes between PDSCH grants (0 disables PDSCH)")
+        ("sim.awgn",          bpo::value<bool>(&args->sim.awgn)->default_value(false),          "Add white gaussian noise to the downlink")
+        ("sim.snr_db",        bpo::value<float>(&args->sim.snr_db)->default_value(20),          "Downlink SNR when sim.awgn is enabled")
+        ("sim.cfo_hz",        bpo::value<float>(&args->sim.cfo_hz)->default_value(0),           "Downlink carrier frequency offset")
+        ("sim.pdu_file",      bpo::value<string>(&args->sim.pdu_file)->default_value(""),       "File of uint16 length-prefixed MAC PDUs (empty generates them)")
+        ("sim.realtime",      bpo::value<bool>(&args->sim.realtime)->default_value(true),       "Pace the downlink in real time, otherwise as fast as possible")
 
         ("pcap.enable",       bpo::value<bool>(&args->pcap.enable)->default_value(false),           "Enable MAC packet captures for wireshark")
         ("pcap.filename",     bpo::value<string>(&args->pcap.filename)->default_value("ue.pcap"),   "MAC layer capture filename")
@@ -95,6 +116,9 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         ("log.all_hex_limit", bpo::value<int>(&args->log.all_hex_limit)->default_value(32),  "ALL log hex dump limit")
 
         ("log.filename",      bpo::value<string>(&args->log.filename)->default_value("/tmp/ue.log"),"Log filename")
+        ("log.overflow",      bpo::value<string>(&args->log.overflow)->default_value("drop_newest"),"Log overflow policy: block, drop_newest or drop_oldest")
+        ("log.ring_size",     bpo::value<int>(&args->log.ring_size)->default_value(256),"Log ring size per thread in kB")
+        ("log.binary",        bpo::value<bool>(&args->log.binary)->default_value(false),"Write a binary log, decoded offline with srsue_log_decoder")
 
         ("usim.algo",         bpo::value<string>(&args->usim.algo),        "USIM authentication algorithm")
         ("usim.op",           bpo::value<string>(&args->usim.op),          "USIM operator variant")
@@ -112,6 +136,7 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         ("expert.rx_gain_offset",         bpo::value<float>(&args->expert.rx_gain_offset)->default_value(-1),     "RX gain offset")
         
         ("expert.pdsch_max_its",         bpo::value<int>(&args->expert.pdsch_max_its)->default_value(-1), "Maximum number of turbo decoder iterations")
+        ("expert.pdsch_adaptive_its",    bpo::value<bool>(&args->expert.pdsch_adaptive_its)->default_value(true), "Lower the turbo decoder iterations of late subframes to meet the HARQ deadline")
 
         ("expert.sync_track_th",         bpo::value<float>(&args->expert.sync_track_th)->default_value(-1), "Synchronization track phase threshold")
         ("expert.sync_track_avg_coef",   bpo::value<float>(&args->expert.sync_track_avg_coef)->default_value(-1), "Synchronization track phase averaging factor")
@@ -122,6 +147,29 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         
         ("expert.continuous_tx",      bpo::value<bool>(&args->expert.continuous_tx)->default_value(false), "Enables continues transmission (default off)")
         ("expert.nof_phy_threads",    bpo::value<int>(&args->expert.nof_phy_threads)->default_value(2), "Number of PHY threads")
+        ("expert.phy_spin_us",        bpo::value<int>(&args->expert.phy_spin_us)->default_value(0), "PHY worker handoff spin time in us before sleeping (0 uses condition variables)")
+        ("expert.pdsch_helpers",      bpo::value<int>(&args->expert.pdsch_helpers)->default_value(0), "Number of threads helping the PHY workers decode PDSCH code blocks (0 disables)")
+        ("expert.pdsch_helpers_min_prb", bpo::value<int>(&args->expert.pdsch_helpers_min_prb)->default_value(50), "Minimum PDSCH grant size in PRB decoded with the helper threads")
+        ("expert.lazy_pdsch_fft",     bpo::value<bool>(&args->expert.lazy_pdsch_fft)->default_value(true), "Demodulate only the control region of subframes without a DL grant")
+        ("expert.phy_worker_scaling", bpo::value<bool>(&args->expert.phy_worker_scaling)->default_value(true), "Start 4 PHY threads and activate them on demand, nof_phy_threads is the initial number")
+        ("expert.cell_cache",         bpo::value<string>(&args->expert.cell_cache)->default_value(""), "File with the last cell, tried before a full cell search (empty disables)")
+        ("expert.harq_softbuffer_bits", bpo::value<int>(&args->expert.harq_softbuffer_bits)->default_value(32), "Bits per DL HARQ soft bit, 16 or 8 for fixed point, 32 for float")
+        ("expert.pdsch_fixed_point",  bpo::value<bool>(&args->expert.pdsch_fixed_point)->default_value(false), "Demodulate and combine PDSCH soft bits in int16 SIMD with 16-bit HARQ storage")
+        ("expert.signal_cache_mb",    bpo::value<int>(&args->expert.signal_cache_mb)->default_value(64), "Memory cap (MB) of the cached PRACH preambles and C-RNTI sequences, 0 disables")
+        ("expert.rx_ring_sf",         bpo::value<int>(&args->expert.rx_ring_sf)->default_value(4), "Subframes received while all PHY workers are busy, 0 blocks the radio until a worker is idle")
+
+        ("affinity.phy_worker", bpo::value<string>(&args->affinity.phy_worker)->default_value(""), "PHY worker threads CPU set and priority offset (<cpus>[@<prio>])")
+        ("affinity.phy_helper", bpo::value<string>(&args->affinity.phy_helper)->default_value(""), "PDSCH decoder helper threads CPU set and priority offset")
+        ("affinity.phy_tx",     bpo::value<string>(&args->affinity.phy_tx)->default_value(""),     "PHY radio transmit thread CPU set and priority offset")
+        ("affinity.phy_meas",   bpo::value<string>(&args->affinity.phy_meas)->default_value(""),   "PHY measurement filtering thread CPU set and priority offset")
+        ("affinity.sync",       bpo::value<string>(&args->affinity.sync)->default_value(""),       "PHY sync thread CPU set and priority offset")
+        ("affinity.mac",        bpo::value<string>(&args->affinity.mac)->default_value(""),        "MAC thread CPU set and priority offset")
+        ("affinity.mac_pdu",    bpo::value<string>(&args->affinity.mac_pdu)->default_value(""),    "MAC PDU processing thread CPU set and priority offset")
+        ("affinity.mac_timers", bpo::value<string>(&args->affinity.mac_timers)->default_value(""), "MAC upper timers thread CPU set and priority offset")
+        ("affinity.gw",         bpo::value<string>(&args->affinity.gw)->default_value(""),         "GW reader thread CPU set and priority offset")
+        ("affinity.logger",     bpo::value<string>(&args->affinity.logger)->default_value(""),     "Logger thread CPU set and priority offset")
+        ("affinity.timeout",    bpo::value<string>(&args->affinity.timeout)->default_value(""),    "Timeout service thread CPU set and priority offset")
+        ("affinity.metrics",    bpo::value<string>(&args->affinity.metrics)->default_value(""),    "Metrics thread CPU set and priority offset")
         
     ;
 
@@ -253,6 +301,8 @@ void *input_loop(void *m)
         cout << "Enter t to restart trace." << endl;
       }
       metrics->toggle_print(do_metrics);
+    } else if('l' == key) {
+      ue::get_instance()->print_latency();
     }
   }
 }
@@ -271,6 +321,7 @@ int main(int argc, char *argv[])
     exit(1);
   }
   metrics.init(ue);
+  thread_affinity::get_instance()->print();
 
   pthread_t input;
   pthread_create(&input, NULL, &input_loop, &metrics);
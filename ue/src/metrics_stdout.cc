@@ -26,6 +26,7 @@
  */
 
 #include "metrics_stdout.h"
+#include "common/thread_affinity.h"
 
 #include <unistd.h>
 #include <sstream>
@@ -59,6 +60,7 @@ bool metrics_stdout::init(ue_metrics_interface *u)
 
   started = true;
   pthread_create(&metrics_thread, NULL, &metrics_thread_start, this);
+  thread_affinity::get_instance()->add(metrics_thread, "metrics", "METRICS");
   return true;
 }
 
@@ -103,6 +105,8 @@ void metrics_stdout::print_metrics()
   if(++n_reports > 10)
   {
     n_reports = 0;
+    print_threads();
+    print_latency();
     cout << endl;
     cout << "--Signal--------------DL------------------------------UL----------------------" << endl;
     cout << "  rsrp    pl    cfo   mcs   snr turbo  brate   bler   mcs   buff  brate   bler" << endl;
@@ -129,15 +133,124 @@ void metrics_stdout::print_metrics()
   }
   cout << endl;
 
+  // CPU load of each thread, in the order threads were started
+  cout << "Load:";
+  for(uint32_t i=0;i<metrics.threads.nof_threads;i++) {
+    thread_metrics_t *t = &metrics.threads.thread[i];
+    cout << " " << t->name << "=" << (int) roundf(t->cpu_load) << "%";
+  }
+  cout << endl;
+
+  // Subframe processing time and the stage with the worst tail
+  latency_metrics_t *l = &metrics.phy.latency;
+  if(l->stage[PHY_STAGE_TOTAL].n > 0) {
+    int worst = PHY_STAGE_FFT;
+    for(int i=0;i<PHY_STAGE_TX_WAIT;i++) {
+      if(l->stage[i].p99_us > l->stage[worst].p99_us)
+        worst = i;
+    }
+    char workers[16];
+    snprintf(workers, sizeof(workers), "%.1f", metrics.phy.sync.nof_workers);
+    cout << "Latency: total p99=" << (int) l->stage[PHY_STAGE_TOTAL].p99_us << "us"
+         << ", max=" << (int) l->stage[PHY_STAGE_TOTAL].max_us << "us"
+         << ", slack p1=" << (int) l->slack_p1_us << "us"
+         << ", miss=" << l->deadline_miss
+         << ", tx_late=" << l->tx_late
+         << ", workers=" << workers
+         << ", worst=" << phy_stage_text[worst] << " p99=" << (int) l->stage[worst].p99_us << "us" << endl;
+  }
+
+  // TBs decoded with fewer turbo iterations to meet the HARQ deadline
+  dl_metrics_t *d = &metrics.phy.dl;
+  if(d->its_capped > 0) {
+    char its[32];
+    snprintf(its, sizeof(its), "%.1f/%.1f", d->its_used, d->its_granted);
+    cout << "Turbo: used/granted=" << its
+         << ", capped=" << d->its_capped
+         << ", misses avoided=" << d->miss_avoided << endl;
+  }
+
+  // Subframes skipped outside DRX active time and the PHY time they would have taken
+  if(d->drx_sleep > 0) {
+    cout << "DRX: sleep=" << (int) roundf(100*d->drx_sleep) << "%"
+         << ", saved=" << (int) roundf(d->drx_saved_us) << "us/sf" << endl;
+  }
+
+  // Subframes received while all the workers were busy
+  sync_metrics_t *s = &metrics.phy.sync;
+  if(s->sf_late > 0 || s->sf_skipped > 0) {
+    cout << "RX ring: late=" << s->sf_late
+         << ", skipped=" << s->sf_skipped << endl;
+  }
+
   if(metrics.uhd.uhd_error) {
     cout << "UHD status:"
          << "  O=" << metrics.uhd.uhd_o
          << ", U=" << metrics.uhd.uhd_u
          << ", L=" << metrics.uhd.uhd_l << endl;
   }
+
+  for(uint32_t i=0;i<BUFFER_POOL_N_CLASSES;i++) {
+    buffer_pool_class_metrics_t *p = &metrics.pool.size_class[i];
+    if(p->alloc_failures > 0) {
+      cout << "Buffer pool " << buffer_pool_class_text[i] << ":"
+           << "  used=" << p->allocated << "/" << p->nof_buffers
+           << ", max=" << p->high_water_mark
+           << ", failed=" << p->alloc_failures << endl;
+    }
+  }
+
+  for(uint32_t i=0;i<metrics.log.nof_layers;i++) {
+    log_layer_metrics_t *l = &metrics.log.layer[i];
+    if(l->dropped > 0) {
+      cout << "Log [" << l->name << "]:"
+           << "  dropped=" << l->dropped
+           << ", total=" << l->total_dropped << endl;
+    }
+  }
   
 }
 
+void metrics_stdout::print_threads()
+{
+  cout << endl;
+  cout << "--Thread---------load----vcsw/s---ivcsw/s---wake_avg---wake_max" << endl;
+  for(uint32_t i=0;i<metrics.threads.nof_threads;i++) {
+    thread_metrics_t *t = &metrics.threads.thread[i];
+    cout << "  " << std::left << std::setw(15) << t->name << std::right;
+    cout << float_to_string(t->cpu_load, 2) << "%";
+    if(t->has_sched) {
+      cout << float_to_eng_string(t->nvcsw, 2);
+      cout << "  " << float_to_eng_string(t->nivcsw, 2);
+    } else {
+      cout << "       -         -";
+    }
+    if(t->nof_wakes > 0) {
+      cout << "   " << float_to_string(t->wake_avg_us, 2) << "us";
+      cout << " " << float_to_string(t->wake_max_us, 2) << "us";
+    } else {
+      cout << "          -         -";
+    }
+    cout << endl;
+  }
+}
+
+void metrics_stdout::print_latency()
+{
+  latency_metrics_t *l = &metrics.phy.latency;
+  cout << endl;
+  cout << "--Stage------------n-----avg-----p99-----max" << endl;
+  for(uint32_t i=0;i<PHY_NOF_STAGES;i++) {
+    stage_metrics_t *s = &l->stage[i];
+    cout << "  " << std::left << std::setw(10) << phy_stage_text[i] << std::right;
+    cout << std::setw(7) << s->n;
+    cout << float_to_string(s->avg_us, 2) << "us";
+    cout << float_to_string(s->p99_us, 2) << "us";
+    cout << float_to_string(s->max_us, 2) << "us";
+    cout << endl;
+  }
+}
+
 void metrics_stdout::print_disconnect()
 {
   if(do_print) {
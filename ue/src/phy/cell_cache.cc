@@ -0,0 +1,91 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "phy/cell_cache.h"
+
+namespace srsue {
+
+bool cell_cache::load(std::string filename, cell_cache_t *c)
+{
+  FILE *f = fopen(filename.c_str(), "r");
+  if (!f) {
+    return false;
+  }
+  uint32_t id, cp, nof_prb, nof_ports;
+  float    dl_freq, cfo, gain;
+  int n = fscanf(f, "dl_freq=%f id=%u cp=%u nof_prb=%u nof_ports=%u cfo=%f gain=%f", 
+                 &dl_freq, &id, &cp, &nof_prb, &nof_ports, &cfo, &gain);
+  fclose(f);
+  if (n != 7 || id >= 504 || cp > 1 || nof_prb < 6 || nof_prb > SRSLTE_MAX_PRB || 
+      nof_ports < 1 || nof_ports > SRSLTE_MAX_PORTS) 
+  {
+    return false;
+  }
+  bzero(c, sizeof(cell_cache_t));
+  c->dl_freq        = dl_freq;
+  c->cell.id        = id;
+  c->cell.cp        = cp ? SRSLTE_CP_EXT : SRSLTE_CP_NORM;
+  c->cell.nof_prb   = nof_prb;
+  c->cell.nof_ports = nof_ports;
+  c->cfo            = cfo;
+  c->gain           = gain;
+  return true;
+}
+
+// Written to a new temporary file and renamed, a crash never leaves a partial cache. 
+// mkstemp() never opens an existing file, so a planted symlink can't redirect the write
+bool cell_cache::save(std::string filename, cell_cache_t *c)
+{
+  std::string tmp = filename + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  if (fd < 0) {
+    return false;
+  }
+  FILE *f = fdopen(fd, "w");
+  if (!f) {
+    close(fd);
+    remove(tmp.c_str());
+    return false;
+  }
+  fprintf(f, "dl_freq=%.0f id=%u cp=%u nof_prb=%u nof_ports=%u cfo=%.1f gain=%.1f\n", 
+          c->dl_freq, c->cell.id, c->cell.cp == SRSLTE_CP_EXT ? 1 : 0, c->cell.nof_prb, 
+          c->cell.nof_ports, c->cfo, c->gain);
+  if (fclose(f)) {
+    remove(tmp.c_str());
+    return false;
+  }
+  if (rename(tmp.c_str(), filename.c_str())) {
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace srsue
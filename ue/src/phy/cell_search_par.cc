@@ -0,0 +1,266 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "phy/cell_search_par.h"
+
+namespace srsue {
+
+sample_fanout::sample_fanout()
+{
+  radio_h  = NULL;
+  ring     = NULL;
+  ring_len = 0;
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cvar, NULL);
+}
+
+sample_fanout::~sample_fanout()
+{
+  if (ring) {
+    free(ring);
+  }
+  pthread_mutex_destroy(&mutex);
+  pthread_cond_destroy(&cvar);
+}
+
+bool sample_fanout::init(srslte::radio *radio, uint32_t nof_readers, uint32_t ring_len_, double srate_)
+{
+  if (ring_len != ring_len_) {
+    if (ring) {
+      free(ring);
+    }
+    ring = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*ring_len_);
+    if (!ring) {
+      ring_len = 0;
+      return false;
+    }
+  }
+  radio_h  = radio;
+  ring_len = ring_len_;
+  srate    = srate_;
+  pos.assign(nof_readers, 0);
+  active.assign(nof_readers, true);
+  head     = 0;
+  reading  = false;
+  error    = false;
+  t0_pos   = 0;
+  bzero(&t0, sizeof(srslte_timestamp_t));
+  return true;
+}
+
+uint64_t sample_fanout::min_pos()
+{
+  uint64_t m = head;
+  for (uint32_t i=0;i<pos.size();i++) {
+    if (active[i] && pos[i] < m) {
+      m = pos[i];
+    }
+  }
+  return m;
+}
+
+// Called without the lock, the ring region [pos, pos+nsamples) is not read by anyone else
+bool sample_fanout::read_radio(uint64_t p, uint32_t nsamples)
+{
+  while (nsamples > 0) {
+    uint32_t idx = p%ring_len;
+    uint32_t n   = ring_len - idx < nsamples ? ring_len - idx : nsamples;
+    srslte_timestamp_t t;
+    if (!radio_h->rx_now(&ring[idx], n, &t)) {
+      return false;
+    }
+    pthread_mutex_lock(&mutex);
+    t0     = t;
+    t0_pos = p;
+    pthread_mutex_unlock(&mutex);
+    p        += n;
+    nsamples -= n;
+  }
+  return true;
+}
+
+int sample_fanout::recv(uint32_t reader, cf_t *data, uint32_t nsamples, srslte_timestamp_t *t)
+{
+  if (reader >= pos.size() || nsamples > ring_len) {
+    return -1;
+  }
+  pthread_mutex_lock(&mutex);
+  while (head < pos[reader] + nsamples && !error) {
+    uint64_t n = pos[reader] + nsamples - head;
+    // Another reader is receiving, or the slowest one still needs the samples to be overwritten
+    if (reading || head + n - min_pos() > ring_len) {
+      pthread_cond_wait(&cvar, &mutex);
+      continue;
+    }
+    reading = true;
+    uint64_t p = head;
+    pthread_mutex_unlock(&mutex);
+    bool ok = read_radio(p, n);
+    pthread_mutex_lock(&mutex);
+    reading = false;
+    if (ok) {
+      head += n;
+    } else {
+      error = true;
+    }
+    pthread_cond_broadcast(&cvar);
+  }
+  if (error) {
+    pthread_mutex_unlock(&mutex);
+    return -1;
+  }
+  uint64_t p = pos[reader];
+  if (t) {
+    *t = t0;
+    srslte_timestamp_add(t, 0, ((double) ((int64_t) (p - t0_pos)))/srate);
+  }
+  pthread_mutex_unlock(&mutex);
+
+  // Samples before head are not overwritten until this reader moves past them
+  uint32_t idx = p%ring_len;
+  uint32_t n   = ring_len - idx < nsamples ? ring_len - idx : nsamples;
+  memcpy(data, &ring[idx], sizeof(cf_t)*n);
+  if (n < nsamples) {
+    memcpy(&data[n], ring, sizeof(cf_t)*(nsamples - n));
+  }
+
+  pthread_mutex_lock(&mutex);
+  pos[reader] += nsamples;
+  pthread_cond_broadcast(&cvar);
+  pthread_mutex_unlock(&mutex);
+  return nsamples;
+}
+
+void sample_fanout::done(uint32_t reader)
+{
+  pthread_mutex_lock(&mutex);
+  if (reader < active.size()) {
+    active[reader] = false;
+  }
+  pthread_cond_broadcast(&cvar);
+  pthread_mutex_unlock(&mutex);
+}
+
+uint64_t sample_fanout::get_nof_received()
+{
+  pthread_mutex_lock(&mutex);
+  uint64_t n = head;
+  pthread_mutex_unlock(&mutex);
+  return n;
+}
+
+
+cell_search_par::cell_search_par()
+{
+  for (int i=0;i<3;i++) {
+    searchers[i].N_id_2 = i;
+    searchers[i].fanout = &fanout;
+  }
+}
+
+int cell_search_par::recv_callback(void *h, void *data, uint32_t nsamples, srslte_timestamp_t *t)
+{
+  searcher *s = (searcher*) h;
+  return s->fanout->recv(s->N_id_2, (cf_t*) data, nsamples, t);
+}
+
+void cell_search_par::searcher::search()
+{
+  bzero(&result, sizeof(srslte_ue_cellsearch_result_t));
+  ret = srslte_ue_cellsearch_scan_N_id_2(&cs, N_id_2, &result);
+  fanout->done(N_id_2);
+}
+
+void cell_search_par::searcher::run_thread()
+{
+  search();
+}
+
+static double callback_set_rx_gain(void *h, double gain)
+{
+  return ((srslte::radio*) h)->set_rx_gain_th(gain);
+}
+
+int cell_search_par::scan(srslte::radio *radio, uint32_t nof_frames, float threshold, bool do_agc, float *gain, 
+                      srslte_ue_cellsearch_result_t found_cells[3], uint32_t *max_N_id_2)
+{
+  // Frames are 5 ms of 6 PRB sampled at 1.92 MHz
+  uint32_t flen = (uint32_t) (SRSLTE_CS_SAMP_FREQ*5e-3);
+  if (!fanout.init(radio, 3, RING_FRAMES*flen, SRSLTE_CS_SAMP_FREQ)) {
+    return -1;
+  }
+
+  int nof_init = 0;
+  for (;nof_init<3;nof_init++) {
+    searcher *s = &searchers[nof_init];
+    if (srslte_ue_cellsearch_init(&s->cs, recv_callback, s)) {
+      break;
+    }
+    srslte_ue_cellsearch_set_nof_frames_to_scan(&s->cs, nof_frames);
+    srslte_ue_cellsearch_set_threshold(&s->cs, threshold);
+  }
+  if (nof_init < 3) {
+    for (int i=0;i<nof_init;i++) {
+      srslte_ue_cellsearch_free(&searchers[i].cs);
+    }
+    return -1;
+  }
+  if (do_agc) {
+    srslte_ue_sync_start_agc(&searchers[0].cs.ue_sync, callback_set_rx_gain, *gain);
+  }
+
+  // The calling thread searches the first N_id_2, inheriting its scheduling for the others
+  searchers[1].start(-1);
+  searchers[2].start(-1);
+  searchers[0].search();
+  searchers[1].wait_thread_finish();
+  searchers[2].wait_thread_finish();
+
+  if (do_agc) {
+    *gain = srslte_agc_get_gain(&searchers[0].cs.ue_sync.agc);
+  }
+
+  int   nof_found = 0;
+  float max_peak  = -1;
+  for (int i=0;i<3;i++) {
+    srslte_ue_cellsearch_free(&searchers[i].cs);
+    if (searchers[i].ret < 0) {
+      return -1;
+    }
+    found_cells[i] = searchers[i].result;
+    if (searchers[i].ret > 0) {
+      nof_found++;
+      if (found_cells[i].peak > max_peak) {
+        max_peak    = found_cells[i].peak;
+        *max_N_id_2 = i;
+      }
+    }
+  }
+  return nof_found;
+}
+
+} // namespace srsue
@@ -0,0 +1,571 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#ifdef LV_HAVE_SSE
+#include <smmintrin.h>
+#endif
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+#endif
+#include "phy/pdsch_fx.h"
+
+#define SAT      32767.0f
+#define SIGMA2   0.5
+
+namespace srsue {
+
+/* LLR = (4a/sigma2)*metric in units of 1/SCALE_16, a being the constellation step of TS 36.211 7.1. 
+ * A is the sign bit metric, B the inner/outer one and C the 64QAM middle one */
+static const float KA_QPSK = -4*M_SQRT1_2/SIGMA2*softbuffer_fx::SCALE_16; 
+static const float A_16    = 1/sqrt(10.0); 
+static const float KA_16   = -4*A_16/SIGMA2*softbuffer_fx::SCALE_16; 
+static const float KB_16   =  4*A_16/SIGMA2*softbuffer_fx::SCALE_16; 
+static const float T2_16   = 2*A_16; 
+static const float A_64    = 1/sqrt(42.0); 
+static const float KA_64   = -4*A_64/SIGMA2*softbuffer_fx::SCALE_16; 
+static const float KB_64   =  4*A_64/SIGMA2*softbuffer_fx::SCALE_16; 
+static const float T2_64   = 2*A_64; 
+static const float T4_64   = 4*A_64; 
+
+// Sub-block interleaver column permutation, TS 36.212 table 5.1.4-1
+static const uint32_t PERM_TC[32] = {0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30, 
+                                     1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31};
+
+static inline int16_t sat16(float x)
+{
+  return (int16_t) lrintf(fmaxf(fminf(x, SAT), -SAT));
+}
+
+/**************************************************************************
+ * Generic kernels 
+ **************************************************************************/
+
+static void demod_qpsk_generic(const float *in, int16_t *out, uint32_t n)
+{
+  for (uint32_t i=0;i<2*n;i++) {
+    out[i] = sat16(in[i]*KA_QPSK); 
+  }
+}
+
+static void demod_16qam_generic(const float *in, int16_t *out, uint32_t n)
+{
+  for (uint32_t i=0;i<n;i++) {
+    for (uint32_t j=0;j<2;j++) {
+      float x = in[2*i+j]; 
+      out[4*i+j]   = sat16(x*KA_16); 
+      out[4*i+2+j] = sat16((fabsf(x) - T2_16)*KB_16); 
+    }
+  }
+}
+
+static void demod_64qam_generic(const float *in, int16_t *out, uint32_t n)
+{
+  for (uint32_t i=0;i<n;i++) {
+    for (uint32_t j=0;j<2;j++) {
+      float x = in[2*i+j]; 
+      out[6*i+j]   = sat16(x*KA_64); 
+      out[6*i+2+j] = sat16((fabsf(x) - T4_64)*KB_64); 
+      out[6*i+4+j] = sat16((fabsf(fabsf(x) - T4_64) - T2_64)*KB_64); 
+    }
+  }
+}
+
+static void descramble_generic(int16_t *llr, const uint8_t *c, uint32_t len)
+{
+  for (uint32_t i=0;i<len;i++) {
+    if (c[i]) {
+      llr[i] = -llr[i]; 
+    }
+  }
+}
+
+static void combine_generic(int16_t *w, const int16_t *e, uint32_t len)
+{
+  for (uint32_t i=0;i<len;i++) {
+    if (w[i] == softbuffer_fx::NULL_16) {
+      w[i] = e[i]; 
+    } else {
+      int32_t x = w[i] + e[i]; 
+      w[i] = x > 32767 ? 32767 : (x < -32767 ? -32767 : x); 
+    }
+  }
+}
+
+/**************************************************************************
+ * SSE4.1 kernels 
+ **************************************************************************/
+
+#ifdef LV_HAVE_SSE
+
+static inline __m128i sat_cvt_sse(__m128 x)
+{
+  return _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(x, _mm_set1_ps(SAT)), _mm_set1_ps(-SAT)));
+}
+
+static inline __m128 abs_sse(__m128 x)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+static void demod_qpsk_sse(const float *in, int16_t *out, uint32_t n)
+{
+  __m128   ka = _mm_set1_ps(KA_QPSK); 
+  uint32_t i  = 0; 
+  for (;i+4<=n;i+=4) {
+    __m128i a0 = sat_cvt_sse(_mm_mul_ps(_mm_loadu_ps(&in[2*i]),   ka));
+    __m128i a1 = sat_cvt_sse(_mm_mul_ps(_mm_loadu_ps(&in[2*i+4]), ka));
+    _mm_storeu_si128((__m128i*) &out[2*i], _mm_packs_epi32(a0, a1));
+  }
+  demod_qpsk_generic(&in[2*i], &out[2*i], n-i);
+}
+
+static void demod_16qam_sse(const float *in, int16_t *out, uint32_t n)
+{
+  __m128   ka = _mm_set1_ps(KA_16); 
+  __m128   kb = _mm_set1_ps(KB_16); 
+  __m128   t2 = _mm_set1_ps(T2_16); 
+  uint32_t i  = 0; 
+  for (;i+2<=n;i+=2) {
+    __m128  x = _mm_loadu_ps(&in[2*i]);
+    __m128i a = sat_cvt_sse(_mm_mul_ps(x, ka));
+    __m128i b = sat_cvt_sse(_mm_mul_ps(_mm_sub_ps(abs_sse(x), t2), kb));
+    _mm_storeu_si128((__m128i*) &out[4*i], _mm_packs_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b)));
+  }
+  demod_16qam_generic(&in[2*i], &out[4*i], n-i);
+}
+
+// Metrics of 2 symbols in the order of TS 36.211 7.1.4, 12 LLRs as 32-bit 
+static inline void interleave_64qam_sse(__m128i a, __m128i b, __m128i c, __m128i *x)
+{
+  x[0] = _mm_unpacklo_epi64(a, b);
+  x[1] = _mm_blend_epi16(c, a, 0xF0);
+  x[2] = _mm_unpackhi_epi64(b, c);
+}
+
+static void demod_64qam_sse(const float *in, int16_t *out, uint32_t n)
+{
+  __m128   ka = _mm_set1_ps(KA_64); 
+  __m128   kb = _mm_set1_ps(KB_64); 
+  __m128   t2 = _mm_set1_ps(T2_64); 
+  __m128   t4 = _mm_set1_ps(T4_64); 
+  uint32_t i  = 0; 
+  for (;i+4<=n;i+=4) {
+    __m128i x[6]; 
+    for (uint32_t j=0;j<2;j++) {
+      __m128  v  = _mm_loadu_ps(&in[2*i+4*j]);
+      __m128  m4 = _mm_sub_ps(abs_sse(v), t4);
+      __m128i a  = sat_cvt_sse(_mm_mul_ps(v, ka));
+      __m128i b  = sat_cvt_sse(_mm_mul_ps(m4, kb));
+      __m128i c  = sat_cvt_sse(_mm_mul_ps(_mm_sub_ps(abs_sse(m4), t2), kb));
+      interleave_64qam_sse(a, b, c, &x[3*j]);
+    }
+    _mm_storeu_si128((__m128i*) &out[6*i],    _mm_packs_epi32(x[0], x[1]));
+    _mm_storeu_si128((__m128i*) &out[6*i+8],  _mm_packs_epi32(x[2], x[3]));
+    _mm_storeu_si128((__m128i*) &out[6*i+16], _mm_packs_epi32(x[4], x[5]));
+  }
+  demod_64qam_generic(&in[2*i], &out[6*i], n-i);
+}
+
+static void descramble_sse(int16_t *llr, const uint8_t *c, uint32_t len)
+{
+  uint32_t i = 0; 
+  for (;i+8<=len;i+=8) {
+    __m128i m = _mm_sub_epi16(_mm_setzero_si128(), _mm_cvtepu8_epi16(_mm_loadl_epi64((__m128i*) &c[i])));
+    __m128i x = _mm_loadu_si128((__m128i*) &llr[i]);
+    _mm_storeu_si128((__m128i*) &llr[i], _mm_sub_epi16(_mm_xor_si128(x, m), m));
+  }
+  descramble_generic(&llr[i], &c[i], len-i);
+}
+
+static void combine_sse(int16_t *w, const int16_t *e, uint32_t len)
+{
+  __m128i vnull = _mm_set1_epi16(softbuffer_fx::NULL_16);
+  __m128i vmin  = _mm_set1_epi16(-32767);
+  uint32_t i = 0; 
+  for (;i+8<=len;i+=8) {
+    __m128i x = _mm_loadu_si128((__m128i*) &w[i]);
+    __m128i y = _mm_loadu_si128((__m128i*) &e[i]);
+    __m128i s = _mm_max_epi16(_mm_adds_epi16(x, y), vmin);
+    _mm_storeu_si128((__m128i*) &w[i], _mm_blendv_epi8(s, y, _mm_cmpeq_epi16(x, vnull)));
+  }
+  combine_generic(&w[i], &e[i], len-i);
+}
+
+#endif /* LV_HAVE_SSE */
+
+/**************************************************************************
+ * AVX2 kernels, compiled for AVX2 and used only if the CPU has it
+ **************************************************************************/
+
+#if defined(LV_HAVE_AVX) && defined(LV_HAVE_SSE)
+
+#define AVX2 __attribute__((target("avx2")))
+
+static inline AVX2 __m256i sat_cvt_avx2(__m256 x)
+{
+  return _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(SAT)), _mm256_set1_ps(-SAT)));
+}
+
+static inline AVX2 __m256 abs_avx2(__m256 x)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+// 16 int16 in order from two vectors of 8 int32
+static inline AVX2 __m256i pack_avx2(__m256i x, __m256i y)
+{
+  return _mm256_permute4x64_epi64(_mm256_packs_epi32(x, y), 0xD8);
+}
+
+static AVX2 void demod_qpsk_avx2(const float *in, int16_t *out, uint32_t n)
+{
+  __m256   ka = _mm256_set1_ps(KA_QPSK); 
+  uint32_t i  = 0; 
+  for (;i+8<=n;i+=8) {
+    __m256i a0 = sat_cvt_avx2(_mm256_mul_ps(_mm256_loadu_ps(&in[2*i]),   ka));
+    __m256i a1 = sat_cvt_avx2(_mm256_mul_ps(_mm256_loadu_ps(&in[2*i+8]), ka));
+    _mm256_storeu_si256((__m256i*) &out[2*i], pack_avx2(a0, a1));
+  }
+  demod_qpsk_sse(&in[2*i], &out[2*i], n-i);
+}
+
+static AVX2 void demod_16qam_avx2(const float *in, int16_t *out, uint32_t n)
+{
+  __m256   ka = _mm256_set1_ps(KA_16); 
+  __m256   kb = _mm256_set1_ps(KB_16); 
+  __m256   t2 = _mm256_set1_ps(T2_16); 
+  uint32_t i  = 0; 
+  for (;i+4<=n;i+=4) {
+    __m256  x  = _mm256_loadu_ps(&in[2*i]);
+    __m256i a  = sat_cvt_avx2(_mm256_mul_ps(x, ka));
+    __m256i b  = sat_cvt_avx2(_mm256_mul_ps(_mm256_sub_ps(abs_avx2(x), t2), kb));
+    __m256i lo = _mm256_unpacklo_epi64(a, b);
+    __m256i hi = _mm256_unpackhi_epi64(a, b);
+    _mm256_storeu_si256((__m256i*) &out[4*i], pack_avx2(_mm256_permute2x128_si256(lo, hi, 0x20), 
+                                                        _mm256_permute2x128_si256(lo, hi, 0x31)));
+  }
+  demod_16qam_sse(&in[2*i], &out[4*i], n-i);
+}
+
+static AVX2 void demod_64qam_avx2(const float *in, int16_t *out, uint32_t n)
+{
+  __m256   ka = _mm256_set1_ps(KA_64); 
+  __m256   kb = _mm256_set1_ps(KB_64); 
+  __m256   t2 = _mm256_set1_ps(T2_64); 
+  __m256   t4 = _mm256_set1_ps(T4_64); 
+  uint32_t i  = 0; 
+  for (;i+4<=n;i+=4) {
+    __m256  v  = _mm256_loadu_ps(&in[2*i]);
+    __m256  m4 = _mm256_sub_ps(abs_avx2(v), t4);
+    __m256i a  = sat_cvt_avx2(_mm256_mul_ps(v, ka));
+    __m256i b  = sat_cvt_avx2(_mm256_mul_ps(m4, kb));
+    __m256i c  = sat_cvt_avx2(_mm256_mul_ps(_mm256_sub_ps(abs_avx2(m4), t2), kb));
+    __m128i x[6]; 
+    interleave_64qam_sse(_mm256_castsi256_si128(a), _mm256_castsi256_si128(b), _mm256_castsi256_si128(c), &x[0]);
+    interleave_64qam_sse(_mm256_extracti128_si256(a, 1), _mm256_extracti128_si256(b, 1), 
+                         _mm256_extracti128_si256(c, 1), &x[3]);
+    _mm_storeu_si128((__m128i*) &out[6*i],    _mm_packs_epi32(x[0], x[1]));
+    _mm_storeu_si128((__m128i*) &out[6*i+8],  _mm_packs_epi32(x[2], x[3]));
+    _mm_storeu_si128((__m128i*) &out[6*i+16], _mm_packs_epi32(x[4], x[5]));
+  }
+  demod_64qam_generic(&in[2*i], &out[6*i], n-i);
+}
+
+static AVX2 void descramble_avx2(int16_t *llr, const uint8_t *c, uint32_t len)
+{
+  uint32_t i = 0; 
+  for (;i+16<=len;i+=16) {
+    __m256i m = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) &c[i])));
+    __m256i x = _mm256_loadu_si256((__m256i*) &llr[i]);
+    _mm256_storeu_si256((__m256i*) &llr[i], _mm256_sub_epi16(_mm256_xor_si256(x, m), m));
+  }
+  descramble_sse(&llr[i], &c[i], len-i);
+}
+
+static AVX2 void combine_avx2(int16_t *w, const int16_t *e, uint32_t len)
+{
+  __m256i vnull = _mm256_set1_epi16(softbuffer_fx::NULL_16);
+  __m256i vmin  = _mm256_set1_epi16(-32767);
+  uint32_t i = 0; 
+  for (;i+16<=len;i+=16) {
+    __m256i x = _mm256_loadu_si256((__m256i*) &w[i]);
+    __m256i y = _mm256_loadu_si256((__m256i*) &e[i]);
+    __m256i s = _mm256_max_epi16(_mm256_adds_epi16(x, y), vmin);
+    _mm256_storeu_si256((__m256i*) &w[i], _mm256_blendv_epi8(s, y, _mm256_cmpeq_epi16(x, vnull)));
+  }
+  combine_sse(&w[i], &e[i], len-i);
+}
+
+#endif /* LV_HAVE_AVX && LV_HAVE_SSE */
+
+/**************************************************************************
+ * pdsch_fx
+ **************************************************************************/
+
+pdsch_fx::pdsch_fx()
+{
+  isa = ISA_GENERIC; 
+  demod_fn[0]   = demod_qpsk_generic; 
+  demod_fn[1]   = demod_16qam_generic; 
+  demod_fn[2]   = demod_64qam_generic; 
+  descramble_fn = descramble_generic; 
+  combine_fn    = combine_generic; 
+}
+
+bool pdsch_fx::isa_supported(isa_t isa)
+{
+  switch (isa) {
+    case ISA_GENERIC: 
+      return true; 
+#ifdef LV_HAVE_SSE
+    case ISA_SSE41: 
+      return __builtin_cpu_supports("sse4.1"); 
+#ifdef LV_HAVE_AVX
+    case ISA_AVX2: 
+      return __builtin_cpu_supports("avx2"); 
+#endif
+#endif
+    default: 
+      return false; 
+  }
+}
+
+pdsch_fx::isa_t pdsch_fx::best_isa()
+{
+  for (int i=NOF_ISA-1;i>0;i--) {
+    if (isa_supported((isa_t) i)) {
+      return (isa_t) i; 
+    }
+  }
+  return ISA_GENERIC; 
+}
+
+const char* pdsch_fx::isa_string(isa_t isa)
+{
+  switch (isa) {
+    case ISA_GENERIC: return "generic"; 
+    case ISA_SSE41:   return "SSE4.1"; 
+    case ISA_AVX2:    return "AVX2"; 
+    default:          return "unknown"; 
+  }
+}
+
+bool pdsch_fx::init(isa_t isa_)
+{
+  if (!isa_supported(isa_)) {
+    return false; 
+  }
+  isa = isa_; 
+  switch (isa) {
+#ifdef LV_HAVE_SSE
+    case ISA_SSE41: 
+      demod_fn[0]   = demod_qpsk_sse; 
+      demod_fn[1]   = demod_16qam_sse; 
+      demod_fn[2]   = demod_64qam_sse; 
+      descramble_fn = descramble_sse; 
+      combine_fn    = combine_sse; 
+      break; 
+#ifdef LV_HAVE_AVX
+    case ISA_AVX2: 
+      demod_fn[0]   = demod_qpsk_avx2; 
+      demod_fn[1]   = demod_16qam_avx2; 
+      demod_fn[2]   = demod_64qam_avx2; 
+      descramble_fn = descramble_avx2; 
+      combine_fn    = combine_avx2; 
+      break; 
+#endif
+#endif
+    default: 
+      demod_fn[0]   = demod_qpsk_generic; 
+      demod_fn[1]   = demod_16qam_generic; 
+      demod_fn[2]   = demod_64qam_generic; 
+      descramble_fn = descramble_generic; 
+      combine_fn    = combine_generic; 
+      break; 
+  }
+
+  /* Code block sizes of TS 36.212 table 5.1.3-3, indexed by size/8. Position i of the turbo 
+   * decoder input is bit i/3 of stream i%3, after N_D dummy bits in the sub-block interleaver */
+  if (tables.size()) {
+    return true; 
+  }
+  tables.resize(SRSLTE_TCOD_MAX_LEN_CB/8+1);
+  for (uint32_t K=40;K<=SRSLTE_TCOD_MAX_LEN_CB;K+=8) {
+    if ((K > 512 && K%16) || (K > 1024 && K%32) || (K > 2048 && K%64)) {
+      continue; 
+    }
+    rm_table_t *t = &tables[K/8]; 
+    uint32_t D   = K+4; 
+    uint32_t R   = (D+31)/32; 
+    uint32_t K_p = 32*R; 
+    uint32_t N_D = K_p - D; 
+    t->cb_len = K; 
+    t->R      = R; 
+    t->N_cb   = 3*K_p; 
+    t->d_idx.resize(3*D);
+    std::vector<uint8_t> used(t->N_cb, 0);
+    for (uint32_t i=0;i<D;i++) {
+      uint32_t y  = i + N_D; 
+      uint32_t k  = PERM_TC[y%32]*R + y/32; 
+      uint32_t y2 = (y + K_p - 1)%K_p; 
+      uint32_t k2 = PERM_TC[y2%32]*R + y2/32; 
+      t->d_idx[3*i]   = k; 
+      t->d_idx[3*i+1] = K_p + 2*k; 
+      t->d_idx[3*i+2] = K_p + 2*k2 + 1; 
+      for (uint32_t j=0;j<3;j++) {
+        used[t->d_idx[3*i+j]] = 1; 
+      }
+    }
+    for (uint32_t j=0;j<t->N_cb;j++) {
+      if (!used[j]) {
+        t->nulls.push_back(j);
+      }
+    }
+  }
+  return true; 
+}
+
+pdsch_fx::isa_t pdsch_fx::get_isa()
+{
+  return isa; 
+}
+
+pdsch_fx::rm_table_t* pdsch_fx::get_table(uint32_t cb_len)
+{
+  if (cb_len%8 || cb_len/8 >= tables.size() || tables[cb_len/8].N_cb == 0) {
+    return NULL; 
+  }
+  return &tables[cb_len/8]; 
+}
+
+void pdsch_fx::demod(srslte_mod_t mod, cf_t *symbols, int16_t *llr, uint32_t nof_symbols)
+{
+  switch (mod) {
+    case SRSLTE_MOD_QPSK:  demod_fn[0]((float*) symbols, llr, nof_symbols); break; 
+    case SRSLTE_MOD_16QAM: demod_fn[1]((float*) symbols, llr, nof_symbols); break; 
+    case SRSLTE_MOD_64QAM: demod_fn[2]((float*) symbols, llr, nof_symbols); break; 
+    default: break; 
+  }
+}
+
+void pdsch_fx::demod_ref(srslte_mod_t mod, cf_t *symbols, float *llr, uint32_t nof_symbols)
+{
+  float *in = (float*) symbols; 
+  for (uint32_t i=0;i<nof_symbols;i++) {
+    for (uint32_t j=0;j<2;j++) {
+      float x = in[2*i+j]; 
+      switch (mod) {
+        case SRSLTE_MOD_QPSK: 
+          llr[2*i+j]   = x*KA_QPSK; 
+          break; 
+        case SRSLTE_MOD_16QAM: 
+          llr[4*i+j]   = x*KA_16; 
+          llr[4*i+2+j] = (fabsf(x) - T2_16)*KB_16; 
+          break; 
+        case SRSLTE_MOD_64QAM: 
+          llr[6*i+j]   = x*KA_64; 
+          llr[6*i+2+j] = (fabsf(x) - T4_64)*KB_64; 
+          llr[6*i+4+j] = (fabsf(fabsf(x) - T4_64) - T2_64)*KB_64; 
+          break; 
+        default: 
+          break; 
+      }
+    }
+  }
+}
+
+void pdsch_fx::descramble(int16_t *llr, uint8_t *c, uint32_t len)
+{
+  descramble_fn(llr, c, len);
+}
+
+// TS 36.212 5.1.4.1.2, bit selection from k0 skipping the dummy and filler bits
+int pdsch_fx::rm_combine(int16_t *w, int16_t *e, uint32_t n_e, uint32_t cb_len, uint32_t rv, uint32_t F)
+{
+  rm_table_t *t = get_table(cb_len); 
+  if (!t || rv > 3 || F > cb_len) {
+    return SRSLTE_ERROR; 
+  }
+
+  // Filler bits are nulls of the systematic and 1st parity streams
+  uint32_t        skip_buf[3*32+2*64]; 
+  const uint32_t *skip   = &t->nulls[0]; 
+  uint32_t        nof_skip = t->nulls.size(); 
+  if (F > 0) {
+    if (nof_skip + 2*F > sizeof(skip_buf)/sizeof(uint32_t)) {
+      return SRSLTE_ERROR; 
+    }
+    memcpy(skip_buf, skip, sizeof(uint32_t)*nof_skip);
+    for (uint32_t i=0;i<F;i++) {
+      skip_buf[nof_skip++] = t->d_idx[3*i]; 
+      skip_buf[nof_skip++] = t->d_idx[3*i+1]; 
+    }
+    std::sort(skip_buf, skip_buf+nof_skip);
+    skip = skip_buf; 
+  }
+
+  uint32_t N_cb = t->N_cb; 
+  uint32_t pos  = t->R*(2*((N_cb+8*t->R-1)/(8*t->R))*rv + 2); 
+  uint32_t si   = std::lower_bound(skip, skip+nof_skip, pos) - skip; 
+  uint32_t k    = 0; 
+  while (k < n_e) {
+    uint32_t next = si < nof_skip ? skip[si] : N_cb; 
+    uint32_t run  = std::min(next - pos, n_e - k); 
+    combine_fn(&w[pos], &e[k], run);
+    k   += run; 
+    pos += run; 
+    if (pos == next) {
+      pos++; 
+      si++; 
+    }
+    if (pos >= N_cb) {
+      pos = 0; 
+      si  = 0; 
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+int pdsch_fx::rm_output(int16_t *w, float *d, uint32_t cb_len)
+{
+  rm_table_t *t = get_table(cb_len); 
+  if (!t) {
+    return SRSLTE_ERROR; 
+  }
+  const float     k   = 1.0/softbuffer_fx::SCALE_16; 
+  const uint16_t *idx = &t->d_idx[0]; 
+  uint32_t        n   = t->d_idx.size(); 
+  for (uint32_t i=0;i<n;i++) {
+    int16_t x = w[idx[i]]; 
+    d[i] = x == softbuffer_fx::NULL_16 ? 0 : k*x; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+} // namespace srsue
@@ -0,0 +1,361 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include "common/log.h"
+#include "phy/pdsch_par.h"
+
+#define MAX_TB_BITS   (75376+24)   // Largest single layer TBS plus its CRC
+#define MAX_RE        (SRSLTE_MAX_PRB*SRSLTE_NRE*2*SRSLTE_CP_NORM_NSYMB)
+
+namespace srsue {
+
+pdsch_par::pdsch_par()
+{
+  pool        = NULL; 
+  log_h       = NULL; 
+  nof_helpers = 0; 
+  max_its     = 0; 
+  initiated   = false; 
+}
+
+pdsch_par::~pdsch_par()
+{
+  free_buffers();
+}
+
+bool pdsch_par::init(srslte::helper_pool *pool_, srslte::log *log_h_, uint32_t max_callers, uint32_t max_its_)
+{
+  pool        = pool_; 
+  log_h       = log_h_; 
+  nof_helpers = pool->get_nof_helpers(); 
+  max_its     = max_its_; 
+  initiated   = true; 
+
+  if (!fx.init(pdsch_fx::best_isa())) {
+    return false; 
+  }
+
+  slots.resize(nof_helpers + max_callers);
+  for (uint32_t i=0;i<slots.size();i++) {
+    slot_t *s = &slots[i]; 
+    bzero(s, sizeof(slot_t));
+    if (srslte_tdec_init(&s->tdec, SRSLTE_TCOD_MAX_LEN_CB)) {
+      return false; 
+    }
+    srslte_crc_init(&s->crc_cb, SRSLTE_LTE_CRC24B, 24);
+    srslte_crc_init(&s->crc_tb, SRSLTE_LTE_CRC24A, 24);
+    s->cb_out = (float*)   srslte_vec_malloc(sizeof(float)*(3*SRSLTE_TCOD_MAX_LEN_CB+12));
+    s->cb_in  = (uint8_t*) srslte_vec_malloc(sizeof(uint8_t)*SRSLTE_TCOD_MAX_LEN_CB);
+    if (!s->cb_out || !s->cb_in) {
+      return false; 
+    }
+  }
+  callers.resize(max_callers);
+  for (uint32_t i=0;i<max_callers;i++) {
+    caller_t *c = &callers[i]; 
+    c->symbols  = (cf_t*)    srslte_vec_malloc(sizeof(cf_t)*MAX_RE);
+    c->ce       = (cf_t*)    srslte_vec_malloc(sizeof(cf_t)*MAX_RE);
+    c->d        = (cf_t*)    srslte_vec_malloc(sizeof(cf_t)*MAX_RE);
+    c->e        = (float*)   srslte_vec_malloc(sizeof(float)*MAX_RE*6);
+    c->e16      = (int16_t*) srslte_vec_malloc(sizeof(int16_t)*MAX_RE*6);
+    c->tb_bits  = (uint8_t*) srslte_vec_malloc(sizeof(uint8_t)*MAX_TB_BITS);
+    c->last_noi = 0; 
+    c->max_its  = max_its; 
+    if (!c->symbols || !c->ce || !c->d || !c->e || !c->e16 || !c->tb_bits) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
+void pdsch_par::free_buffers()
+{
+  if (!initiated) {
+    return; 
+  }
+  for (uint32_t i=0;i<slots.size();i++) {
+    srslte_tdec_free(&slots[i].tdec);
+    if (slots[i].cb_out) {
+      free(slots[i].cb_out);
+    }
+    if (slots[i].cb_in) {
+      free(slots[i].cb_in);
+    }
+  }
+  for (uint32_t i=0;i<callers.size();i++) {
+    caller_t *c = &callers[i]; 
+    if (c->symbols) free(c->symbols);
+    if (c->ce)      free(c->ce);
+    if (c->d)       free(c->d);
+    if (c->e)       free(c->e);
+    if (c->e16)     free(c->e16);
+    if (c->tb_bits) free(c->tb_bits);
+  }
+  slots.clear();
+  callers.clear();
+  initiated = false; 
+}
+
+bool pdsch_par::is_supported(srslte_cell_t *cell, uint32_t sf_idx)
+{
+  return cell->nof_ports == 1 && sf_idx != 0 && sf_idx != 5; 
+}
+
+float pdsch_par::last_noi(uint32_t caller)
+{
+  return callers[caller].last_noi; 
+}
+
+void pdsch_par::set_max_its(uint32_t caller, uint32_t max_its_)
+{
+  callers[caller].max_its = max_its_ < 1 ? 1 : (max_its_ > max_its ? max_its : max_its_); 
+}
+
+pdsch_fx::isa_t pdsch_par::get_fx_isa()
+{
+  return fx.get_isa(); 
+}
+
+/* Copies the PDSCH resource elements of the grant in mapping order: frequency 
+ * first within each OFDM symbol, skipping the control region and the cell 
+ * specific reference signals of antenna port 0. */
+uint32_t pdsch_par::get_re(srslte_cell_t *cell, cf_t *input, cf_t *output, srslte_ra_dl_grant_t *grant, uint32_t lstart)
+{
+  uint32_t nsymb   = SRSLTE_CP_NSYMB(cell->cp);
+  uint32_t v_shift = cell->id%6; 
+  cf_t    *out     = output; 
+
+  for (uint32_t s=0;s<2;s++) {
+    for (uint32_t l=(s==0?lstart:0);l<nsymb;l++) {
+      bool     has_ref = (l == 0 || l == nsymb-3);
+      uint32_t k_ref   = ((l == 0 ? 0 : 3) + v_shift)%6; 
+      cf_t    *in_sym  = &input[(l + s*nsymb)*cell->nof_prb*SRSLTE_NRE];
+      for (uint32_t n=0;n<cell->nof_prb;n++) {
+        if (!grant->prb_idx[s][n]) {
+          continue; 
+        }
+        cf_t *in = &in_sym[n*SRSLTE_NRE];
+        if (has_ref) {
+          for (uint32_t k=0;k<SRSLTE_NRE;k++) {
+            if (k%6 != k_ref) {
+              *out++ = in[k];
+            }
+          }
+        } else {
+          memcpy(out, in, sizeof(cf_t)*SRSLTE_NRE);
+          out += SRSLTE_NRE; 
+        }
+      }
+    }
+  }
+  return (uint32_t) (out - output);
+}
+
+int pdsch_par::decode(uint32_t caller, srslte_pdsch_t *pdsch, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffer, 
+                      cf_t *sf_symbols, cf_t *ce, float noise_estimate, uint8_t *data)
+{
+  caller_t *c = &callers[caller]; 
+  uint32_t nof_re   = cfg->nbits.nof_re; 
+  uint32_t nof_bits = cfg->nbits.nof_bits; 
+
+  if (get_re(&pdsch->cell, sf_symbols, c->symbols, &cfg->grant, cfg->nbits.lstart) != nof_re || 
+      get_re(&pdsch->cell, ce,         c->ce,      &cfg->grant, cfg->nbits.lstart) != nof_re) 
+  {
+    log_error(log_h, "Error extracting PDSCH resource elements, expected %d\n", nof_re);
+    return SRSLTE_ERROR; 
+  }
+
+  srslte_predecoding_single(c->symbols, c->ce, c->d, nof_re, noise_estimate);
+
+  srslte_demod_soft_alg_set(&pdsch->demod, SRSLTE_DEMOD_SOFT_ALG_APPROX);
+  srslte_demod_soft_sigma_set(&pdsch->demod, sqrt(0.5));
+  srslte_demod_soft_table_set(&pdsch->demod, &pdsch->mod[cfg->grant.mcs.mod]);
+  srslte_demod_soft_demodulator(&pdsch->demod, c->d, c->e, nof_re);
+
+  // Scrambling sequence of the C-RNTI set with srslte_pdsch_set_rnti()
+  srslte_scrambling_f_offset(&pdsch->seq[cfg->sf_idx], c->e, 0, nof_bits);
+
+  return decode_tb(caller, &cfg->cb_segm, srslte_mod_bits_x_symbol(cfg->grant.mcs.mod), cfg->rv, 
+                   nof_bits, c->e, softbuffer, data);
+}
+
+int pdsch_par::decode_fx(uint32_t caller, srslte_pdsch_t *pdsch, srslte_pdsch_cfg_t *cfg, softbuffer_fx *softbuffer, 
+                         cf_t *sf_symbols, cf_t *ce, float noise_estimate, uint8_t *data)
+{
+  caller_t *c = &callers[caller]; 
+  uint32_t nof_re   = cfg->nbits.nof_re; 
+  uint32_t nof_bits = cfg->nbits.nof_bits; 
+  uint32_t Qm       = srslte_mod_bits_x_symbol(cfg->grant.mcs.mod); 
+
+  if (softbuffer->get_nof_bits() != 16) {
+    log_error(log_h, "Error decoding PDSCH: fixed-point path needs a 16-bit softbuffer\n");
+    return SRSLTE_ERROR; 
+  }
+  if (get_re(&pdsch->cell, sf_symbols, c->symbols, &cfg->grant, cfg->nbits.lstart) != nof_re || 
+      get_re(&pdsch->cell, ce,         c->ce,      &cfg->grant, cfg->nbits.lstart) != nof_re) 
+  {
+    log_error(log_h, "Error extracting PDSCH resource elements, expected %d\n", nof_re);
+    return SRSLTE_ERROR; 
+  }
+
+  srslte_predecoding_single(c->symbols, c->ce, c->d, nof_re, noise_estimate);
+  fx.demod(cfg->grant.mcs.mod, c->d, c->e16, nof_re);
+  fx.descramble(c->e16, pdsch->seq[cfg->sf_idx].c, nof_bits);
+
+  srslte_cbsegm_t *cb_segm = &cfg->cb_segm; 
+  if (cb_segm->C == 0 || cb_segm->C > softbuffer->get_max_cb() || Qm == 0) {
+    log_error(log_h, "Error decoding TB: %d code blocks, softbuffer has %d\n", cb_segm->C, softbuffer->get_max_cb());
+    return SRSLTE_ERROR; 
+  }
+
+  tb_job_t j; 
+  bzero(&j, sizeof(tb_job_t));
+  j.cb_segm       = cb_segm; 
+  j.Qm            = Qm; 
+  j.rv            = cfg->rv; 
+  j.Gp            = nof_bits/Qm; 
+  j.e16_bits      = c->e16; 
+  j.softbuffer_16 = softbuffer; 
+  if (run_tb(caller, &j)) {
+    return SRSLTE_ERROR; 
+  }
+  srslte_bit_pack_vector(c->tb_bits, data, cb_segm->tbs);
+  return SRSLTE_SUCCESS; 
+}
+
+int pdsch_par::decode_tb(uint32_t caller, srslte_cbsegm_t *cb_segm, uint32_t Qm, uint32_t rv, uint32_t nof_e_bits, 
+                         float *e_bits, srslte_softbuffer_rx_t *softbuffer, uint8_t *data)
+{
+  caller_t *c = &callers[caller]; 
+
+  if (cb_segm->C == 0 || cb_segm->C > softbuffer->max_cb || Qm == 0) {
+    log_error(log_h, "Error decoding TB: %d code blocks, softbuffer has %d\n", cb_segm->C, softbuffer->max_cb);
+    return SRSLTE_ERROR; 
+  }
+
+  tb_job_t j; 
+  bzero(&j, sizeof(tb_job_t));
+  j.cb_segm    = cb_segm; 
+  j.Qm         = Qm; 
+  j.rv         = rv; 
+  j.Gp         = nof_e_bits/Qm; 
+  j.e_bits     = e_bits; 
+  j.softbuffer = softbuffer; 
+  if (run_tb(caller, &j)) {
+    return SRSLTE_ERROR; 
+  }
+  srslte_bit_pack_vector(c->tb_bits, data, cb_segm->tbs);
+  return SRSLTE_SUCCESS; 
+}
+
+// Decodes the code blocks of j in the pool and checks the transport block CRC
+int pdsch_par::run_tb(uint32_t caller, tb_job_t *j)
+{
+  caller_t *c = &callers[caller]; 
+  slot_t   *s = &slots[nof_helpers + caller]; 
+  srslte_cbsegm_t *cb_segm = j->cb_segm; 
+
+  j->q       = this; 
+  j->max_its = c->max_its; 
+  j->gamma   = j->Gp%cb_segm->C; 
+  j->tb_bits = c->tb_bits; 
+
+  pool->run(cb_job, j, cb_segm->C, nof_helpers + caller);
+
+  c->last_noi = (float) j->nof_its/cb_segm->C; 
+  if (j->error) {
+    return SRSLTE_ERROR; 
+  }
+
+  bool ok = cb_segm->C == 1 ? j->crc_ok : !srslte_crc_checksum(&s->crc_tb, c->tb_bits, cb_segm->tbs+24);
+  return ok ? SRSLTE_SUCCESS : SRSLTE_ERROR; 
+}
+
+void pdsch_par::cb_job(void *arg, uint32_t idx, uint32_t slot)
+{
+  tb_job_t *j = (tb_job_t*) arg; 
+  j->q->decode_cb(j, idx, &j->q->slots[slot]);
+}
+
+// Code block i: TS 36.212 5.1.4.1.2 bit selection, 5.1.2 segmentation
+void pdsch_par::decode_cb(tb_job_t *j, uint32_t i, slot_t *s)
+{
+  srslte_cbsegm_t *cb_segm = j->cb_segm; 
+  uint32_t C       = cb_segm->C; 
+  uint32_t F       = i == 0 ? cb_segm->F : 0; 
+  uint32_t crc_len = C > 1 ? 24 : 0; 
+  uint32_t cb_len  = i < cb_segm->C2 ? cb_segm->K2 : cb_segm->K1; 
+
+  // Soft bits of this code block start after the E bits of the previous ones
+  uint32_t e_lo    = j->Qm*(j->Gp/C); 
+  uint32_t e_hi    = j->Qm*((j->Gp+C-1)/C); 
+  uint32_t n_lo    = C - j->gamma; 
+  uint32_t n_e     = i < n_lo ? e_lo : e_hi; 
+  uint32_t rp      = i < n_lo ? i*e_lo : n_lo*e_lo + (i-n_lo)*e_hi; 
+
+  // Decoded bits of the previous code blocks, without filler and CRC
+  uint32_t wp      = 0; 
+  for (uint32_t k=0;k<i;k++) {
+    wp += (k < cb_segm->C2 ? cb_segm->K2 : cb_segm->K1) - crc_len - (k == 0 ? cb_segm->F : 0);
+  }
+
+  if (j->e16_bits) {
+    int16_t *w = j->softbuffer_16->get_cb_16(i, cb_len); 
+    if (!w || fx.rm_combine(w, &j->e16_bits[rp], n_e, cb_len, j->rv, F) || fx.rm_output(w, s->cb_out, cb_len)) {
+      j->error = 1; 
+      return; 
+    }
+  } else if (srslte_rm_turbo_rx(j->softbuffer->buffer_f[i], j->softbuffer->buff_size, &j->e_bits[rp], n_e, 
+                                s->cb_out, 3*cb_len+12, j->rv, F)) 
+  {
+    j->error = 1; 
+    return; 
+  }
+
+  uint32_t its   = 0; 
+  bool     crc_ok = false; 
+  srslte_tdec_reset(&s->tdec, cb_len);
+  do {
+    srslte_tdec_iteration(&s->tdec, s->cb_out, cb_len);
+    its++; 
+    srslte_tdec_decision(&s->tdec, s->cb_in, cb_len);
+    if (C > 1) {
+      crc_ok = !srslte_crc_checksum(&s->crc_cb, s->cb_in, cb_len);
+    } else {
+      crc_ok = !srslte_crc_checksum(&s->crc_tb, &s->cb_in[F], cb_segm->tbs+24);
+    }
+  } while (its < j->max_its && !crc_ok);
+
+  memcpy(&j->tb_bits[wp], &s->cb_in[F], cb_len - crc_len - F);
+  __sync_fetch_and_add(&j->nof_its, its);
+  if (C == 1 && crc_ok) {
+    j->crc_ok = 1; 
+  }
+}
+
+} // namespace srsue
@@ -29,26 +29,25 @@
 #include "srslte/srslte.h"
 #include "phy/phch_common.h"
 
-#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 namespace srsue {
 
-cf_t zeros[50000];
-
-phch_common::phch_common(uint32_t max_mutex_) : tx_mutex(max_mutex_)
+phch_common::phch_common()
 {
   params_db = NULL; 
   log_h     = NULL; 
   radio_h   = NULL; 
+  tx_h      = NULL; 
   mac       = NULL; 
-  max_mutex = max_mutex_;
-  nof_mutex = 0; 
+  pdsch_dec = NULL; 
+  scaler    = NULL; 
+  sig_cache = NULL; 
+  meas      = NULL; 
   sr_enabled        = false; 
-  is_first_of_burst = true; 
-  is_first_tx       = true; 
   rar_grant_pending = false; 
   pathloss = 0; 
   cur_pathloss = 0; 
@@ -59,7 +58,6 @@ phch_common::phch_common(uint32_t max_mutex_) : tx_mutex(max_mutex_)
   rx_gain_offset = 0; 
   sr_last_tx_tti = -1;
   cur_pusch_power = 0;
-  bzero(zeros, 50000*sizeof(cf_t));
 
   bzero(&dl_metrics, sizeof(dl_metrics_t));
   dl_metrics_read = true;
@@ -70,26 +68,34 @@ phch_common::phch_common(uint32_t max_mutex_) : tx_mutex(max_mutex_)
   bzero(&sync_metrics, sizeof(sync_metrics_t));
   sync_metrics_read = true;
   sync_metrics_count = 0;
+  deadline_miss[0] = 0;
+  deadline_miss[1] = 0;
+  its_nof_tb       = 0; 
+  its_granted_sum  = 0; 
+  its_used_sum     = 0; 
+  its_capped       = 0; 
+  its_miss_avoided = 0; 
+  drx_cycle        = 0; 
+  drx_offset       = 0; 
+  drx_on_duration  = 0; 
+  drx_until        = 0; 
+  drx_nof_tti      = 0; 
+  drx_monitored    = 0; 
+  drx_pdcch_us     = 0; 
 }
   
-void phch_common::init(phy_params *_params, srslte::log *_log, srslte::radio *_radio, mac_interface_phy *_mac)
+void phch_common::init(phy_params *_params, srslte::log *_log, srslte::radio *_radio, mac_interface_phy *_mac, phch_tx *_tx)
 {
   params_db = _params;
   log_h     = _log; 
   radio_h   = _radio; 
+  tx_h      = _tx; 
   mac       = _mac; 
     
-  is_first_tx = true; 
   sr_last_tx_tti = -1;
-  for (int i=0;i<nof_mutex;i++) {
-    pthread_mutex_init(&tx_mutex[i], NULL);
-  }
 }
 
-void phch_common::set_nof_mutex(uint32_t nof_mutex_) {
-  nof_mutex = nof_mutex_; 
-  assert(nof_mutex <= max_mutex);
-}
+
 
 bool phch_common::ul_rnti_active(uint32_t tti) {
   if ((tti >= ul_rnti_start && ul_rnti_start >= 0 || ul_rnti_start < 0) && 
@@ -116,6 +122,32 @@ srslte::radio* phch_common::get_radio()
   return radio_h;
 }
 
+void phch_common::drx_set_cycle(uint32_t cycle, uint32_t offset, uint32_t on_duration)
+{
+  drx_offset      = cycle ? offset%cycle : 0; 
+  drx_on_duration = on_duration; 
+  drx_cycle       = cycle; 
+}
+
+void phch_common::drx_set_active_until(uint32_t tti)
+{
+  drx_until = tti; 
+}
+
+// All DRX cycles divide 10240, so the on-duration pattern is continuous across SFN wrap-around
+bool phch_common::drx_active(uint32_t tti)
+{
+  uint32_t cycle = drx_cycle; 
+  if (!cycle) {
+    return true; 
+  }
+  if ((tti + cycle - drx_offset)%cycle < drx_on_duration) {
+    return true; 
+  }
+  // The MAC keeps active_until no older than its current TTI, ahead of tti within half the TTI range 
+  return (drx_until + 10240 - tti)%10240 < 5120; 
+}
+
 // Unpack RAR grant as defined in Section 6.2 of 36.213 
 void phch_common::set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN])
 {
@@ -143,7 +175,8 @@ bool phch_common::get_pending_rar(uint32_t tti, srslte_dci_rar_grant_t *rar_gran
 
 /* Common variables used by all phy workers */
 uint16_t phch_common::get_ul_rnti(uint32_t tti) {
-  if (ul_rnti_active(tti)) {
+  // An adaptive retransmission grant may come with a pending PHICH, even outside DRX active time
+  if (ul_rnti_active(tti) && (ul_rnti_type != SRSLTE_RNTI_USER || drx_active(tti) || get_pending_ack(tti))) {
     return ul_rnti; 
   } else {
     return 0; 
@@ -159,7 +192,7 @@ void phch_common::set_ul_rnti(srslte_rnti_type_t type, uint16_t rnti_value, int
   ul_rnti_end   = tti_end;
 }
 uint16_t phch_common::get_dl_rnti(uint32_t tti) {
-  if (dl_rnti_active(tti)) {
+  if (dl_rnti_active(tti) && (dl_rnti_type != SRSLTE_RNTI_USER || drx_active(tti))) {
     return dl_rnti; 
   } else {
     return 0; 
@@ -203,42 +236,25 @@ bool phch_common::get_pending_ack(uint32_t tti, uint32_t *I_lowest, uint32_t *n_
   return pending_ack[tti%10].enabled;
 }
 
-/* The transmisison of UL subframes must be in sequence. Each worker uses this function to indicate
- * that all processing is done and data is ready for transmission or there is no transmission at all (tx_enable). 
- * In that case, the end of burst message will be send to the radio 
+/* The transmisison of UL subframes must be in sequence. The TX thread sends them in the order of 
+ * tx_reserve() calls. Each worker uses worker_end() to indicate that all processing is done and data 
+ * is ready for transmission or there is no transmission at all (tx_enable), in which case the TX thread
+ * sends the end of burst message to the radio. 
  */
-void phch_common::worker_end(uint32_t tti, bool tx_enable, 
-                                   cf_t *buffer, uint32_t nof_samples, 
-                                   srslte_timestamp_t tx_time) 
+uint32_t phch_common::tx_reserve(srslte_timestamp_t tx_time, uint32_t nof_samples, uint64_t deadline_ns)
 {
+  return tx_h->reserve(tx_time, nof_samples, deadline_ns);
+}
 
-  // Wait previous TTIs to be transmitted 
-  if (is_first_tx) {
-    is_first_tx = false; 
-  } else {
-    pthread_mutex_lock(&tx_mutex[tti%nof_mutex]);
-  }
-
-  radio_h->set_tti(tti); 
-  if (tx_enable) {
-    radio_h->tx(buffer, nof_samples, tx_time);
-    is_first_of_burst = false; 
-  } else {
-    if (params_db->get_param(phy_interface_params::CONTINUOUS_TX)>0) {
-      if (!is_first_of_burst) {
-        radio_h->tx(zeros, nof_samples, tx_time);
-      }
-    } else {
-      if (!is_first_of_burst) {
-        radio_h->tx_end();
-        is_first_of_burst = true;   
-      }
-    }
-  }
-  // Trigger next transmission 
-  pthread_mutex_unlock(&tx_mutex[(tti+1)%nof_mutex]);
-}    
+uint64_t phch_common::tx_deadline_ns(uint64_t rx_ns, float time_adv_sec)
+{
+  return rx_ns + 3000000 - (uint64_t) (time_adv_sec*1e9) - TX_MARGIN_NS; 
+}
 
+void phch_common::worker_end(uint32_t tx_seq, uint32_t tti, bool tx_enable, cf_t *buffer, uint32_t nof_samples) 
+{
+  tx_h->push(tx_seq, tti, tx_enable, buffer, nof_samples);
+}
 
 void phch_common::set_cell(const srslte_cell_t &c) {
   cell = c;
@@ -269,6 +285,41 @@ void phch_common::set_dl_metrics(const dl_metrics_t &m) {
 void phch_common::get_dl_metrics(dl_metrics_t &m) {
   m = dl_metrics;
   dl_metrics_read = true;
+  uint32_t n        = __sync_lock_test_and_set(&its_nof_tb, 0);
+  uint32_t granted  = __sync_lock_test_and_set(&its_granted_sum, 0);
+  uint32_t used     = __sync_lock_test_and_set(&its_used_sum, 0);
+  m.its_granted     = n ? (float) granted/n : 0;
+  m.its_used        = n ? (float) used/n/100 : 0;
+  m.its_capped      = __sync_lock_test_and_set(&its_capped, 0);
+  m.miss_avoided    = __sync_lock_test_and_set(&its_miss_avoided, 0);
+  
+  uint32_t nof_tti   = __sync_lock_test_and_set(&drx_nof_tti, 0);
+  uint32_t monitored = __sync_lock_test_and_set(&drx_monitored, 0);
+  uint32_t pdcch_us  = __sync_lock_test_and_set(&drx_pdcch_us, 0);
+  m.drx_sleep       = nof_tti ? (float) (nof_tti - monitored)/nof_tti : 0;
+  m.drx_saved_us    = monitored ? m.drx_sleep*pdcch_us/monitored : 0;
+}
+
+void phch_common::add_pdsch_its(uint32_t granted, float used, bool capped, bool met)
+{
+  __sync_fetch_and_add(&its_granted_sum, granted);
+  __sync_fetch_and_add(&its_used_sum, (uint32_t) (used*100));
+  __sync_fetch_and_add(&its_nof_tb, 1);
+  if (capped) {
+    __sync_fetch_and_add(&its_capped, 1);
+    if (met) {
+      __sync_fetch_and_add(&its_miss_avoided, 1);
+    }
+  }
+}
+
+void phch_common::add_drx_tti(bool monitored, uint64_t pdcch_ns)
+{
+  __sync_fetch_and_add(&drx_nof_tti, 1);
+  if (monitored) {
+    __sync_fetch_and_add(&drx_monitored, 1);
+    __sync_fetch_and_add(&drx_pdcch_us, (uint32_t) (pdcch_ns/1000));
+  }
 }
 
 void phch_common::set_ul_metrics(const ul_metrics_t &m) {
@@ -298,6 +349,9 @@ void phch_common::set_sync_metrics(const sync_metrics_t &m) {
     sync_metrics_count++;
     sync_metrics.cfo = sync_metrics.cfo + (m.cfo - sync_metrics.cfo)/sync_metrics_count;
     sync_metrics.sfo = sync_metrics.sfo + (m.sfo - sync_metrics.sfo)/sync_metrics_count;
+    sync_metrics.nof_workers = sync_metrics.nof_workers + (m.nof_workers - sync_metrics.nof_workers)/sync_metrics_count;
+    sync_metrics.sf_late    += m.sf_late;
+    sync_metrics.sf_skipped += m.sf_skipped;
   }
 }
 
@@ -306,13 +360,55 @@ void phch_common::get_sync_metrics(sync_metrics_t &m) {
   sync_metrics_read = true;
 }
 
-void phch_common::reset_ul()
+void phch_common::add_latency(uint64_t stage_ns[PHY_NOF_STAGES], uint32_t mask, int64_t slack_ns)
 {
-  is_first_tx = true; 
-  is_first_of_burst = true; 
-  for (int i=0;i<nof_mutex;i++) {
-    pthread_mutex_unlock(&tx_mutex[i]);
+  for (int j=0;j<2;j++) {
+    for (int i=0;i<PHY_NOF_STAGES;i++) {
+      if (mask & (1<<i)) {
+        stage_hist[j][i].add(stage_ns[i]);
+      }
+    }
+    if (slack_ns >= 0) {
+      slack_hist[j].add(slack_ns);
+    } else {
+      __sync_fetch_and_add(&deadline_miss[j], 1);
+    }
+  }
+  if (scaler && (mask & (1<<PHY_STAGE_TOTAL))) {
+    scaler->add_tti(stage_ns[PHY_STAGE_TOTAL]);
+  }
+}
+
+void phch_common::get_latency_metrics(latency_metrics_t &m)
+{
+  for (int i=0;i<PHY_NOF_STAGES;i++) {
+    latency_hist *h = &stage_hist[0][i];
+    m.stage[i].n      = h->count();
+    m.stage[i].avg_us = h->mean()/1000;
+    m.stage[i].p99_us = (float) h->percentile(99)/1000;
+    m.stage[i].max_us = (float) h->max()/1000;
+    h->reset();
+  }
+  m.slack_p1_us   = (float) slack_hist[0].percentile(1)/1000;
+  m.deadline_miss = __sync_lock_test_and_set(&deadline_miss[0], 0);
+  slack_hist[0].reset();
+  m.tx_late       = tx_h ? tx_h->get_late() : 0; 
+  m.tx_overflow   = tx_h ? tx_h->get_overflow() : 0; 
+}
+
+// Totals since start, not reset so the trace file written on stop covers the whole run
+void phch_common::print_latency(FILE *f)
+{
+  fprintf(f, "PHY subframe processing latency, %d deadline misses\n", deadline_miss[1]);
+  for (int i=0;i<PHY_NOF_STAGES;i++) {
+    stage_hist[1][i].print(f, phy_stage_text[i]);
   }
+  slack_hist[1].print(f, "slack");
+}
+
+void phch_common::reset_ul()
+{
+  tx_h->reset();
 }
 
 }
@@ -0,0 +1,219 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include "phy/phch_meas.h"
+#include "phy/phch_common.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+namespace srsue {
+
+phch_meas::phch_meas()
+{
+  common      = NULL; 
+  radio_h     = NULL; 
+  params_db   = NULL; 
+  log_h       = NULL; 
+  running     = false; 
+  head        = 0; 
+  tail        = 0; 
+  nof_dropped = 0; 
+  last_offset_tti = -1; 
+  bzero(slots, sizeof(slots));
+  for (uint32_t i=0;i<NOF_SAMPLES;i++) {
+    slots[i].seq = i; 
+  }
+}
+
+phch_meas::~phch_meas()
+{
+  stop();
+}
+
+bool phch_meas::init(phch_common *common_, srslte::radio *radio_h_, phy_params *params_db_, srslte::log *log_h_, int prio)
+{
+  common    = common_; 
+  radio_h   = radio_h_; 
+  params_db = params_db_; 
+  log_h     = log_h_; 
+
+  running = true; 
+  if (!start(prio)) {
+    running = false; 
+  }
+  return running; 
+}
+
+void phch_meas::stop()
+{
+  if (running) {
+    running = false; 
+    wait_thread_finish();
+  }
+}
+
+// Multi-producer enqueue of a bounded ring with per-slot sequence numbers, like msg_queue
+bool phch_meas::push(const sample_t &s)
+{
+  uint32_t pos = head; 
+  slot_t  *slot; 
+  while (true) {
+    slot = &slots[pos%NOF_SAMPLES];
+    int32_t dif = (int32_t) (slot->seq - pos);
+    if (dif == 0) {
+      if (__sync_bool_compare_and_swap(&head, pos, pos+1)) {
+        break; 
+      }
+      pos = head; 
+    } else if (dif < 0) {
+      __sync_fetch_and_add(&nof_dropped, 1);
+      return false; 
+    } else {
+      pos = head; 
+    }
+  }
+  slot->s = s; 
+  __sync_synchronize();
+  slot->seq = pos+1; 
+  return true; 
+}
+
+// Single consumer
+bool phch_meas::pop(sample_t *s)
+{
+  slot_t *slot = &slots[tail%NOF_SAMPLES];
+  if (slot->seq != tail+1) {
+    return false; 
+  }
+  __sync_synchronize();
+  *s = slot->s; 
+  __sync_synchronize();
+  slot->seq = tail+NOF_SAMPLES; 
+  tail++; 
+  return true; 
+}
+
+uint32_t phch_meas::get_dropped()
+{
+  return __sync_lock_test_and_set(&nof_dropped, 0);
+}
+
+uint32_t phch_meas::process()
+{
+  sample_t s; 
+  uint32_t n = 0; 
+  while (pop(&s)) {
+    update_gain_offset(&s);
+    if (common->rx_gain_offset) {
+      update_filter(&s);
+    }
+    n++; 
+  }
+  return n; 
+}
+
+/* ADC/RX gain offset, every GAIN_OFFSET_PERIOD subframes or until known. Samples of different 
+ * workers may arrive slightly out of order, the period is measured from the last update */
+void phch_meas::update_gain_offset(sample_t *s)
+{
+  if (common->rx_gain_offset && last_offset_tti >= 0 && 
+      (s->tti + 10240 - last_offset_tti)%10240 < GAIN_OFFSET_PERIOD) 
+  {
+    return; 
+  }
+  last_offset_tti = s->tti; 
+  float rx_gain_offset = 0; 
+  if (radio_h->has_rssi()) {
+    if (s->rssi) {
+      rx_gain_offset = 10*log10(s->rssi)-radio_h->get_rssi();
+    }
+  } else {
+    if (params_db->get_param(phy_interface_params::RX_GAIN_OFFSET) > 0) {
+      rx_gain_offset = (float) params_db->get_param(phy_interface_params::RX_GAIN_OFFSET);
+    } else {
+      rx_gain_offset = radio_h->get_rx_gain();
+    }
+  }
+  if (common->rx_gain_offset) {
+    common->rx_gain_offset = SRSLTE_VEC_EMA(common->rx_gain_offset, rx_gain_offset, 0.1);
+  } else {
+    common->rx_gain_offset = rx_gain_offset; 
+  }
+}
+
+// L3 filtering of the RSRP with the RRC filter coefficient k, F = (1-a)*F + a*M with a = 1/2^(k/4)
+void phch_meas::update_filter(sample_t *s)
+{
+  float rsrp = 10*log10(s->rsrp) + 30 - common->rx_gain_offset;
+  float rssi = 10*log10(s->rssi) + 30 - common->rx_gain_offset;
+  float rsrq = 10*log10(s->rsrq);
+
+  if (!common->rsrp_filtered) {
+    common->rsrp_filtered = rsrp;
+  } else {
+    int64_t k = params_db->get_param(phy_interface_params::MEAS_FILTER_COEFF); 
+    float   a = pow(0.5, (float) (k > 0 ? k : 0)/4);
+    common->rsrp_filtered = SRSLTE_VEC_EMA(rsrp, common->rsrp_filtered, a);
+    if (isnan(common->rsrp_filtered) || isinf(common->rsrp_filtered)) {
+      common->rsrp_filtered = 0; 
+    }
+  }
+  float tx_crs_power = (float) params_db->get_param(phy_interface_params::PDSCH_RSPOWER);
+  common->pathloss = tx_crs_power - common->rsrp_filtered;
+
+  dl_metrics_t dl; 
+  bzero(&dl, sizeof(dl_metrics_t));
+  dl.n           = s->noise;
+  dl.rsrp        = common->rsrp_filtered;
+  dl.rsrq        = rsrq;
+  dl.rssi        = rssi;
+  dl.pathloss    = common->pathloss;
+  dl.sinr        = 10*log10(s->snr);
+  dl.turbo_iters = s->turbo_iters;
+  dl.mcs         = s->dl_mcs;
+  common->set_dl_metrics(dl);
+  common->set_ul_metrics(s->ul);
+}
+
+void phch_meas::run_thread()
+{
+  while (running) {
+    usleep(PERIOD_US);
+    process();
+    uint32_t n = get_dropped(); 
+    if (n) {
+      Warning("Measurement queue full, %d samples dropped\n", n);
+    }
+  }
+}
+
+} // namespace srsue
@@ -25,22 +25,26 @@
  */
 
 #include <unistd.h>
+#include <math.h>
 #include "srslte/srslte.h"
 #include "common/log.h"
 #include "phy/phch_worker.h"
 #include "phy/phch_common.h"
 #include "phy/phch_recv.h"
 
-#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 namespace srsue {
  
 
 phch_recv::phch_recv() { 
-  running = false; 
+  running       = false; 
+  cur_freq      = 0; 
+  cache_pending = false; 
+  bzero(&metrics, sizeof(sync_metrics_t));
 }
 
 bool phch_recv::init(srslte::radio* _radio_handler, mac_interface_phy *_mac, prach* _prach_buffer, srslte::thread_pool* _workers_pool,
@@ -52,15 +56,12 @@ bool phch_recv::init(srslte::radio* _radio_handler, mac_interface_phy *_mac, pra
   workers_pool = _workers_pool;
   worker_com   = _worker_com;
   prach_buffer = _prach_buffer; 
-  tx_mutex_cnt = 0; 
+  last_tti_ns  = 0; 
   running      = true; 
   phy_state    = IDLE; 
   time_adv_sec = 0; 
   cell_is_set  = false; 
   do_agc       = do_agc_;
-
-  nof_tx_mutex = MUTEX_X_WORKER*workers_pool->get_nof_workers();
-  worker_com->set_nof_mutex(nof_tx_mutex);
     
   start(prio);
 }
@@ -106,6 +107,12 @@ bool phch_recv::init_cell() {
           return false; 
         }
       }
+      // Same size as the worker buffers, they are swapped
+      int64_t nof_slots = worker_com->params_db->get_param(phy_interface_params::RX_RING_SF); 
+      if (!rx_buffers.init(nof_slots > 0 ? nof_slots : 0, 2*SRSLTE_SF_LEN_PRB(cell.nof_prb))) {
+        Error("Error setting cell: allocating RX ring\n");
+        return false; 
+      }
       radio_h->set_tti_len(SRSLTE_SF_LEN_PRB(cell.nof_prb));
       if (do_agc) {
         srslte_ue_sync_start_agc(&ue_sync, callback_set_rx_gain, last_gain);    
@@ -128,34 +135,98 @@ void phch_recv::free_cell()
       ((phch_worker*) workers_pool->get_worker(i))->free_cell();
     }
     prach_buffer->free_cell();
+    skip_ring(rx_buffers.get_nof_pending());
+    rx_buffers.free_buffers();
   }
 }
 
 
-bool phch_recv::cell_search(int force_N_id_2) 
+void phch_recv::set_frequencies(const std::vector<float> &dl_freq, const std::vector<float> &ul_freq)
 {
-  uint8_t bch_payload[SRSLTE_BCH_PAYLOAD_LEN];
-  uint8_t bch_payload_bits[SRSLTE_BCH_PAYLOAD_LEN/8];
-  
-  srslte_ue_cellsearch_result_t found_cells[3];
-  srslte_ue_cellsearch_t        cs; 
+  dl_freqs = dl_freq;
+  ul_freqs = ul_freq;
+  cur_freq = 0;
+}
 
-  bzero(found_cells, 3*sizeof(srslte_ue_cellsearch_result_t));
+void phch_recv::set_cell_cache(std::string filename)
+{
+  cache_file    = filename;
+  cache_pending = filename.length() > 0;
+}
 
-  log_h->console("Searching for cell...\n");
-  if (srslte_ue_cellsearch_init(&cs, radio_recv_wrapper_cs, radio_h)) {
-    Error("Initiating UE cell search\n");
-    return false; 
+void phch_recv::set_frequency(uint32_t idx)
+{
+  if (idx < dl_freqs.size()) {
+    radio_h->set_rx_freq(dl_freqs[idx]);
+    radio_h->set_tx_freq(ul_freqs[idx]);
+    cur_freq = idx;
+    log_h->console("Setting frequency: DL=%.1f Mhz, UL=%.1f MHz\n", dl_freqs[idx]/1e6, ul_freqs[idx]/1e6);
   }
-  
+}
+
+/* Searches the cells in each carrier in order, the first whose MIB is decoded is selected. 
+ * The cell from the cache is tried first, once */
+bool phch_recv::cell_search(int force_N_id_2) 
+{
+  if (cache_pending) {
+    cache_pending = false;
+    if (search_cached()) {
+      return true;
+    }
+  }
+  uint32_t nof_freqs = dl_freqs.size() > 0 ? dl_freqs.size() : 1;
+  for (uint32_t i=0;i<nof_freqs;i++) {
+    set_frequency(i);
+    if (search_pss(force_N_id_2) && decode_mib()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool phch_recv::search_cached()
+{
+  cell_cache_t c;
+  if (!cell_cache::load(cache_file, &c)) {
+    return false;
+  }
+  // The cached carrier must be one of those configured
+  uint32_t i = 0;
+  while (i < dl_freqs.size() && fabsf(dl_freqs[i] - c.dl_freq) > 1000) {
+    i++;
+  }
+  if (dl_freqs.size() > 0 && i == dl_freqs.size()) {
+    Info("Cached cell at %.1f MHz is not in the carrier list\n", c.dl_freq/1e6);
+    return false;
+  }
+  set_frequency(i);
+
+  cell.id        = c.cell.id;
+  cell.cp        = c.cell.cp;
+  cellsearch_cfo = c.cfo;
   if (do_agc) {
-    srslte_ue_sync_start_agc(&cs.ue_sync, callback_set_rx_gain, last_gain);
+    last_gain = c.gain;
   }
-  
-  srslte_ue_cellsearch_set_nof_frames_to_scan(&cs, 
-    worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_PSS_NFRAMES));
-  srslte_ue_cellsearch_set_threshold(&cs, (float) 
-    worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_PSS_CORRELATION_THRESHOLD)/10);
+  log_h->console("Trying cached CELL ID: %d CP: %s, CFO: %.1f KHz...\n", cell.id, srslte_cp_string(cell.cp), cellsearch_cfo/1000);
+  if (!decode_mib()) {
+    log_h->console("Cached cell not found\n");
+    return false;
+  }
+  if (cell.nof_prb != c.cell.nof_prb || cell.nof_ports != c.cell.nof_ports) {
+    Info("Cached cell had %d PRB and %d ports\n", c.cell.nof_prb, c.cell.nof_ports);
+  }
+  return true;
+}
+
+bool phch_recv::search_pss(int force_N_id_2)
+{
+  srslte_ue_cellsearch_result_t found_cells[3];
+  bzero(found_cells, 3*sizeof(srslte_ue_cellsearch_result_t));
+
+  log_h->console("Searching for cell...\n");
+
+  uint32_t nof_frames = worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_PSS_NFRAMES);
+  float    threshold  = (float) worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_PSS_CORRELATION_THRESHOLD)/10;
 
   radio_h->set_rx_srate(1.92e6);
   radio_h->start_rx();
@@ -165,16 +236,27 @@ bool phch_recv::cell_search(int force_N_id_2)
   int ret = SRSLTE_ERROR; 
   
   if (force_N_id_2 >= 0 && force_N_id_2 < 3) {
+    srslte_ue_cellsearch_t cs; 
+    if (srslte_ue_cellsearch_init(&cs, radio_recv_wrapper_cs, radio_h)) {
+      Error("Initiating UE cell search\n");
+      radio_h->stop_rx();
+      return false; 
+    }
+    if (do_agc) {
+      srslte_ue_sync_start_agc(&cs.ue_sync, callback_set_rx_gain, last_gain);
+    }
+    srslte_ue_cellsearch_set_nof_frames_to_scan(&cs, nof_frames);
+    srslte_ue_cellsearch_set_threshold(&cs, threshold);
     ret = srslte_ue_cellsearch_scan_N_id_2(&cs, force_N_id_2, &found_cells[force_N_id_2]);
     max_peak_cell = force_N_id_2;
+    last_gain = srslte_agc_get_gain(&cs.ue_sync.agc);
+    srslte_ue_cellsearch_free(&cs);
   } else {
-    ret = srslte_ue_cellsearch_scan(&cs, found_cells, &max_peak_cell); 
+    // The 3 N_id_2 are correlated in parallel over the same frames
+    ret = searcher.scan(radio_h, nof_frames, threshold, do_agc, &last_gain, found_cells, &max_peak_cell); 
   }
 
-  last_gain = srslte_agc_get_gain(&cs.ue_sync.agc);
-
   radio_h->stop_rx();
-  srslte_ue_cellsearch_free(&cs);
   
   if (ret < 0) {
     Error("Error decoding MIB: Error searching PSS\n");
@@ -190,7 +272,15 @@ bool phch_recv::cell_search(int force_N_id_2)
   cellsearch_cfo = found_cells[max_peak_cell].cfo;
   
   log_h->console("Found CELL ID: %d CP: %s, CFO: %.1f KHz.\nTrying to decode MIB...\n", cell.id, srslte_cp_string(cell.cp), cellsearch_cfo/1000);
-  
+  return true;
+}
+
+// MIB sync at 1.92 MHz on cell.id and cell.cp
+bool phch_recv::decode_mib()
+{
+  uint8_t bch_payload[SRSLTE_BCH_PAYLOAD_LEN];
+  uint8_t bch_payload_bits[SRSLTE_BCH_PAYLOAD_LEN/8];
+
   srslte_ue_mib_sync_t ue_mib_sync; 
 
   if (srslte_ue_mib_sync_init(&ue_mib_sync, cell.id, cell.cp, radio_recv_wrapper_cs, radio_h)) {
@@ -204,10 +294,11 @@ bool phch_recv::cell_search(int force_N_id_2)
 
   /* Find and decode MIB */
   uint32_t sfn, sfn_offset; 
+  radio_h->set_rx_srate(1.92e6);
   radio_h->start_rx();
-  ret = srslte_ue_mib_sync_decode(&ue_mib_sync, 
-                                  worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_MIB_NFRAMES), 
-                                  bch_payload, &cell.nof_ports, &sfn_offset); 
+  int ret = srslte_ue_mib_sync_decode(&ue_mib_sync, 
+                                      worker_com->params_db->get_param(phy_interface_params::CELLSEARCH_TIMEOUT_MIB_NFRAMES), 
+                                      bch_payload, &cell.nof_ports, &sfn_offset); 
   radio_h->stop_rx();
   last_gain = srslte_agc_get_gain(&ue_mib_sync.ue_sync.agc);
   srslte_ue_mib_sync_free(&ue_mib_sync);
@@ -226,6 +317,22 @@ bool phch_recv::cell_search(int force_N_id_2)
   }
 }
 
+void phch_recv::save_cell()
+{
+  if (cache_file.length() == 0) {
+    return;
+  }
+  cell_cache_t c;
+  bzero(&c, sizeof(cell_cache_t));
+  c.dl_freq = cur_freq < dl_freqs.size() ? dl_freqs[cur_freq] : 0;
+  c.cell    = cell;
+  c.cfo     = srslte_ue_sync_get_cfo(&ue_sync);
+  c.gain    = do_agc ? srslte_agc_get_gain(&ue_sync.agc) : radio_h->get_rx_gain();
+  if (!cell_cache::save(cache_file, &c)) {
+    Warning("Error saving cell to %s\n", cache_file.c_str());
+  }
+}
+
 
 int phch_recv::sync_sfn(void) {
   
@@ -263,10 +370,41 @@ int phch_recv::sync_sfn(void) {
   return 0;
 }
 
+// Hands the pending subframes of the RX ring to the idle workers, swapping buffers
+void phch_recv::dispatch_ring()
+{
+  rx_ring::slot_t *s; 
+  while ((s = rx_buffers.front())) {
+    phch_worker *w = (phch_worker*) workers_pool->try_wait_worker(s->tti);
+    if (!w) {
+      return; 
+    }
+    s->buffer = w->swap_buffer(s->buffer);
+    w->set_cfo(s->cfo);
+    w->set_tti(s->tti, s->tx_seq, s->rx_ns, s->deadline_ns);
+    workers_pool->start_worker(w);
+    rx_buffers.pop();
+    metrics.sf_late++; 
+  }
+}
+
+// Drops the oldest pending subframes, the TX slots reserved for them are released empty
+void phch_recv::skip_ring(uint32_t nof_sf)
+{
+  rx_ring::slot_t *s; 
+  for (uint32_t i=0;i<nof_sf && (s = rx_buffers.front());i++) {
+    worker_com->worker_end(s->tx_seq, s->tti, false, NULL, 0);
+    rx_buffers.pop();
+    metrics.sf_skipped++; 
+  }
+}
+
 void phch_recv::run_thread()
 {
   phch_worker *worker = NULL;
+  rx_ring::slot_t *slot = NULL; 
   cf_t *buffer = NULL;
+  uint64_t wait_ns = 0;   // Time waiting for an idle worker
   while(running) {
     switch(phy_state) {
       case CELL_SEARCH:
@@ -300,6 +438,7 @@ void phch_recv::run_thread()
             break; 
           case 1:
             srslte_ue_sync_set_agc_period(&ue_sync, 20);
+            save_cell();
             phy_state = SYNC_DONE;  
             break;        
           case 0:
@@ -316,55 +455,113 @@ void phch_recv::run_thread()
         }
         
         tti = (tti+1)%10240;        
-        worker = (phch_worker*) workers_pool->wait_worker(tti);
-        if (worker) {          
-          buffer = worker->get_buffer();
-          if (srslte_ue_sync_zerocopy(&ue_sync, buffer) == 1) {
-            log_h->step(tti);
-
-            Debug("Worker %d synchronized\n", worker->get_id());
-            
-            metrics.sfo = srslte_ue_sync_get_sfo(&ue_sync);
-            metrics.cfo = srslte_ue_sync_get_cfo(&ue_sync);
+        
+        // Subframes received while all the workers were busy go first, in reception order
+        dispatch_ring();
+        
+        /* Without a ring the radio is not read until a worker is idle. With it, the subframe is 
+         * received into the ring if no worker is idle, so samples never pile up in the driver */
+        worker  = NULL; 
+        slot    = NULL; 
+        wait_ns = now_ns();
+        if (!rx_buffers.get_nof_slots()) {
+          worker = (phch_worker*) workers_pool->wait_worker(tti);
+          if (!worker) {
+            // wait_worker() only returns NULL if it's being closed. Quit now to avoid unnecessary loops here
+            running = false; 
+            break; 
+          }
+        } else if (!rx_buffers.get_nof_pending()) {
+          worker = (phch_worker*) workers_pool->try_wait_worker(tti);
+        }
+        if (!worker) {
+          if (rx_buffers.is_full()) {
+            Warning("RX ring full, skipping TTI %d\n", rx_buffers.front()->tti);
+            skip_ring(1);
+          }
+          slot = rx_buffers.next(); 
+        }
+        wait_ns = now_ns() - wait_ns; 
+        buffer = worker ? worker->get_buffer() : slot->buffer;
+        if (srslte_ue_sync_zerocopy(&ue_sync, buffer) == 1) {
+          log_h->step(tti);
+
+          // Wake latency of the sync thread is its lateness relative to the 1 ms TTI period
+          uint64_t now = now_ns();
+          if (last_tti_ns) {
+            wake_record(now - last_tti_ns > 1000000 ? now - last_tti_ns - 1000000 : 0);
+          }
+          last_tti_ns = now; 
+          update_usage();
+
+          metrics.sfo = srslte_ue_sync_get_sfo(&ue_sync);
+          metrics.cfo = srslte_ue_sync_get_cfo(&ue_sync);
+          metrics.nof_workers = workers_pool->get_nof_active();
+          worker_com->set_sync_metrics(metrics);
+          metrics.sf_late    = 0; 
+          metrics.sf_skipped = 0; 
+  
+          /* Compute TX time: Any transmission happens in TTI+4 thus advance 4 ms the reception time */
+          srslte_timestamp_t rx_time, tx_time, tx_time_prach; 
+          srslte_ue_sync_get_last_timestamp(&ue_sync, &rx_time); 
+          srslte_timestamp_copy(&tx_time, &rx_time);
+          srslte_timestamp_copy(&tx_time_prach, &rx_time);
+          srslte_timestamp_add(&tx_time, 0, 4e-3 - time_adv_sec);
+          srslte_timestamp_add(&tx_time_prach, 0, 4e-3);
+          
+          // The TX thread sends UL subframes in this order, dropping those not ready before air time
+          uint64_t deadline_ns = phch_common::tx_deadline_ns(now, time_adv_sec); 
+          uint32_t tx_seq = worker_com->tx_reserve(tx_time, SRSLTE_SF_LEN_PRB(cell.nof_prb), deadline_ns);
+          if (worker) {
+            Debug("Settting TTI=%d, tx_seq=%d to worker %d\n", tti, tx_seq, worker->get_id());
             worker->set_cfo(metrics.cfo/15000);
-            worker_com->set_sync_metrics(metrics);
-    
-            /* Compute TX time: Any transmission happens in TTI+4 thus advance 4 ms the reception time */
-            srslte_timestamp_t rx_time, tx_time, tx_time_prach; 
-            srslte_ue_sync_get_last_timestamp(&ue_sync, &rx_time); 
-            srslte_timestamp_copy(&tx_time, &rx_time);
-            srslte_timestamp_copy(&tx_time_prach, &rx_time);
-            srslte_timestamp_add(&tx_time, 0, 4e-3 - time_adv_sec);
-            srslte_timestamp_add(&tx_time_prach, 0, 4e-3);
-            worker->set_tx_time(tx_time);
-            
-            Debug("Settting TTI=%d, tx_mutex=%d to worker %d\n", tti, tx_mutex_cnt, worker->get_id());
-            worker->set_tti(tti, tx_mutex_cnt);
-            tx_mutex_cnt = (tx_mutex_cnt+1)%nof_tx_mutex;
-
-            // Check if we need to TX a PRACH 
-            if (prach_buffer->is_ready_to_send(tti)) {
-              srslte_timestamp_t cur_time; 
-              radio_h->get_time(&cur_time);
-              Info("TX PRACH now. RX time: %d:%f, Now: %d:%f\n", rx_time.full_secs, rx_time.frac_secs, 
-                   cur_time.full_secs, cur_time.frac_secs);
-              // send prach if we have to 
-              prach_buffer->send(radio_h, metrics.cfo/15000, worker_com->pathloss, tx_time_prach);
-              radio_h->tx_end();            
-              worker_com->p0_preamble = prach_buffer->get_p0_preamble();
-              worker_com->cur_radio_power = SRSLTE_MIN(SRSLTE_PC_MAX, worker_com->pathloss + worker_com->p0_preamble);
-            }            
-            workers_pool->start_worker(worker);             
-            mac->tti_clock(tti);
+            worker->set_tti(tti, tx_seq, now, deadline_ns);
           } else {
-            log_h->console("Sync Error!\n");
-            worker->release();
-            phy_state = SYNCING;
-            worker_com->reset_ul();
+            Debug("No idle worker, TTI=%d, tx_seq=%d queued in the RX ring\n", tti, tx_seq);
+            slot->tti         = tti; 
+            slot->tx_seq      = tx_seq; 
+            slot->cfo         = metrics.cfo/15000; 
+            slot->rx_ns       = now; 
+            slot->deadline_ns = deadline_ns; 
+            rx_buffers.push();
+          }
+
+          // Check if we need to TX a PRACH 
+          if (prach_buffer->is_ready_to_send(tti)) {
+            srslte_timestamp_t cur_time; 
+            radio_h->get_time(&cur_time);
+            Info("TX PRACH now. RX time: %d:%f, Now: %d:%f\n", rx_time.full_secs, rx_time.frac_secs, 
+                 cur_time.full_secs, cur_time.frac_secs);
+            // send prach if we have to 
+            prach_buffer->send(radio_h, metrics.cfo/15000, worker_com->pathloss, tx_time_prach);
+            radio_h->tx_end();            
+            worker_com->p0_preamble = prach_buffer->get_p0_preamble();
+            worker_com->cur_radio_power = SRSLTE_MIN(SRSLTE_PC_MAX, worker_com->pathloss + worker_com->p0_preamble);
+          }            
+          if (worker) {
+            workers_pool->start_worker(worker);             
+          }
+          mac->tti_clock(tti);
+
+          // Workers not needed for the current load are parked from the next wait_worker(). 
+          // A subframe that had to go to the ring counts as a full subframe waiting for a worker
+          if (worker_com->scaler) {
+            uint32_t n = worker_com->scaler->step(time_adv_sec, worker ? wait_ns : 1000000);
+            if (n != workers_pool->get_nof_active()) {
+              Info("Active PHY workers %d -> %d\n", workers_pool->get_nof_active(), n);
+              workers_pool->set_nof_active(n);
+            }
           }
         } else {
-          // wait_worker() only returns NULL if it's being closed. Quit now to avoid unnecessary loops here
-          running = false; 
+          log_h->console("Sync Error!\n");
+          last_tti_ns = 0; 
+          if (worker) {
+            worker->release();
+          }
+          // Pending subframes belong to the lost timing
+          skip_ring(rx_buffers.get_nof_pending());
+          phy_state = SYNCING;
+          worker_com->reset_ul();
         }
         break;
       case IDLE:
@@ -0,0 +1,264 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "phy/phch_tx.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+// Largest subframe, samples
+#define MAX_SF_LEN  SRSLTE_SF_LEN_PRB(SRSLTE_MAX_PRB)
+
+namespace srsue {
+
+static void futex_wait_ns(volatile uint32_t *addr, uint32_t val, uint64_t timeout_ns)
+{
+  struct timespec t;
+  t.tv_sec  = timeout_ns/1000000000;
+  t.tv_nsec = timeout_ns%1000000000;
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, &t, NULL, 0);
+}
+
+static void futex_wake(volatile uint32_t *addr, int n)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+phch_tx::phch_tx()
+{
+  radio_h       = NULL; 
+  params_db     = NULL; 
+  log_h         = NULL; 
+  zeros         = NULL; 
+  running       = false; 
+  reserved_seq  = 0; 
+  next_seq      = 0; 
+  reset_pending = 0; 
+  nof_late      = 0; 
+  nof_overflow  = 0; 
+  is_first_of_burst = true; 
+  bzero(slots, sizeof(slots));
+}
+
+phch_tx::~phch_tx()
+{
+  for (uint32_t i=0;i<NOF_SLOTS;i++) {
+    if (slots[i].buffer) {
+      free(slots[i].buffer);
+    }
+  }
+  if (zeros) {
+    free(zeros);
+  }
+}
+
+bool phch_tx::init(srslte::radio *radio_h_, phy_params *params_db_, srslte::log *log_h_, int prio)
+{
+  radio_h   = radio_h_; 
+  params_db = params_db_; 
+  log_h     = log_h_; 
+
+  for (uint32_t i=0;i<NOF_SLOTS;i++) {
+    slots[i].buffer = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*MAX_SF_LEN);
+    if (!slots[i].buffer) {
+      return false; 
+    }
+    slots[i].state = SLOT_FREE; 
+    // Never matches the sequence number of a pending subframe
+    slots[i].seq   = i + 1; 
+  }
+  zeros = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*MAX_SF_LEN);
+  if (!zeros) {
+    return false; 
+  }
+  bzero(zeros, sizeof(cf_t)*MAX_SF_LEN);
+
+  running = true; 
+  if (!start(prio)) {
+    running = false; 
+  }
+  return running; 
+}
+
+void phch_tx::stop()
+{
+  if (running) {
+    running = false; 
+    wait_thread_finish();
+  }
+}
+
+uint32_t phch_tx::reserve(srslte_timestamp_t tx_time, uint32_t nof_samples, uint64_t deadline_ns)
+{
+  uint32_t seq = reserved_seq; 
+  slot_t  *s   = &slots[seq%NOF_SLOTS];
+  // Still held by a subframe NOF_SLOTS behind, skip this one instead of waiting for it 
+  if (s->state == SLOT_FREE) {
+    s->seq         = seq; 
+    s->tx_time     = tx_time; 
+    s->nof_samples = nof_samples; 
+    s->deadline_ns = deadline_ns; 
+    s->tx_enable   = false; 
+    s->state       = SLOT_RESERVED; 
+  } else {
+    __sync_fetch_and_add(&nof_overflow, 1);
+  }
+  __sync_synchronize();
+  reserved_seq = seq + 1; 
+  futex_wake(&reserved_seq, 1);
+  return seq; 
+}
+
+void phch_tx::push(uint32_t seq, uint32_t tti, bool tx_enable, cf_t *buffer, uint32_t nof_samples)
+{
+  slot_t *s = &slots[seq%NOF_SLOTS];
+  if (s->seq != seq) {
+    return; 
+  }
+  s->tti       = tti; 
+  s->tx_enable = tx_enable; 
+  if (tx_enable) {
+    memcpy(s->buffer, buffer, sizeof(cf_t)*SRSLTE_MIN(nof_samples, MAX_SF_LEN));
+    s->nof_samples = SRSLTE_MIN(nof_samples, MAX_SF_LEN); 
+  }
+  __sync_synchronize();
+  if (__sync_bool_compare_and_swap(&s->state, SLOT_RESERVED, SLOT_READY)) {
+    wake_stamp();
+    futex_wake(&s->state, 1);
+  } else {
+    // Dropped by the TX thread while this worker was running, the slot is ours to release
+    s->state = SLOT_FREE; 
+  }
+}
+
+void phch_tx::reset()
+{
+  reset_pending = 1; 
+}
+
+uint32_t phch_tx::get_late()
+{
+  return __sync_lock_test_and_set(&nof_late, 0);
+}
+
+uint32_t phch_tx::get_overflow()
+{
+  return __sync_lock_test_and_set(&nof_overflow, 0);
+}
+
+// Waits for the worker of the slot or its deadline. Returns false if the deadline passed.
+bool phch_tx::wait_slot(slot_t *s)
+{
+  while (running) {
+    uint32_t state = s->state; 
+    if (state == SLOT_READY) {
+      return true; 
+    }
+    uint64_t now = now_ns();
+    if (now >= s->deadline_ns) {
+      return !__sync_bool_compare_and_swap(&s->state, SLOT_RESERVED, SLOT_DROPPED);
+    }
+    futex_wait_ns(&s->state, state, s->deadline_ns - now);
+    wake_sample();
+  }
+  return false; 
+}
+
+void phch_tx::tx_slot(slot_t *s)
+{
+  radio_h->set_tti(s->tti); 
+  if (s->tx_enable) {
+    radio_h->tx(s->buffer, s->nof_samples, s->tx_time);
+    is_first_of_burst = false; 
+  } else {
+    if (params_db->get_param(phy_interface_params::CONTINUOUS_TX)>0) {
+      if (!is_first_of_burst) {
+        radio_h->tx(zeros, s->nof_samples, s->tx_time);
+      }
+    } else {
+      if (!is_first_of_burst) {
+        radio_h->tx_end();
+        is_first_of_burst = true;   
+      }
+    }
+  }
+}
+
+// The worker of this subframe is still running. Keep the burst going with zeros or end it.
+void phch_tx::tx_late(slot_t *s)
+{
+  __sync_fetch_and_add(&nof_late, 1);
+  Warning("TX subframe %d late, %s\n", s->seq, 
+          params_db->get_param(phy_interface_params::CONTINUOUS_TX)>0 ? "zero-filled" : "dropped");
+  if (!is_first_of_burst) {
+    if (params_db->get_param(phy_interface_params::CONTINUOUS_TX)>0) {
+      radio_h->tx(zeros, s->nof_samples, s->tx_time);
+    } else {
+      radio_h->tx_end();
+      is_first_of_burst = true; 
+    }
+  }
+}
+
+void phch_tx::run_thread()
+{
+  while (running) {
+    if (reset_pending) {
+      reset_pending = 0; 
+      if (!is_first_of_burst) {
+        radio_h->tx_end();
+        is_first_of_burst = true; 
+      }
+    }
+    uint32_t reserved = reserved_seq; 
+    if (next_seq == reserved) {
+      // Nothing dispatched yet, wake at least once per TTI to check reset() and stop()
+      futex_wait_ns(&reserved_seq, reserved, 1000000);
+      wake_sample();
+      continue; 
+    }
+    slot_t *s = &slots[next_seq%NOF_SLOTS];
+    if (s->seq == next_seq) {
+      if (wait_slot(s)) {
+        tx_slot(s);
+        s->state = SLOT_FREE; 
+      } else if (running) {
+        tx_late(s);
+      }
+    }
+    next_seq++; 
+    update_usage();
+  }
+}
+
+} // namespace srsue
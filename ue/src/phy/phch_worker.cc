@@ -30,10 +30,16 @@
 #include "common/mac_interface.h"
 #include "common/phy_interface.h"
 
-#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) phy->log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) phy->log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) phy->log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) phy->log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(phy->log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(phy->log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(phy->log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(phy->log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+// Time kept in reserve for radio and scheduling jitter when capping turbo iterations
+#define PDSCH_ITS_MARGIN_NS 100000
+
+// With LAZY_PDSCH_FFT, one in this many subframes is fully estimated so that measurements stay fresh
+#define FULL_ESTIMATE_PERIOD 5
 
 
 namespace srsue {
@@ -45,10 +51,24 @@ phch_worker::phch_worker() : tr_exec(10240)
   
   cell_initiated  = false; 
   pregen_enabled  = false; 
+  pregen_valid    = false; 
   rar_cqi_request = false; 
   rnti_is_set     = false; 
+  crnti           = 0; 
   trace_enabled   = false; 
   cfi = 0;
+  ctrl_symbols = 0; 
+  stage_mask = 0; 
+  stage_t0   = 0; 
+  rx_ns      = 0; 
+  deadline_ns = 0; 
+  its_cost_ns[0] = 0; 
+  its_cost_ns[1] = 0; 
+  its_tail_ns    = 0; 
+  its_granted    = 0; 
+  its_capped     = false; 
+  last_noi       = 0; 
+  pdsch_end_ns   = 0; 
   
   bzero(&dl_metrics, sizeof(dl_metrics_t));
   bzero(&ul_metrics, sizeof(ul_metrics_t));
@@ -75,6 +95,10 @@ bool phch_worker::init_cell(srslte_cell_t cell_)
     Error("Initiating UE DL\n");
     return false; 
   }
+  if (srslte_softbuffer_rx_init(&softbuffer_tmp, cell.nof_prb)) {
+    Error("Initiating soft buffer\n");
+    return false; 
+  }
   
   if (srslte_ue_ul_init(&ue_ul, cell)) {  
     Error("Initiating UE UL\n");
@@ -83,12 +107,11 @@ bool phch_worker::init_cell(srslte_cell_t cell_)
   srslte_ue_ul_set_normalization(&ue_ul, true);
   srslte_ue_ul_set_cfo_enable(&ue_ul, true);
   
-  /* Set decoder iterations */
-  if (phy->params_db->get_param(phy_interface_params::PDSCH_MAX_ITS) > 0) {
-    srslte_sch_set_max_noi(&ue_dl.pdsch.dl_sch, phy->params_db->get_param(phy_interface_params::PDSCH_MAX_ITS));
-  }
+  /* Set decoder iterations, decode_pdsch() may lower them for late TTIs */
+  srslte_sch_set_max_noi(&ue_dl.pdsch.dl_sch, phy->params_db->get_param(phy_interface_params::PDSCH_MAX_ITS));
   
   cell_initiated = true; 
+  pregen_valid   = false; 
   
   snr = 0; 
   
@@ -103,6 +126,7 @@ void phch_worker::free_cell()
     }
     srslte_ue_dl_free(&ue_dl);
     srslte_ue_ul_free(&ue_ul);
+    srslte_softbuffer_rx_free(&softbuffer_tmp);
   }
 }
 
@@ -111,10 +135,19 @@ cf_t* phch_worker::get_buffer()
   return signal_buffer; 
 }
 
-void phch_worker::set_tti(uint32_t tti_, uint32_t tx_tti_)
+cf_t* phch_worker::swap_buffer(cf_t *buffer)
 {
-  tti    = tti_; 
-  tx_tti = tx_tti_;
+  cf_t *old = signal_buffer; 
+  signal_buffer = buffer; 
+  return old; 
+}
+
+void phch_worker::set_tti(uint32_t tti_, uint32_t tx_seq_, uint64_t rx_ns_, uint64_t deadline_ns_)
+{
+  tti         = tti_; 
+  tx_seq      = tx_seq_;
+  rx_ns       = rx_ns_;
+  deadline_ns = deadline_ns_; 
 }
 
 void phch_worker::set_cfo(float cfo_)
@@ -124,9 +157,69 @@ void phch_worker::set_cfo(float cfo_)
 
 void phch_worker::set_crnti(uint16_t rnti)
 {
-  srslte_ue_dl_set_rnti(&ue_dl, rnti);
-  srslte_ue_ul_set_rnti(&ue_ul, rnti);
+  // The sequences are the same in all the workers, the first one generates them for the others
+  signal_cache::key_t    key = signal_cache::crnti_key(cell.id, cell.nof_prb, cell.cp, rnti); 
+  signal_cache::entry_t *e   = phy->sig_cache ? phy->sig_cache->acquire(&key) : NULL; 
+  if (e && load_crnti_seqs(e, rnti)) {
+    Debug("C-RNTI 0x%x sequences found in cache\n", rnti);
+  } else {
+    srslte_ue_dl_set_rnti(&ue_dl, rnti);
+    srslte_ue_ul_set_rnti(&ue_ul, rnti);
+    if (phy->sig_cache && !e) {
+      store_crnti_seqs(&key);
+    }
+  }
+  if (e) {
+    phy->sig_cache->release(e);
+  }
   rnti_is_set = true; 
+  crnti       = rnti; 
+}
+
+/* Entry layout: the length of the 10 PDSCH and 10 PUSCH sequences, then their bits in the same order. 
+ * On a hit the rest of what srslte_ue_dl_set_rnti() and srslte_ue_ul_set_rnti() do is cheap and done here */
+bool phch_worker::load_crnti_seqs(signal_cache::entry_t *e, uint16_t rnti)
+{
+  uint32_t *lens = (uint32_t*) e->data; 
+  uint8_t  *bits = &e->data[2*SRSLTE_NSUBFRAMES_X_FRAME*sizeof(uint32_t)]; 
+  for (uint32_t i=0;i<2*SRSLTE_NSUBFRAMES_X_FRAME;i++) {
+    srslte_sequence_t *seq = i < SRSLTE_NSUBFRAMES_X_FRAME ? &ue_dl.pdsch.seq[i] : &ue_ul.pusch.seq[i-SRSLTE_NSUBFRAMES_X_FRAME]; 
+    if (srslte_sequence_init(seq, lens[i])) {
+      return false; 
+    }
+    memcpy(seq->c, bits, lens[i]);
+    bits += lens[i]; 
+  }
+  ue_dl.pdsch.rnti_is_set = true; 
+  ue_dl.pdsch.rnti        = rnti; 
+  ue_dl.current_rnti      = rnti; 
+  ue_ul.pusch.rnti_is_set = true; 
+  ue_ul.pusch.rnti        = rnti; 
+  ue_ul.current_rnti      = rnti; 
+  srslte_pucch_set_crnti(&ue_ul.pucch, rnti);
+  return true; 
+}
+
+void phch_worker::store_crnti_seqs(signal_cache::key_t *key)
+{
+  uint32_t nof_bytes = 2*SRSLTE_NSUBFRAMES_X_FRAME*sizeof(uint32_t); 
+  for (uint32_t i=0;i<SRSLTE_NSUBFRAMES_X_FRAME;i++) {
+    nof_bytes += ue_dl.pdsch.seq[i].len + ue_ul.pusch.seq[i].len; 
+  }
+  signal_cache::entry_t *e = phy->sig_cache->insert(key, nof_bytes); 
+  if (!e) {
+    return; 
+  }
+  uint32_t *lens = (uint32_t*) e->data; 
+  uint8_t  *bits = &e->data[2*SRSLTE_NSUBFRAMES_X_FRAME*sizeof(uint32_t)]; 
+  for (uint32_t i=0;i<2*SRSLTE_NSUBFRAMES_X_FRAME;i++) {
+    srslte_sequence_t *seq = i < SRSLTE_NSUBFRAMES_X_FRAME ? &ue_dl.pdsch.seq[i] : &ue_ul.pusch.seq[i-SRSLTE_NSUBFRAMES_X_FRAME]; 
+    lens[i] = seq->len; 
+    memcpy(bits, seq->c, seq->len);
+    bits += seq->len; 
+  }
+  phy->sig_cache->publish(e);
+  phy->sig_cache->release(e);
 }
 
 void phch_worker::work_imp()
@@ -142,6 +235,8 @@ void phch_worker::work_imp()
 #endif
 
   tr_log_start();
+  stage_mask = 0; 
+  stage_t0   = now_ns();
   
   reset_uci();
 
@@ -163,21 +258,30 @@ void phch_worker::work_imp()
     /***** Downlink Processing *******/
     
     /* PDCCH DL + PDSCH */
-    if(decode_pdcch_dl(&dl_mac_grant)) {
+    bool dl_grant_available = decode_pdcch_dl(&dl_mac_grant);
+    stage_end(PHY_STAGE_DL_DCI);
+    if(dl_grant_available) {
       /* Send grant to MAC and get action for this TB */
       phy->mac->new_grant_dl(dl_mac_grant, &dl_action);
+      stage_end(PHY_STAGE_MAC);
       
       /* Decode PDSCH if instructed to do so */
       dl_ack = dl_action.default_ack; 
       if (dl_action.decode_enabled) {
-        dl_ack = decode_pdsch(&dl_action.phy_grant.dl, dl_action.payload_ptr, 
-                              dl_action.softbuffer, dl_action.rv, dl_action.rnti, 
-                              dl_mac_grant.pid);              
+        if (extract_fft_data()) {
+          dl_ack = decode_pdsch(&dl_action.phy_grant.dl, dl_action.payload_ptr, 
+                                dl_action.softbuffer, dl_action.fx_softbuffer, dl_action.rv, dl_action.rnti, 
+                                dl_mac_grant.pid);              
+        } else {
+          dl_ack = false; 
+        }
+        stage_end(PHY_STAGE_PDSCH);
       }
       if (dl_action.generate_ack_callback && dl_action.decode_enabled) {
         phy->mac->tb_decoded(dl_ack, dl_mac_grant.rnti_type, dl_mac_grant.pid);
         dl_ack = dl_action.generate_ack_callback(dl_action.generate_ack_callback_arg);
         Info("Calling generate ACK callback returned=%d\n", dl_ack);
+        stage_end(PHY_STAGE_MAC);
       }
       if (dl_action.generate_ack) {
         set_uci_ack(dl_ack);
@@ -187,6 +291,7 @@ void phch_worker::work_imp()
     // Decode PHICH 
     bool ul_ack; 
     bool ul_ack_available = decode_phich(&ul_ack); 
+    stage_end(PHY_STAGE_PHICH);
     
     /***** Uplink Processing + Transmission *******/
     
@@ -199,14 +304,18 @@ void phch_worker::work_imp()
     
     /* Check if we have UL grant. ul_phy_grant will be overwritten by new grant */
     ul_grant_available = decode_pdcch_ul(&ul_mac_grant);   
+    stage_end(PHY_STAGE_UL_DCI);
     
     /* Send UL grant or HARQ information (from PHICH) to MAC */
     if (ul_grant_available         && ul_ack_available)  {    
       phy->mac->new_grant_ul_ack(ul_mac_grant, ul_ack, &ul_action);      
+      stage_end(PHY_STAGE_MAC);
     } else if (ul_grant_available  && !ul_ack_available) {
       phy->mac->new_grant_ul(ul_mac_grant, &ul_action);
+      stage_end(PHY_STAGE_MAC);
     } else if (!ul_grant_available && ul_ack_available)  {    
       phy->mac->harq_recv(tti, ul_ack, &ul_action);        
+      stage_end(PHY_STAGE_MAC);
     }
 
     /* Set UL CFO before transmission */  
@@ -230,40 +339,97 @@ void phch_worker::work_imp()
     encode_srs();
     signal_ready = true; 
   } 
+  stage_end(PHY_STAGE_UL_ENCODE);
 
   tr_log_end();
   
-  phy->worker_end(tx_tti, signal_ready, signal_buffer, SRSLTE_SF_LEN_PRB(cell.nof_prb), tx_time);
+  phy->worker_end(tx_seq, tti, signal_ready, signal_buffer, SRSLTE_SF_LEN_PRB(cell.nof_prb));
+  stage_end(PHY_STAGE_TX_WAIT);
+
+  // The UL subframe is handed to the TX thread, check against its deadline
+  int64_t slack_ns = (int64_t) (deadline_ns - stage_t0);
+  
+  if (its_granted) {
+    // Track the worst recent tail, decay slowly when it shrinks 
+    float tail = (float) (stage_t0 - pdsch_end_ns);
+    its_tail_ns = tail > its_tail_ns ? tail : its_tail_ns + (tail - its_tail_ns)/16; 
+    phy->add_pdsch_its(its_granted, last_noi, its_capped, slack_ns >= 0);
+    its_granted = 0; 
+  }
   
   if (dl_action.decode_enabled && !dl_action.generate_ack_callback) {
     phy->mac->tb_decoded(dl_ack, dl_mac_grant.rnti_type, dl_mac_grant.pid);
+    stage_end(PHY_STAGE_MAC);
   }
 
   update_measurements();
+  
+  if (rnti_is_set) {
+    uint64_t pdcch_ns = 0; 
+    for (int i=PHY_STAGE_FFT;i<=PHY_STAGE_UL_DCI;i++) {
+      if ((stage_mask & (1<<i)) && i != PHY_STAGE_PDSCH) {
+        pdcch_ns += stage_ns[i];
+      }
+    }
+    phy->add_drx_tti(phy->drx_active(tti), pdcch_ns);
+  }
+
+  stage_ns[PHY_STAGE_TOTAL] = now_ns() - rx_ns; 
+  stage_mask |= 1<<PHY_STAGE_TOTAL; 
+  phy->add_latency(stage_ns, stage_mask, slack_ns);
 }
 
 
 bool phch_worker::extract_fft_and_pdcch_llr() {
   bool decode_pdcch = false; 
-  if (phy->get_ul_rnti(tti) || phy->get_dl_rnti(tti) || phy->get_pending_rar(tti)) {
+  
+  /* RNTIs searched in this TTI, C-RNTI only in DRX active time */
+  dl_rnti = phy->get_dl_rnti(tti); 
+  ul_rnti = phy->get_ul_rnti(tti); 
+  if (ul_rnti || dl_rnti || phy->get_pending_rar(tti)) {
     decode_pdcch = true; 
   } 
   
   /* Without a grant, we might need to do fft processing if need to decode PHICH */
+  ctrl_symbols = 0; 
   if (phy->get_pending_ack(tti) || decode_pdcch) {
-    if (srslte_ue_dl_decode_fft_estimate(&ue_dl, signal_buffer, tti%10, &cfi) < 0) {
+    if (phy->params_db->get_param(phy_interface_params::LAZY_PDSCH_FFT) && 
+        ue_dl_ctrl::is_supported(&cell) && (tti%FULL_ESTIMATE_PERIOD) != 0) 
+    {
+      int n = ue_dl_ctrl::fft_estimate_ctrl(&ue_dl, signal_buffer, tti%10, &cfi); 
+      if (n < 0) {
+        Error("Getting PDCCH FFT estimate\n");
+        return false; 
+      }
+      ctrl_symbols = n; 
+    } else if (srslte_ue_dl_decode_fft_estimate(&ue_dl, signal_buffer, tti%10, &cfi) < 0) {
       Error("Getting PDCCH FFT estimate\n");
       return false; 
     }        
+    stage_end(PHY_STAGE_FFT);
   }
-  if (decode_pdcch) { /* and not in DRX mode */ 
+  if (decode_pdcch) {
     if (srslte_pdcch_extract_llr(&ue_dl.pdcch, ue_dl.sf_symbols, ue_dl.ce, 0, tti%10, cfi)) {
       Error("Extracting PDCCH LLR\n");
       return false; 
     }
+    stage_end(PHY_STAGE_PDCCH_LLR);
   }
   return (decode_pdcch || phy->get_pending_ack(tti));
 }
+
+/* Completes the FFT and channel estimate of subframes where only the control region was demodulated */
+bool phch_worker::extract_fft_data() {
+  if (ctrl_symbols) {
+    if (ue_dl_ctrl::fft_estimate_data(&ue_dl, signal_buffer, tti%10, ctrl_symbols) < 0) {
+      Error("Getting PDSCH FFT estimate\n");
+      return false; 
+    }
+    ctrl_symbols = 0; 
+    stage_end(PHY_STAGE_FFT);
+  }
+  return true; 
+}
   
 
 
@@ -280,7 +446,6 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
   char timestr[64];
   timestr[0]='\0';
 
-  dl_rnti = phy->get_dl_rnti(tti); 
   if (dl_rnti) {
     
     srslte_rnti_type_t type = phy->get_dl_rnti_type();
@@ -325,8 +490,8 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
   }
 }
 
-bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, 
-                               srslte_softbuffer_rx_t* softbuffer, uint32_t rv, uint16_t rnti, uint32_t harq_pid)
+bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, srslte_softbuffer_rx_t* softbuffer, 
+                               softbuffer_fx *fx_softbuffer, uint32_t rv, uint16_t rnti, uint32_t harq_pid)
 {
   char timestr[64];
   timestr[0]='\0';
@@ -344,20 +509,66 @@ bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload,
       gettimeofday(&t[1], NULL);
 #endif
       
-      bool ack = srslte_pdsch_decode_rnti(&ue_dl.pdsch, &ue_dl.pdsch_cfg, softbuffer, ue_dl.sf_symbols, 
-                                    ue_dl.ce, noise_estimate, rnti, payload) == 0;
+      bool     ack; 
+      uint32_t nof_cb  = ue_dl.pdsch_cfg.cb_segm.C; 
+      bool     par_ok  = phy->pdsch_dec && rnti_is_set && rnti == crnti && pdsch_par::is_supported(&cell, tti%10); 
+      // C-RNTI grants with 16-bit HARQ storage are demodulated and combined in int16
+      bool     fixed   = par_ok && fx_softbuffer && fx_softbuffer->get_nof_bits() == 16 && 
+                         phy->params_db->get_param(phy_interface_params::PDSCH_FIXED_POINT); 
+      // Large C-RNTI grants split their code blocks across the PDSCH helpers
+      bool     helpers = par_ok && (fixed || 
+                         grant->nof_prb >= (uint32_t) phy->params_db->get_param(phy_interface_params::PDSCH_HELPERS_MIN_PRB));
+      its_granted = pdsch_its_budget(nof_cb, helpers);
+      
+      uint64_t t0 = now_ns();
+      // Otherwise the HARQ soft bits kept in fixed point are combined in the worker softbuffer
+      if (fx_softbuffer && !fixed) {
+        if (fx_softbuffer->expand(&ue_dl.pdsch_cfg.cb_segm, &softbuffer_tmp)) {
+          Error("Error loading soft buffer of %d code blocks\n", nof_cb);
+          return false; 
+        }
+        softbuffer = &softbuffer_tmp; 
+      }
+      if (fixed) {
+        phy->pdsch_dec->set_max_its(get_id(), its_granted);
+        ack = phy->pdsch_dec->decode_fx(get_id(), &ue_dl.pdsch, &ue_dl.pdsch_cfg, fx_softbuffer, ue_dl.sf_symbols, 
+                                        ue_dl.ce[0], noise_estimate, payload) == 0;
+        last_noi = phy->pdsch_dec->last_noi(get_id());
+      } else if (helpers) {
+        phy->pdsch_dec->set_max_its(get_id(), its_granted);
+        ack = phy->pdsch_dec->decode(get_id(), &ue_dl.pdsch, &ue_dl.pdsch_cfg, softbuffer, ue_dl.sf_symbols, 
+                                     ue_dl.ce[0], noise_estimate, payload) == 0;
+        last_noi = phy->pdsch_dec->last_noi(get_id());
+      } else {
+        srslte_sch_set_max_noi(&ue_dl.pdsch.dl_sch, its_granted);
+        ack = srslte_pdsch_decode_rnti(&ue_dl.pdsch, &ue_dl.pdsch_cfg, softbuffer, ue_dl.sf_symbols, 
+                                       ue_dl.ce, noise_estimate, rnti, payload) == 0;
+        last_noi = srslte_pdsch_last_noi(&ue_dl.pdsch);
+      }
+      // Not needed once the TB is decoded, the next grant of this process is a new TB
+      if (fx_softbuffer && !fixed && !ack) {
+        fx_softbuffer->compress(&ue_dl.pdsch_cfg.cb_segm, &softbuffer_tmp);
+      }
+      pdsch_end_ns = now_ns(); 
+      
+      // Includes demodulation, so the cost per iteration errs on the high side. Capped TBs
+      // are left out, spreading that overhead over fewer iterations would feed back into the cap
+      if (nof_cb > 0 && last_noi > 0 && !its_capped) {
+        float cost = (float) (pdsch_end_ns - t0)/(last_noi*nof_cb); 
+        its_cost_ns[helpers] = its_cost_ns[helpers] ? its_cost_ns[helpers] + (cost - its_cost_ns[helpers])/8 : cost; 
+      }
 #ifdef LOG_EXECTIME
       gettimeofday(&t[2], NULL);
       get_time_interval(t);
       snprintf(timestr, 64, ", dec_time=%4d us", (int) t[0].tv_usec);
 #endif
       
-      Info("PDSCH: l_crb=%2d, harq=%d, tbs=%d, mcs=%d, rv=%d, crc=%s, snr=%.1f dB, n_iter=%d%s\n", 
+      Info("PDSCH: l_crb=%2d, harq=%d, tbs=%d, mcs=%d, rv=%d, crc=%s, snr=%.1f dB, n_iter=%.1f/%d%s\n", 
              grant->nof_prb, harq_pid, 
              grant->mcs.tbs/8, grant->mcs.idx, rv, 
              ack?"OK":"KO", 
              10*log10(srslte_chest_dl_get_snr(&ue_dl.chest)), 
-             srslte_pdsch_last_noi(&ue_dl.pdsch),
+             last_noi, its_granted, 
              timestr);
 
       // Store metrics
@@ -421,7 +632,6 @@ bool phch_worker::decode_pdcch_ul(mac_interface_phy::mac_grant_t* grant)
     rar_cqi_request = rar_grant.cqi_request;    
     ret = true;  
   } else {
-    ul_rnti = phy->get_ul_rnti(tti);
     if (ul_rnti) {
       if (srslte_ue_dl_find_ul_dci(&ue_dl, &dci_msg, cfi, tti%10, ul_rnti) != 1) {
         return false; 
@@ -537,11 +747,6 @@ bool phch_worker::srs_is_ready_to_send() {
   return false; 
 }
 
-void phch_worker::set_tx_time(srslte_timestamp_t _tx_time)
-{
-  memcpy(&tx_time, &_tx_time, sizeof(srslte_timestamp_t));
-}
-
 void phch_worker::encode_pusch(srslte_ra_ul_grant_t *grant, uint8_t *payload, uint32_t current_tx_nb, 
                                srslte_softbuffer_tx_t* softbuffer, uint32_t rv, uint16_t rnti, bool is_from_rar)
 {
@@ -759,9 +964,20 @@ void phch_worker::set_ul_params()
   I_sr                         = (uint32_t) phy->params_db->get_param(phy_interface_params::SR_CONFIG_INDEX);
   
 
+  // Reconfigurations that keep the DMRS and SRS configuration reuse the pregenerated signals
   if (pregen_enabled) { 
-    Info("Pre-generating UL signals\n");
-    srslte_ue_ul_pregen_signals(&ue_ul);
+    if (!pregen_valid || 
+        memcmp(&pregen_dmrs_cfg, &dmrs_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t)) || 
+        memcmp(&pregen_srs_cfg,  &srs_cfg,  sizeof(srslte_refsignal_srs_cfg_t))) 
+    {
+      Info("Pre-generating UL signals\n");
+      srslte_ue_ul_pregen_signals(&ue_ul);
+      memcpy(&pregen_dmrs_cfg, &dmrs_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+      memcpy(&pregen_srs_cfg,  &srs_cfg,  sizeof(srslte_refsignal_srs_cfg_t));
+      pregen_valid = true; 
+    } else {
+      Info("UL signals already pre-generated for this configuration\n");
+    }
   }  
 }
 
@@ -790,68 +1006,21 @@ float phch_worker::set_power(float tx_power) {
 
 /**************************** Measurements **************************/
 
+/* Raw linear measurements of this subframe go to the measurement thread, which filters them and 
+ * estimates the RX gain offset and the pathloss */
 void phch_worker::update_measurements() 
 {
-    /* Compute ADC/RX gain offset every 20 ms */
-  if ((tti%20) == 0 || phy->rx_gain_offset == 0) {
-    float rx_gain_offset = 0; 
-    if (phy->get_radio()->has_rssi()) {
-      float rssi_all_signal = srslte_chest_dl_get_rssi(&ue_dl.chest);          
-      if (rssi_all_signal) {
-        rx_gain_offset = 10*log10(rssi_all_signal)-phy->get_radio()->get_rssi();
-      } else {
-        rx_gain_offset = 0; 
-      }
-    } else {
-      if (phy->params_db->get_param(phy_interface_params::RX_GAIN_OFFSET) > 0) {
-        rx_gain_offset = (float) phy->params_db->get_param(phy_interface_params::RX_GAIN_OFFSET);
-      } else {
-        rx_gain_offset = phy->get_radio()->get_rx_gain();
-      }
-    }
-    if (phy->rx_gain_offset) {
-      phy->rx_gain_offset = SRSLTE_VEC_EMA(phy->rx_gain_offset, rx_gain_offset, 0.1);
-    } else {
-      phy->rx_gain_offset = rx_gain_offset; 
-    }
-  }
-  
-  // Adjust measurements with RX gain offset    
-  if (phy->rx_gain_offset) {
-    float rsrp = 10*log10(srslte_chest_dl_get_rsrp(&ue_dl.chest)) + 30 - phy->rx_gain_offset;
-    float rssi = 10*log10(srslte_chest_dl_get_rssi(&ue_dl.chest)) + 30 - phy->rx_gain_offset;
-    float rsrq = 10*log10(srslte_chest_dl_get_rsrq(&ue_dl.chest));
-
-    
-    // TODO: Send UE measurements to RRC where filtering is done. Now do filtering here
-    if (!phy->rsrp_filtered) {
-      phy->rsrp_filtered = rsrp;
-    } else {
-      uint32_t k = 4; // Set by RRC reconfiguration message
-      float coeff = pow(0.5,(float) k/4);
-      phy->rsrp_filtered = SRSLTE_VEC_EMA(phy->rsrp_filtered, rsrp, coeff);
-      if (isnan(phy->rsrp_filtered) || isinf(phy->rsrp_filtered)) {
-        phy->rsrp_filtered = 0; 
-      }
-    }    
-    // Compute PL
-    float tx_crs_power = (float) phy->params_db->get_param(phy_interface_params::PDSCH_RSPOWER);
-    phy->pathloss = tx_crs_power - phy->rsrp_filtered;
-
-    // Store metrics
-    dl_metrics.n      = srslte_chest_dl_get_noise_estimate(&ue_dl.chest);
-    dl_metrics.rsrp   = phy->rsrp_filtered;
-    dl_metrics.rsrq   = rsrq;
-    dl_metrics.rssi   = rssi;
-    dl_metrics.pathloss = phy->pathloss;
-    dl_metrics.sinr   = 10*log10(srslte_chest_dl_get_snr(&ue_dl.chest));
-    dl_metrics.turbo_iters = srslte_pdsch_last_noi(&ue_dl.pdsch);
-    phy->set_dl_metrics(dl_metrics);
-    
-    phy->set_ul_metrics(ul_metrics);
-
-  }
-
+  phch_meas::sample_t m; 
+  m.tti         = tti; 
+  m.rsrp        = srslte_chest_dl_get_rsrp(&ue_dl.chest);
+  m.rsrq        = srslte_chest_dl_get_rsrq(&ue_dl.chest);
+  m.rssi        = srslte_chest_dl_get_rssi(&ue_dl.chest);
+  m.noise       = srslte_chest_dl_get_noise_estimate(&ue_dl.chest);
+  m.snr         = srslte_chest_dl_get_snr(&ue_dl.chest);
+  m.turbo_iters = last_noi; 
+  m.dl_mcs      = dl_metrics.mcs; 
+  m.ul          = ul_metrics; 
+  phy->meas->push(m);
 }
 
 
@@ -886,5 +1055,34 @@ void phch_worker::tr_log_end()
   }
 }
 
+uint32_t phch_worker::pdsch_its_budget(uint32_t nof_cb, bool helpers)
+{
+  uint32_t max_its = phy->params_db->get_param(phy_interface_params::PDSCH_MAX_ITS);
+  its_capped = false; 
+  if (!phy->params_db->get_param(phy_interface_params::PDSCH_ADAPTIVE_ITS) || !its_cost_ns[helpers] || !nof_cb) {
+    return max_its; 
+  }
+  int64_t left_ns = (int64_t) (deadline_ns - now_ns()) - (int64_t) its_tail_ns - PDSCH_ITS_MARGIN_NS; 
+  int64_t its     = left_ns/(int64_t) (its_cost_ns[helpers]*nof_cb + 1); 
+  if (its >= max_its) {
+    return max_its; 
+  }
+  its_capped = true; 
+  Debug("PDSCH: %d us left, capping turbo decoder to %d iterations\n", (int) (left_ns/1000), its > 1 ? (int) its : 1);
+  return its > 1 ? its : 1; 
+}
+
+void phch_worker::stage_end(phy_stage_t stage)
+{
+  uint64_t t = now_ns(); 
+  if (stage_mask & (1<<stage)) {
+    stage_ns[stage] += t - stage_t0; 
+  } else {
+    stage_ns[stage] = t - stage_t0; 
+    stage_mask |= 1<<stage; 
+  }
+  stage_t0 = t; 
+}
+
 
 }
@@ -35,14 +35,15 @@
 #include "srslte/srslte.h"
 
 #include "common/threads.h"
+#include "common/thread_affinity.h"
 #include "common/log.h"
 #include "phy/phy.h"
 #include "phy/phch_worker.h"
 
-#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 
 
@@ -53,7 +54,7 @@ namespace srsue {
 
 phy::phy() : workers_pool(MAX_WORKERS), 
              workers(MAX_WORKERS), 
-             workers_common(phch_recv::MUTEX_X_WORKER*MAX_WORKERS)
+             pdsch_helpers(MAX_WORKERS)
 {
 }
 
@@ -73,19 +74,88 @@ bool phy::init_(srslte::radio* radio_handler_, mac_interface_phy *mac, srslte::l
   
   log_h = log_h_; 
   radio_handler = radio_handler_;
-  nof_workers = nof_workers_; 
+  nof_workers = nof_workers_ < MAX_WORKERS ? nof_workers_ : MAX_WORKERS; 
+
+  /* With scaling, all MAX_WORKERS workers are started and initialize the cell whatever nof_workers_ is, 
+   * which becomes the number active at first */
+  bool scaling = params_db.get_param(phy_interface_params::WORKERS_SCALING) > 0;
+  if (scaling) {
+    nof_workers = MAX_WORKERS; 
+  }
+
+  // Workers scale their per-TTI turbo iteration cap down from this value
+  if (params_db.get_param(phy_interface_params::PDSCH_MAX_ITS) <= 0) {
+    params_db.set_param(phy_interface_params::PDSCH_MAX_ITS, DEFAULT_PDSCH_MAX_ITS);
+  }
+  // Until RRC configures it
+  params_db.set_param(phy_interface_params::MEAS_FILTER_COEFF, DEFAULT_MEAS_FILTER_COEFF);
   
   // Add workers to workers pool and start threads
+  if (params_db.get_param(phy_interface_params::WORKERS_SPIN_US) > 0) {
+    workers_pool.set_handoff_mode(srslte::thread_pool::HANDOFF_SPIN, 
+                                  params_db.get_param(phy_interface_params::WORKERS_SPIN_US));
+  }
   for (int i=0;i<nof_workers;i++) {
     workers[i].set_common(&workers_common);
     workers_pool.init_worker(i, &workers[i], WORKERS_THREAD_PRIO);    
+    std::stringstream name;
+    name << "PHY_WORKER" << i;
+    srsue::thread_affinity::get_instance()->add(&workers[i], "phy_worker", name.str(), WORKERS_THREAD_PRIO);
+  }
+  if (scaling) {
+    workers_scaler.init(MIN_WORKERS, MAX_WORKERS, nof_workers_);
+    workers_pool.set_nof_active(workers_scaler.get_nof_workers());
+    workers_common.scaler = &workers_scaler; 
   }
 
-  prach_buffer.init(&params_db, log_h);
-  workers_common.init(&params_db, log_h, radio_handler, mac);
+  /* Optional helper threads shared by all workers to decode PDSCH code blocks. The fixed-point 
+   * path also goes through pdsch_dec, without helpers its code blocks run in the worker */
+  uint32_t nof_helpers = params_db.get_param(phy_interface_params::PDSCH_HELPERS) > 0 ? 
+                         params_db.get_param(phy_interface_params::PDSCH_HELPERS) : 0; 
+  if (nof_helpers > 0 || params_db.get_param(phy_interface_params::PDSCH_FIXED_POINT)) {
+    if ((nof_helpers == 0 || pdsch_helpers.init(nof_helpers, WORKERS_THREAD_PRIO)) && 
+        pdsch_dec.init(&pdsch_helpers, log_h, nof_workers, params_db.get_param(phy_interface_params::PDSCH_MAX_ITS))) 
+    {
+      for (uint32_t i=0;i<nof_helpers;i++) {
+        std::stringstream name;
+        name << "PHY_HELPER" << i;
+        srsue::thread_affinity::get_instance()->add(pdsch_helpers.get_helper(i), "phy_helper", name.str(), WORKERS_THREAD_PRIO);
+      }
+      workers_common.pdsch_dec = &pdsch_dec; 
+      if (params_db.get_param(phy_interface_params::PDSCH_FIXED_POINT)) {
+        log_h->console("PDSCH fixed-point kernels: %s\n", pdsch_fx::isa_string(pdsch_dec.get_fx_isa()));
+      }
+    } else {
+      log_error(log_h, "Error initiating %d PDSCH helpers, decoding in the workers\n", nof_helpers);
+      pdsch_helpers.stop();
+    }
+  }
+
+  // Precomputed signals survive cell changes and reattachments, up to the cap
+  int64_t cache_mb = params_db.get_param(phy_interface_params::SIGNAL_CACHE_MB); 
+  if (cache_mb > 0) {
+    sig_cache.set_max_bytes((uint64_t) cache_mb*1024*1024);
+    workers_common.sig_cache = &sig_cache; 
+  }
+  prach_buffer.init(&params_db, log_h, cache_mb > 0 ? &sig_cache : NULL);
+  if (!tx_thread.init(radio_handler, &params_db, log_h, TX_THREAD_PRIO)) {
+    log_h->console("Error starting PHY TX thread\n");
+    return false; 
+  }
+  srsue::thread_affinity::get_instance()->add(&tx_thread, "phy_tx", "PHY_TX", TX_THREAD_PRIO);
+  workers_common.init(&params_db, log_h, radio_handler, mac, &tx_thread);
+  
+  // Measurement filtering, gain offset and pathloss off the workers
+  if (!meas_thread.init(&workers_common, radio_handler, &params_db, log_h, MEAS_THREAD_PRIO)) {
+    log_h->console("Error starting PHY measurement thread\n");
+    return false; 
+  }
+  srsue::thread_affinity::get_instance()->add(&meas_thread, "phy_meas", "PHY_MEAS", MEAS_THREAD_PRIO);
+  workers_common.meas = &meas_thread; 
   
   // Warning this must be initialized after all workers have been added to the pool
   sf_recv.init(radio_handler, mac, &prach_buffer, &workers_pool, &workers_common, log_h, do_agc, SF_RECV_THREAD_PRIO);
+  srsue::thread_affinity::get_instance()->add(&sf_recv, "sync", "PHY_SYNC", SF_RECV_THREAD_PRIO);
 
   return true; 
 }
@@ -105,16 +175,35 @@ void phy::write_trace(std::string filename)
   }
 }
 
+void phy::set_frequencies(const std::vector<float> &dl_freq, const std::vector<float> &ul_freq)
+{
+  sf_recv.set_frequencies(dl_freq, ul_freq);
+}
+
+void phy::set_cell_cache(std::string filename)
+{
+  sf_recv.set_cell_cache(filename);
+}
+
+void phy::print_latency(FILE *f)
+{
+  workers_common.print_latency(f);
+}
+
 void phy::stop()
 {  
   sf_recv.stop();
   workers_pool.stop();
+  pdsch_helpers.stop();
+  tx_thread.stop();
+  meas_thread.stop();
 }
 
 void phy::get_metrics(phy_metrics_t &m) {
   workers_common.get_dl_metrics(m.dl);
   workers_common.get_ul_metrics(m.ul);
   workers_common.get_sync_metrics(m.sync);
+  workers_common.get_latency_metrics(m.latency);
   m.mabr = srslte_ra_tbs_from_idx(srslte_ra_tbs_idx_from_mcs(m.dl.mcs), workers_common.get_nof_prb());
 
   // Estimate IP-layer MABR as 75% of MAC-layer MABR
@@ -191,6 +280,18 @@ void phy::pdcch_ul_search_reset()
   workers_common.set_ul_rnti(SRSLTE_RNTI_USER, 0);
 }
 
+/* Workers run up to nof_workers-1 subframes ahead of the one whose PDCCH restarts a DRX timer, 
+ * so the active time is extended by as many subframes */
+void phy::drx_set_cycle(uint32_t cycle, uint32_t offset, uint32_t on_duration)
+{
+  workers_common.drx_set_cycle(cycle, offset, on_duration + nof_workers - 1);
+}
+
+void phy::drx_set_active_until(uint32_t tti)
+{
+  workers_common.drx_set_active_until((tti + nof_workers - 1)%10240);
+}
+
 void phy::get_current_cell(srslte_cell_t *cell)
 {
   sf_recv.get_current_cell(cell);
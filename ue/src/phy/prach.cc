@@ -34,10 +34,10 @@
 #include "phy/phy.h"
 #include "common/phy_interface.h"
 
-#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, ERROR, error_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, WARNING, warning_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, INFO, info_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) SRSUE_LOG(log_h, DEBUG, debug_line, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
 namespace srsue {
  
@@ -45,54 +45,89 @@ namespace srsue {
 void prach::free_cell() 
 {
   if (initiated) {
+    if (signal_buffer) {
+      free(signal_buffer);
+    }
+    srslte_cfo_free(&cfo_h);
+  }
+  if (cached) {
+    cache->release(cached);
+    cached = NULL; 
+  } else {
     for (int i=0;i<64;i++) {
       if (buffer[i]) {
         free(buffer[i]);    
       }      
     }
-    if (signal_buffer) {
-      free(signal_buffer);
-    }
-    srslte_cfo_free(&cfo_h);
+  }
+  bzero(buffer, sizeof(buffer));
+  if (prach_initiated) {
     srslte_prach_free(&prach_obj);
+    prach_initiated = false; 
   }
+  signal_buffer = NULL; 
+  initiated     = false; 
 }
 
-void prach::init(phy_params* params_db_, srslte::log* log_h_)
+void prach::init(phy_params* params_db_, srslte::log* log_h_, signal_cache *cache_)
 {
   log_h = log_h_; 
   params_db = params_db_; 
+  cache = cache_; 
 }
 
 bool prach::init_cell(srslte_cell_t cell_)
 {
+  // Called again on every PRACH reconfiguration
+  free_cell();
+  
   cell = cell_; 
   preamble_idx = -1; 
 
-  Info("ConfigIdx=%d, RootSeq=%d, ZC=%d\n", 
-       params_db->get_param(phy_interface_params::PRACH_CONFIG_INDEX),     
-       params_db->get_param(phy_interface_params::PRACH_ROOT_SEQ_IDX),     
-       params_db->get_param(phy_interface_params::PRACH_ZC_CONFIG));
+  uint32_t config_idx  = params_db->get_param(phy_interface_params::PRACH_CONFIG_INDEX); 
+  uint32_t root_seq    = params_db->get_param(phy_interface_params::PRACH_ROOT_SEQ_IDX); 
+  bool     high_speed  = params_db->get_param(phy_interface_params::PRACH_HIGH_SPEED_FLAG)?true:false; 
+  uint32_t zc_config   = params_db->get_param(phy_interface_params::PRACH_ZC_CONFIG); 
+  uint32_t freq_offset = params_db->get_param(phy_interface_params::PRACH_FREQ_OFFSET); 
+
+  Info("ConfigIdx=%d, RootSeq=%d, ZC=%d\n", config_idx, root_seq, zc_config);
   
-  if (srslte_prach_init(&prach_obj, srslte_symbol_sz(cell.nof_prb), 
-                        srslte_prach_get_preamble_format(params_db->get_param(phy_interface_params::PRACH_CONFIG_INDEX)), 
-                        params_db->get_param(phy_interface_params::PRACH_ROOT_SEQ_IDX), 
-                        params_db->get_param(phy_interface_params::PRACH_HIGH_SPEED_FLAG)?true:false, 
-                        params_db->get_param(phy_interface_params::PRACH_ZC_CONFIG))) 
-  {
-    Error("Initiating PRACH library\n");
-    return false; 
+  // The preambles only depend on the bandwidth and the PRACH configuration, not on the cell ID
+  signal_cache::key_t key = signal_cache::prach_key(cell.nof_prb, config_idx, high_speed, zc_config, freq_offset, root_seq); 
+  if (cache) {
+    cached = cache->acquire(&key);
   }
-  
-  len = prach_obj.N_seq + prach_obj.N_cp;
-  for (int i=0;i<64;i++) {
-    buffer[i] = (cf_t*) srslte_vec_malloc(len*sizeof(cf_t));
-    if(!buffer[i]) {
+  if (cached) {
+    len = cached->nof_bytes/(64*sizeof(cf_t));
+    for (int i=0;i<64;i++) {
+      buffer[i] = &((cf_t*) cached->data)[i*len];
+    }
+    Info("PRACH preambles found in cache\n");
+  } else {
+    if (srslte_prach_init(&prach_obj, srslte_symbol_sz(cell.nof_prb), 
+                          srslte_prach_get_preamble_format(config_idx), root_seq, high_speed, zc_config)) 
+    {
+      Error("Initiating PRACH library\n");
       return false; 
-    }    
-    if(srslte_prach_gen(&prach_obj, i, params_db->get_param(phy_interface_params::PRACH_FREQ_OFFSET), buffer[i])) {
-      Error("Generating PRACH preamble %d\n", i);
-      return false;
+    }
+    prach_initiated = true; 
+    
+    len = prach_obj.N_seq + prach_obj.N_cp;
+    if (cache) {
+      cached = cache->insert(&key, 64*len*sizeof(cf_t));
+    }
+    for (int i=0;i<64;i++) {
+      buffer[i] = cached ? &((cf_t*) cached->data)[i*len] : (cf_t*) srslte_vec_malloc(len*sizeof(cf_t));
+      if(!buffer[i]) {
+        return false; 
+      }    
+      if(srslte_prach_gen(&prach_obj, i, freq_offset, buffer[i])) {
+        Error("Generating PRACH preamble %d\n", i);
+        return false;
+      }
+    }
+    if (cached) {
+      cache->publish(cached);
     }
   }
   srslte_cfo_init(&cfo_h, len);
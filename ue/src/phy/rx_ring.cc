@@ -0,0 +1,112 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "phy/rx_ring.h"
+
+namespace srsue {
+
+rx_ring::rx_ring()
+{
+  head        = 0; 
+  nof_pending = 0; 
+}
+
+rx_ring::~rx_ring()
+{
+  free_buffers();
+}
+
+bool rx_ring::init(uint32_t nof_slots, uint32_t buffer_len)
+{
+  free_buffers();
+  slots.resize(nof_slots);
+  for (uint32_t i=0;i<nof_slots;i++) {
+    bzero(&slots[i], sizeof(slot_t));
+    slots[i].buffer = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*buffer_len);
+    if (!slots[i].buffer) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
+void rx_ring::free_buffers()
+{
+  for (uint32_t i=0;i<slots.size();i++) {
+    if (slots[i].buffer) {
+      free(slots[i].buffer);
+    }
+  }
+  slots.clear();
+  head        = 0; 
+  nof_pending = 0; 
+}
+
+uint32_t rx_ring::get_nof_slots()
+{
+  return slots.size(); 
+}
+
+uint32_t rx_ring::get_nof_pending()
+{
+  return nof_pending; 
+}
+
+bool rx_ring::is_full()
+{
+  return nof_pending == slots.size(); 
+}
+
+rx_ring::slot_t* rx_ring::next()
+{
+  if (is_full()) {
+    return NULL; 
+  }
+  return &slots[(head + nof_pending)%slots.size()];
+}
+
+void rx_ring::push()
+{
+  if (!is_full()) {
+    nof_pending++; 
+  }
+}
+
+rx_ring::slot_t* rx_ring::front()
+{
+  return nof_pending ? &slots[head] : NULL; 
+}
+
+void rx_ring::pop()
+{
+  if (nof_pending) {
+    head = (head + 1)%slots.size(); 
+    nof_pending--; 
+  }
+}
+
+} // namespace srsue
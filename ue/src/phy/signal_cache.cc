@@ -0,0 +1,225 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "srslte/srslte.h"
+#include "phy/signal_cache.h"
+
+namespace srsue {
+
+signal_cache::signal_cache()
+{
+  max_bytes   = 0; 
+  nof_bytes   = 0; 
+  nof_hits    = 0; 
+  nof_misses  = 0; 
+  nof_evicted = 0; 
+  pthread_mutex_init(&mutex, NULL);
+}
+
+signal_cache::~signal_cache()
+{
+  for (map_t::iterator it=entries.begin();it!=entries.end();it++) {
+    free(it->second->data);
+    delete it->second; 
+  }
+  pthread_mutex_destroy(&mutex);
+}
+
+bool signal_cache::key_cmp::operator()(const key_t &a, const key_t &b) const
+{
+  return memcmp(&a, &b, sizeof(key_t)) < 0; 
+}
+
+signal_cache::key_t signal_cache::prach_key(uint32_t nof_prb, uint32_t config_idx, bool high_speed, uint32_t zc_config, 
+                                            uint32_t freq_offset, uint32_t root_seq)
+{
+  key_t key; 
+  bzero(&key, sizeof(key_t));
+  key.type         = PRACH_PREAMBLES; 
+  key.nof_prb      = nof_prb; 
+  key.prach_config = (config_idx&0x3f) | (high_speed?0x40:0) | ((zc_config&0xf)<<8) | ((freq_offset&0xff)<<16); 
+  key.root_seq     = root_seq; 
+  return key; 
+}
+
+signal_cache::key_t signal_cache::crnti_key(uint32_t cell_id, uint32_t nof_prb, uint32_t cp, uint16_t rnti)
+{
+  key_t key; 
+  bzero(&key, sizeof(key_t));
+  key.type    = CRNTI_SEQUENCES; 
+  key.cell_id = cell_id; 
+  key.nof_prb = nof_prb; 
+  key.cp      = cp; 
+  key.rnti    = rnti; 
+  return key; 
+}
+
+void signal_cache::set_max_bytes(uint64_t max_bytes_)
+{
+  pthread_mutex_lock(&mutex);
+  max_bytes = max_bytes_; 
+  evict(0);
+  pthread_mutex_unlock(&mutex);
+}
+
+signal_cache::entry_t* signal_cache::acquire(key_t *key)
+{
+  entry_t *e = NULL; 
+  pthread_mutex_lock(&mutex);
+  map_t::iterator it = entries.find(*key);
+  if (it != entries.end() && it->second->ready) {
+    e = it->second; 
+    e->refs++; 
+    lru.remove(e);
+    lru.push_front(e);
+    nof_hits++; 
+  } else {
+    nof_misses++; 
+  }
+  pthread_mutex_unlock(&mutex);
+  return e; 
+}
+
+signal_cache::entry_t* signal_cache::insert(key_t *key, uint32_t nof_bytes_)
+{
+  entry_t *e = NULL; 
+  pthread_mutex_lock(&mutex);
+  if (entries.find(*key) == entries.end() && evict(nof_bytes_)) {
+    uint8_t *data = (uint8_t*) srslte_vec_malloc(nof_bytes_);
+    if (data) {
+      e = new entry_t; 
+      e->key       = *key; 
+      e->data      = data; 
+      e->nof_bytes = nof_bytes_; 
+      e->refs      = 1; 
+      e->ready     = false; 
+      entries[*key] = e; 
+      lru.push_front(e);
+      nof_bytes += nof_bytes_; 
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+  return e; 
+}
+
+void signal_cache::publish(entry_t *e)
+{
+  pthread_mutex_lock(&mutex);
+  e->ready = true; 
+  pthread_mutex_unlock(&mutex);
+}
+
+void signal_cache::release(entry_t *e)
+{
+  pthread_mutex_lock(&mutex);
+  if (e->refs > 0) {
+    e->refs--; 
+  }
+  // Entries dropped while being filled are not kept
+  if (!e->refs && !e->ready) {
+    map_t::iterator it = entries.find(e->key);
+    if (it != entries.end()) {
+      remove(it);
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void signal_cache::clear()
+{
+  pthread_mutex_lock(&mutex);
+  map_t::iterator it = entries.begin(); 
+  while (it != entries.end()) {
+    map_t::iterator next = it; 
+    next++; 
+    if (!it->second->refs) {
+      remove(it);
+      nof_evicted++; 
+    }
+    it = next; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+// Makes room for nof_bytes_ more, least recently used first. Called with the mutex locked
+bool signal_cache::evict(uint64_t nof_bytes_)
+{
+  if (nof_bytes_ > max_bytes) {
+    return false; 
+  }
+  std::list<entry_t*>::iterator it = lru.end(); 
+  while (nof_bytes + nof_bytes_ > max_bytes && it != lru.begin()) {
+    it--; 
+    entry_t *e = *it; 
+    if (!e->refs) {
+      it = lru.erase(it);
+      nof_bytes -= e->nof_bytes; 
+      entries.erase(e->key);
+      free(e->data);
+      delete e; 
+      nof_evicted++; 
+    }
+  }
+  return nof_bytes + nof_bytes_ <= max_bytes; 
+}
+
+void signal_cache::remove(map_t::iterator it)
+{
+  entry_t *e = it->second; 
+  lru.remove(e);
+  nof_bytes -= e->nof_bytes; 
+  entries.erase(it);
+  free(e->data);
+  delete e; 
+}
+
+uint64_t signal_cache::get_nof_bytes()
+{
+  return nof_bytes; 
+}
+
+uint32_t signal_cache::get_nof_entries()
+{
+  return entries.size(); 
+}
+
+uint32_t signal_cache::get_nof_hits()
+{
+  return nof_hits; 
+}
+
+uint32_t signal_cache::get_nof_misses()
+{
+  return nof_misses; 
+}
+
+uint32_t signal_cache::get_nof_evicted()
+{
+  return nof_evicted; 
+}
+
+} // namespace srsue
@@ -0,0 +1,135 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "phy/ue_dl_ctrl.h"
+
+namespace srsue {
+
+bool ue_dl_ctrl::is_supported(srslte_cell_t *cell)
+{
+  return cell->nof_ports <= 2; 
+}
+
+int ue_dl_ctrl::fft_estimate_ctrl(srslte_ue_dl_t *q, cf_t *input, uint32_t sf_idx, uint32_t *cfi)
+{
+  uint32_t nof_re = SRSLTE_NRE*q->cell.nof_prb; 
+  float    cfi_corr; 
+  
+  fft_symbols(q, input, 0, 1);
+  float noise_estimate = estimate_symbol0(q, sf_idx); 
+  
+  if (srslte_pcfich_decode(&q->pcfich, q->sf_symbols, q->ce, noise_estimate, sf_idx, cfi, &cfi_corr) < 0) {
+    fprintf(stderr, "Error decoding PCFICH\n");
+    return -1; 
+  }
+  if (srslte_regs_set_cfi(&q->regs, *cfi)) {
+    fprintf(stderr, "Error setting CFI\n");
+    return -1; 
+  }
+  
+  // PDCCH spans one more symbol in narrow cells, PHICH extended duration always 3 
+  uint32_t nof_symbols = q->cell.nof_prb <= 10 ? *cfi+1 : *cfi; 
+  if (q->cell.phich_length == SRSLTE_PHICH_EXT && nof_symbols < 3) {
+    nof_symbols = 3; 
+  }
+  
+  fft_symbols(q, input, 1, nof_symbols);
+  for (uint32_t p=0;p<q->cell.nof_ports;p++) {
+    for (uint32_t l=1;l<nof_symbols;l++) {
+      memcpy(&q->ce[p][l*nof_re], q->ce[p], nof_re*sizeof(cf_t));
+    }
+  }
+  return nof_symbols; 
+}
+
+int ue_dl_ctrl::fft_estimate_data(srslte_ue_dl_t *q, cf_t *input, uint32_t sf_idx, uint32_t nof_symbols)
+{
+  fft_symbols(q, input, nof_symbols, 2*SRSLTE_CP_NSYMB(q->cell.cp));
+  if (srslte_chest_dl_estimate(&q->chest, q->sf_symbols, q->ce, sf_idx) < 0) {
+    return -1; 
+  }
+  return 0; 
+}
+
+// Same as srslte_ofdm_rx_sf() restricted to symbols l0 to l1-1 of the subframe 
+void ue_dl_ctrl::fft_symbols(srslte_ue_dl_t *q, cf_t *input, uint32_t l0, uint32_t l1)
+{
+  srslte_ofdm_t *fft   = &q->fft; 
+  uint32_t       nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  
+  for (uint32_t l=l0;l<l1;l++) {
+    uint32_t i  = l%nsymb; 
+    cf_t    *in = &input[(l/nsymb)*fft->slot_sz + i*fft->symbol_sz]; 
+    for (uint32_t j=0;j<=i;j++) {
+      in += SRSLTE_CP_ISNORM(q->cell.cp)?SRSLTE_CP_LEN_NORM(j, fft->symbol_sz):SRSLTE_CP_LEN_EXT(fft->symbol_sz);
+    }
+    srslte_dft_run_c(&fft->fft_plan, in, fft->tmp);
+    memcpy(&q->sf_symbols[l*fft->nof_re], &fft->tmp[fft->nof_guards], fft->nof_re*sizeof(cf_t));
+  }
+}
+
+/* Least squares estimate at the symbol 0 CRS of each port, linearly interpolated in frequency 
+ * and held flat beyond the outermost pilots. Returns the noise estimate. 
+ */
+float ue_dl_ctrl::estimate_symbol0(srslte_ue_dl_t *q, uint32_t sf_idx)
+{
+  cf_t     h[2*SRSLTE_MAX_PRB]; 
+  uint32_t nof_ref   = 2*q->cell.nof_prb; 
+  uint32_t nof_re    = SRSLTE_NRE*q->cell.nof_prb; 
+  uint32_t nof_ports = q->cell.nof_ports < 2 ? q->cell.nof_ports : 2; 
+  float    noise     = 0; 
+  
+  for (uint32_t p=0;p<nof_ports;p++) {
+    cf_t    *pilots = q->chest.csr_signal.pilots[p/2][sf_idx]; 
+    uint32_t v      = ((p==0?0:3) + q->cell.id)%6; 
+    cf_t    *ce     = q->ce[p]; 
+    
+    for (uint32_t m=0;m<nof_ref;m++) {
+      h[m] = q->sf_symbols[6*m+v]/pilots[m];
+    }
+    for (uint32_t k=0;k<v;k++) {
+      ce[k] = h[0];
+    }
+    for (uint32_t m=0;m<nof_ref-1;m++) {
+      for (uint32_t j=0;j<6;j++) {
+        ce[6*m+v+j] = h[m] + (h[m+1]-h[m])*((float) j/6);
+      }
+    }
+    for (uint32_t k=6*(nof_ref-1)+v;k<nof_re;k++) {
+      ce[k] = h[nof_ref-1];
+    }
+    
+    // Pilots are 6 subcarriers apart, the channel is close to linear between neighbours 
+    for (uint32_t m=1;m<nof_ref-1;m++) {
+      cf_t d = h[m] - (h[m-1]+h[m+1])/2; 
+      noise += __real__ d*__real__ d + __imag__ d*__imag__ d; 
+    }
+  }
+  return noise/(1.5*nof_ports*(nof_ref-2)); 
+}
+
+} // namespace srsue
@@ -0,0 +1,139 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include "phy/worker_scaler.h"
+
+namespace srsue {
+
+worker_scaler::worker_scaler()
+{
+  init(1, 1, 1);
+}
+
+void worker_scaler::init(uint32_t min_workers_, uint32_t max_workers_, uint32_t nof_workers_)
+{
+  min_workers = min_workers_ > 0 ? min_workers_ : 1;
+  max_workers = max_workers_ > min_workers ? max_workers_ : min_workers;
+  nof_workers = nof_workers_;
+  if (nof_workers < min_workers) {
+    nof_workers = min_workers;
+  }
+  if (nof_workers > max_workers) {
+    nof_workers = max_workers;
+  }
+  for (uint32_t i=0;i<WINDOW;i++) {
+    busy_us[i] = 0;
+  }
+  wr_idx  = 0;
+  tti_cnt = 0;
+  hold    = WINDOW;
+}
+
+void worker_scaler::add_tti(uint64_t busy_ns)
+{
+  uint32_t idx = __sync_fetch_and_add(&wr_idx, 1)%WINDOW;
+  busy_us[idx] = (uint32_t) (busy_ns/1000);
+}
+
+uint32_t worker_scaler::get_nof_workers()
+{
+  return nof_workers;
+}
+
+uint32_t worker_scaler::workers_needed(uint32_t busy_us)
+{
+  return 1 + (busy_us + MARGIN_US + 999)/1000;
+}
+
+/* The UL subframe of a TTI is transmitted 3 ms after the subframe is received, minus the time 
+ * advance. A subframe processed for longer misses it, so no more than that many can be in 
+ * processing at once, plus the one being received */
+uint32_t worker_scaler::workers_max(float time_adv_sec)
+{
+  int32_t deadline_us = 3000 - (int32_t) (time_adv_sec*1e6);
+  uint32_t depth = deadline_us > 0 ? 1 + (deadline_us + 999)/1000 : 1;
+  if (depth > max_workers) {
+    depth = max_workers;
+  }
+  return depth > min_workers ? depth : min_workers;
+}
+
+// Largest processing time of the last nof_tti TTIs
+uint32_t worker_scaler::max_busy_us(uint32_t nof_tti)
+{
+  uint32_t wr  = wr_idx;
+  uint32_t n   = nof_tti < wr ? nof_tti : wr;
+  uint32_t max = 0;
+  for (uint32_t i=0;i<n;i++) {
+    uint32_t t = busy_us[(wr - 1 - i)%WINDOW];
+    if (t > max) {
+      max = t;
+    }
+  }
+  return max;
+}
+
+uint32_t worker_scaler::step(float time_adv_sec, uint64_t wait_ns)
+{
+  uint32_t cap = workers_max(time_adv_sec);
+  if (nof_workers > cap) {
+    nof_workers = cap;
+  }
+  tti_cnt++;
+  if (hold > 0) {
+    hold--;
+  }
+
+  // Samples are piling up in the radio, do not wait for the window to show it
+  if (wait_ns > STARVED_NS) {
+    if (nof_workers < cap) {
+      nof_workers++;
+    }
+    hold    = STARVED_HOLD*WINDOW;
+    tti_cnt = 0; 
+    return nof_workers;
+  }
+
+  if (tti_cnt < EVAL_PERIOD) {
+    return nof_workers;
+  }
+  tti_cnt = 0;
+
+  uint32_t n = workers_needed(max_busy_us(EVAL_PERIOD));
+  if (n > nof_workers) {
+    nof_workers = n < cap ? n : cap;
+    hold        = WINDOW;
+  } else if (hold == 0 && nof_workers > min_workers && 
+             workers_needed(max_busy_us(WINDOW)) < nof_workers) 
+  {
+    nof_workers--;
+    hold = WINDOW;
+  }
+  return nof_workers;
+}
+
+} // namespace srsue
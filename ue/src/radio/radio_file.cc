@@ -0,0 +1,369 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "srslte/srslte.h"
+#include "radio/radio_file.h"
+
+namespace srslte {
+
+radio_file::radio_file()
+{
+  rx_map         = NULL; 
+  rx_map_len     = 0; 
+  rx_nof_samples = 0; 
+  rx_pos         = 0; 
+  rx_total       = 0; 
+  format         = RADIO_FILE_FC32;
+  loop           = false; 
+  realtime       = false; 
+  eof            = false; 
+  file_srate     = 0; 
+  rx_srate       = 1.92e6;
+  tx_srate       = 1.92e6;
+  decim          = 1; 
+  pace_start     = 0; 
+  pace_secs      = 0; 
+  tx_file        = NULL; 
+  in_burst       = false; 
+  rx_gain        = 0; 
+  tx_gain        = 0; 
+  tti            = 0; 
+  offset         = 0; 
+  sf_len         = 0; 
+  bzero(&rx_time, sizeof(srslte_timestamp_t));
+  bzero(&end_of_burst_time, sizeof(srslte_timestamp_t));
+}
+
+radio_file::~radio_file()
+{
+  if (rx_map) {
+    munmap(rx_map, rx_map_len);
+  }
+  if (tx_file) {
+    fclose(tx_file);
+  }
+}
+
+bool radio_file::init(std::string rx_filename, std::string tx_filename, radio_file_format_t format_, 
+                      double file_srate_, bool loop_, bool realtime_)
+{
+  format     = format_; 
+  file_srate = file_srate_; 
+  loop       = loop_; 
+  realtime   = realtime_; 
+  if (file_srate > 0) {
+    rx_srate = file_srate; 
+  }
+
+  printf("Opening IQ file %s...\n", rx_filename.c_str());
+  int fd = open(rx_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    perror("open");
+    return false; 
+  }
+  struct stat st; 
+  if (fstat(fd, &st) || st.st_size == 0) {
+    fprintf(stderr, "Error IQ file %s is empty\n", rx_filename.c_str());
+    close(fd);
+    return false; 
+  }
+  rx_map_len = st.st_size; 
+  rx_map     = (uint8_t*) mmap(NULL, rx_map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (rx_map == MAP_FAILED) {
+    perror("mmap");
+    rx_map = NULL; 
+    return false; 
+  }
+  madvise(rx_map, rx_map_len, MADV_SEQUENTIAL);
+  rx_nof_samples = rx_map_len/(format == RADIO_FILE_SC16 ? 2*sizeof(int16_t) : sizeof(cf_t));
+
+  if (!tx_filename.empty()) {
+    tx_file = fopen(tx_filename.c_str(), "w");
+    if (!tx_file) {
+      perror("fopen");
+      return false; 
+    }
+  }
+  return true;    
+}
+
+void radio_file::read_sample(uint64_t idx, cf_t *s)
+{
+  if (format == RADIO_FILE_SC16) {
+    int16_t *p = (int16_t*) rx_map + 2*idx; 
+    float   *f = (float*) s; 
+    f[0] = (float) p[0]/32768; 
+    f[1] = (float) p[1]/32768; 
+  } else {
+    *s = ((cf_t*) rx_map)[idx];
+  }
+}
+
+bool radio_file::rx_at(void* buffer, uint32_t nof_samples, srslte_timestamp_t rx_time)
+{
+  fprintf(stderr, "Not implemented\n");
+  return false; 
+}
+
+bool radio_file::rx_now(void* buffer, uint32_t nof_samples, srslte_timestamp_t* rxd_time)
+{
+  cf_t    *out = (cf_t*) buffer; 
+  uint32_t n   = 0; 
+
+  if (!rx_map) {
+    return false; 
+  }
+  while (n < nof_samples) {
+    uint64_t avail = rx_nof_samples - rx_pos; 
+    if (avail < decim) {
+      if (loop) {
+        rx_pos = 0; 
+        continue; 
+      }
+      if (!eof) {
+        printf("End of IQ file reached\n");
+        eof = true; 
+      }
+      if (n == 0) {
+        return false; 
+      }
+      bzero(&out[n], sizeof(cf_t)*(nof_samples-n));
+      break; 
+    }
+    if (format == RADIO_FILE_FC32 && decim == 1) {
+      // Copy straight from the mapping
+      uint32_t len = SRSLTE_MIN(nof_samples-n, avail);
+      memcpy(&out[n], (cf_t*) rx_map + rx_pos, sizeof(cf_t)*len);
+      n      += len; 
+      rx_pos += len; 
+    } else {
+      cf_t acc = 0, s; 
+      for (uint32_t k=0;k<decim;k++) {
+        read_sample(rx_pos+k, &s);
+        acc += s; 
+      }
+      out[n++] = acc/decim; 
+      rx_pos  += decim; 
+    }
+  }
+  rx_total += (uint64_t) nof_samples*decim; 
+
+  if (rxd_time) {
+    srslte_timestamp_copy(rxd_time, &rx_time);
+  }
+  srslte_timestamp_add(&rx_time, 0, (double) nof_samples/rx_srate);
+  pace((double) nof_samples/rx_srate);
+  return true; 
+}
+
+double radio_file::now_secs()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+// Sleeps until the wall clock catches up with the samples delivered
+void radio_file::pace(double secs)
+{
+  pace_secs += secs; 
+  if (realtime) {
+    double wait = pace_start + pace_secs - now_secs();
+    if (wait > 0) {
+      usleep((useconds_t) (wait*1e6));
+    }
+  }
+}
+
+uint64_t radio_file::get_nof_rx_samples()
+{
+  return rx_total; 
+}
+
+void radio_file::get_time(srslte_timestamp_t *now) {
+  srslte_timestamp_copy(now, &rx_time);
+}
+
+float radio_file::set_tx_power(float power)
+{
+  if (power > 10) {
+    power = 10; 
+  }
+  if (power < -50) {
+    power = -50; 
+  }
+  tx_gain = power + 74;
+  return tx_gain; 
+}
+
+float radio_file::get_max_tx_power()
+{
+  return 10;
+}
+
+float radio_file::get_rssi()
+{
+  return 0;
+}
+
+bool radio_file::has_rssi()
+{
+  return false;
+}
+
+bool radio_file::tx(void* buffer, uint32_t nof_samples, srslte_timestamp_t tx_time)
+{
+  int n = (int) nof_samples + offset; 
+  offset = 0; 
+  if (n < 0) {
+    n = 0; 
+  }
+
+  srslte_timestamp_copy(&end_of_burst_time, &tx_time);
+  srslte_timestamp_add(&end_of_burst_time, 0, (double) n/tx_srate); 
+  in_burst = true; 
+
+  if (tx_file) {
+    radio_file_tx_hdr_t hdr; 
+    bzero(&hdr, sizeof(radio_file_tx_hdr_t));
+    hdr.full_secs   = tx_time.full_secs; 
+    hdr.frac_secs   = tx_time.frac_secs; 
+    hdr.nof_samples = n; 
+    if (fwrite(&hdr, sizeof(radio_file_tx_hdr_t), 1, tx_file) != 1 || 
+        fwrite(buffer, sizeof(cf_t), n, tx_file) != (size_t) n) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
+bool radio_file::tx_end()
+{
+  if (in_burst && tx_file) {
+    radio_file_tx_hdr_t hdr; 
+    bzero(&hdr, sizeof(radio_file_tx_hdr_t));
+    hdr.full_secs = end_of_burst_time.full_secs; 
+    hdr.frac_secs = end_of_burst_time.frac_secs; 
+    fwrite(&hdr, sizeof(radio_file_tx_hdr_t), 1, tx_file);
+  }
+  in_burst = false; 
+  return true; 
+}
+
+uint32_t radio_file::get_tti_len()
+{
+  return sf_len; 
+}
+
+void radio_file::set_tti_len(uint32_t sf_len_)
+{
+  sf_len = sf_len_; 
+}
+
+void radio_file::set_tti(uint32_t tti_) {
+  tti = tti_; 
+}
+
+void radio_file::tx_offset(int offset_)
+{
+  offset = offset_; 
+}
+
+void radio_file::set_rx_freq(float freq)
+{
+}
+
+void radio_file::set_tx_freq(float freq)
+{
+}
+
+void radio_file::set_rx_gain(float gain)
+{
+  rx_gain = gain; 
+}
+
+double radio_file::set_rx_gain_th(float gain)
+{
+  rx_gain = gain; 
+  return gain; 
+}
+
+void radio_file::set_tx_gain(float gain)
+{
+  tx_gain = gain; 
+}
+
+float radio_file::get_tx_gain()
+{
+  return tx_gain; 
+}
+
+float radio_file::get_rx_gain()
+{
+  return rx_gain; 
+}
+
+void radio_file::set_master_clock_rate(float rate)
+{
+}
+
+void radio_file::set_rx_srate(float srate)
+{
+  rx_srate = srate; 
+  decim    = 1; 
+  if (file_srate > 0) {
+    decim = (uint32_t) lround(file_srate/srate);
+    if (decim < 1 || fabs(decim*srate - file_srate) > 1) {
+      fprintf(stderr, "Error IQ file rate %.2f MHz is not a multiple of %.2f MHz\n", file_srate*1e-6, srate*1e-6);
+      decim = SRSLTE_MAX(decim, 1);
+    }
+  }
+}
+
+void radio_file::set_tx_srate(float srate)
+{
+  tx_srate = srate; 
+}
+
+void radio_file::start_rx()
+{
+  pace_start = now_secs(); 
+  pace_secs  = 0; 
+}
+
+void radio_file::stop_rx()
+{
+}
+  
+}
@@ -0,0 +1,566 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "radio/radio_sim.h"
+
+#define SIM_LCID       3      // Logical channel used by the generated PDUs
+#define SIM_HDR_LEN    5      // MAC subheader plus sequence number
+#define SIM_NOF_LOC    30
+
+namespace srslte {
+
+radio_sim::radio_sim()
+{
+  dl         = NULL; 
+  tti        = 10239; 
+  sf_pos     = 0; 
+  pdu_seq    = 0; 
+  pdu_idx    = 0; 
+  data       = NULL; 
+  cfo_phase  = 0; 
+  pace_start = 0; 
+  pace_secs  = 0; 
+  rx_srate   = 1.92e6;
+  tx_srate   = 1.92e6;
+  in_burst   = false; 
+  rx_gain    = 0; 
+  tx_gain    = 0; 
+  cur_tti    = 0; 
+  offset     = 0; 
+  sf_len     = 0; 
+  bzero(ndi, sizeof(ndi));
+  bzero(bch_payload, sizeof(bch_payload));
+  bzero(&dl_search, sizeof(enb_dl_t));
+  bzero(&dl_cell, sizeof(enb_dl_t));
+  bzero(&rx_time, sizeof(srslte_timestamp_t));
+  bzero(&metrics, sizeof(radio_sim_metrics_t));
+}
+
+radio_sim::~radio_sim()
+{
+  free_dl(&dl_search);
+  free_dl(&dl_cell);
+  if (data) {
+    free(data);
+  }
+}
+
+bool radio_sim::init(radio_sim_args_t *args_)
+{
+  args = *args_; 
+
+  if (args.cfi < 1 || args.cfi > 3) {
+    fprintf(stderr, "Error simulated eNodeB CFI must be 1, 2 or 3\n");
+    return false; 
+  }
+  if (!args.pdu_file.empty() && !load_pdus(args.pdu_file)) {
+    return false; 
+  }
+  
+  srslte_cell_t cell; 
+  bzero(&cell, sizeof(srslte_cell_t));
+  cell.nof_prb         = args.nof_prb; 
+  cell.id              = args.cell_id; 
+  cell.nof_ports       = 1; 
+  cell.cp              = SRSLTE_CP_NORM; 
+  cell.phich_length    = SRSLTE_PHICH_NORM; 
+  cell.phich_resources = SRSLTE_PHICH_R_1; 
+
+  if (!init_dl(&dl_cell, cell, true)) {
+    return false; 
+  }
+  // Cell search runs on the central 6 PRB at 1.92 MHz
+  if (cell.nof_prb > 6) {
+    cell.nof_prb = 6; 
+    if (!init_dl(&dl_search, cell, false)) {
+      return false; 
+    }
+  }
+  data = (uint8_t*) srslte_vec_malloc(sizeof(uint8_t)*SRSLTE_MAX_BUFFER_SIZE_BYTES);
+  if (!data) {
+    return false; 
+  }
+  set_rx_srate(1.92e6);
+  printf("Simulated eNodeB: PCI=%d, PRB=%d, RNTI=0x%x, MCS=%d, grant every %d sf\n", 
+         args.cell_id, args.nof_prb, args.rnti, args.mcs, args.grant_period);
+  return true; 
+}
+
+bool radio_sim::init_dl(enb_dl_t *q, srslte_cell_t cell, bool has_pdsch)
+{
+  q->cell      = cell; 
+  q->has_pdsch = has_pdsch; 
+  q->sf_len    = SRSLTE_SF_LEN_PRB(cell.nof_prb);
+  q->srate     = srslte_sampling_freq_hz(cell.nof_prb);
+
+  q->sf_symbols[0] = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp));
+  q->output        = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*q->sf_len);
+  if (!q->sf_symbols[0] || !q->output) {
+    return false; 
+  }
+  for (int i=1;i<SRSLTE_MAX_PORTS;i++) {
+    q->sf_symbols[i] = q->sf_symbols[0];
+  }
+  for (int i=0;i<SRSLTE_MAX_PORTS;i++) {
+    q->slot1_symbols[i] = &q->sf_symbols[0][SRSLTE_SLOT_LEN_RE(cell.nof_prb, cell.cp)];
+  }
+
+  if (srslte_ofdm_tx_init(&q->ifft, cell.cp, cell.nof_prb)) {
+    fprintf(stderr, "Error creating iFFT object\n");
+    return false; 
+  }
+  srslte_ofdm_set_normalize(&q->ifft, true);
+
+  if (srslte_pbch_init(&q->pbch, cell)) {
+    fprintf(stderr, "Error creating PBCH object\n");
+    return false; 
+  }
+  if (srslte_regs_init(&q->regs, cell)) {
+    fprintf(stderr, "Error initiating REGs\n");
+    return false; 
+  }
+  if (srslte_regs_set_cfi(&q->regs, args.cfi)) {
+    fprintf(stderr, "Error setting CFI\n");
+    return false; 
+  }
+  if (srslte_pcfich_init(&q->pcfich, &q->regs, cell)) {
+    fprintf(stderr, "Error creating PCFICH object\n");
+    return false; 
+  }
+  if (srslte_pdcch_init(&q->pdcch, &q->regs, cell)) {
+    fprintf(stderr, "Error creating PDCCH object\n");
+    return false; 
+  }
+  if (srslte_pdsch_init(&q->pdsch, cell)) {
+    fprintf(stderr, "Error creating PDSCH object\n");
+    return false; 
+  }
+  srslte_pdsch_set_rnti(&q->pdsch, args.rnti);
+  if (srslte_softbuffer_tx_init(&q->softbuffer, cell.nof_prb)) {
+    fprintf(stderr, "Error initiating soft buffer\n");
+    return false; 
+  }
+  // Cell-specific reference signals are taken from the channel estimator pilots
+  if (srslte_chest_dl_init(&q->est, cell)) {
+    fprintf(stderr, "Error initializing equalizer\n");
+    return false; 
+  }
+  srslte_pss_generate(q->pss_signal, SRSLTE_CELL_ID_2(cell.id));
+  srslte_sss_generate(q->sss_signal0, q->sss_signal5, cell.id);
+
+  q->initiated = true; 
+  return true; 
+}
+
+void radio_sim::free_dl(enb_dl_t *q)
+{
+  if (q->initiated) {
+    srslte_ofdm_tx_free(&q->ifft);
+    srslte_pbch_free(&q->pbch);
+    srslte_regs_free(&q->regs);
+    srslte_pcfich_free(&q->pcfich);
+    srslte_pdcch_free(&q->pdcch);
+    srslte_pdsch_free(&q->pdsch);
+    srslte_softbuffer_tx_free(&q->softbuffer);
+    srslte_chest_dl_free(&q->est);
+  }
+  if (q->sf_symbols[0]) {
+    free(q->sf_symbols[0]);
+  }
+  if (q->output) {
+    free(q->output);
+  }
+  bzero(q, sizeof(enb_dl_t));
+}
+
+bool radio_sim::load_pdus(std::string filename)
+{
+  FILE *f = fopen(filename.c_str(), "r");
+  if (!f) {
+    perror("fopen");
+    return false; 
+  }
+  uint16_t len; 
+  while (fread(&len, sizeof(uint16_t), 1, f) == 1) {
+    std::vector<uint8_t> pdu(len);
+    if (len > 0 && fread(&pdu[0], 1, len, f) != len) {
+      fprintf(stderr, "Error truncated PDU in %s\n", filename.c_str());
+      break; 
+    }
+    pdus.push_back(pdu);
+  }
+  fclose(f);
+  if (pdus.empty()) {
+    fprintf(stderr, "Error no PDUs in %s\n", filename.c_str());
+    return false; 
+  }
+  printf("Loaded %d MAC PDUs from %s\n", (int) pdus.size(), filename.c_str());
+  return true; 
+}
+
+/* Fills a transport block with the next PDU of the stream. Generated PDUs are
+ * a single MAC subheader followed by a sequence number and a byte pattern 
+ * derived from it. PDUs read from file are truncated or zero-padded to the TBS. 
+ */
+uint32_t radio_sim::next_pdu(uint8_t *payload, uint32_t nof_bytes)
+{
+  if (!pdus.empty()) {
+    std::vector<uint8_t> *pdu = &pdus[pdu_idx];
+    pdu_idx = (pdu_idx+1)%pdus.size();
+    uint32_t len = SRSLTE_MIN(nof_bytes, pdu->size());
+    if (len > 0) {
+      memcpy(payload, &(*pdu)[0], len);
+    }
+    bzero(&payload[len], nof_bytes-len);
+    return len; 
+  }
+  if (nof_bytes < SIM_HDR_LEN) {
+    bzero(payload, nof_bytes);
+    return 0; 
+  }
+  uint32_t seq = pdu_seq++; 
+  payload[0] = SIM_LCID;
+  payload[1] = (seq>>24)&0xff;
+  payload[2] = (seq>>16)&0xff;
+  payload[3] = (seq>>8)&0xff;
+  payload[4] = seq&0xff;
+  for (uint32_t i=SIM_HDR_LEN;i<nof_bytes;i++) {
+    payload[i] = (uint8_t) (seq+i);
+  }
+  return nof_bytes; 
+}
+
+bool radio_sim::check_pdu(uint8_t *payload, uint32_t nof_bytes)
+{
+  if (nof_bytes < SIM_HDR_LEN || payload[0] != SIM_LCID) {
+    return false; 
+  }
+  uint32_t seq = ((uint32_t) payload[1]<<24) | ((uint32_t) payload[2]<<16) | 
+                 ((uint32_t) payload[3]<<8)  |  (uint32_t) payload[4];
+  for (uint32_t i=SIM_HDR_LEN;i<nof_bytes;i++) {
+    if (payload[i] != (uint8_t) (seq+i)) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
+/* Synthesizes one downlink subframe into q->output */
+void radio_sim::gen_sf(enb_dl_t *q, uint32_t tti)
+{
+  uint32_t sf_idx = tti%10; 
+  uint32_t sfn    = (tti/10)%1024; 
+
+  bzero(q->sf_symbols[0], sizeof(cf_t)*SRSLTE_SF_LEN_RE(q->cell.nof_prb, q->cell.cp));
+
+  if (sf_idx == 0 || sf_idx == 5) {
+    srslte_pss_put_slot(q->pss_signal, q->sf_symbols[0], q->cell.nof_prb, q->cell.cp);
+    srslte_sss_put_slot(sf_idx ? q->sss_signal5 : q->sss_signal0, q->sf_symbols[0], q->cell.nof_prb, q->cell.cp);
+  }
+  srslte_refsignal_cs_put_sf(q->cell, 0, q->est.csr_signal.pilots[0][sf_idx], q->sf_symbols[0]);
+
+  if (sf_idx == 0) {
+    // Both generators encode every frame so that their PBCH redundancy versions stay aligned with SFN mod 4
+    srslte_pbch_mib_pack(&dl_cell.cell, sfn, bch_payload);
+    srslte_pbch_encode(&dl_cell.pbch, bch_payload, dl_cell.slot1_symbols);
+    if (dl_search.initiated) {
+      srslte_pbch_encode(&dl_search.pbch, bch_payload, dl_search.slot1_symbols);
+    }
+  }
+  srslte_pcfich_encode(&q->pcfich, args.cfi, q->sf_symbols, sf_idx);
+
+  if (q->has_pdsch && args.grant_period > 0 && (tti%args.grant_period) == 0) {
+    srslte_ra_dl_dci_t ra_dl; 
+    bzero(&ra_dl, sizeof(srslte_ra_dl_dci_t));
+    uint32_t pid = tti%8; 
+    ndi[pid] = !ndi[pid];
+    ra_dl.harq_process = pid; 
+    ra_dl.mcs_idx      = args.mcs; 
+    ra_dl.ndi          = ndi[pid];
+    ra_dl.rv_idx       = 0; 
+    ra_dl.alloc_type   = SRSLTE_RA_ALLOC_TYPE0;
+    ra_dl.type0_alloc.rbg_bitmask = 0xffffffff;
+
+    srslte_dci_msg_t      dci_msg; 
+    srslte_dci_location_t locations[SIM_NOF_LOC];
+    srslte_ra_dl_dci_t    dci_unpacked; 
+    srslte_ra_dl_grant_t  grant; 
+    srslte_pdsch_cfg_t    pdsch_cfg; 
+
+    srslte_dci_msg_pack_pdsch(&ra_dl, &dci_msg, SRSLTE_DCI_FORMAT1, q->cell.nof_prb, false);
+    if (srslte_pdcch_ue_locations(&q->pdcch, locations, SIM_NOF_LOC, sf_idx, args.cfi, args.rnti) > 0     && 
+        !srslte_pdcch_encode(&q->pdcch, &dci_msg, locations[0], args.rnti, q->sf_symbols, sf_idx, args.cfi) && 
+        !srslte_dci_msg_to_dl_grant(&dci_msg, args.rnti, q->cell.nof_prb, &dci_unpacked, &grant)          && 
+        !srslte_pdsch_cfg(&pdsch_cfg, q->cell, &grant, args.cfi, sf_idx, 0)) 
+    {
+      uint32_t nof_bytes = grant.mcs.tbs/8; 
+      next_pdu(data, nof_bytes);
+      srslte_softbuffer_tx_reset(&q->softbuffer);
+      if (!srslte_pdsch_encode_rnti(&q->pdsch, &pdsch_cfg, &q->softbuffer, data, args.rnti, q->sf_symbols)) {
+        metrics.dl_grants++; 
+        metrics.dl_bytes += nof_bytes; 
+      }
+    } else {
+      fprintf(stderr, "Error encoding DL grant at tti=%d\n", tti);
+    }
+  }
+
+  srslte_ofdm_tx_sf(&q->ifft, q->sf_symbols[0], q->output);
+  impair(q);
+  metrics.dl_sf++; 
+}
+
+// Frequency offset and AWGN 
+void radio_sim::impair(enb_dl_t *q)
+{
+  if (args.cfo_hz != 0) {
+    double w = 2*M_PI*args.cfo_hz/q->srate; 
+    cf_t   rot; 
+    float *r = (float*) &rot; 
+    for (uint32_t i=0;i<q->sf_len;i++) {
+      r[0] = cosf((float) cfo_phase);
+      r[1] = sinf((float) cfo_phase);
+      q->output[i] *= rot; 
+      cfo_phase += w; 
+    }
+    cfo_phase = fmod(cfo_phase, 2*M_PI);
+  }
+  if (args.awgn) {
+    float power = srslte_vec_avg_power_cf(q->output, q->sf_len);
+    srslte_ch_awgn_c(q->output, q->output, power*powf(10, -args.snr_db/10), q->sf_len);
+  }
+}
+
+bool radio_sim::rx_at(void* buffer, uint32_t nof_samples, srslte_timestamp_t rx_time)
+{
+  fprintf(stderr, "Not implemented\n");
+  return false; 
+}
+
+bool radio_sim::rx_now(void* buffer, uint32_t nof_samples, srslte_timestamp_t* rxd_time)
+{
+  cf_t    *out = (cf_t*) buffer; 
+  uint32_t n   = 0; 
+
+  if (!dl) {
+    return false; 
+  }
+  while (n < nof_samples) {
+    if (sf_pos == dl->sf_len) {
+      tti    = (tti+1)%10240; 
+      sf_pos = 0; 
+      gen_sf(dl, tti);
+    }
+    uint32_t len = SRSLTE_MIN(nof_samples-n, dl->sf_len-sf_pos);
+    memcpy(&out[n], &dl->output[sf_pos], sizeof(cf_t)*len);
+    n      += len; 
+    sf_pos += len; 
+  }
+
+  if (rxd_time) {
+    srslte_timestamp_copy(rxd_time, &rx_time);
+  }
+  srslte_timestamp_add(&rx_time, 0, (double) nof_samples/rx_srate);
+  pace((double) nof_samples/rx_srate);
+  return true; 
+}
+
+double radio_sim::now_secs()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+// Sleeps until the wall clock catches up with the samples delivered
+void radio_sim::pace(double secs)
+{
+  pace_secs += secs; 
+  if (args.realtime) {
+    double wait = pace_start + pace_secs - now_secs();
+    if (wait > 0) {
+      usleep((useconds_t) (wait*1e6));
+    }
+  }
+}
+
+void radio_sim::get_metrics(radio_sim_metrics_t *m)
+{
+  memcpy(m, &metrics, sizeof(radio_sim_metrics_t));
+}
+
+void radio_sim::get_time(srslte_timestamp_t *now) {
+  srslte_timestamp_copy(now, &rx_time);
+}
+
+float radio_sim::set_tx_power(float power)
+{
+  if (power > 10) {
+    power = 10; 
+  }
+  if (power < -50) {
+    power = -50; 
+  }
+  tx_gain = power + 74;
+  return tx_gain; 
+}
+
+float radio_sim::get_max_tx_power()
+{
+  return 10;
+}
+
+float radio_sim::get_rssi()
+{
+  return 0;
+}
+
+bool radio_sim::has_rssi()
+{
+  return false;
+}
+
+/* Uplink chunks are not transmitted. Each one must be a whole subframe, 
+ * possibly shortened by tx_offset(), and be timed after the last sample 
+ * the PHY has received. 
+ */
+bool radio_sim::tx(void* buffer, uint32_t nof_samples, srslte_timestamp_t tx_time)
+{
+  int n = (int) nof_samples + offset; 
+  offset = 0; 
+  metrics.ul_chunks++; 
+  if (nof_samples != sf_len && sf_len > 0) {
+    metrics.ul_bad_len++; 
+  }
+  if (srslte_timestamp_real(&tx_time) < srslte_timestamp_real(&rx_time)) {
+    metrics.ul_late++; 
+  }
+  in_burst = n > 0; 
+  return true; 
+}
+
+bool radio_sim::tx_end()
+{
+  if (in_burst) {
+    metrics.ul_bursts++; 
+  }
+  in_burst = false; 
+  return true; 
+}
+
+uint32_t radio_sim::get_tti_len()
+{
+  return sf_len; 
+}
+
+void radio_sim::set_tti_len(uint32_t sf_len_)
+{
+  sf_len = sf_len_; 
+}
+
+void radio_sim::set_tti(uint32_t tti_) {
+  cur_tti = tti_; 
+}
+
+void radio_sim::tx_offset(int offset_)
+{
+  offset = offset_; 
+}
+
+void radio_sim::set_rx_freq(float freq)
+{
+}
+
+void radio_sim::set_tx_freq(float freq)
+{
+}
+
+void radio_sim::set_rx_gain(float gain)
+{
+  rx_gain = gain; 
+}
+
+double radio_sim::set_rx_gain_th(float gain)
+{
+  rx_gain = gain; 
+  return gain; 
+}
+
+void radio_sim::set_tx_gain(float gain)
+{
+  tx_gain = gain; 
+}
+
+float radio_sim::get_tx_gain()
+{
+  return tx_gain; 
+}
+
+float radio_sim::get_rx_gain()
+{
+  return rx_gain; 
+}
+
+void radio_sim::set_master_clock_rate(float rate)
+{
+}
+
+// Selects the generator for the new rate and restarts at a subframe boundary
+void radio_sim::set_rx_srate(float srate)
+{
+  rx_srate = srate; 
+  if (dl_search.initiated && fabs(srate - dl_search.srate) < 1) {
+    dl = &dl_search; 
+  } else if (fabs(srate - dl_cell.srate) < 1) {
+    dl = &dl_cell; 
+  } else {
+    fprintf(stderr, "Error simulated eNodeB does not support %.2f MHz\n", srate*1e-6);
+    dl = NULL; 
+    return; 
+  }
+  sf_pos = dl->sf_len; 
+}
+
+void radio_sim::set_tx_srate(float srate)
+{
+  tx_srate = srate; 
+}
+
+void radio_sim::start_rx()
+{
+  pace_start = now_secs(); 
+  pace_secs  = 0; 
+}
+
+void radio_sim::stop_rx()
+{
+}
+  
+}
@@ -28,6 +28,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/thread/mutex.hpp>
 #include "ue.h"
+#include "common/thread_affinity.h"
 #include "srslte_version_check.h"
 #include "srslte/srslte.h"
 
@@ -36,6 +37,14 @@ namespace srsue{
 ue*           ue::instance = NULL;
 boost::mutex  ue_instance_mutex;
 
+/* Uplink minus downlink carrier frequency (MHz) of the FDD E-UTRA bands, 36.101 Table 5.5-1. 
+ * 0 for reserved, TDD and downlink-only bands */
+#define NOF_FDD_BANDS 32
+static const float band_duplex_mhz[NOF_FDD_BANDS+1] = {
+     0, -190,  -80,  -95, -400,  -45,  -45, -120,  -45,  -95, -400,  -48,  -30,   31,   30,    0, 
+     0,  -30,  -45,  -45,   41,  -48, -100, -180,101.5,  -80,  -45,  -45,  -55,    0,  -45,  -10, 
+     0};
+
 bool ue::check_srslte_version(void) {
   bool ret = (0 != srslte_check_version(REQ_SRSLTE_VMAJOR, REQ_SRSLTE_VMINOR, REQ_SRSLTE_VPATCH));
   if(!ret) {
@@ -67,6 +76,7 @@ void ue::cleanup(void)
 
 ue::ue()
     :started(false)
+    ,radio(NULL)
 {
   pool = buffer_pool::get_instance();
 }
@@ -83,8 +93,20 @@ bool ue::init(all_args_t *args_)
   if (!check_srslte_version()) {
     return false; 
   }
+
+  // Must be set before the logger starts. Threads already running are placed too.
+  if (!set_thread_affinity()) {
+    return false; 
+  }
   
-  logger.init(args->log.filename);
+  log_overflow_t log_overflow;
+  if (!overflow(args->log.overflow, &log_overflow)) {
+    return false; 
+  }
+  logger.init(args->log.filename,
+              args->log.binary,
+              log_overflow,
+              args->log.ring_size*1024);
   uhd_log.init("UHD ", &logger);
   phy_log.init("PHY ", &logger, true);
   mac_log.init("MAC ", &logger, true);
@@ -132,48 +154,42 @@ bool ue::init(all_args_t *args_)
   set_expert_parameters();
 
   // Init layers
-  radio_uhd.register_msg_handler(uhd_msg);
-  char *c_str = new char[args->usrp_args.size() + 1];
-  strcpy(c_str, args->usrp_args.c_str());
+  if (!init_radio()) {
+    return false;
+  }
   
-  /* Start Radio/PHY with AGC if rx_gain argument is negative */
+  /* Start PHY with AGC if rx_gain argument is negative */
   if (args->rf.rx_gain < 0) {
-    if(!radio_uhd.init_agc(c_str))
-    {
-      printf("Failed to find usrp with args=%s\n",c_str);
-      delete [] c_str;
-      return false;
-    }    
-    phy.init_agc(&radio_uhd, &mac, &phy_log, args->expert.nof_phy_threads);
+    phy.init_agc(radio, &mac, &phy_log, args->expert.nof_phy_threads);
   } else {
-    if(!radio_uhd.init(c_str))
-    {
-      printf("Failed to find usrp with args=%s\n",c_str);
-      delete [] c_str;
-      return false;
-    }    
-    phy.init(&radio_uhd, &mac, &phy_log, args->expert.nof_phy_threads);
-    radio_uhd.set_rx_gain(args->rf.rx_gain);
+    phy.init(radio, &mac, &phy_log, args->expert.nof_phy_threads);
+    radio->set_rx_gain(args->rf.rx_gain);
     if (args->rf.tx_gain < 0) {
-      radio_uhd.set_tx_gain(args->rf.rx_gain);
+      radio->set_tx_gain(args->rf.rx_gain);
     }
   }
   if (args->rf.tx_gain > 0) {
-    radio_uhd.set_tx_gain(args->rf.tx_gain);
+    radio->set_tx_gain(args->rf.tx_gain);
   } else {
     std::cout << std::endl << 
                 "Warning: TX gain was not set. " << 
                 "Using open-loop power control (not working properly)" << std::endl << std::endl; 
   }
 
-  delete [] c_str;
+  std::vector<float> dl_freqs, ul_freqs;
+  if (!get_frequencies(dl_freqs, ul_freqs)) {
+    return false;
+  }
+  phy.set_frequencies(dl_freqs, ul_freqs);
+  phy.set_cell_cache(args->expert.cell_cache);
 
-  radio_uhd.set_rx_freq(args->rf.dl_freq);
-  radio_uhd.set_tx_freq(args->rf.ul_freq);
+  radio->set_rx_freq(dl_freqs[0]);
+  radio->set_tx_freq(ul_freqs[0]);
 
-  phy_log.console("Setting frequency: DL=%.1f Mhz, UL=%.1f MHz\n", args->rf.dl_freq/1e6, args->rf.ul_freq/1e6);
+  phy_log.console("Setting frequency: DL=%.1f Mhz, UL=%.1f MHz\n", dl_freqs[0]/1e6, ul_freqs[0]/1e6);
 
   mac.init(&phy, &rlc, &mac_log);
+  mac.set_param(mac_interface_params::HARQ_SOFTBUFFER_BITS, args->expert.harq_softbuffer_bits);
   rlc.init(&pdcp, &rrc, this, &rlc_log, &mac);
   pdcp.init(&rlc, &rrc, &gw, &pdcp_log);
   rrc.init(&phy, &mac, &rlc, &pdcp, &nas, &usim, &rrc_log);
@@ -185,6 +201,97 @@ bool ue::init(all_args_t *args_)
   return true;
 }
 
+/* rf.dl_earfcn replaces rf.dl_freq with a list of carriers, each one with the uplink carrier of 
+ * its band. Only FDD bands are supported */
+bool ue::get_frequencies(std::vector<float> &dl_freqs, std::vector<float> &ul_freqs) {
+  std::vector<std::string> list;
+  if (args->rf.dl_earfcn.length() > 0) {
+    boost::split(list, args->rf.dl_earfcn, boost::is_any_of(", "), boost::token_compress_on);
+  }
+  for (uint32_t i=0;i<list.size();i++) {
+    if (list[i].length() == 0) {
+      continue;
+    }
+    char *end;
+    long earfcn = strtol(list[i].c_str(), &end, 10);
+    float fd    = earfcn >= 0 && *end == '\0' ? srslte_band_fd((uint32_t) earfcn) : -1;
+    if (fd < 0) {
+      printf("Invalid rf.dl_earfcn=%s\n", list[i].c_str());
+      return false;
+    }
+    uint32_t band = srslte_band_get_band((uint32_t) earfcn);
+    if (band > NOF_FDD_BANDS || band_duplex_mhz[band] == 0) {
+      printf("Invalid rf.dl_earfcn=%s, band %d is not an FDD band\n", list[i].c_str(), band);
+      return false;
+    }
+    dl_freqs.push_back(fd*1e6);
+    ul_freqs.push_back((fd + band_duplex_mhz[band])*1e6);
+  }
+  if (dl_freqs.size() == 0) {
+    dl_freqs.push_back(args->rf.dl_freq);
+    ul_freqs.push_back(args->rf.ul_freq);
+  }
+  return true;
+}
+
+bool ue::set_thread_affinity() {
+  thread_affinity *affinity = thread_affinity::get_instance();
+  std::string keys[] = {"phy_worker", "phy_helper", "phy_tx", "phy_meas", "sync", "mac", "mac_pdu", "mac_timers", "gw", "logger", "timeout", "metrics"};
+  std::string specs[] = {args->affinity.phy_worker, args->affinity.phy_helper, args->affinity.phy_tx, args->affinity.phy_meas, 
+                         args->affinity.sync, args->affinity.mac, args->affinity.mac_pdu, args->affinity.mac_timers, args->affinity.gw, 
+                         args->affinity.logger, args->affinity.timeout, args->affinity.metrics};
+  for (uint32_t i=0;i<sizeof(keys)/sizeof(keys[0]);i++) {
+    if (!affinity->set(keys[i], specs[i])) {
+      printf("Invalid affinity.%s=%s, expected <cpus>[@<prio_offset>]\n", keys[i].c_str(), specs[i].c_str());
+      return false; 
+    }
+  }
+  affinity->configure();
+  return true; 
+}
+
+bool ue::init_radio() {
+  if (args->rf.device == "file") {
+    srslte::radio_file_format_t format = srslte::RADIO_FILE_FC32;
+    if (args->rf.file_format == "sc16") {
+      format = srslte::RADIO_FILE_SC16;
+    } else if (args->rf.file_format != "fc32") {
+      printf("Invalid rf.file_format=%s, expected fc32 or sc16\n", args->rf.file_format.c_str());
+      return false;
+    }
+    if (!radio_file.init(args->rf.file_rx, args->rf.file_tx, format, args->rf.file_srate, 
+                         args->rf.file_loop, args->rf.file_realtime)) {
+      printf("Failed to open IQ file %s\n", args->rf.file_rx.c_str());
+      return false;
+    }
+    radio = &radio_file;
+    return true;
+  } else if (args->rf.device == "sim") {
+    if (!radio_sim.init(&args->sim)) {
+      printf("Failed to start simulated eNodeB\n");
+      return false;
+    }
+    radio = &radio_sim;
+    return true;
+  } else if (args->rf.device != "uhd") {
+    printf("Invalid rf.device=%s, expected uhd, file or sim\n", args->rf.device.c_str());
+    return false;
+  }
+
+  radio_uhd.register_msg_handler(uhd_msg);
+  char *c_str = new char[args->usrp_args.size() + 1];
+  strcpy(c_str, args->usrp_args.c_str());
+  
+  /* Start Radio with AGC if rx_gain argument is negative */
+  bool ret = (args->rf.rx_gain < 0) ? radio_uhd.init_agc(c_str) : radio_uhd.init(c_str);
+  if (!ret) {
+    printf("Failed to find usrp with args=%s\n",c_str);
+  }
+  delete [] c_str;
+  radio = &radio_uhd;
+  return ret;
+}
+
 void ue::set_expert_parameters() {
   phy.set_param(phy_interface_params::CELLSEARCH_TIMEOUT_MIB_NFRAMES, args->expert.sync_find_max_frames);
   phy.set_param(phy_interface_params::CELLSEARCH_TIMEOUT_PSS_NFRAMES, args->expert.sync_find_max_frames);
@@ -216,6 +323,16 @@ void ue::set_expert_parameters() {
 
   phy.set_param(phy_interface_params::CONTINUOUS_TX, args->expert.continuous_tx?1:0);
   phy.set_param(phy_interface_params::PDSCH_MAX_ITS, args->expert.pdsch_max_its);
+  phy.set_param(phy_interface_params::PDSCH_ADAPTIVE_ITS, args->expert.pdsch_adaptive_its?1:0);
+
+  phy.set_param(phy_interface_params::WORKERS_SPIN_US, args->expert.phy_spin_us);
+  phy.set_param(phy_interface_params::PDSCH_HELPERS, args->expert.pdsch_helpers);
+  phy.set_param(phy_interface_params::PDSCH_HELPERS_MIN_PRB, args->expert.pdsch_helpers_min_prb);
+  phy.set_param(phy_interface_params::LAZY_PDSCH_FFT, args->expert.lazy_pdsch_fft?1:0);
+  phy.set_param(phy_interface_params::PDSCH_FIXED_POINT, args->expert.pdsch_fixed_point?1:0);
+  phy.set_param(phy_interface_params::SIGNAL_CACHE_MB, args->expert.signal_cache_mb);
+  phy.set_param(phy_interface_params::RX_RING_SF, args->expert.rx_ring_sf);
+  phy.set_param(phy_interface_params::WORKERS_SCALING, args->expert.phy_worker_scaling?1:0);
     
 }
 
@@ -241,6 +358,11 @@ void ue::stop()
     {
       phy.write_trace(args->trace.phy_filename);
       radio_uhd.write_trace(args->trace.radio_filename);
+      FILE *f = fopen((args->trace.phy_filename + "_latency.txt").c_str(), "w");
+      if (f) {
+        phy.print_latency(f);
+        fclose(f);
+      }
     }
     started = false;
   }
@@ -256,12 +378,20 @@ bool ue::get_metrics(ue_metrics_t &m)
     if(RRC_STATE_RRC_CONNECTED == rrc.get_state()) {
       phy.get_metrics(m.phy);
       mac.get_metrics(m.mac);
+      pool->get_metrics(m.pool);
+      logger.get_metrics(m.log);
+      thread_affinity::get_instance()->get_metrics(m.threads);
       return true;
     }
   }
   return false;
 }
 
+void ue::print_latency()
+{
+  phy.print_latency(stdout);
+}
+
 void ue::uhd_msg(const char *msg)
 {
   ue *u = ue::get_instance();
@@ -287,10 +417,23 @@ void ue::handle_uhd_msg(const char* msg)
     str.erase(std::remove(str.begin(), str.end(), '\n'), str.end());
     str.erase(std::remove(str.begin(), str.end(), '\r'), str.end());
     str.push_back('\n');
-    uhd_log.info(str);
+    log_info(&uhd_log, str);
   }
 }
 
+bool ue::overflow(std::string o, srsue::log_overflow_t *policy)
+{
+  boost::to_lower(o);
+  for(uint32_t i=0;i<LOG_OVERFLOW_N_ITEMS;i++) {
+    if(o == log_overflow_text[i]) {
+      *policy = (log_overflow_t) i;
+      return true;
+    }
+  }
+  printf("Invalid log.overflow=%s, must be block, drop_newest or drop_oldest\n", o.c_str());
+  return false;
+}
+
 srslte::LOG_LEVEL_ENUM ue::level(std::string l)
 {
   boost::to_upper(l);
@@ -26,6 +26,7 @@
 
 
 #include "upper/gw.h"
+#include "common/thread_affinity.h"
 
 #include <fcntl.h>
 #include <arpa/inet.h>
@@ -74,12 +75,11 @@ void gw::stop()
 *******************************************************************************/
 bool gw::check_ul_buffers()
 {
-  byte_buffer_t *sdu;
-  int n_sdus = rx_sdu_queue.size();
-  for(int i=0;i<n_sdus;i++)
+  byte_buffer_t *sdus[64];
+  uint32_t n_sdus = rx_sdu_queue.read_batch(sdus, 64);
+  for(uint32_t i=0;i<n_sdus;i++)
   {
-    rx_sdu_queue.read(&sdu);
-    pdcp->write_sdu(RB_ID_DRB1, sdu);
+    pdcp->write_sdu(RB_ID_DRB1, sdus[i]);
   }
   return (n_sdus > 0);
 }
@@ -89,14 +89,14 @@ bool gw::check_ul_buffers()
 *******************************************************************************/
 void gw::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
 {
-  gw_log->info_hex(pdu->msg, pdu->N_bytes, "DL PDU");
+  log_info_hex(gw_log, pdu->msg, pdu->N_bytes, "DL PDU");
   if(!if_up)
   {
-    gw_log->warning("TUN/TAP not up - dropping gw DL message\n");
+    log_warning(gw_log, "TUN/TAP not up - dropping gw DL message\n");
   }else{
     if(pdu->N_bytes != write(tun_fd, pdu->msg, pdu->N_bytes))
     {
-      gw_log->error("DL TUN/TAP write failure\n");
+      log_error(gw_log, "DL TUN/TAP write failure\n");
       printf("DL TUN/TAP write failure writting %d bytes\n", pdu->N_bytes);
     }
   }
@@ -112,7 +112,7 @@ error_t gw::setup_if_addr(uint32_t ip_addr, char *err_str)
   {
       if(init_if(err_str))
       {
-        gw_log->error("init_if failed\n");
+        log_error(gw_log, "init_if failed\n");
         return(ERROR_CANT_START);
       }
   }
@@ -124,7 +124,7 @@ error_t gw::setup_if_addr(uint32_t ip_addr, char *err_str)
   if(0 > ioctl(sock, SIOCSIFADDR, &ifr))
   {
       err_str = strerror(errno);
-      gw_log->debug("Failed to set socket address: %s\n", err_str);
+      log_debug(gw_log, "Failed to set socket address: %s\n", err_str);
       close(tun_fd);
       return(ERROR_CANT_START);
   }
@@ -133,13 +133,14 @@ error_t gw::setup_if_addr(uint32_t ip_addr, char *err_str)
   if(0 > ioctl(sock, SIOCSIFNETMASK, &ifr))
   {
       err_str = strerror(errno);
-      gw_log->debug("Failed to set socket netmask: %s\n", err_str);
+      log_debug(gw_log, "Failed to set socket netmask: %s\n", err_str);
       close(tun_fd);
       return(ERROR_CANT_START);
   }
 
   // Setup a thread to receive packets from the TUN device
   start(GW_THREAD_PRIO);
+  thread_affinity::get_instance()->add(this, "gw", "GW", GW_THREAD_PRIO);
 
   return(ERROR_NONE);
 }
@@ -155,11 +156,11 @@ error_t gw::init_if(char *err_str)
 
     // Construct the TUN device
     tun_fd = open("/dev/net/tun", O_RDWR);
-    gw_log->info("TUN file descriptor = %d\n", tun_fd);
+    log_info(gw_log, "TUN file descriptor = %d\n", tun_fd);
     if(0 > tun_fd)
     {
         err_str = strerror(errno);
-        gw_log->debug("Failed to open TUN device: %s\n", err_str);
+        log_debug(gw_log, "Failed to open TUN device: %s\n", err_str);
         return(ERROR_CANT_START);
     }
     memset(&ifr, 0, sizeof(ifr));
@@ -168,7 +169,7 @@ error_t gw::init_if(char *err_str)
     if(0 > ioctl(tun_fd, TUNSETIFF, &ifr))
     {
         err_str = strerror(errno);
-        gw_log->debug("Failed to set TUN device name: %s\n", err_str);
+        log_debug(gw_log, "Failed to set TUN device name: %s\n", err_str);
         close(tun_fd);
         return(ERROR_CANT_START);
     }
@@ -178,7 +179,7 @@ error_t gw::init_if(char *err_str)
     if(0 > ioctl(sock, SIOCGIFFLAGS, &ifr))
     {
         err_str = strerror(errno);
-        gw_log->debug("Failed to bring up socket: %s\n", err_str);
+        log_debug(gw_log, "Failed to bring up socket: %s\n", err_str);
         close(tun_fd);
         return(ERROR_CANT_START);
     }
@@ -186,7 +187,7 @@ error_t gw::init_if(char *err_str)
     if(0 > ioctl(sock, SIOCSIFFLAGS, &ifr))
     {
         err_str = strerror(errno);
-        gw_log->debug("Failed to set socket flags: %s\n", err_str);
+        log_debug(gw_log, "Failed to set socket flags: %s\n", err_str);
         close(tun_fd);
         return(ERROR_CANT_START);
     }
@@ -206,12 +207,12 @@ void gw::run_thread()
     int32           N_bytes;
     byte_buffer_t  *pdu = pool->allocate();
 
-    gw_log->info("GW IP packet receiver thread running\n");
+    log_info(gw_log, "GW IP packet receiver thread running\n");
 
     while(running)
     {
-        N_bytes = read(tun_fd, &pdu->msg[idx], SRSUE_MAX_BUFFER_SIZE_BYTES-SRSUE_BUFFER_HEADER_OFFSET);
-        gw_log->debug("Read %d bytes from TUN fd=%d\n", N_bytes, tun_fd);
+        N_bytes = read(tun_fd, &pdu->msg[idx], pdu->get_tailroom());
+        log_debug(gw_log, "Read %d bytes from TUN fd=%d\n", N_bytes, tun_fd);
         if(N_bytes > 0)
         {
             pdu->N_bytes = idx + N_bytes;
@@ -220,7 +221,7 @@ void gw::run_thread()
             // Check if entire packet was received
             if(ntohs(ip_pkt->tot_len) == pdu->N_bytes)
             {
-              gw_log->info_hex(pdu->msg, pdu->N_bytes, "UL PDU");
+              log_info_hex(gw_log, pdu->msg, pdu->N_bytes, "UL PDU");
               
               // Send PDU directly to PDCP
               pdcp->write_sdu(RB_ID_DRB1, pdu);
@@ -230,13 +231,14 @@ void gw::run_thread()
             }else{
               idx += N_bytes;
             }
+            update_usage();
         }else{
-            gw_log->error("Failed to read from TUN interface - gw receive thread exiting.\n");
+            log_error(gw_log, "Failed to read from TUN interface - gw receive thread exiting.\n");
             break;
         }
     }
 
-    gw_log->info("GW IP receiver thread exiting.\n");
+    log_info(gw_log, "GW IP receiver thread exiting.\n");
 }
 
 } // namespace srsue
@@ -68,7 +68,7 @@ emm_state_t nas::get_state()
 
 void nas::notify_connection_setup()
 {
-  nas_log->debug("State = %s\n", emm_state_text[state]);
+  log_debug(nas_log, "State = %s\n", emm_state_text[state]);
   if(EMM_STATE_DEREGISTERED == state)
   {
     send_attach_request();
@@ -80,7 +80,7 @@ void nas::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
   uint8 pd;
   uint8 msg_type;
 
-  nas_log->info_hex(pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
+  log_info_hex(nas_log, pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
 
   // Parse the message
   liblte_mme_parse_msg_header((LIBLTE_BYTE_MSG_STRUCT*)pdu, &pd, &msg_type);
@@ -114,7 +114,7 @@ void nas::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
       parse_emm_information(lcid, pdu);
       break;
   default:
-      nas_log->error("Not handling NAS message with MSG_TYPE=%02X\n",msg_type);
+      log_error(nas_log, "Not handling NAS message with MSG_TYPE=%02X\n",msg_type);
       pool->deallocate(pdu);
       break;
   }
@@ -137,7 +137,7 @@ void nas::parse_attach_accept(uint32_t lcid, byte_buffer_t *pdu)
   LIBLTE_MME_ATTACH_COMPLETE_MSG_STRUCT                              attach_complete;
   LIBLTE_MME_ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT_MSG_STRUCT   act_def_eps_bearer_context_accept;
 
-  nas_log->info("Received Attach Accept\n");
+  log_info(nas_log, "Received Attach Accept\n");
   count_dl++;
 
   liblte_mme_unpack_attach_accept_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu, &attach_accept);
@@ -183,7 +183,7 @@ void nas::parse_attach_accept(uint32_t lcid, byte_buffer_t *pdu)
       ip_addr |= act_def_eps_bearer_context_req.pdn_addr.addr[2] << 8;
       ip_addr |= act_def_eps_bearer_context_req.pdn_addr.addr[3];
 
-      nas_log->info("IP allocated by network %u.%u.%u.%u\n",
+      log_info(nas_log, "IP allocated by network %u.%u.%u.%u\n",
                     act_def_eps_bearer_context_req.pdn_addr.addr[0],
                     act_def_eps_bearer_context_req.pdn_addr.addr[1],
                     act_def_eps_bearer_context_req.pdn_addr.addr[2],
@@ -199,12 +199,12 @@ void nas::parse_attach_accept(uint32_t lcid, byte_buffer_t *pdu)
       char *err_str;
       if(gw->setup_if_addr(ip_addr, err_str))
       {
-        nas_log->error("Failed to set gateway address - %s\n", err_str);
+        log_error(nas_log, "Failed to set gateway address - %s\n", err_str);
       }
     }
     else
     {
-      nas_log->error("Not handling IPV6 or IPV4V6");
+      log_error(nas_log, "Not handling IPV6 or IPV4V6");
       pool->deallocate(pdu);
       return;
     }
@@ -245,7 +245,7 @@ void nas::parse_attach_accept(uint32_t lcid, byte_buffer_t *pdu)
                                         lcid-1,
                                         (LIBLTE_BYTE_MSG_STRUCT*)pdu);
 
-    nas_log->info("Sending Attach Complete\n");
+    log_info(nas_log, "Sending Attach Complete\n");
     rrc->write_sdu(lcid, pdu);
     
     // Instruct RRC to enable capabilities
@@ -253,7 +253,7 @@ void nas::parse_attach_accept(uint32_t lcid, byte_buffer_t *pdu)
   }
   else
   {
-    nas_log->info("Not handling attach type %u\n", attach_accept.eps_attach_result);
+    log_info(nas_log, "Not handling attach type %u\n", attach_accept.eps_attach_result);
     state = EMM_STATE_DEREGISTERED;
     pool->deallocate(pdu);
   }
@@ -264,7 +264,7 @@ void nas::parse_attach_reject(uint32_t lcid, byte_buffer_t *pdu)
   LIBLTE_MME_ATTACH_REJECT_MSG_STRUCT attach_rej;
 
   liblte_mme_unpack_attach_reject_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu, &attach_rej);
-  nas_log->warning("Received Attach Reject. Cause= %02X\n", attach_rej.emm_cause);
+  log_warning(nas_log, "Received Attach Reject. Cause= %02X\n", attach_rej.emm_cause);
   nas_log->console("Received Attach Reject. Cause= %02X\n", attach_rej.emm_cause);
   state = EMM_STATE_DEREGISTERED;
   pool->deallocate(pdu);
@@ -276,7 +276,7 @@ void nas::parse_authentication_request(uint32_t lcid, byte_buffer_t *pdu)
   LIBLTE_MME_AUTHENTICATION_REQUEST_MSG_STRUCT  auth_req;
   LIBLTE_MME_AUTHENTICATION_RESPONSE_MSG_STRUCT auth_res;
 
-  nas_log->info("Received Authentication Request\n");;
+  log_info(nas_log, "Received Authentication Request\n");;
   liblte_mme_unpack_authentication_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu, &auth_req);
 
   // Reuse the pdu for the response message
@@ -287,7 +287,7 @@ void nas::parse_authentication_request(uint32_t lcid, byte_buffer_t *pdu)
   mcc = rrc->get_mcc();
   mnc = rrc->get_mnc();
 
-  nas_log->info("MCC=%d, MNC=%d\n", mcc, mnc);
+  log_info(nas_log, "MCC=%d, MNC=%d\n", mcc, mnc);
 
   bool    net_valid;
   uint8_t res[8];
@@ -295,26 +295,26 @@ void nas::parse_authentication_request(uint32_t lcid, byte_buffer_t *pdu)
 
   if(net_valid)
   {
-    nas_log->info("Network authentication succesful\n");
+    log_info(nas_log, "Network authentication succesful\n");
     for(int i=0; i<8; i++)
     {
       auth_res.res[i] = res[i];
     }
     liblte_mme_pack_authentication_response_msg(&auth_res, (LIBLTE_BYTE_MSG_STRUCT*)pdu);
 
-    nas_log->info("Sending Authentication Response\n");
+    log_info(nas_log, "Sending Authentication Response\n");
     rrc->write_sdu(lcid, pdu);
   }
   else
   {
-    nas_log->warning("Network authentication failure\n");
+    log_warning(nas_log, "Network authentication failure\n");
     pool->deallocate(pdu);
   }
 }
 
 void nas::parse_authentication_reject(uint32_t lcid, byte_buffer_t *pdu)
 {
-  nas_log->warning("Received Authentication Reject\n");
+  log_warning(nas_log, "Received Authentication Reject\n");
   pool->deallocate(pdu);
   state = EMM_STATE_DEREGISTERED;
   // FIXME: Command RRC to release?
@@ -322,7 +322,7 @@ void nas::parse_authentication_reject(uint32_t lcid, byte_buffer_t *pdu)
 
 void nas::parse_identity_request(uint32_t lcid, byte_buffer_t *pdu)
 {
-  nas_log->error("TODO:parse_identity_request\n");
+  log_error(nas_log, "TODO:parse_identity_request\n");
 }
 
 void nas::parse_security_mode_command(uint32_t lcid, byte_buffer_t *pdu)
@@ -331,7 +331,7 @@ void nas::parse_security_mode_command(uint32_t lcid, byte_buffer_t *pdu)
   LIBLTE_MME_SECURITY_MODE_COMPLETE_MSG_STRUCT sec_mode_comp;
   LIBLTE_MME_SECURITY_MODE_REJECT_MSG_STRUCT   sec_mode_rej;
 
-  nas_log->info("Received Security Mode Command\n");
+  log_info(nas_log, "Received Security Mode Command\n");
   liblte_mme_unpack_security_mode_command_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu, &sec_mode_cmd);
 
   // FIXME: Handle nonce_ue, nonce_mme
@@ -347,7 +347,7 @@ void nas::parse_security_mode_command(uint32_t lcid, byte_buffer_t *pdu)
     // Send security mode reject
     sec_mode_rej.emm_cause = LIBLTE_MME_EMM_CAUSE_UE_SECURITY_CAPABILITIES_MISMATCH;
     liblte_mme_pack_security_mode_reject_msg(&sec_mode_rej, (LIBLTE_BYTE_MSG_STRUCT*)pdu);
-    nas_log->warning("Sending Security Mode Reject due to security capabilities mismatch\n");
+    log_warning(nas_log, "Sending Security Mode Reject due to security capabilities mismatch\n");
   }
   else
   {
@@ -376,7 +376,7 @@ void nas::parse_security_mode_command(uint32_t lcid, byte_buffer_t *pdu)
                                                LIBLTE_SECURITY_DIRECTION_UPLINK,
                                                lcid-1,
                                                (LIBLTE_BYTE_MSG_STRUCT*)pdu);
-    nas_log->info("Sending Security Mode Complete nas_count_ul=%d, RB=%s\n",
+    log_info(nas_log, "Sending Security Mode Complete nas_count_ul=%d, RB=%s\n",
                  count_ul,
                  rb_id_text[lcid]);
   }
@@ -386,15 +386,15 @@ void nas::parse_security_mode_command(uint32_t lcid, byte_buffer_t *pdu)
 
 void nas::parse_service_reject(uint32_t lcid, byte_buffer_t *pdu)
 {
-  nas_log->error("TODO:parse_service_reject\n");
+  log_error(nas_log, "TODO:parse_service_reject\n");
 }
 void nas::parse_esm_information_request(uint32_t lcid, byte_buffer_t *pdu)
 {
-  nas_log->error("TODO:parse_esm_information_request\n");
+  log_error(nas_log, "TODO:parse_esm_information_request\n");
 }
 void nas::parse_emm_information(uint32_t lcid, byte_buffer_t *pdu)
 {
-  nas_log->error("TODO:parse_emm_information\n");
+  log_error(nas_log, "TODO:parse_emm_information\n");
 }
 
 /*******************************************************************************
@@ -447,7 +447,7 @@ void nas::send_attach_request()
   // Pack the message
   liblte_mme_pack_attach_request_msg(&attach_req, (LIBLTE_BYTE_MSG_STRUCT*)msg);
 
-  nas_log->info("Sending attach request\n");
+  log_info(nas_log, "Sending attach request\n");
   rrc->write_sdu(RB_ID_SRB1, msg);
 }
 
@@ -455,7 +455,7 @@ void nas::gen_pdn_connectivity_request(LIBLTE_BYTE_MSG_STRUCT *msg)
 {
     LIBLTE_MME_PDN_CONNECTIVITY_REQUEST_MSG_STRUCT  pdn_con_req;
 
-    nas_log->info("Generating PDN Connectivity Request\n");
+    log_info(nas_log, "Generating PDN Connectivity Request\n");
 
     // Set the PDN con req parameters
     pdn_con_req.eps_bearer_id       = 0x05;     // First Bearer ID
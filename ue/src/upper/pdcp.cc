@@ -59,11 +59,11 @@ void pdcp::write_sdu(uint32_t lcid, byte_buffer_t *sdu)
 void pdcp::add_bearer(uint32_t lcid, LIBLTE_RRC_PDCP_CONFIG_STRUCT *cnfg)
 {
   if(lcid < 0 || lcid >= SRSUE_N_RADIO_BEARERS) {
-    pdcp_log->error("Radio bearer id must be in [0:%d] - %d\n", SRSUE_N_RADIO_BEARERS, lcid);
+    log_error(pdcp_log, "Radio bearer id must be in [0:%d] - %d\n", SRSUE_N_RADIO_BEARERS, lcid);
     return;
   }
   pdcp_array[lcid].init(rlc, rrc, gw, pdcp_log, lcid, cnfg);
-  pdcp_log->info("Added bearer %s\n", rb_id_text[lcid]);
+  log_info(pdcp_log, "Added bearer %s\n", rb_id_text[lcid]);
 }
 
 void pdcp::config_security(uint32_t lcid, uint8_t *k_rrc_enc, uint8_t *k_rrc_int)
@@ -96,11 +96,11 @@ void pdcp::write_pdu_bcch_dlsch(byte_buffer_t *sdu)
 bool pdcp::valid_lcid(uint32_t lcid)
 {
   if(lcid < 0 || lcid >= SRSUE_N_RADIO_BEARERS) {
-    pdcp_log->error("Radio bearer id must be in [0:%d] - %d", SRSUE_N_RADIO_BEARERS, lcid);
+    log_error(pdcp_log, "Radio bearer id must be in [0:%d] - %d", SRSUE_N_RADIO_BEARERS, lcid);
     return false;
   }
   if(!pdcp_array[lcid].is_active()) {
-    pdcp_log->error("RLC entity for logical channel %d has not been activated", lcid);
+    log_error(pdcp_log, "RLC entity for logical channel %d has not been activated", lcid);
     return false;
   }
   return true;
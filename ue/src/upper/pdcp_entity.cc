@@ -76,7 +76,7 @@ bool pdcp_entity::is_active()
 // RRC interface
 void pdcp_entity::write_sdu(byte_buffer_t *sdu)
 {
-  log->info_hex(sdu->msg, sdu->N_bytes, "UL %s SDU", rb_id_text[lcid]);
+  log_info_hex(log, sdu->msg, sdu->N_bytes, "UL %s SDU", rb_id_text[lcid]);
 
   // Handle SRB messages
   switch(lcid)
@@ -133,15 +133,15 @@ void pdcp_entity::write_pdu(byte_buffer_t *pdu)
   {
   case RB_ID_SRB0:
     // Simply pass on to RRC
-    log->info_hex(pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
+    log_info_hex(log, pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
     rrc->write_pdu(RB_ID_SRB0, pdu);
     break;
   case RB_ID_SRB1: // Intentional fall-through
   case RB_ID_SRB2:
     uint32_t sn;
-    log->info_hex(pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
+    log_info_hex(log, pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
     pdcp_unpack_control_pdu(pdu, &sn);
-    log->info_hex(pdu->msg, pdu->N_bytes, "DL %s SDU SN: %d",
+    log_info_hex(log, pdu->msg, pdu->N_bytes, "DL %s SDU SN: %d",
                   rb_id_text[lcid], sn);
     rrc->write_pdu(lcid, pdu);
     break;
@@ -157,7 +157,7 @@ void pdcp_entity::write_pdu(byte_buffer_t *pdu)
     } else {
       pdcp_unpack_data_pdu_short_sn(pdu, &sn);
     }
-    log->info_hex(pdu->msg, pdu->N_bytes, "DL %s PDU: %d", rb_id_text[lcid], sn);
+    log_info_hex(log, pdu->msg, pdu->N_bytes, "DL %s PDU: %d", rb_id_text[lcid], sn);
     gw->write_pdu(lcid, pdu);
   }
 }
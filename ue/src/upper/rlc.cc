@@ -101,8 +101,8 @@ void rlc::write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
 
 void rlc::write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes)
 {
-  rlc_log->info_hex(payload, nof_bytes, "BCCH BCH message received.");
-  byte_buffer_t *buf = pool->allocate();
+  log_info_hex(rlc_log, payload, nof_bytes, "BCCH BCH message received.");
+  byte_buffer_t *buf = pool->allocate(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   pdcp->write_pdu_bcch_bch(buf);
@@ -110,8 +110,8 @@ void rlc::write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes)
 
 void rlc::write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes)
 {
-  rlc_log->info_hex(payload, nof_bytes, "BCCH DLSCH message received.");
-  byte_buffer_t *buf = pool->allocate();
+  log_info_hex(rlc_log, payload, nof_bytes, "BCCH DLSCH message received.");
+  byte_buffer_t *buf = pool->allocate(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   pdcp->write_pdu_bcch_dlsch(buf);
@@ -135,7 +135,7 @@ void rlc::add_bearer(uint32_t lcid)
     cnfg.dl_am_rlc.t_status_prohibit  = LIBLTE_RRC_T_STATUS_PROHIBIT_MS0;
     add_bearer(lcid, &cnfg);
   }else{
-    rlc_log->error("Radio bearer %s does not support default RLC configuration.",
+    log_error(rlc_log, "Radio bearer %s does not support default RLC configuration.",
                    rb_id_text[lcid]);
   }
 }
@@ -143,10 +143,10 @@ void rlc::add_bearer(uint32_t lcid)
 void rlc::add_bearer(uint32_t lcid, LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
 {
   if(lcid < 0 || lcid >= SRSUE_N_RADIO_BEARERS) {
-    rlc_log->error("Radio bearer id must be in [0:%d] - %d\n", SRSUE_N_RADIO_BEARERS, lcid);
+    log_error(rlc_log, "Radio bearer id must be in [0:%d] - %d\n", SRSUE_N_RADIO_BEARERS, lcid);
     return;
   }else{
-    rlc_log->info("Adding radio bearer %s with mode %s\n",
+    log_info(rlc_log, "Adding radio bearer %s with mode %s\n",
                   rb_id_text[lcid], liblte_rrc_rlc_mode_text[cnfg->rlc_mode]);
   }
 
@@ -165,7 +165,7 @@ void rlc::add_bearer(uint32_t lcid, LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rlc_array[lcid] = new rlc_um;
     break;
   default:
-    rlc_log->error("Cannot add RLC entity - invalid mode\n");
+    log_error(rlc_log, "Cannot add RLC entity - invalid mode\n");
     return;
   }
   rlc_array[lcid]->init(rlc_log, lcid, pdcp, rrc, mac_timers);
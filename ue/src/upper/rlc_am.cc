@@ -81,7 +81,7 @@ void rlc_am::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
   t_reordering      = liblte_rrc_t_reordering_num[cnfg->dl_am_rlc.t_reordering];
   t_status_prohibit = liblte_rrc_t_status_prohibit_num[cnfg->dl_am_rlc.t_status_prohibit];
 
-  log->info("%s configured: t_poll_retx=%d, poll_pdu=%d, poll_byte=%d, max_retx_thresh=%d, "
+  log_info(log, "%s configured: t_poll_retx=%d, poll_pdu=%d, poll_byte=%d, max_retx_thresh=%d, "
             "t_reordering=%d, t_status_prohibit=%d\n",
             rb_id_text[lcid], t_poll_retx, poll_pdu, poll_byte, max_retx_thresh,
             t_reordering, t_status_prohibit);
@@ -103,7 +103,7 @@ uint32_t rlc_am::get_bearer()
 
 void rlc_am::write_sdu(byte_buffer_t *sdu)
 {
-  log->info_hex(sdu->msg, sdu->N_bytes, "%s Tx SDU", rb_id_text[lcid]);
+  log_info_hex(log, sdu->msg, sdu->N_bytes, "%s Tx SDU", rb_id_text[lcid]);
   tx_sdu_queue.write(sdu);
 }
 
@@ -148,7 +148,7 @@ int rlc_am::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   boost::lock_guard<boost::mutex> lock(mutex);
 
-  log->info("MAC opportunity - %d bytes\n", nof_bytes);
+  log_info(log, "MAC opportunity - %d bytes\n", nof_bytes);
 
   // Tx STATUS if requested
   if(do_status && !status_prohibited())
@@ -193,7 +193,7 @@ void rlc_am::check_reordering_timeout()
   if(reordering_timeout.is_running() && reordering_timeout.expired())
   {
     reordering_timeout.reset();
-    log->debug("%s reordering timeout expiry - updating vr_ms\n", rb_id_text[lcid]);
+    log_debug(log, "%s reordering timeout expiry - updating vr_ms\n", rb_id_text[lcid]);
 
     // 36.322 v10 Section 5.1.3.2.4
     vr_ms = vr_x;
@@ -252,7 +252,7 @@ int  rlc_am::build_status_pdu(uint8_t *payload, uint32_t nof_bytes)
   int pdu_len = rlc_am_packed_length(&status);
   if(nof_bytes >= pdu_len)
   {
-    log->info("%s Tx status PDU - %s\n",
+    log_info(log, "%s Tx status PDU - %s\n",
               rb_id_text[lcid], rlc_am_to_string(&status).c_str());
 
     do_status     = false;
@@ -263,7 +263,7 @@ int  rlc_am::build_status_pdu(uint8_t *payload, uint32_t nof_bytes)
     debug_state();
     return rlc_am_write_status_pdu(&status, payload);
   }else{
-    log->warning("%s Cannot tx status PDU - %d bytes available, %d bytes required\n",
+    log_warning(log, "%s Cannot tx status PDU - %d bytes available, %d bytes required\n",
                  rb_id_text[lcid], nof_bytes, pdu_len);
     return 0;
   }
@@ -291,13 +291,13 @@ int  rlc_am::build_retx_pdu(uint8_t *payload, uint32_t nof_bytes)
     tx_window[sn].retx_count++;
     if(tx_window[sn].retx_count >= max_retx_thresh)
       rrc->max_retx_attempted();
-    log->info("%s Retx SN %d, retx count: %d\n",
+    log_info(log, "%s Retx SN %d, retx count: %d\n",
               rb_id_text[lcid], sn, tx_window[sn].retx_count);
     debug_state();
     return tx_window[sn].buf->N_bytes;
   }else{
     //TODO: implement PDU resegmentation
-    log->warning("%s Cannot retx SN %d - %d bytes available, %d bytes required\n",
+    log_warning(log, "%s Cannot retx SN %d - %d bytes available, %d bytes required\n",
                  rb_id_text[lcid], sn, nof_bytes, tx_window[sn].buf->N_bytes);
     return 0;
   }
@@ -307,11 +307,11 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   if(!tx_sdu && tx_sdu_queue.size() == 0)
   {
-    log->info("No data available to be sent");
+    log_info(log, "No data available to be sent");
     return 0;
   }
 
-  byte_buffer_t *pdu = pool->allocate();
+  byte_buffer_t *pdu = pool->allocate(nof_bytes);
   rlc_amd_pdu_header_t header;
   header.dc   = RLC_DC_FIELD_DATA_PDU;
   header.rf   = 0;
@@ -330,7 +330,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   if(pdu_space <= head_len)
   {
-    log->warning("%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
+    log_warning(log, "%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
                  rb_id_text[lcid], nof_bytes, head_len);
     return 0;
   }
@@ -413,17 +413,17 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   rlc_amd_pdu_header_t header;
   rlc_am_read_data_pdu_header(payload, nof_bytes, &header);
 
-  log->info_hex(payload, nof_bytes, "%s Rx data PDU SN: %d",
+  log_info_hex(log, payload, nof_bytes, "%s Rx data PDU SN: %d",
                 rb_id_text[lcid], header.sn);
 
   if(!inside_rx_window(header.sn))
   {
     if(header.p)
     {
-      log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
+      log_info(log, "%s Status packet requested through polling bit\n", rb_id_text[lcid]);
       do_status = true;
     }
-    log->info("%s SN: %d outside rx window [%d:%d] - discarding\n",
+    log_info(log, "%s SN: %d outside rx window [%d:%d] - discarding\n",
               rb_id_text[lcid], header.sn, vr_r, vr_mr);
     return;
   }
@@ -432,17 +432,17 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   {
     if(header.p)
     {
-      log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
+      log_info(log, "%s Status packet requested through polling bit\n", rb_id_text[lcid]);
       do_status = true;
     }
-    log->info("%s Discarding duplicate SN: %d\n",
+    log_info(log, "%s Discarding duplicate SN: %d\n",
               rb_id_text[lcid], header.sn);
     return;
   }
 
   // Write to rx window
   rlc_amd_rx_pdu_t pdu;
-  pdu.buf = pool->allocate();
+  pdu.buf = pool->allocate(nof_bytes);
   memcpy(pdu.buf->msg, payload, nof_bytes);
   pdu.buf->N_bytes = nof_bytes;
   //Strip header from PDU
@@ -469,7 +469,7 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   // Check poll bit
   if(header.p)
   {
-    log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
+    log_info(log, "%s Status packet requested through polling bit\n", rb_id_text[lcid]);
     poll_received = true;
 
     // 36.322 v10 Section 5.2.3
@@ -511,12 +511,12 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 
 void rlc_am::handle_control_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  log->info_hex(payload, nof_bytes, "%s Rx control PDU", rb_id_text[lcid]);
+  log_info_hex(log, payload, nof_bytes, "%s Rx control PDU", rb_id_text[lcid]);
 
   rlc_status_pdu_t status;
   rlc_am_read_status_pdu(payload, nof_bytes, &status);
 
-  log->info("%s Rx Status PDU: %s\n", rb_id_text[lcid], rlc_am_to_string(&status).c_str());
+  log_info(log, "%s Rx Status PDU: %s\n", rb_id_text[lcid], rlc_am_to_string(&status).c_str());
 
   poll_retx_timeout.reset();
 
@@ -571,7 +571,7 @@ void rlc_am::reassemble_rx_sdus()
       rx_sdu->N_bytes += len;
       rx_window[vr_r].buf->msg += len;
       rx_window[vr_r].buf->N_bytes -= len;
-      log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+      log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       pdcp->write_pdu(lcid, rx_sdu);
       rx_sdu = pool->allocate();
     }
@@ -581,7 +581,7 @@ void rlc_am::reassemble_rx_sdus()
     rx_sdu->N_bytes += rx_window[vr_r].buf->N_bytes;
     if(rlc_am_end_aligned(rx_window[vr_r].header.fi))
     {
-      log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+      log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       pdcp->write_pdu(lcid, rx_sdu);
       rx_sdu = pool->allocate();
     }
@@ -618,7 +618,7 @@ bool rlc_am::inside_rx_window(uint16_t sn)
 
 void rlc_am::debug_state()
 {
-  log->debug("%s vt_a = %d, vt_ms = %d, vt_s = %d, poll_sn = %d \n"
+  log_debug(log, "%s vt_a = %d, vt_ms = %d, vt_s = %d, poll_sn = %d \n"
              "vr_r = %d, vr_mr = %d, vr_x = %d, vr_ms = %d, vr_h = %d\n",
              rb_id_text[lcid], vt_a, vt_ms, vt_s, poll_sn,
              vr_r, vr_mr, vr_x, vr_ms, vr_h);
@@ -50,7 +50,7 @@ void rlc_tm::init(srslte::log        *log_,
 
 void rlc_tm::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
 {
-  log->error("Attempted to configure TM RLC entity");
+  log_error(log, "Attempted to configure TM RLC entity");
 }
 
 rlc_mode_t rlc_tm::get_mode()
@@ -80,7 +80,7 @@ int rlc_tm::read_pdu(uint8_t *payload, uint32_t nof_bytes)
   uint32_t pdu_size = ul_queue.size_tail_bytes();
   if(pdu_size > nof_bytes)
   {
-    log->error("UL %s PDU size larger than MAC opportunity\n", rb_id_text[lcid]);
+    log_error(log, "UL %s PDU size larger than MAC opportunity\n", rb_id_text[lcid]);
     return 0;
   }
 
@@ -89,13 +89,13 @@ int rlc_tm::read_pdu(uint8_t *payload, uint32_t nof_bytes)
   pdu_size = buf->N_bytes;
   memcpy(payload, buf->msg, buf->N_bytes);
   pool->deallocate(buf);
-  log->info_hex(payload, pdu_size, "UL %s, %s PDU", rb_id_text[lcid], rlc_mode_text[RLC_MODE_TM]);
+  log_info_hex(log, payload, pdu_size, "UL %s, %s PDU", rb_id_text[lcid], rlc_mode_text[RLC_MODE_TM]);
   return pdu_size;
 }
 
 void rlc_tm:: write_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  byte_buffer_t *buf = pool->allocate();
+  byte_buffer_t *buf = pool->allocate(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   pdcp->write_pdu(lcid, buf);  
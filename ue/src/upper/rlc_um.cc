@@ -72,7 +72,7 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rx_mod              = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 32 : 1024;
     tx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->ul_um_bi_rlc.sn_field_len;
     tx_mod              = (RLC_UMD_SN_SIZE_5_BITS == tx_sn_field_length) ? 32 : 1024;
-    log->info("%s configured in %s mode: "
+    log_info(log, "%s configured in %s mode: "
               "t_reordering=%d ms, rx_sn_field_length=%u bits, tx_sn_field_length=%u bits\n",
               rb_id_text[lcid], liblte_rrc_rlc_mode_text[cnfg->rlc_mode],
               liblte_rrc_t_reordering_num[t_reordering],
@@ -82,7 +82,7 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
   case LIBLTE_RRC_RLC_MODE_UM_UNI_UL:
     tx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->ul_um_uni_rlc.sn_field_len;
     tx_mod              = (RLC_UMD_SN_SIZE_5_BITS == tx_sn_field_length) ? 32 : 1024;
-    log->info("%s configured in %s mode: tx_sn_field_length=%u bits\n",
+    log_info(log, "%s configured in %s mode: tx_sn_field_length=%u bits\n",
               rb_id_text[lcid], liblte_rrc_rlc_mode_text[cnfg->rlc_mode],
               rlc_umd_sn_size_num[tx_sn_field_length]);
     break;
@@ -91,14 +91,14 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->dl_um_uni_rlc.sn_field_len;
     rx_window_size      = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 16 : 512;
     rx_mod              = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 32 : 1024;
-    log->info("%s configured in %s mode: "
+    log_info(log, "%s configured in %s mode: "
               "t_reordering=%d ms, rx_sn_field_length=%u bits\n",
               rb_id_text[lcid], liblte_rrc_rlc_mode_text[cnfg->rlc_mode],
               liblte_rrc_t_reordering_num[t_reordering],
               rlc_umd_sn_size_num[rx_sn_field_length]);
     break;
   default:
-    log->error("RLC configuration mode not recognized\n");
+    log_error(log, "RLC configuration mode not recognized\n");
   }
 }
 
@@ -118,8 +118,13 @@ uint32_t rlc_um::get_bearer()
 
 void rlc_um::write_sdu(byte_buffer_t *sdu)
 {
-  log->info_hex(sdu->msg, sdu->N_bytes, "%s Tx SDU", rb_id_text[lcid]);
-  tx_sdu_queue.write(sdu);
+  log_info_hex(log, sdu->msg, sdu->N_bytes, "%s Tx SDU", rb_id_text[lcid]);
+  // Don't stall PDCP when MAC stops pulling data, UM SDUs may be lost anyway
+  if(!tx_sdu_queue.try_write(sdu))
+  {
+    log_warning(log, "%s Tx SDU queue full - dropping SDU\n", rb_id_text[lcid]);
+    pool->deallocate(sdu);
+  }
 }
 
 /****************************************************************************
@@ -150,7 +155,7 @@ uint32_t rlc_um::get_buffer_state()
 
 int rlc_um::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  log->info("MAC opportunity - %d bytes\n", nof_bytes);
+  log_info(log, "MAC opportunity - %d bytes\n", nof_bytes);
   return build_data_pdu(payload, nof_bytes);
 }
 
@@ -171,10 +176,10 @@ void rlc_um::timer_expired(uint32_t timeout_id)
     boost::lock_guard<boost::mutex> lock(mutex);
 
     // 36.322 v10 Section 5.1.2.2.4
-    log->debug("%s reordering timeout expiry - updating vr_ur and reassembling\n",
+    log_debug(log, "%s reordering timeout expiry - updating vr_ur and reassembling\n",
                rb_id_text[lcid]);
 
-    log->warning("Lost PDU SN: %d", vr_ur);
+    log_warning(log, "Lost PDU SN: %d", vr_ur);
     pdu_lost = true;
     rx_sdu->reset();
     while(RX_MOD_BASE(vr_ur) < RX_MOD_BASE(vr_ux))
@@ -206,14 +211,14 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   if(!tx_sdu && tx_sdu_queue.size() == 0)
   {
-    log->info("No data available to be sent");
+    log_info(log, "No data available to be sent");
     return 0;
   }
 
-  byte_buffer_t *pdu = pool->allocate();
+  byte_buffer_t *pdu = pool->allocate(nof_bytes);
   if(!pdu || pdu->N_bytes != 0)
   {
-    log->error("Failed to allocate PDU buffer\n");
+    log_error(log, "Failed to allocate PDU buffer\n");
     return 0;
   }
   rlc_umd_pdu_header_t header;
@@ -231,7 +236,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   if(pdu_space <= head_len)
   {
-    log->warning("%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
+    log_warning(log, "%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
                  rb_id_text[lcid], nof_bytes, head_len);
     return 0;
   }
@@ -240,7 +245,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   if(tx_sdu)
   {
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
-    log->debug("%s adding remainder of SDU segment - %d bytes of %d remaining\n",
+    log_debug(log, "%s adding remainder of SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
     memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
@@ -260,13 +265,13 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   // Pull SDUs from queue
   while(pdu_space > head_len && tx_sdu_queue.size() > 0)
   {
-    log->debug("pdu_space=%d, head_len=%d\n", pdu_space, head_len);
+    log_debug(log, "pdu_space=%d, head_len=%d\n", pdu_space, head_len);
     if(last_li > 0)
       header.li[header.N_li++] = last_li;
     head_len = rlc_um_packed_length(&header);
     tx_sdu_queue.read(&tx_sdu);
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
-    log->debug("%s adding new SDU segment - %d bytes of %d remaining\n",
+    log_debug(log, "%s adding new SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
     memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
@@ -290,11 +295,11 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   vt_us = (vt_us + 1)%tx_mod;
 
   // Add header and TX
-  log->debug("%s packing PDU with length %d\n", rb_id_text[lcid], pdu->N_bytes);
+  log_debug(log, "%s packing PDU with length %d\n", rb_id_text[lcid], pdu->N_bytes);
   rlc_um_write_data_pdu_header(&header, pdu);
   memcpy(payload, pdu->msg, pdu->N_bytes);
   uint32_t ret = pdu->N_bytes;
-  log->debug("%sreturning length %d\n", rb_id_text[lcid], pdu->N_bytes);
+  log_debug(log, "%sreturning length %d\n", rb_id_text[lcid], pdu->N_bytes);
   pool->deallocate(pdu);
 
   debug_state();
@@ -307,27 +312,27 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   rlc_umd_pdu_header_t header;
   rlc_um_read_data_pdu_header(payload, nof_bytes, rx_sn_field_length, &header);
 
-  log->info_hex(payload, nof_bytes, "DL %s Rx data PDU SN: %d",
+  log_info_hex(log, payload, nof_bytes, "DL %s Rx data PDU SN: %d",
                 rb_id_text[lcid], header.sn);
 
   if(RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_uh-rx_window_size) &&
      RX_MOD_BASE(header.sn) <  RX_MOD_BASE(vr_ur))
   {
-    log->info("%s SN: %d outside rx window [%d:%d] - discarding\n",
+    log_info(log, "%s SN: %d outside rx window [%d:%d] - discarding\n",
               rb_id_text[lcid], header.sn, vr_ur, vr_uh);
     return;
   }
   it = rx_window.find(header.sn);
   if(rx_window.end() != it)
   {
-    log->info("%s Discarding duplicate SN: %d\n",
+    log_info(log, "%s Discarding duplicate SN: %d\n",
               rb_id_text[lcid], header.sn);
     return;
   }
 
   // Write to rx window
   rlc_umd_pdu_t pdu;
-  pdu.buf = pool->allocate();
+  pdu.buf = pool->allocate(nof_bytes);
   memcpy(pdu.buf->msg, payload, nof_bytes);
   pdu.buf->N_bytes = nof_bytes;
   //Strip header from PDU
@@ -386,10 +391,10 @@ void rlc_um::reassemble_rx_sdus()
         rx_window[vr_ur].buf->msg += len;
         rx_window[vr_ur].buf->N_bytes -= len;
         if(pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
-          log->warning("Dropping remainder of lost PDU\n");
+          log_warning(log, "Dropping remainder of lost PDU\n");
           rx_sdu->reset();
         } else {
-          log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+          log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
           pdcp->write_pdu(lcid, rx_sdu);
           rx_sdu = pool->allocate();
         }
@@ -402,10 +407,10 @@ void rlc_um::reassemble_rx_sdus()
       if(rlc_um_end_aligned(rx_window[vr_ur].header.fi))
       {
         if(pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
-          log->warning("Dropping remainder of lost PDU\n");
+          log_warning(log, "Dropping remainder of lost PDU\n");
           rx_sdu->reset();
         } else {
-          log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+          log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
           pdcp->write_pdu(lcid, rx_sdu);
           rx_sdu = pool->allocate();
         }
@@ -433,10 +438,10 @@ void rlc_um::reassemble_rx_sdus()
       rx_window[vr_ur].buf->msg += len;
       rx_window[vr_ur].buf->N_bytes -= len;
       if(pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
-        log->warning("Dropping remainder of lost PDU\n");
+        log_warning(log, "Dropping remainder of lost PDU\n");
         rx_sdu->reset();
       } else {
-        log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+        log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
         pdcp->write_pdu(lcid, rx_sdu);
         rx_sdu = pool->allocate();
       }
@@ -449,10 +454,10 @@ void rlc_um::reassemble_rx_sdus()
     if(rlc_um_end_aligned(rx_window[vr_ur].header.fi))
     {
       if(pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
-        log->warning("Dropping remainder of lost PDU\n");
+        log_warning(log, "Dropping remainder of lost PDU\n");
         rx_sdu->reset();
       } else {
-        log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
+        log_info_hex(log, rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
         pdcp->write_pdu(lcid, rx_sdu);
         rx_sdu = pool->allocate();
       }
@@ -480,7 +485,7 @@ bool rlc_um::inside_reordering_window(uint16_t sn)
 
 void rlc_um::debug_state()
 {
-  log->debug("%s vt_us = %d, vr_ur = %d, vr_ux = %d, vr_uh = %d \n",
+  log_debug(log, "%s vt_us = %d, vr_ur = %d, vr_ux = %d, vr_uh = %d \n",
              rb_id_text[lcid], vt_us, vr_ur, vr_ux, vr_uh);
 
 }
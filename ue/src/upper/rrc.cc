@@ -73,7 +73,7 @@ rrc_state_t rrc::get_state()
 
 void rrc::write_sdu(uint32_t lcid, byte_buffer_t *sdu)
 {
-  rrc_log->info_hex(sdu->msg, sdu->N_bytes, "UL %s SDU", rb_id_text[lcid]);
+  log_info_hex(rrc_log, sdu->msg, sdu->N_bytes, "UL %s SDU", rb_id_text[lcid]);
 
   switch(state)
   {
@@ -84,7 +84,7 @@ void rrc::write_sdu(uint32_t lcid, byte_buffer_t *sdu)
     send_ul_info_transfer(lcid, sdu);
     break;
   default:
-    rrc_log->error("SDU received from NAS while RRC state = %s", rrc_state_text[state]);
+    log_error(rrc_log, "SDU received from NAS while RRC state = %s", rrc_state_text[state]);
     break;
   }
 }
@@ -111,7 +111,7 @@ uint16_t rrc::get_mnc()
 
 void rrc::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
 {
-  rrc_log->info_hex(pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
+  log_info_hex(rrc_log, pdu->msg, pdu->N_bytes, "DL %s PDU", rb_id_text[lcid]);
 
   switch(lcid)
   {
@@ -123,7 +123,7 @@ void rrc::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
     parse_dl_dcch(lcid, pdu);
     break;
   default:
-    rrc_log->error("DL PDU with invalid bearer id: %s", lcid);
+    log_error(rrc_log, "DL PDU with invalid bearer id: %s", lcid);
     break;
   }
 
@@ -132,12 +132,12 @@ void rrc::write_pdu(uint32_t lcid, byte_buffer_t *pdu)
 void rrc::write_pdu_bcch_bch(byte_buffer_t *pdu)
 {
   // Unpack the MIB
-  rrc_log->info_hex(pdu->msg, pdu->N_bytes, "BCCH BCH message received.");
+  log_info_hex(rrc_log, pdu->msg, pdu->N_bytes, "BCCH BCH message received.");
   srslte_bit_unpack_vector(pdu->msg, bit_buf.msg, pdu->N_bytes*8);
   bit_buf.N_bits = pdu->N_bytes*8;
   pool->deallocate(pdu);
   liblte_rrc_unpack_bcch_bch_msg((LIBLTE_BIT_MSG_STRUCT*)&bit_buf, &mib);
-  rrc_log->info("MIB received BW=%s MHz\n", liblte_rrc_dl_bandwidth_text[mib.dl_bw]);
+  log_info(rrc_log, "MIB received BW=%s MHz\n", liblte_rrc_dl_bandwidth_text[mib.dl_bw]);
   rrc_log->console("MIB received BW=%s MHz\n", liblte_rrc_dl_bandwidth_text[mib.dl_bw]);
 
   // Start the SIB search state machine
@@ -147,7 +147,7 @@ void rrc::write_pdu_bcch_bch(byte_buffer_t *pdu)
 
 void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
 {
-  rrc_log->info_hex(pdu->msg, pdu->N_bytes, "BCCH DLSCH message received.");
+  log_info_hex(rrc_log, pdu->msg, pdu->N_bytes, "BCCH DLSCH message received.");
   LIBLTE_RRC_BCCH_DLSCH_MSG_STRUCT dlsch_msg;
   srslte_bit_unpack_vector(pdu->msg, bit_buf.msg, pdu->N_bytes*8);
   bit_buf.N_bits = pdu->N_bytes*8;
@@ -158,7 +158,7 @@ void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
     if (LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_1 == dlsch_msg.sibs[0].sib_type && RRC_STATE_SIB1_SEARCH == state) {
       // Handle SIB1
       memcpy(&sib1, &dlsch_msg.sibs[0].sib.sib1, sizeof(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_1_STRUCT));
-      rrc_log->info("SIB1 received, CellID=%d, si_window=%d, sib2_period=%d\n",
+      log_info(rrc_log, "SIB1 received, CellID=%d, si_window=%d, sib2_period=%d\n",
                     sib1.cell_id&0xfff,
                     liblte_rrc_si_window_length_num[sib1.si_window_length],
                     liblte_rrc_si_periodicity_num[sib1.sched_info[0].si_periodicity]);
@@ -178,7 +178,7 @@ void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
       // Handle SIB2
       memcpy(&sib2, &dlsch_msg.sibs[0].sib.sib2, sizeof(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2_STRUCT));
       rrc_log->console("SIB2 received\n");
-      rrc_log->info("SIB2 received\n");
+      log_info(rrc_log, "SIB2 received\n");
       state = RRC_STATE_WAIT_FOR_CON_SETUP;
       mac->set_param(srsue::mac_interface_params::BCCH_SI_WINDOW_ST, -1);
       apply_sib2_configs();
@@ -202,7 +202,7 @@ void rrc::max_retx_attempted()
 
 void rrc::send_con_request()
 {
-  rrc_log->debug("Preparing RRC Connection Request");
+  log_debug(rrc_log, "Preparing RRC Connection Request");
   LIBLTE_RRC_UL_CCCH_MSG_STRUCT ul_ccch_msg;
 
   // Prepare ConnectionRequest packet
@@ -230,17 +230,17 @@ void rrc::send_con_request()
   for (int i=0;i<nbytes;i++) {
     ue_cri_ptr[nbytes-i-1] = pdcp_buf->msg[i];
   }
-  rrc_log->debug("Setting UE contention resolution ID: %d\n", uecri);
+  log_debug(rrc_log, "Setting UE contention resolution ID: %d\n", uecri);
   mac->set_param(srsue::mac_interface_params::CONTENTION_ID, uecri);
 
-  rrc_log->info("Sending RRC Connection Request on SRB0\n");
+  log_info(rrc_log, "Sending RRC Connection Request on SRB0\n");
   state = RRC_STATE_WAIT_FOR_CON_SETUP;
   pdcp->write_sdu(RB_ID_SRB0, pdcp_buf);
 }
 
 void rrc::send_con_setup_complete(byte_buffer_t *nas_msg)
 {
-  rrc_log->debug("Preparing RRC Connection Setup Complete\n");
+  log_debug(rrc_log, "Preparing RRC Connection Setup Complete\n");
   LIBLTE_RRC_UL_DCCH_MSG_STRUCT ul_dcch_msg;
 
   // Prepare ConnectionSetupComplete packet
@@ -263,14 +263,14 @@ void rrc::send_con_setup_complete(byte_buffer_t *nas_msg)
   srslte_bit_pack_vector(bit_buf.msg, pdcp_buf->msg, bit_buf.N_bits);
   pdcp_buf->N_bytes = bit_buf.N_bits/8;
 
-  rrc_log->info("Sending RRC Connection Setup Complete\n");
+  log_info(rrc_log, "Sending RRC Connection Setup Complete\n");
   state = RRC_STATE_RRC_CONNECTED;
   pdcp->write_sdu(RB_ID_SRB1, pdcp_buf);
 }
 
 void rrc::send_ul_info_transfer(uint32_t lcid, byte_buffer_t *sdu)
 {
-  rrc_log->debug("Preparing UL Info Transfer\n");
+  log_debug(rrc_log, "Preparing UL Info Transfer\n");
   LIBLTE_RRC_UL_DCCH_MSG_STRUCT ul_dcch_msg;
 
   // Prepare UL INFO packet
@@ -294,13 +294,13 @@ void rrc::send_ul_info_transfer(uint32_t lcid, byte_buffer_t *sdu)
   srslte_bit_pack_vector(bit_buf.msg, pdu->msg, bit_buf.N_bits);
   pdu->N_bytes = bit_buf.N_bits/8;
 
-  rrc_log->info("Sending UL Info Transfer\n");
+  log_info(rrc_log, "Sending UL Info Transfer\n");
   pdcp->write_sdu(lcid, pdu);
 }
 
 void rrc::send_security_mode_complete(uint32_t lcid, byte_buffer_t *pdu)
 {
-  rrc_log->debug("Preparing Security Mode Complete\n");
+  log_debug(rrc_log, "Preparing Security Mode Complete\n");
   LIBLTE_RRC_UL_DCCH_MSG_STRUCT ul_dcch_msg;
   ul_dcch_msg.msg_type = LIBLTE_RRC_UL_DCCH_MSG_TYPE_SECURITY_MODE_COMPLETE;
   ul_dcch_msg.msg.security_mode_complete.rrc_transaction_id = transaction_id;
@@ -316,13 +316,13 @@ void rrc::send_security_mode_complete(uint32_t lcid, byte_buffer_t *pdu)
   srslte_bit_pack_vector(bit_buf.msg, pdu->msg, bit_buf.N_bits);
   pdu->N_bytes = bit_buf.N_bits/8;
 
-  rrc_log->info("Sending Security Mode Complete\n");
+  log_info(rrc_log, "Sending Security Mode Complete\n");
   pdcp->write_sdu(lcid, pdu);
 }
 
 void rrc::send_rrc_con_reconfig_complete(uint32_t lcid, byte_buffer_t *pdu)
 {
-  rrc_log->debug("Preparing RRC Connection Reconfig Complete\n");
+  log_debug(rrc_log, "Preparing RRC Connection Reconfig Complete\n");
   LIBLTE_RRC_UL_DCCH_MSG_STRUCT ul_dcch_msg;
 
   ul_dcch_msg.msg_type = LIBLTE_RRC_UL_DCCH_MSG_TYPE_RRC_CON_RECONFIG_COMPLETE;
@@ -339,7 +339,7 @@ void rrc::send_rrc_con_reconfig_complete(uint32_t lcid, byte_buffer_t *pdu)
   srslte_bit_pack_vector(bit_buf.msg, pdu->msg, bit_buf.N_bits);
   pdu->N_bytes = bit_buf.N_bits/8;
 
-  rrc_log->info("Sending RRC Connection Reconfig Complete\n");
+  log_info(rrc_log, "Sending RRC Connection Reconfig Complete\n");
   pdcp->write_sdu(lcid, pdu);
 }
 
@@ -351,7 +351,7 @@ void rrc::enable_capabilities()
 
 void rrc::send_rrc_ue_cap_info(uint32_t lcid, byte_buffer_t *pdu)
 {
-  rrc_log->debug("Preparing UE Capability Info\n");
+  log_debug(rrc_log, "Preparing UE Capability Info\n");
   LIBLTE_RRC_UL_DCCH_MSG_STRUCT ul_dcch_msg;
 
   ul_dcch_msg.msg_type = LIBLTE_RRC_UL_DCCH_MSG_TYPE_UE_CAPABILITY_INFO;
@@ -424,7 +424,7 @@ void rrc::send_rrc_ue_cap_info(uint32_t lcid, byte_buffer_t *pdu)
   srslte_bit_pack_vector(bit_buf.msg, pdu->msg, bit_buf.N_bits);
   pdu->N_bytes = bit_buf.N_bits/8;
 
-  rrc_log->info("Sending UE Capability Info\n");
+  log_info(rrc_log, "Sending UE Capability Info\n");
   pdcp->write_sdu(lcid, pdu);
 }
 
@@ -439,28 +439,28 @@ void rrc::parse_dl_ccch(byte_buffer_t *pdu)
   pool->deallocate(pdu);
   liblte_rrc_unpack_dl_ccch_msg((LIBLTE_BIT_MSG_STRUCT*)&bit_buf, &dl_ccch_msg);
 
-  rrc_log->info("SRB0 - Received %s\n",
+  log_info(rrc_log, "SRB0 - Received %s\n",
                 liblte_rrc_dl_ccch_msg_type_text[dl_ccch_msg.msg_type]);
 
   switch(dl_ccch_msg.msg_type)
   {
   case LIBLTE_RRC_DL_CCCH_MSG_TYPE_RRC_CON_REJ:
-    rrc_log->info("Connection Reject received. Wait time: %d\n",
+    log_info(rrc_log, "Connection Reject received. Wait time: %d\n",
                   dl_ccch_msg.msg.rrc_con_rej.wait_time);
     state = RRC_STATE_IDLE;
     break;
   case LIBLTE_RRC_DL_CCCH_MSG_TYPE_RRC_CON_SETUP:
-    rrc_log->info("Connection Setup received\n");
+    log_info(rrc_log, "Connection Setup received\n");
     handle_con_setup(&dl_ccch_msg.msg.rrc_con_setup);
-    rrc_log->info("Notifying NAS of connection setup\n");
+    log_info(rrc_log, "Notifying NAS of connection setup\n");
     state = RRC_STATE_COMPLETING_SETUP;
     nas->notify_connection_setup();
     break;
   case LIBLTE_RRC_DL_CCCH_MSG_TYPE_RRC_CON_REEST:
-    rrc_log->error("Not handling Connection Reestablishment message");
+    log_error(rrc_log, "Not handling Connection Reestablishment message");
     break;
   case LIBLTE_RRC_DL_CCCH_MSG_TYPE_RRC_CON_REEST_REJ:
-    rrc_log->error("Not handling Connection Reestablishment Reject message");
+    log_error(rrc_log, "Not handling Connection Reestablishment Reject message");
     break;
   default:
     break;
@@ -473,7 +473,7 @@ void rrc::parse_dl_dcch(uint32_t lcid, byte_buffer_t *pdu)
   bit_buf.N_bits = pdu->N_bytes*8;
   liblte_rrc_unpack_dl_dcch_msg((LIBLTE_BIT_MSG_STRUCT*)&bit_buf, &dl_dcch_msg);
 
-  rrc_log->info("%s - Received %s\n",
+  log_info(rrc_log, "%s - Received %s\n",
                 rb_id_text[lcid],
                 liblte_rrc_dl_dcch_msg_type_text[dl_dcch_msg.msg_type]);
 
@@ -555,7 +555,7 @@ void rrc::sib_search()
       si_win_start = sib_start_tti(tti, 2, 5);
       mac->set_param(srsue::mac_interface_params::BCCH_SI_WINDOW_ST, si_win_start);
       mac->set_param(srsue::mac_interface_params::BCCH_SI_WINDOW_LEN, 1);
-      rrc_log->debug("Instructed MAC to search for SIB1, win_start=%d, win_len=%d\n",
+      log_debug(rrc_log, "Instructed MAC to search for SIB1, win_start=%d, win_len=%d\n",
                      si_win_start, 1);
 
       break;
@@ -569,7 +569,7 @@ void rrc::sib_search()
 
       mac->set_param(srsue::mac_interface_params::BCCH_SI_WINDOW_ST,  si_win_start);
       mac->set_param(srsue::mac_interface_params::BCCH_SI_WINDOW_LEN, si_win_len);
-      rrc_log->debug("Instructed MAC to search for SIB2, win_start=%d, win_len=%d\n",
+      log_debug(rrc_log, "Instructed MAC to search for SIB2, win_start=%d, win_len=%d\n",
                      si_win_start, si_win_len);
 
       break;
@@ -589,7 +589,7 @@ uint32_t rrc::sib_start_tti(uint32_t tti, uint32_t period, uint32_t x) {
 void rrc::apply_sib2_configs()
 {
   if(RRC_STATE_WAIT_FOR_CON_SETUP != state){
-    rrc_log->error("State must be RRC_STATE_WAIT_FOR_CON_SETUP to handle SIB2. Actual state: %s\n",
+    log_error(rrc_log, "State must be RRC_STATE_WAIT_FOR_CON_SETUP to handle SIB2. Actual state: %s\n",
                    rrc_state_text[state]);
     return;
   }
@@ -618,7 +618,7 @@ void rrc::apply_sib2_configs()
   mac->set_param(srsue::mac_interface_params::HARQ_MAXMSG3TX,
                  sib2.rr_config_common_sib.rach_cnfg.max_harq_msg3_tx);
 
-  rrc_log->info("Set RACH ConfigCommon: NofPreambles=%d, ResponseWindow=%d, ContentionResolutionTimer=%d ms\n",
+  log_info(rrc_log, "Set RACH ConfigCommon: NofPreambles=%d, ResponseWindow=%d, ContentionResolutionTimer=%d ms\n",
          liblte_rrc_number_of_ra_preambles_num[sib2.rr_config_common_sib.rach_cnfg.num_ra_preambles],
          liblte_rrc_ra_response_window_size_num[sib2.rr_config_common_sib.rach_cnfg.ra_resp_win_size],
          liblte_rrc_mac_contention_resolution_timer_num[sib2.rr_config_common_sib.rach_cnfg.mac_con_res_timer]);
@@ -646,7 +646,7 @@ void rrc::apply_sib2_configs()
   phy->set_param(srsue::phy_interface_params::PUSCH_RS_GROUP_ASSIGNMENT,
                  sib2.rr_config_common_sib.pusch_cnfg.ul_rs.group_assignment_pusch);
 
-  rrc_log->info("Set PUSCH ConfigCommon: HopOffset=%d, RSGroup=%d, RSNcs=%d, N_sb=%d\n",
+  log_info(rrc_log, "Set PUSCH ConfigCommon: HopOffset=%d, RSGroup=%d, RSNcs=%d, N_sb=%d\n",
     sib2.rr_config_common_sib.pusch_cnfg.pusch_hopping_offset,
     sib2.rr_config_common_sib.pusch_cnfg.ul_rs.group_assignment_pusch,
     sib2.rr_config_common_sib.pusch_cnfg.ul_rs.cyclic_shift,
@@ -662,7 +662,7 @@ void rrc::apply_sib2_configs()
   phy->set_param(srsue::phy_interface_params::PUCCH_N_RB_2,
                  sib2.rr_config_common_sib.pucch_cnfg.n_rb_cqi);
 
-  rrc_log->info("Set PUCCH ConfigCommon: DeltaShift=%d, CyclicShift=%d, N1=%d, NRB=%d\n",
+  log_info(rrc_log, "Set PUCCH ConfigCommon: DeltaShift=%d, CyclicShift=%d, N1=%d, NRB=%d\n",
          liblte_rrc_delta_pucch_shift_num[sib2.rr_config_common_sib.pucch_cnfg.delta_pucch_shift],
          sib2.rr_config_common_sib.pucch_cnfg.n_cs_an,
          sib2.rr_config_common_sib.pucch_cnfg.n1_pucch_an,
@@ -698,7 +698,7 @@ void rrc::apply_sib2_configs()
   phy->set_param(srsue::phy_interface_params::PRACH_CONFIG_INDEX,
                  sib2.rr_config_common_sib.prach_cnfg.prach_cnfg_info.prach_config_index);
 
-  rrc_log->info("Set PRACH ConfigCommon: SeqIdx=%d, HS=%d, FreqOffset=%d, ZC=%d, ConfigIndex=%d\n",
+  log_info(rrc_log, "Set PRACH ConfigCommon: SeqIdx=%d, HS=%d, FreqOffset=%d, ZC=%d, ConfigIndex=%d\n",
                  sib2.rr_config_common_sib.prach_cnfg.root_sequence_index,
                  sib2.rr_config_common_sib.prach_cnfg.prach_cnfg_info.high_speed_flag?1:0,
                  sib2.rr_config_common_sib.prach_cnfg.prach_cnfg_info.prach_freq_offset,
@@ -712,7 +712,7 @@ void rrc::apply_sib2_configs()
     phy->set_param(srsue::phy_interface_params::SRS_CS_ACKNACKSIMUL, sib2.rr_config_common_sib.srs_ul_cnfg.ack_nack_simul_tx);
   }
 
-  rrc_log->info("Set SRS ConfigCommon: BW-Configuration=%d, SF-Configuration=%d, ACKNACK=%d\n",
+  log_info(rrc_log, "Set SRS ConfigCommon: BW-Configuration=%d, SF-Configuration=%d, ACKNACK=%d\n",
                 sib2.rr_config_common_sib.srs_ul_cnfg.bw_cnfg,
                 sib2.rr_config_common_sib.srs_ul_cnfg.subfr_cnfg,
                 sib2.rr_config_common_sib.srs_ul_cnfg.ack_nack_simul_tx);
@@ -820,7 +820,7 @@ void rrc::handle_con_setup(LIBLTE_RRC_CONNECTION_SETUP_STRUCT *setup)
 
       phy->configure_ul_params();
 
-      rrc_log->info("Set PHY config ded: SR-n_pucch=%d, SR-ConfigIndex=%d, SR-TransMax=%d, SRS-ConfigIndex=%d, SRS-bw=%d, SRS-Nrcc=%d, SRS-hop=%d, SRS-Ncs=%d\n",
+      log_info(rrc_log, "Set PHY config ded: SR-n_pucch=%d, SR-ConfigIndex=%d, SR-TransMax=%d, SRS-ConfigIndex=%d, SRS-bw=%d, SRS-Nrcc=%d, SRS-hop=%d, SRS-Ncs=%d\n",
                    phy_cnfg->sched_request_cnfg.sr_pucch_resource_idx,
                    phy_cnfg->sched_request_cnfg.sr_cnfg_idx,
                    liblte_rrc_dsr_trans_max_num[phy_cnfg->sched_request_cnfg.dsr_trans_max],
@@ -834,40 +834,7 @@ void rrc::handle_con_setup(LIBLTE_RRC_CONNECTION_SETUP_STRUCT *setup)
 
   if(cnfg->mac_main_cnfg_present && !cnfg->mac_main_cnfg.default_value)
   {
-    // MAC MAIN CONFIG
-    LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *mac_cnfg = &cnfg->mac_main_cnfg.explicit_value;
-    if(mac_cnfg->ulsch_cnfg_present)
-    {
-      if(mac_cnfg->ulsch_cnfg.max_harq_tx_present)
-      {
-        mac->set_param(srsue::mac_interface_params::HARQ_MAXTX,
-                       liblte_rrc_max_harq_tx_num[mac_cnfg->ulsch_cnfg.max_harq_tx]);
-      }
-      if(mac_cnfg->ulsch_cnfg.periodic_bsr_timer_present)
-      {
-        mac->set_param(srsue::mac_interface_params::BSR_TIMER_PERIODIC,
-                       liblte_rrc_periodic_bsr_timer_num[mac_cnfg->ulsch_cnfg.periodic_bsr_timer]);
-      }
-      mac->set_param(srsue::mac_interface_params::BSR_TIMER_RETX,
-                     liblte_rrc_retransmission_bsr_timer_num[mac_cnfg->ulsch_cnfg.retx_bsr_timer]);
-      //TODO: tti_bundling?
-    }
-    if(mac_cnfg->drx_cnfg_present)
-    {
-      //TODO
-    }
-    if(mac_cnfg->phr_cnfg_present)
-    {
-      mac->set_param(srsue::mac_interface_params::PHR_TIMER_PERIODIC, liblte_rrc_periodic_phr_timer_num[mac_cnfg->phr_cnfg.periodic_phr_timer]);
-      mac->set_param(srsue::mac_interface_params::PHR_TIMER_PROHIBIT, liblte_rrc_prohibit_phr_timer_num[mac_cnfg->phr_cnfg.prohibit_phr_timer]);
-      mac->set_param(srsue::mac_interface_params::PHR_DL_PATHLOSS_CHANGE, liblte_rrc_dl_pathloss_change_num[mac_cnfg->phr_cnfg.dl_pathloss_change]);
-    }
-    //TODO: time_alignment_timer?
-
-    rrc_log->info("Set MAC main config: harq-MaxReTX=%d, bsr-TimerReTX=%d, bsr-TimerPeriodic=%d\n",
-                 liblte_rrc_max_harq_tx_num[mac_cnfg->ulsch_cnfg.max_harq_tx],
-                 liblte_rrc_retransmission_bsr_timer_num[mac_cnfg->ulsch_cnfg.retx_bsr_timer],
-                 liblte_rrc_periodic_bsr_timer_num[mac_cnfg->ulsch_cnfg.periodic_bsr_timer]);
+    apply_mac_config_dedicated(&cnfg->mac_main_cnfg.explicit_value);
   }
 
   if(setup->rr_cnfg.sps_cnfg_present)
@@ -896,7 +863,15 @@ void rrc::handle_rrc_con_reconfig(uint32_t lcid, LIBLTE_RRC_CONNECTION_RECONFIGU
 
   if(reconfig->meas_cnfg_present)
   {
-    //TODO: handle meas_cnfg
+    // Only the serving cell RSRP filter is used for now, measured by the PHY
+    LIBLTE_RRC_QUANTITY_CONFIG_STRUCT *qc = &reconfig->meas_cnfg.quantity_cnfg;
+    if(reconfig->meas_cnfg.quantity_cnfg_present && qc->qc_eutra_present &&
+       liblte_rrc_filter_coefficient_num[qc->qc_eutra.fc_rsrp] >= 0)
+    {
+      phy->set_param(srsue::phy_interface_params::MEAS_FILTER_COEFF, liblte_rrc_filter_coefficient_num[qc->qc_eutra.fc_rsrp]);
+      log_info(rrc_log, "Set RSRP filter coefficient k=%d\n", liblte_rrc_filter_coefficient_num[qc->qc_eutra.fc_rsrp]);
+    }
+    //TODO: handle the rest of meas_cnfg
   }
   if(reconfig->mob_ctrl_info_present)
   {
@@ -905,6 +880,11 @@ void rrc::handle_rrc_con_reconfig(uint32_t lcid, LIBLTE_RRC_CONNECTION_RECONFIGU
 
   if(reconfig->rr_cnfg_ded_present)
   {
+    if(reconfig->rr_cnfg_ded.mac_main_cnfg_present && !reconfig->rr_cnfg_ded.mac_main_cnfg.default_value)
+    {
+      apply_mac_config_dedicated(&reconfig->rr_cnfg_ded.mac_main_cnfg.explicit_value);
+    }
+
     uint32_t n_srb = reconfig->rr_cnfg_ded.srb_to_add_mod_list_size;
     for(i=0; i<n_srb; i++)
     {
@@ -936,6 +916,73 @@ void rrc::handle_rrc_con_reconfig(uint32_t lcid, LIBLTE_RRC_CONNECTION_RECONFIGU
   }
 }
 
+void rrc::apply_mac_config_dedicated(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *mac_cnfg)
+{
+  if(mac_cnfg->ulsch_cnfg_present)
+  {
+    if(mac_cnfg->ulsch_cnfg.max_harq_tx_present)
+    {
+      mac->set_param(srsue::mac_interface_params::HARQ_MAXTX,
+                     liblte_rrc_max_harq_tx_num[mac_cnfg->ulsch_cnfg.max_harq_tx]);
+    }
+    if(mac_cnfg->ulsch_cnfg.periodic_bsr_timer_present)
+    {
+      mac->set_param(srsue::mac_interface_params::BSR_TIMER_PERIODIC,
+                     liblte_rrc_periodic_bsr_timer_num[mac_cnfg->ulsch_cnfg.periodic_bsr_timer]);
+    }
+    mac->set_param(srsue::mac_interface_params::BSR_TIMER_RETX,
+                   liblte_rrc_retransmission_bsr_timer_num[mac_cnfg->ulsch_cnfg.retx_bsr_timer]);
+    //TODO: tti_bundling?
+  }
+  if(mac_cnfg->drx_cnfg_present)
+  {
+    LIBLTE_RRC_DRX_CONFIG_STRUCT *drx_cnfg = &mac_cnfg->drx_cnfg;
+    if(drx_cnfg->setup_present)
+    {
+      mac->set_param(srsue::mac_interface_params::DRX_ON_DURATION_TIMER,
+                     liblte_rrc_on_duration_timer_num[drx_cnfg->on_duration_timer]);
+      mac->set_param(srsue::mac_interface_params::DRX_INACTIVITY_TIMER,
+                     liblte_rrc_drx_inactivity_timer_num[drx_cnfg->drx_inactivity_timer]);
+      mac->set_param(srsue::mac_interface_params::DRX_RETX_TIMER,
+                     liblte_rrc_drx_retransmission_timer_num[drx_cnfg->drx_retx_timer]);
+      mac->set_param(srsue::mac_interface_params::DRX_LONG_CYCLE,
+                     liblte_rrc_long_drx_cycle_start_offset_choice_num[drx_cnfg->long_drx_cycle_start_offset_choice]);
+      mac->set_param(srsue::mac_interface_params::DRX_LONG_CYCLE_OFFSET, drx_cnfg->long_drx_cycle_start_offset);
+      if(drx_cnfg->short_drx_present)
+      {
+        mac->set_param(srsue::mac_interface_params::DRX_SHORT_CYCLE,
+                       liblte_rrc_short_drx_cycle_num[drx_cnfg->short_drx_cycle]);
+        mac->set_param(srsue::mac_interface_params::DRX_SHORT_CYCLE_TIMER, drx_cnfg->short_drx_cycle_timer);
+      }else{
+        mac->set_param(srsue::mac_interface_params::DRX_SHORT_CYCLE, 0);
+      }
+      log_info(rrc_log, "Set DRX config: onDuration=%d, inactivity=%d, retx=%d, longCycle=%d, offset=%d, shortCycle=%s\n",
+                   liblte_rrc_on_duration_timer_num[drx_cnfg->on_duration_timer],
+                   liblte_rrc_drx_inactivity_timer_num[drx_cnfg->drx_inactivity_timer],
+                   liblte_rrc_drx_retransmission_timer_num[drx_cnfg->drx_retx_timer],
+                   liblte_rrc_long_drx_cycle_start_offset_choice_num[drx_cnfg->long_drx_cycle_start_offset_choice],
+                   drx_cnfg->long_drx_cycle_start_offset,
+                   drx_cnfg->short_drx_present?liblte_rrc_short_drx_cycle_text[drx_cnfg->short_drx_cycle]:"none");
+    }else{
+      mac->set_param(srsue::mac_interface_params::DRX_LONG_CYCLE, 0);
+    }
+  }
+  if(mac_cnfg->phr_cnfg_present)
+  {
+    mac->set_param(srsue::mac_interface_params::PHR_TIMER_PERIODIC, liblte_rrc_periodic_phr_timer_num[mac_cnfg->phr_cnfg.periodic_phr_timer]);
+    mac->set_param(srsue::mac_interface_params::PHR_TIMER_PROHIBIT, liblte_rrc_prohibit_phr_timer_num[mac_cnfg->phr_cnfg.prohibit_phr_timer]);
+    mac->set_param(srsue::mac_interface_params::PHR_DL_PATHLOSS_CHANGE, liblte_rrc_dl_pathloss_change_num[mac_cnfg->phr_cnfg.dl_pathloss_change]);
+  }
+  //TODO: time_alignment_timer?
+
+  log_info(rrc_log, "Set MAC main config: harq-MaxReTX=%d, bsr-TimerReTX=%d, bsr-TimerPeriodic=%d\n",
+               liblte_rrc_max_harq_tx_num[mac_cnfg->ulsch_cnfg.max_harq_tx],
+               liblte_rrc_retransmission_bsr_timer_num[mac_cnfg->ulsch_cnfg.retx_bsr_timer],
+               liblte_rrc_periodic_bsr_timer_num[mac_cnfg->ulsch_cnfg.periodic_bsr_timer]);
+  
+  mac->reconfiguration();
+}
+
 void rrc::add_srb(LIBLTE_RRC_SRB_TO_ADD_MOD_STRUCT *srb_cnfg)
 {
   // Setup PDCP
@@ -984,7 +1031,7 @@ void rrc::add_srb(LIBLTE_RRC_SRB_TO_ADD_MOD_STRUCT *srb_cnfg)
   }
 
   srbs[srb_cnfg->srb_id] = *srb_cnfg;
-  rrc_log->info("Added radio bearer %s\n", rb_id_text[srb_cnfg->srb_id]);
+  log_info(rrc_log, "Added radio bearer %s\n", rb_id_text[srb_cnfg->srb_id]);
 }
 
 void rrc::add_drb(LIBLTE_RRC_DRB_TO_ADD_MOD_STRUCT *drb_cnfg)
@@ -994,7 +1041,7 @@ void rrc::add_drb(LIBLTE_RRC_DRB_TO_ADD_MOD_STRUCT *drb_cnfg)
      !drb_cnfg->rlc_cnfg_present  ||
      !drb_cnfg->lc_cnfg_present)
   {
-    rrc_log->error("Cannot add DRB - incomplete configuration\n");
+    log_error(rrc_log, "Cannot add DRB - incomplete configuration\n");
     return;
   }
 
@@ -1025,7 +1072,7 @@ void rrc::add_drb(LIBLTE_RRC_DRB_TO_ADD_MOD_STRUCT *drb_cnfg)
   mac->setup_lcid(lcid, 3, 2, prioritized_bit_rate, bucket_size_duration);
 
   drbs[lcid] = *drb_cnfg;
-  rrc_log->info("Added radio bearer %s\n", rb_id_text[lcid]);
+  log_info(rrc_log, "Added radio bearer %s\n", rb_id_text[lcid]);
 }
 
 void rrc::release_drb(uint8_t lcid)
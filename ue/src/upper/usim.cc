@@ -46,14 +46,14 @@ void usim::init(usim_args_t *args, srslte::log *usim_log_)
   if(32 == args->op.length()) {
     str_to_hex(args->op, op);
   } else {
-    usim_log->error("Invalid length for OP: %d should be %d", args->op.length(), 32);
+    log_error(usim_log, "Invalid length for OP: %d should be %d", args->op.length(), 32);
     usim_log->console("Invalid length for OP: %d should be %d", args->op.length(), 32);
   }
 
   if(4 == args->amf.length()) {
     str_to_hex(args->amf, amf);
   } else {
-    usim_log->error("Invalid length for AMF: %d should be %d", args->amf.length(), 4);
+    log_error(usim_log, "Invalid length for AMF: %d should be %d", args->amf.length(), 4);
     usim_log->console("Invalid length for AMF: %d should be %d", args->amf.length(), 4);
   }
 
@@ -65,7 +65,7 @@ void usim::init(usim_args_t *args, srslte::log *usim_log_)
       imsi += imsi_str[i] - '0';
     }
   } else {
-    usim_log->error("Invalid length for ISMI: %d should be %d", args->imsi.length(), 15);
+    log_error(usim_log, "Invalid length for ISMI: %d should be %d", args->imsi.length(), 15);
     usim_log->console("Invalid length for IMSI: %d should be %d", args->imsi.length(), 15);
   }
 
@@ -77,14 +77,14 @@ void usim::init(usim_args_t *args, srslte::log *usim_log_)
       imei += imei_str[i] - '0';
     }
   } else {
-    usim_log->error("Invalid length for IMEI: %d should be %d", args->imei.length(), 15);
+    log_error(usim_log, "Invalid length for IMEI: %d should be %d", args->imei.length(), 15);
     usim_log->console("Invalid length for IMEI: %d should be %d", args->imei.length(), 15);
   }
 
   if(32 == args->k.length()) {
     str_to_hex(args->k, k);
   } else {
-    usim_log->error("Invalid length for K: %d should be %d", args->k.length(), 32);
+    log_error(usim_log, "Invalid length for K: %d should be %d", args->k.length(), 32);
     usim_log->console("Invalid length for K: %d should be %d", args->k.length(), 32);
   }
 
@@ -105,7 +105,7 @@ void usim::get_imsi_vec(uint8_t* imsi_, uint32_t n)
 {
   if(NULL == imsi_ || n < 15)
   {
-    usim_log->error("Invalid parameters to get_imsi_vec");
+    log_error(usim_log, "Invalid parameters to get_imsi_vec");
     return;
   }
 
@@ -121,7 +121,7 @@ void usim::get_imei_vec(uint8_t* imei_, uint32_t n)
 {
   if(NULL == imei_ || n < 15)
   {
-    usim_log->error("Invalid parameters to get_imei_vec");
+    log_error(usim_log, "Invalid parameters to get_imei_vec");
     return;
   }
 
@@ -0,0 +1,148 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NTHREADS 8
+#define NMSGS    100000
+
+#include <stdio.h>
+#include "common/buffer_pool.h"
+#include "common/msg_queue.h"
+
+using namespace srsue;
+
+typedef struct {
+  msg_queue *q;
+  bool       passed;
+}args_t;
+
+// Allocates buffers of varying sizes, frees them on the same thread
+void* alloc_thread(void *a) {
+  args_t      *args = (args_t*)a;
+  buffer_pool *pool = buffer_pool::get_instance();
+  for(uint32_t i=0;i<NMSGS;i++)
+  {
+    uint32_t       len = (i*97)%SRSUE_MAX_BUFFER_SIZE_BYTES/2;
+    byte_buffer_t *b   = pool->allocate(len);
+    if(!b || b->get_tailroom() < len) {
+      args->passed = false;
+      return NULL;
+    }
+    b->N_bytes = len;
+    pool->deallocate(b);
+  }
+  return NULL;
+}
+
+// Allocates buffers and passes them to another thread to be freed
+void* producer_thread(void *a) {
+  args_t      *args = (args_t*)a;
+  buffer_pool *pool = buffer_pool::get_instance();
+  for(uint32_t i=0;i<NMSGS;i++)
+  {
+    byte_buffer_t *b = pool->allocate(4);
+    memcpy(b->msg, &i, 4);
+    b->N_bytes = 4;
+    args->q->write(b);
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  bool                  result = true;
+  buffer_pool          *pool = buffer_pool::get_instance();
+  buffer_pool_metrics_t m;
+  pthread_t             threads[NTHREADS];
+  args_t                args[NTHREADS];
+  msg_queue             q;
+  pthread_t             producer;
+  args_t                producer_args;
+  byte_buffer_t        *b;
+  uint32_t              r;
+
+  // Size class selection
+  b = pool->allocate(40);
+  if(b->get_capacity() >= SRSUE_MAX_BUFFER_SIZE_BYTES)
+    result = false;
+  // Header prepends assume the same headroom in every class
+  if(b->get_headroom() != SRSUE_BUFFER_HEADER_OFFSET)
+    result = false;
+  pool->deallocate(b);
+  b = pool->allocate();
+  if(b->get_tailroom() != SRSUE_MAX_BUFFER_SIZE_BYTES-SRSUE_BUFFER_HEADER_OFFSET)
+    result = false;
+
+  // Assignment into a smaller class copies what fits
+  byte_buffer_t *s = pool->allocate(40);
+  b->N_bytes = b->get_tailroom();
+  memset(b->msg, 0xA5, b->N_bytes);
+  *s = *b;
+  if(s->N_bytes != s->get_capacity()-s->get_headroom() || s->msg[s->N_bytes-1] != 0xA5)
+    result = false;
+  pool->deallocate(s);
+  pool->deallocate(b);
+
+  // Concurrent allocation
+  for(int i=0;i<NTHREADS;i++) {
+    args[i].passed = true;
+    pthread_create(&threads[i], NULL, &alloc_thread, &args[i]);
+  }
+  for(int i=0;i<NTHREADS;i++) {
+    pthread_join(threads[i], NULL);
+    if(!args[i].passed)
+      result = false;
+  }
+
+  // Cross-thread deallocation
+  producer_args.q = &q;
+  pthread_create(&producer, NULL, &producer_thread, &producer_args);
+  for(uint32_t i=0;i<NMSGS;i++)
+  {
+    q.read(&b);
+    memcpy(&r, b->msg, 4);
+    pool->deallocate(b);
+    if(r != i)
+      result = false;
+  }
+  pthread_join(producer, NULL);
+
+  pool->get_metrics(m);
+  for(int i=0;i<BUFFER_POOL_N_CLASSES;i++) {
+    printf("%-6s: size=%5d, nof_buffers=%d, allocated=%d, max=%d, failed=%d\n",
+           buffer_pool_class_text[i], m.size_class[i].buffer_size, m.size_class[i].nof_buffers,
+           m.size_class[i].allocated, m.size_class[i].high_water_mark, m.size_class[i].alloc_failures);
+    if(m.size_class[i].allocated != 0 || m.size_class[i].alloc_failures != 0)
+      result = false;
+  }
+  buffer_pool::cleanup();
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n;");
+    exit(1);
+  }
+}
@@ -0,0 +1,107 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "common/helper_pool.h"
+
+#define NHELPERS 3
+#define NCALLERS 2
+#define NJOBS    13
+#define NRUNS    20000
+
+using namespace srslte;
+
+helper_pool pool(NCALLERS);
+
+typedef struct {
+  volatile uint32_t count[NJOBS];
+  volatile uint32_t bad_slot;
+  uint32_t          caller_slot;
+}batch_arg_t;
+
+void job(void *a, uint32_t idx, uint32_t slot) {
+  batch_arg_t *arg = (batch_arg_t*) a;
+  if(slot >= NHELPERS && slot != arg->caller_slot)
+    arg->bad_slot = 1;
+  __sync_fetch_and_add(&arg->count[idx], 1);
+}
+
+void* caller_thread(void *a) {
+  uint32_t    slot = *((uint32_t*) a);
+  batch_arg_t arg;
+  for(uint32_t r=0;r<NRUNS;r++) {
+    memset((void*) &arg, 0, sizeof(batch_arg_t));
+    arg.caller_slot = slot;
+    pool.run(job, &arg, NJOBS, slot);
+    // Every job must have run exactly once by the time run() returns
+    for(uint32_t i=0;i<NJOBS;i++) {
+      if(arg.count[i] != 1 || arg.bad_slot) {
+        printf("Caller %d run %d: job %d ran %d times, bad_slot=%d\n", slot, r, i, arg.count[i], arg.bad_slot);
+        return (void*) 1;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  bool result = true;
+
+  // Without helpers jobs run on the caller
+  batch_arg_t arg;
+  memset((void*) &arg, 0, sizeof(batch_arg_t));
+  arg.caller_slot = NHELPERS;
+  pool.run(job, &arg, NJOBS, NHELPERS);
+  for(uint32_t i=0;i<NJOBS;i++)
+    result &= arg.count[i] == 1;
+
+  pool.init(NHELPERS);
+
+  pthread_t threads[NCALLERS];
+  uint32_t  slots[NCALLERS];
+  for(uint32_t i=0;i<NCALLERS;i++) {
+    slots[i] = NHELPERS+i;
+    pthread_create(&threads[i], NULL, &caller_thread, &slots[i]);
+  }
+  for(uint32_t i=0;i<NCALLERS;i++) {
+    void *ret;
+    pthread_join(threads[i], &ret);
+    if(ret)
+      result = false;
+  }
+  pool.stop();
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
@@ -0,0 +1,98 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "common/latency_hist.h"
+
+#define NTHREADS 4
+#define NSAMPLES 100000
+
+using namespace srsue;
+
+latency_hist hist;
+
+void* add_thread(void *a) {
+  for(uint32_t i=1;i<=NSAMPLES;i++)
+    hist.add(i);
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  bool result = true;
+
+  // Every value falls in a bucket whose bounds are within 12.5%
+  for(uint64_t v=0;v<(1ULL<<LATENCY_HIST_MAX_BITS);v=v*9/8+1) {
+    uint32_t b = latency_hist::bin(v);
+    if(b >= LATENCY_HIST_NOF_BINS || latency_hist::bin_max(b) < v ||
+       (b > 0 && latency_hist::bin_max(b-1) >= v) ||
+       latency_hist::bin_max(b) - v > v/LATENCY_HIST_SUB) {
+      printf("Wrong bucket %d for %lu\n", b, (unsigned long) v);
+      result = false;
+      break;
+    }
+  }
+  if(latency_hist::bin(1ULL<<40) != LATENCY_HIST_NOF_BINS-1) {
+    printf("Overflow not clamped to the last bucket\n");
+    result = false;
+  }
+
+  pthread_t threads[NTHREADS];
+  for(int i=0;i<NTHREADS;i++)
+    pthread_create(&threads[i], NULL, &add_thread, NULL);
+  for(int i=0;i<NTHREADS;i++)
+    pthread_join(threads[i], NULL);
+
+  uint64_t p50 = hist.percentile(50);
+  uint64_t p99 = hist.percentile(99);
+  hist.print(stdout, "uniform", 1, "ns");
+  if(hist.count() != NTHREADS*NSAMPLES || hist.max() != NSAMPLES) {
+    printf("count=%lu max=%lu\n", (unsigned long) hist.count(), (unsigned long) hist.max());
+    result = false;
+  }
+  if(p50 < NSAMPLES/2 || p50 > NSAMPLES/2*9/8 || p99 < NSAMPLES*99/100 || p99 > NSAMPLES) {
+    printf("p50=%lu p99=%lu\n", (unsigned long) p50, (unsigned long) p99);
+    result = false;
+  }
+  if(hist.mean() < NSAMPLES/2 || hist.mean() > NSAMPLES/2+1) {
+    printf("mean=%f\n", hist.mean());
+    result = false;
+  }
+  hist.reset();
+  if(hist.count() != 0 || hist.percentile(99) != 0) {
+    printf("reset failed\n");
+    result = false;
+  }
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
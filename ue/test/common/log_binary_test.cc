@@ -0,0 +1,239 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NTHREADS 10
+#define NMSGS    1000
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <vector>
+#include "common/log_filter.h"
+#include "common/log_binary.h"
+
+using namespace srsue;
+
+// Checks that deferred formatting gives the same result as vsnprintf
+bool check_format(const char *fmt, ...)
+{
+  char     expected[1024];
+  uint8_t  buf[LOG_BINARY_MAX_ARGS_LEN];
+  va_list  args;
+
+  va_start(args, fmt);
+  vsnprintf(expected, sizeof(expected), fmt, args);
+  va_end(args);
+  va_start(args, fmt);
+  uint32_t len = log_binary_encode_args(fmt, args, buf, sizeof(buf));
+  va_end(args);
+
+  std::string result = log_binary_format_args(fmt, buf, len);
+  if(result.compare(expected)) {
+    printf("Format mismatch: \"%s\" != \"%s\"\n", result.c_str(), expected);
+    return false;
+  }
+  return true;
+}
+
+bool test_formats()
+{
+  bool pass = true;
+  pass &= check_format("No arguments\n");
+  pass &= check_format("%d %i %u %x %X %o %c", -5, 7, 4000000000u, 0xbeef, 0xcafe, 8, 'a');
+  pass &= check_format("%5d|%-5d|%05d|%+d", 1, 2, 3, 4);
+  pass &= check_format("%ld %lu %lld %llx", -123456789l, 123456789ul, -1234567890123ll, 0x123456789abcull);
+  pass &= check_format("%hhu %hd", 200, -3);
+  pass &= check_format("%f %.2f %e %g %10.3f", 1.5, 3.14159, 1e-9, 2.5e10, -0.001);
+  pass &= check_format("%s and %10s and %-4s|", "abc", "right", "l");
+  pass &= check_format("%*d %.*f %*.*s", 6, 42, 3, 2.71828, 8, 3, "truncated");
+  pass &= check_format("100%% %s", "done");
+  pass &= check_format("%p", (void*) 0x1234);
+  pass &= check_format("%zu %s", (size_t) 99, (char*) NULL);
+  return pass;
+}
+
+// A full table gives the reserved overflow id, never defined, and counts each overflow
+bool test_table_overflow()
+{
+  log_binary_table t(4);
+  bool pass = t.intern("a") == 0 && t.intern("b") == 1 && t.intern("c") == 2;
+  pass &= t.intern("d") == t.overflow_id() && t.intern("e") == t.overflow_id();
+  pass &= t.intern("a") == 0 && t.size() == 3 && t.get(t.overflow_id()) == NULL;
+  pass &= t.get_nof_overflows() == 2;
+
+  log_binary_msg_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.fmt_id   = LOG_BINARY_FORMAT_OVERFLOW;
+  msg.layer_id = LOG_BINARY_LAYER_OVERFLOW;
+  std::string line = log_binary_format_msg(&msg, NULL, NULL);
+  pass &= strstr(line.c_str(), "[OVFL]") && strstr(line.c_str(), "<format table overflow>");
+  if(!pass)
+    printf("Table overflow: %s", line.c_str());
+  return pass;
+}
+
+typedef struct {
+  log_filter *log;
+  int         thread_id;
+}args_t;
+
+void* thread_loop(void *a) {
+  args_t *args = (args_t*)a;
+  uint8_t hex[40];
+  for(int i=0;i<40;i++)
+    hex[i] = i;
+  for(int i=0;i<NMSGS;i++)
+  {
+    args->log->step(i);
+    if(i%10)
+      args->log->info("Thread %d: %d %s\n", args->thread_id, i, "ok");
+    else
+      args->log->info_hex(hex, 40, "Thread %d: %d hex\n", args->thread_id, i);
+  }
+  return NULL;
+}
+
+void write(std::string filename) {
+  logger     l;
+  log_filter filters[NTHREADS];
+  pthread_t  threads[NTHREADS];
+  args_t     args[NTHREADS];
+  l.init(filename, true);
+  for(int i=0;i<NTHREADS;i++) {
+    char name[8];
+    snprintf(name, sizeof(name), "T%03d", i);
+    filters[i].init(name, &l, true);
+    filters[i].set_level(srslte::LOG_LEVEL_DEBUG);
+    filters[i].set_hex_limit(16);
+    args[i].log = &filters[i];
+    args[i].thread_id = i;
+    pthread_create(&threads[i], NULL, &thread_loop, &args[i]);
+  }
+  for(int i=0;i<NTHREADS;i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+bool read(std::string filename) {
+  bool                     written[NTHREADS][NMSGS];
+  std::vector<std::string> formats;
+  std::vector<std::string> layers;
+  uint8_t                  rec[LOG_BINARY_MAX_RECORD];
+  log_binary_hdr_t        *hdr = (log_binary_hdr_t*) rec;
+  char                     magic[sizeof(LOG_BINARY_MAGIC)] = {0};
+  bool                     pass = true;
+
+  memset(written, 0, sizeof(written));
+  FILE *f = fopen(filename.c_str(), "r");
+  if(f == NULL)
+    return false;
+  if(fread(magic, 1, strlen(LOG_BINARY_MAGIC), f) != strlen(LOG_BINARY_MAGIC) ||
+     strcmp(magic, LOG_BINARY_MAGIC)) {
+    printf("Wrong magic\n");
+    pass = false;
+  }
+  while(pass && fread(hdr, 1, sizeof(log_binary_hdr_t), f) == sizeof(log_binary_hdr_t)) {
+    if(fread(&rec[sizeof(log_binary_hdr_t)], 1, hdr->len-sizeof(log_binary_hdr_t), f) !=
+       hdr->len-sizeof(log_binary_hdr_t)) {
+      printf("Truncated record\n");
+      pass = false;
+      break;
+    }
+    log_binary_def_t *def = (log_binary_def_t*) rec;
+    log_binary_msg_t *msg = (log_binary_msg_t*) rec;
+    const char       *str = (const char*) &rec[sizeof(log_binary_def_t)];
+    int               thread, n;
+    switch(hdr->type) {
+    case LOG_BINARY_REC_FORMAT:
+      if(def->id != formats.size())
+        pass = false;
+      formats.push_back(str);
+      break;
+    case LOG_BINARY_REC_LAYER:
+      if(def->id != layers.size())
+        pass = false;
+      layers.push_back(str);
+      break;
+    case LOG_BINARY_REC_MSG:
+    {
+      // Definitions must always precede the messages using them
+      if(msg->fmt_id >= formats.size() || msg->layer_id >= layers.size()) {
+        printf("Message before definition\n");
+        pass = false;
+        break;
+      }
+      std::string line = log_binary_format_msg(msg, formats[msg->fmt_id].c_str(),
+                                               layers[msg->layer_id].c_str());
+      const char *p = strstr(line.c_str(), "Thread ");
+      if(!p || sscanf(p, "Thread %d: %d", &thread, &n) != 2 ||
+         thread < 0 || thread >= NTHREADS || n < 0 || n >= NMSGS) {
+        printf("Bad message: %s", line.c_str());
+        pass = false;
+        break;
+      }
+      char expected[64];
+      snprintf(expected, sizeof(expected), "[T%03d] Info    [%05d] ", thread, n);
+      if(!strstr(line.c_str(), expected)) {
+        printf("Bad header: %s", line.c_str());
+        pass = false;
+      }
+      if(n%10 == 0 && (msg->hex_len != 16 ||
+                       !strstr(line.c_str(), "0000: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f"))) {
+        printf("Bad hex dump: %s", line.c_str());
+        pass = false;
+      }
+      written[thread][n] = true;
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  fclose(f);
+  for(int i=0;i<NTHREADS;i++) {
+    for(int j=0;j<NMSGS;j++) {
+      if(!written[i][j]) pass = false;
+    }
+  }
+  return pass;
+}
+
+int main(int argc, char **argv) {
+  bool result;
+  std::string f("log.bin");
+  result = test_formats();
+  result &= test_table_overflow();
+  write(f);
+  result &= read(f);
+  remove(f.c_str());
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
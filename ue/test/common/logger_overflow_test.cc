@@ -0,0 +1,114 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NTHREADS 4
+#define NMSGS    20000
+
+#include <stdio.h>
+#include <string.h>
+#include "common/log_filter.h"
+
+using namespace srsue;
+
+typedef struct {
+  log_filter *log;
+  int         thread_id;
+}args_t;
+
+void* thread_loop(void *a) {
+  args_t *args = (args_t*)a;
+  char    pad[201];
+  memset(pad, 'x', 200);
+  pad[200] = '\0';
+  for(int i=0;i<NMSGS;i++)
+    args->log->info("Msg %d %d %s\n", args->thread_id, i, pad);
+  return NULL;
+}
+
+uint32_t count_lines(std::string filename) {
+  char     line[512];
+  uint32_t n = 0;
+  FILE    *f = fopen(filename.c_str(), "r");
+  if(f) {
+    while(fgets(line, sizeof(line), f)) {
+      if(strstr(line, "Msg "))
+        n++;
+    }
+    fclose(f);
+  }
+  return n;
+}
+
+// All messages must be either written or counted as dropped
+bool test_policy(log_overflow_t policy) {
+  std::string   filename("log_overflow.txt");
+  log_metrics_t metrics;
+  uint32_t      nof_dropped = 0;
+  {
+    logger     l;
+    log_filter filters[NTHREADS];
+    pthread_t  threads[NTHREADS];
+    args_t     args[NTHREADS];
+    l.init(filename, false, policy, 1024*64);
+    for(int i=0;i<NTHREADS;i++) {
+      char name[8];
+      snprintf(name, sizeof(name), "L%d", i);
+      filters[i].init(name, &l);
+      filters[i].set_level(srslte::LOG_LEVEL_INFO);
+      args[i].log       = &filters[i];
+      args[i].thread_id = i;
+      pthread_create(&threads[i], NULL, &thread_loop, &args[i]);
+    }
+    for(int i=0;i<NTHREADS;i++) {
+      pthread_join(threads[i], NULL);
+    }
+    l.get_metrics(metrics);
+  }
+  for(uint32_t i=0;i<metrics.nof_layers;i++)
+    nof_dropped += metrics.layer[i].total_dropped;
+  uint32_t nof_written = count_lines(filename);
+  remove(filename.c_str());
+
+  printf("Policy %-12s: written=%d, dropped=%d\n", log_overflow_text[policy], nof_written, nof_dropped);
+  if(nof_written+nof_dropped != NTHREADS*NMSGS)
+    return false;
+  if(policy == LOG_OVERFLOW_BLOCK && nof_dropped > 0)
+    return false;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  bool result = true;
+  for(uint32_t i=0;i<LOG_OVERFLOW_N_ITEMS;i++)
+    result &= test_policy((log_overflow_t) i);
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
@@ -25,14 +25,19 @@
  */
 
 #define NMSGS    1000000
+#define NWRITERS 4
+#define NMSGS_MP 100000
+#define NBATCH   16
 
 #include <stdio.h>
+#include <sched.h>
 #include "common/msg_queue.h"
 
 using namespace srsue;
 
 typedef struct {
   msg_queue   *q;
+  uint32_t     id;
 }args_t;
 
 void* write_thread(void *a) {
@@ -44,6 +49,91 @@ void* write_thread(void *a) {
     b->N_bytes = 4;
     args->q->write(b);
   }
+  return NULL;
+}
+
+// Non-blocking writer, retries while the queue reports backpressure
+void* try_write_thread(void *a) {
+  args_t *args = (args_t*)a;
+  for(uint32_t i=0;i<NMSGS_MP/NWRITERS;i++)
+  {
+    byte_buffer_t *b = new byte_buffer_t;
+    memcpy(b->msg, &args->id, 4);
+    memcpy(&b->msg[4], &i, 4);
+    b->N_bytes = 8;
+    while(!args->q->try_write(b))
+      sched_yield();
+  }
+  return NULL;
+}
+
+// Multiple producers with try_write(), consumer with read_batch()
+bool test_mpsc() {
+  bool           result = true;
+  msg_queue      q(64);
+  pthread_t      threads[NWRITERS];
+  args_t         args[NWRITERS];
+  uint32_t       next[NWRITERS];
+  byte_buffer_t *b[NBATCH];
+  uint32_t       nof_read = 0;
+
+  for(uint32_t i=0;i<NWRITERS;i++) {
+    args[i].q  = &q;
+    args[i].id = i;
+    next[i]    = 0;
+    pthread_create(&threads[i], NULL, &try_write_thread, &args[i]);
+  }
+  while(nof_read < NWRITERS*(NMSGS_MP/NWRITERS))
+  {
+    uint32_t n = q.read_batch(b, NBATCH);
+    if(n == 0) {
+      // Nothing queued, block until the next message arrives
+      q.read(&b[0]);
+      n = 1;
+    }
+    for(uint32_t i=0;i<n;i++)
+    {
+      uint32_t id, r;
+      memcpy(&id, b[i]->msg, 4);
+      memcpy(&r, &b[i]->msg[4], 4);
+      delete b[i];
+      // Messages from each producer must arrive in order
+      if(id >= NWRITERS || r != next[id]++)
+        result = false;
+    }
+    nof_read += n;
+  }
+  for(uint32_t i=0;i<NWRITERS;i++) {
+    pthread_join(threads[i], NULL);
+  }
+  if(q.size() != 0 || q.size_bytes() != 0)
+    result = false;
+  return result;
+}
+
+// try_write() reports a full queue, counters follow reads and writes
+bool test_backpressure() {
+  bool           result = true;
+  msg_queue      q(8);
+  byte_buffer_t  bufs[9];
+  byte_buffer_t *b[8];
+
+  for(uint32_t i=0;i<8;i++) {
+    bufs[i].N_bytes = i+1;
+    if(!q.try_write(&bufs[i]))
+      result = false;
+  }
+  if(q.try_write(&bufs[8]))
+    result = false;
+  if(q.size() != 8 || q.size_bytes() != 36 || q.size_tail_bytes() != 1)
+    result = false;
+  if(q.read_batch(b, 3) != 3 || b[0] != &bufs[0] || b[2] != &bufs[2])
+    result = false;
+  if(q.size() != 5 || q.size_bytes() != 30 || q.size_tail_bytes() != 4)
+    result = false;
+  if(q.read_batch(b, 8) != 5 || q.read_batch(b, 8) != 0 || q.size_tail_bytes() != 0)
+    result = false;
+  return result;
 }
 
 int main(int argc, char **argv) {
@@ -70,6 +160,9 @@ int main(int argc, char **argv) {
 
   pthread_join(thread, NULL);
 
+  result &= test_mpsc();
+  result &= test_backpressure();
+
   if(result) {
     printf("Passed\n");
     exit(0);
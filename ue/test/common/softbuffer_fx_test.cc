@@ -0,0 +1,122 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "common/softbuffer_fx.h"
+
+using namespace srsue;
+
+void check(bool cond, const char *what)
+{
+  if(!cond) {
+    printf("%s\n", what);
+    exit(-1);
+  }
+}
+
+// Round trip of 2 code blocks through fixed point with nof_bits and the given scale
+void round_trip(uint32_t nof_bits, float scale)
+{
+  srslte_cbsegm_t cb_segm;
+  bzero(&cb_segm, sizeof(srslte_cbsegm_t));
+  cb_segm.C  = 2;
+  cb_segm.C2 = 1;
+  cb_segm.K2 = 40;
+  cb_segm.K1 = SRSLTE_TCOD_MAX_LEN_CB;
+
+  softbuffer_fx          fx;
+  srslte_softbuffer_rx_t sb;
+  check(fx.init(100, nof_bits), "Init");
+  check(fx.get_nof_bytes() == (size_t) fx.get_max_cb()*softbuffer_fx::CB_LEN*nof_bits/8, "Size");
+  check(!srslte_softbuffer_rx_init(&sb, 100), "Init float");
+
+  // Empty code blocks expand to untransmitted bits
+  check(!fx.expand(&cb_segm, &sb), "Expand empty");
+  check(sb.buffer_f[0][0] == SRSLTE_RX_NULL && sb.buffer_f[1][softbuffer_fx::CB_LEN-1] == SRSLTE_RX_NULL, "Empty not null");
+
+  float max = (nof_bits == 16 ? INT16_MAX : INT8_MAX)/scale;
+  for(uint32_t i=0;i<2;i++) {
+    uint32_t len = softbuffer_fx::cb_w_len(i < cb_segm.C2 ? cb_segm.K2 : cb_segm.K1);
+    for(uint32_t j=0;j<len;j++) {
+      switch(j%4) {
+        case 0:  sb.buffer_f[i][j] = SRSLTE_RX_NULL; break;
+        case 1:  sb.buffer_f[i][j] = -4*max; break;
+        default: sb.buffer_f[i][j] = max*((float) (j%1000)/500 - 1); break;
+      }
+    }
+  }
+  check(!fx.compress(&cb_segm, &sb), "Compress");
+
+  std::vector<float> ref[2];
+  for(uint32_t i=0;i<2;i++) {
+    uint32_t len = softbuffer_fx::cb_w_len(i < cb_segm.C2 ? cb_segm.K2 : cb_segm.K1);
+    ref[i].assign(sb.buffer_f[i], sb.buffer_f[i]+len);
+    bzero(sb.buffer_f[i], sizeof(float)*len);
+  }
+  check(!fx.expand(&cb_segm, &sb), "Expand");
+  for(uint32_t i=0;i<2;i++) {
+    for(uint32_t j=0;j<ref[i].size();j++) {
+      float x = sb.buffer_f[i][j];
+      if(j%4 == 0) {
+        check(x == SRSLTE_RX_NULL, "Null not kept");
+      } else if(j%4 == 1) {
+        check(x == -max, "Not saturated");
+      } else {
+        check(fabsf(x - ref[i][j]) <= 0.5/scale + 1e-6, "Quantization error");
+      }
+    }
+  }
+
+  // Reset only clears the code blocks
+  fx.reset();
+  check(!fx.expand(&cb_segm, &sb), "Expand after reset");
+  check(sb.buffer_f[1][1] == SRSLTE_RX_NULL, "Reset");
+
+  cb_segm.C = fx.get_max_cb() + 1;
+  check(fx.expand(&cb_segm, &sb) != 0, "Too many code blocks");
+
+  srslte_softbuffer_rx_free(&sb);
+}
+
+int main(int argc, char **argv)
+{
+  check(softbuffer_fx::cb_w_len(SRSLTE_TCOD_MAX_LEN_CB) == softbuffer_fx::CB_LEN, "Largest code block");
+  check(softbuffer_fx::cb_w_len(40) == 3*64, "Smallest code block");
+  check(softbuffer_fx::max_cb_prb(6) < softbuffer_fx::max_cb_prb(100), "Bandwidth");
+
+  round_trip(16, softbuffer_fx::SCALE_16);
+  round_trip(8,  softbuffer_fx::SCALE_8);
+
+  softbuffer_fx fx;
+  check(!fx.init(6, 32), "Float is not fixed point");
+
+  printf("Ok\n");
+  exit(0);
+}
@@ -0,0 +1,161 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "common/thread_affinity.h"
+
+using namespace srsue;
+
+volatile bool running = true;
+
+void* idle_thread(void *a) {
+  while(running)
+    usleep(1000);
+  return NULL;
+}
+
+// Busy thread woken through wake_stamp() by the main thread
+class busy_thread : public thread
+{
+public:
+  busy_thread() : nof_runs(0) {}
+  volatile uint32_t nof_runs;
+  volatile bool     wake_pending;
+protected:
+  void run_thread() {
+    while(running) {
+      if(wake_pending) {
+        wake_pending = false;
+        wake_sample();
+        nof_runs++;
+      }
+      update_usage();
+    }
+  }
+};
+
+bool check_parse(std::string spec, bool valid, int nof_cpus, int prio)
+{
+  cpu_set_t cpus;
+  bool      has_cpus, has_prio;
+  int       p;
+  bool      ret = thread_affinity::parse(spec, &cpus, &has_cpus, &p, &has_prio);
+  if(ret != valid) {
+    printf("parse(\"%s\") returned %s\n", spec.c_str(), ret?"true":"false");
+    return false;
+  }
+  if(valid && (CPU_COUNT(&cpus) != nof_cpus || p != prio)) {
+    printf("parse(\"%s\"): nof_cpus=%d, prio=%d\n", spec.c_str(), CPU_COUNT(&cpus), p);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  bool             result   = true;
+  thread_affinity *affinity = thread_affinity::get_instance();
+  pthread_t        early, late;
+  cpu_set_t        cpus;
+  char             name[16];
+
+  // Spec parsing
+  result &= check_parse("",          true,  0, -1);
+  result &= check_parse("2",         true,  1, -1);
+  result &= check_parse("0-3,6",     true,  5, -1);
+  result &= check_parse("1@0",       true,  1,  0);
+  result &= check_parse("@-1",       true,  0, -1);
+  result &= check_parse("3-1",       false, 0, -1);
+  result &= check_parse("a",         false, 0, -1);
+  result &= check_parse("1@",        false, 0, -1);
+  result &= check_parse("1@100",     false, 0, -1);
+  result &= check_parse("1-",        false, 0, -1);
+
+  // A thread registered before configure() is placed when configured,
+  // one registered after is placed immediately
+  pthread_create(&early, NULL, &idle_thread, NULL);
+  affinity->add(early, "test", "TEST_EARLY");
+  if(!affinity->set("test", "0") || affinity->set("bad", "x"))
+    result = false;
+  affinity->configure();
+  pthread_create(&late, NULL, &idle_thread, NULL);
+  affinity->add(late, "test", "A_VERY_LONG_THREAD_NAME");
+  affinity->print();
+
+  pthread_t threads[2] = {early, late};
+  const char *names[2] = {"TEST_EARLY", "A_VERY_LONG_THR"};
+  for(int i=0;i<2;i++) {
+    pthread_getname_np(threads[i], name, sizeof(name));
+    if(strcmp(name, names[i])) {
+      printf("Thread name %s, expected %s\n", name, names[i]);
+      result = false;
+    }
+    pthread_getaffinity_np(threads[i], sizeof(cpu_set_t), &cpus);
+    if(CPU_COUNT(&cpus) != 1 || !CPU_ISSET(0, &cpus)) {
+      printf("Thread %s not pinned to CPU 0\n", names[i]);
+      result = false;
+    }
+  }
+
+  // Thread metrics
+  busy_thread       busy;
+  threads_metrics_t m;
+  busy.wake_pending = false;
+  busy.start();
+  affinity->add(&busy, "busy", "BUSY");
+  affinity->get_metrics(m);
+  for(uint32_t i=0;i<10;i++) {
+    uint32_t n = busy.nof_runs;
+    busy.wake_stamp();
+    busy.wake_pending = true;
+    while(busy.nof_runs == n)
+      usleep(100);
+  }
+  usleep(50000);
+  affinity->get_metrics(m);
+  thread_metrics_t *t = &m.thread[m.nof_threads-1];
+  printf("%s: load=%.1f%%, vcsw/s=%.1f, ivcsw/s=%.1f, wakes=%d, wake_avg=%.1f us, wake_max=%.1f us\n",
+         t->name, t->cpu_load, t->nvcsw, t->nivcsw, t->nof_wakes, t->wake_avg_us, t->wake_max_us);
+  if(m.nof_threads != 3 || strcmp(t->name, "BUSY") || !t->has_sched || m.thread[0].has_sched ||
+     t->cpu_load <= 0 || t->nof_wakes != 10 || t->wake_max_us < t->wake_avg_us)
+    result = false;
+
+  running = false;
+  busy.wait_thread_finish();
+  pthread_join(early, NULL);
+  pthread_join(late, NULL);
+  thread_affinity::cleanup();
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
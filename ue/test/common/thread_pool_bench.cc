@@ -0,0 +1,131 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * Measures the latency from start_worker() until the worker begins work_imp()
+ * for the condition variable and spin/futex handoff modes of the thread pool,
+ * following the phch_recv pattern: wait_worker(tti), start_worker(), one TTI
+ * per period.
+ *
+ * Usage: thread_pool_bench [nof_ttis] [period_us] [nof_workers] [work_us]
+ *****************************************************************************/
+
+#define NOF_TTIS      100000
+#define PERIOD_US     100
+#define NOF_WORKERS   2
+#define WORK_US       50
+#define SPIN_US       50
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+#include "common/thread_pool.h"
+
+using namespace srslte;
+
+uint64_t now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+class bench_worker : public thread_pool::worker
+{
+public:
+  void set_tti(uint32_t tti_, uint64_t start_)
+  {
+    tti      = tti_;
+    start_ns = start_;
+  }
+  uint32_t              work_us;
+  std::vector<uint64_t> *latency;
+  volatile uint32_t     *nof_done;
+protected:
+  void work_imp()
+  {
+    (*latency)[tti] = now_ns() - start_ns;
+    uint64_t end = now_ns() + (uint64_t) work_us*1000;
+    while(now_ns() < end);
+    __sync_fetch_and_add(nof_done, 1);
+  }
+private:
+  uint32_t tti;
+  uint64_t start_ns;
+};
+
+void bench(const char *name, thread_pool::handoff_mode_t mode, uint32_t nof_ttis,
+           uint32_t period_us, uint32_t nof_workers, uint32_t work_us)
+{
+  thread_pool               pool(nof_workers);
+  std::vector<bench_worker> workers(nof_workers);
+  std::vector<uint64_t>     latency(nof_ttis);
+  volatile uint32_t         nof_done = 0;
+
+  pool.set_handoff_mode(mode, SPIN_US);
+  for(uint32_t i=0;i<nof_workers;i++) {
+    workers[i].work_us  = work_us;
+    workers[i].latency  = &latency;
+    workers[i].nof_done = &nof_done;
+    pool.init_worker(i, &workers[i]);
+  }
+
+  uint64_t next = now_ns();
+  for(uint32_t tti=0;tti<nof_ttis;tti++) {
+    next += (uint64_t) period_us*1000;
+    bench_worker *w = (bench_worker*) pool.wait_worker(tti);
+    w->set_tti(tti, now_ns());
+    pool.start_worker(w);
+    struct timespec ts;
+    ts.tv_sec  = next/1000000000;
+    ts.tv_nsec = next%1000000000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+  }
+  while(nof_done < nof_ttis)
+    usleep(1000);
+  pool.stop();
+
+  std::sort(latency.begin(), latency.end());
+  printf("%-5s wake latency over %d TTIs: p50=%6.1f us, p99=%6.1f us, max=%8.1f us\n",
+         name, nof_ttis,
+         (double) latency[nof_ttis/2]/1000,
+         (double) latency[(uint64_t) nof_ttis*99/100]/1000,
+         (double) latency[nof_ttis-1]/1000);
+}
+
+int main(int argc, char **argv) {
+  uint32_t nof_ttis    = argc > 1 ? atoi(argv[1]) : NOF_TTIS;
+  uint32_t period_us   = argc > 2 ? atoi(argv[2]) : PERIOD_US;
+  uint32_t nof_workers = argc > 3 ? atoi(argv[3]) : NOF_WORKERS;
+  uint32_t work_us     = argc > 4 ? atoi(argv[4]) : WORK_US;
+
+  bench("cond", thread_pool::HANDOFF_COND, nof_ttis, period_us, nof_workers, work_us);
+  bench("spin", thread_pool::HANDOFF_SPIN, nof_ttis, period_us, nof_workers, work_us);
+  exit(0);
+}
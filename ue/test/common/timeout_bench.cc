@@ -0,0 +1,150 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * Compares the cost of re-arming timeouts with the timer wheel service against
+ * the original thread-per-timeout implementation, as done by RLC for every
+ * PDU.
+ *****************************************************************************/
+
+#define NOF_ITERATIONS 10000
+#define DURATION_MSEC  50
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "common/timeout.h"
+
+using namespace srsue;
+
+// Original thread-per-timeout implementation, kept here as reference
+class legacy_timeout
+{
+public:
+  legacy_timeout():running(false),callback(NULL){}
+  void start(int duration_msec_, uint32_t timeout_id_=0,timeout_callback *callback_=NULL)
+  {
+    reset();
+    stop_time     = boost::posix_time::microsec_clock::local_time() + boost::posix_time::milliseconds(duration_msec_);
+    running       = true;
+    timeout_id    = timeout_id_;
+    callback      = callback_;
+    if(callback)
+      pthread_create(&thread, NULL, &thread_start, this);
+  }
+  void reset()
+  {
+    if(callback && running) {
+      pthread_cancel(thread);
+      pthread_join(thread, NULL);
+    }
+    running = false;
+  }
+  bool expired()
+  {
+    if(running)
+      return boost::posix_time::microsec_clock::local_time() > stop_time;
+    else
+      return false;
+  }
+  static void* thread_start(void *t_)
+  {
+    legacy_timeout *t = (legacy_timeout*)t_;
+    boost::posix_time::time_duration diff = t->stop_time - boost::posix_time::microsec_clock::local_time();
+    int32_t usec = diff.total_microseconds();
+    if(usec > 0)
+      usleep(usec);
+    if(t->callback && t->running)
+      t->callback->timeout_expired(t->timeout_id);
+    return NULL;
+  }
+private:
+  boost::posix_time::ptime  stop_time;
+  pthread_t                 thread;
+  uint32_t                  timeout_id;
+  timeout_callback         *callback;
+  bool                      running;
+};
+
+class callback
+    : public timeout_callback
+{
+public:
+  callback():n(0){}
+  void timeout_expired(uint32_t timeout_id) { n++; }
+  uint32_t n;
+};
+
+double now_us()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e6 + t.tv_nsec/1e3;
+}
+
+template<class T>
+void bench(const char *name, T *t, callback *c)
+{
+  double start, end;
+  bool   e = false;
+
+  // Re-arm with callback (RLC poll-retx/reordering pattern)
+  start = now_us();
+  for(uint32_t i=0;i<NOF_ITERATIONS;i++)
+    t->start(DURATION_MSEC, 0, c);
+  end = now_us();
+  t->reset();
+  printf("%-8s start+reset with callback: %8.2f us/op\n", name, (end-start)/NOF_ITERATIONS);
+
+  // Polled expiry (RLC status prohibit pattern)
+  t->start(DURATION_MSEC);
+  start = now_us();
+  for(uint32_t i=0;i<NOF_ITERATIONS;i++)
+    e |= t->expired();
+  end = now_us();
+  t->reset();
+  printf("%-8s expired() poll:            %8.3f us/op%s\n", name, (end-start)/NOF_ITERATIONS, e?" (expired)":"");
+}
+
+int main(int argc, char **argv) {
+  callback       c;
+  legacy_timeout lt;
+  timeout        t;
+
+  bench("legacy", &lt, &c);
+  bench("wheel",  &t,  &c);
+
+  // Expiry accuracy of the timer wheel
+  double start = now_us();
+  t.start(DURATION_MSEC);
+  while(!t.expired())
+    usleep(100);
+  printf("wheel    %d ms timeout expired after %.2f ms\n", DURATION_MSEC, (now_us()-start)/1000);
+  exit(0);
+}
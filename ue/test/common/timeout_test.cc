@@ -37,7 +37,7 @@ class callback
     : public timeout_callback
 {
 public:
-  callback(){}
+  callback():finished(false){}
   void timeout_expired(uint32_t timeout_id)
   {
     boost::mutex::scoped_lock lock(mut);
@@ -67,7 +67,7 @@ int main(int argc, char **argv) {
   timeout t;
 
   c.start_time = boost::posix_time::microsec_clock::local_time();
-  t.start(0, duration_msec, &c);
+  t.start(duration_msec, id, &c);
   c.wait();
 
   boost::posix_time::time_duration diff = c.end_time - c.start_time;
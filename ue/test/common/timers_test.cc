@@ -0,0 +1,122 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NOF_TIMERS 20
+#define NOF_TTIS   20000
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/timers.h"
+
+using namespace srslte;
+
+class callback
+    : public timer_callback
+{
+public:
+  callback(timers *t_, bool rearm_) : t(t_), rearm(rearm_) { bzero(n, sizeof(n)); }
+  void timer_expired(uint32_t timer_id)
+  {
+    n[timer_id]++;
+    last_expiry[timer_id] = tti;
+    if (rearm) {
+      t->get(timer_id)->set(this, timer_id+1);
+    }
+  }
+  timers  *t;
+  bool     rearm;
+  uint32_t tti;
+  uint32_t n[NOF_TIMERS];
+  uint32_t last_expiry[NOF_TIMERS];
+};
+
+int main(int argc, char **argv) {
+  bool             result = true;
+  timers           t(NOF_TIMERS);
+  timers_metrics_t m;
+
+  // Timers expire exactly after their timeout and can be re-armed from the callback
+  callback c(&t, true);
+  for (uint32_t i=0;i<NOF_TIMERS;i++) {
+    t.get(i)->set(&c, i+1);
+  }
+  for (c.tti=1;c.tti<=NOF_TTIS;c.tti++) {
+    t.step_all();
+  }
+  for (uint32_t i=0;i<NOF_TIMERS;i++) {
+    if (c.n[i] != NOF_TTIS/(i+1)) {
+      printf("Timer %d expired %d times, expected %d\n", i, c.n[i], NOF_TTIS/(i+1));
+      result = false;
+    }
+  }
+
+  // Stopped timers keep their counter and resume with run()
+  callback c2(&t, false);
+  timers::timer *tm = t.get(0);
+  tm->set(&c2, 10);
+  for (c2.tti=0;c2.tti<5;c2.tti++) t.step_all();
+  tm->stop();
+  for (;c2.tti<100;c2.tti++) t.step_all();
+  if (c2.n[0] != 0 || !tm->is_expired()) {
+    result = false;
+  }
+  tm->run();
+  if (!tm->is_running()) {
+    result = false;
+  }
+  for (;c2.tti<104;c2.tti++) t.step_all();
+  if (c2.n[0] != 0) {
+    result = false;
+  }
+  t.step_all();
+  if (c2.n[0] != 1 || !tm->is_expired() || tm->is_running()) {
+    result = false;
+  }
+
+  // Reset restarts the count, long timeouts wrap around the wheel
+  tm->set(&c2, 1000);
+  for (uint32_t i=0;i<999;i++) t.step_all();
+  tm->reset();
+  for (uint32_t i=0;i<999;i++) t.step_all();
+  if (c2.n[0] != 1) {
+    result = false;
+  }
+  t.step_all();
+  if (c2.n[0] != 2) {
+    result = false;
+  }
+
+  t.get_metrics(m);
+  printf("steps=%d, expired=%d, avg=%.3f us, max=%.3f us\n", m.nof_steps, m.nof_expired, m.avg_step_us, m.max_step_us);
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n;");
+    exit(1);
+  }
+}
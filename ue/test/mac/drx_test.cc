@@ -0,0 +1,162 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/log_stdout.h"
+#include "mac/proc_drx.h"
+#include "phy/phch_common.h"
+
+using namespace srsue;
+
+// Passes the DRX state to the phch_common of the PHY workers, which evaluates the PDCCH monitoring
+class phy_dummy : public phy_interface
+{
+public:
+  phy_dummy() : cycle(0), offset(0), until(0) {}
+  void configure_prach_params() {}
+  void sync_start() {}
+  void sync_stop() {}
+  void prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm) {}
+  int  prach_tx_tti() { return -1; }
+  void sr_send() {}
+  int  sr_last_tx_tti() { return -1; }
+  void set_timeadv_rar(uint32_t ta_cmd) {}
+  void set_timeadv(uint32_t ta_cmd) {}
+  void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]) {}
+  void pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end) {}
+  void pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end) {}
+  void pdcch_ul_search_reset() {}
+  void pdcch_dl_search_reset() {}
+  void drx_set_cycle(uint32_t c, uint32_t o, uint32_t d) { cycle = c; offset = o; common.drx_set_cycle(c, o, d); }
+  void drx_set_active_until(uint32_t tti) { until = tti; common.drx_set_active_until(tti); }
+  uint32_t get_current_tti() { return 0; }
+  void get_current_cell(srslte_cell_t *cell) {}
+  float get_phr() { return 0; }
+  void reset() {}
+
+  bool active(uint32_t tti) { return common.drx_active(tti); }
+
+  phch_common common;
+  uint32_t    cycle, offset, until;
+};
+
+phy_dummy  phy;
+mac_params params;
+drx_proc   drx;
+
+void check(bool cond, const char *what, uint32_t tti) {
+  if(!cond) {
+    printf("%s at TTI %d\n", what, tti);
+    exit(-1);
+  }
+}
+
+// Steps the procedure over nof_tti TTIs from tti and returns the number of active ones
+uint32_t run(uint32_t tti, uint32_t nof_tti) {
+  uint32_t n = 0;
+  for(uint32_t i=0;i<nof_tti;i++) {
+    drx.step((tti+i)%10240);
+    n += phy.active((tti+i)%10240);
+  }
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  srslte::log_stdout log("MAC");
+  drx.init(&phy, &log, &params);
+
+  params.set_param(mac_interface_params::DRX_ON_DURATION_TIMER, 4);
+  params.set_param(mac_interface_params::DRX_INACTIVITY_TIMER,  10);
+  params.set_param(mac_interface_params::DRX_RETX_TIMER,        16);
+  params.set_param(mac_interface_params::DRX_LONG_CYCLE,        40);
+  params.set_param(mac_interface_params::DRX_LONG_CYCLE_OFFSET, 25);
+  params.set_param(mac_interface_params::DRX_SHORT_CYCLE,       0);
+  params.set_param(mac_interface_params::DRX_SHORT_CYCLE_TIMER, 0);
+
+  // Active until the inactivity timer expires, then only in the on-durations
+  drx.configure(100);
+  check(phy.cycle == 40 && phy.offset == 25, "Long cycle not set", 100);
+  check(run(100, 11) == 11, "Inactivity after configuration", 100);
+  check(run(111, 154) == 3*4, "On-durations", 111);
+
+  // A PDCCH restarts the inactivity timer
+  drx.pdcch_dl(265, 3);
+  check(run(265, 11) == 11, "Inactivity timer not started", 265);
+  check(!phy.active(276), "Inactivity timer not stopped", 276);
+
+  // A NACK keeps the retransmission timer running after the HARQ RTT
+  drx.dl_tb_decoded(3, false);
+  check(phy.until == 265+8+16-1, "Retransmission timer", 276);
+  drx.pdcch_dl(270, 4);
+  drx.dl_tb_decoded(4, true);
+  check(phy.until == 265+8+16-1, "ACK started the retransmission timer", 276);
+
+  // Short cycle after the inactivity timer expires, back to the long cycle after 3 short cycles
+  params.set_param(mac_interface_params::DRX_SHORT_CYCLE,       10);
+  params.set_param(mac_interface_params::DRX_SHORT_CYCLE_TIMER, 3);
+  drx.configure(300);
+  run(300, 12);
+  check(phy.cycle == 10 && phy.offset == 5, "Short cycle not started", 311);
+  run(312, 30);
+  check(phy.cycle == 10, "Short cycle stopped early", 341);
+  run(342, 1);
+  check(phy.cycle == 40, "Long cycle not resumed", 342);
+
+  // DRX Command stops the inactivity timer
+  drx.pdcch_ul(400);
+  drx.drx_command(402);
+  check(!phy.active(403), "Active after DRX Command", 403);
+  check(phy.cycle == 10, "DRX Command did not start the short cycle", 402);
+
+  // but not a running retransmission timer
+  run(403, 47);
+  drx.pdcch_dl(450, 5);
+  drx.dl_tb_decoded(5, false);
+  drx.drx_command(452);
+  check(phy.until == 450+8+16-1, "DRX Command stopped the retransmission timer", 452);
+  check(phy.active(460) && !phy.active(474), "Retransmission timer after DRX Command", 452);
+
+  // Pending SR
+  run(453, 47);
+  drx.keep_active(500);
+  check(phy.active(500), "SR not in active time", 500);
+
+  // Idle across the SFN wrap-around, active_until never looks ahead
+  params.set_param(mac_interface_params::DRX_SHORT_CYCLE, 0);
+  drx.configure(501);
+  run(501, 11);
+  check(run(512, 2*10240) == 2*4*10240/40, "Active time after wrap-around", 512);
+
+  // Released
+  params.set_param(mac_interface_params::DRX_LONG_CYCLE, 0);
+  drx.configure(600);
+  check(phy.cycle == 0, "DRX not released", 600);
+
+  printf("Ok\n");
+  exit(0);
+}
@@ -0,0 +1,196 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "phy/cell_search_par.h"
+#include "phy/cell_cache.h"
+
+#define NOF_READERS 3
+#define RING_LEN    1000
+#define NOF_SAMPLES 100000
+
+using namespace srsue;
+
+// Sample i of the stream has value i
+class radio_dummy : public srslte::radio
+{
+public:
+  radio_dummy() : next(0), nof_rx(0) {}
+  void get_time(srslte_timestamp_t *now) { bzero(now, sizeof(srslte_timestamp_t)); }
+  bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time) { return true; }
+  bool tx_end() { return true; }
+  bool rx_now(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time) {
+    cf_t *s = (cf_t*) buffer;
+    for(uint32_t i=0;i<nof_samples;i++)
+      s[i] = (float) next++;
+    nof_rx++;
+    bzero(rxd_time, sizeof(srslte_timestamp_t));
+    return true;
+  }
+  bool rx_at(void *buffer, uint32_t nof_samples, srslte_timestamp_t rx_time) { return false; }
+  void set_tx_gain(float gain) {}
+  void set_rx_gain(float gain) {}
+  double set_rx_gain_th(float gain) { return gain; }
+  void set_tx_freq(float freq) {}
+  void set_rx_freq(float freq) {}
+  void set_master_clock_rate(float rate) {}
+  void set_tx_srate(float srate) {}
+  void set_rx_srate(float srate) {}
+  void start_rx() {}
+  void stop_rx() {}
+  float get_tx_gain() { return 0; }
+  float get_rx_gain() { return 0; }
+  float get_max_tx_power() { return 0; }
+  float set_tx_power(float power_dbm) { return power_dbm; }
+  float get_rssi() { return 0; }
+  bool  has_rssi() { return false; }
+  void set_tti(uint32_t tti) {}
+  void tx_offset(int offset) {}
+  void set_tti_len(uint32_t sf_len) {}
+  uint32_t get_tti_len() { return 0; }
+
+  volatile uint32_t next;
+  volatile uint32_t nof_rx;
+};
+
+radio_dummy   radio;
+sample_fanout fanout;
+
+typedef struct {
+  uint32_t id;
+  uint32_t errors;
+}reader_args_t;
+
+// Reads the stream in chunks of varying size, like ue_sync does when aligning to the PSS
+void* reader_thread(void *a)
+{
+  reader_args_t *args = (reader_args_t*) a;
+  cf_t buf[RING_LEN];
+  uint32_t n = 0;
+  uint32_t seed = args->id;
+  while(n < NOF_SAMPLES) {
+    uint32_t len = 1 + rand_r(&seed)%(RING_LEN/2);
+    if(len > NOF_SAMPLES - n)
+      len = NOF_SAMPLES - n;
+    srslte_timestamp_t t;
+    if(fanout.recv(args->id, buf, len, &t) != (int) len) {
+      args->errors++;
+      break;
+    }
+    for(uint32_t i=0;i<len;i++) {
+      if(__real__ buf[i] != (float) (n+i))
+        args->errors++;
+    }
+    n += len;
+    if(args->id == 0)
+      usleep(10);
+  }
+  fanout.done(args->id);
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  // Every reader gets the whole stream, which is received from the radio once
+  if(!fanout.init(&radio, NOF_READERS, RING_LEN, 1.92e6)) {
+    printf("Error initiating fanout\n");
+    exit(-1);
+  }
+  pthread_t     threads[NOF_READERS];
+  reader_args_t args[NOF_READERS];
+  for(uint32_t i=0;i<NOF_READERS;i++) {
+    args[i].id     = i;
+    args[i].errors = 0;
+    pthread_create(&threads[i], NULL, reader_thread, &args[i]);
+  }
+  for(uint32_t i=0;i<NOF_READERS;i++) {
+    pthread_join(threads[i], NULL);
+    if(args[i].errors) {
+      printf("Reader %d: %d wrong samples\n", i, args[i].errors);
+      exit(-1);
+    }
+  }
+  if(fanout.get_nof_received() != NOF_SAMPLES || radio.next != NOF_SAMPLES) {
+    printf("Received %d samples from the radio, expected %d\n", radio.next, NOF_SAMPLES);
+    exit(-1);
+  }
+
+  // A reader that is done does not hold back the others
+  fanout.init(&radio, 2, RING_LEN, 1.92e6);
+  fanout.done(1);
+  cf_t buf[RING_LEN];
+  for(uint32_t i=0;i<10;i++) {
+    if(fanout.recv(0, buf, RING_LEN, NULL) != RING_LEN) {
+      printf("Reader blocked by a finished reader\n");
+      exit(-1);
+    }
+  }
+
+  // Cell cache round trip
+  char filename[] = "/tmp/cell_cache_testXXXXXX";
+  int fd = mkstemp(filename);
+  close(fd);
+  cell_cache_t c, d;
+  bzero(&c, sizeof(cell_cache_t));
+  c.dl_freq        = 2680e6;
+  c.cell.id        = 321;
+  c.cell.cp        = SRSLTE_CP_EXT;
+  c.cell.nof_prb   = 50;
+  c.cell.nof_ports = 2;
+  c.cfo            = -1234.5;
+  c.gain           = 42.5;
+  if(!cell_cache::save(filename, &c) || !cell_cache::load(filename, &d)) {
+    printf("Error saving or loading the cell cache\n");
+    exit(-1);
+  }
+  if(d.dl_freq != c.dl_freq || d.cell.id != c.cell.id || d.cell.cp != c.cell.cp || 
+     d.cell.nof_prb != c.cell.nof_prb || d.cell.nof_ports != c.cell.nof_ports || 
+     d.cfo != c.cfo || d.gain != c.gain) 
+  {
+    printf("Cell cache mismatch\n");
+    exit(-1);
+  }
+
+  // A corrupt cache is ignored
+  FILE *f = fopen(filename, "w");
+  fprintf(f, "dl_freq=2680000000 id=999 cp=0\n");
+  fclose(f);
+  if(cell_cache::load(filename, &d)) {
+    printf("Corrupt cell cache loaded\n");
+    exit(-1);
+  }
+  remove(filename);
+  if(cell_cache::load(filename, &d)) {
+    printf("Missing cell cache loaded\n");
+    exit(-1);
+  }
+
+  printf("Ok\n");
+  exit(0);
+}
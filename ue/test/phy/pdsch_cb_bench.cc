@@ -0,0 +1,201 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+/******************************************************************************
+ *  File:         pdsch_cb_bench.cc
+ *  Description:  Measures the latency of decoding one PDSCH transport block 
+ *                (rate dematching, turbo decoding and CRC) with the code
+ *                blocks split across 0 to N helper threads. A transport block
+ *                is encoded once, converted to noisy soft bits and decoded
+ *                repeatedly with pdsch_par::decode_tb().
+ *****************************************************************************/
+
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "srslte/srslte.h"
+#include "common/helper_pool.h"
+#include "common/log_stdout.h"
+#include "phy/pdsch_par.h"
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+
+typedef struct {
+  uint32_t nof_prb; 
+  uint32_t mcs; 
+  uint32_t max_helpers; 
+  uint32_t nof_tb; 
+  uint32_t max_its; 
+  float    snr_db; 
+}prog_args_t;
+
+prog_args_t prog_args; 
+
+void args_default(prog_args_t *args) {
+  args->nof_prb     = 100; 
+  args->mcs         = 28; 
+  args->max_helpers = 3; 
+  args->nof_tb      = 1000; 
+  args->max_its     = 4; 
+  args->snr_db      = 10; 
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [pmhnis]\n", prog);
+  printf("\t-p number of PRB [Default %d]\n", args->nof_prb);
+  printf("\t-m PDSCH MCS [Default %d]\n", args->mcs);
+  printf("\t-h maximum number of helper threads [Default %d]\n", args->max_helpers);
+  printf("\t-n transport blocks decoded per helper count [Default %d]\n", args->nof_tb);
+  printf("\t-i maximum turbo decoder iterations [Default %d]\n", args->max_its);
+  printf("\t-s SNR of the soft bits in dB [Default %.1f]\n", args->snr_db);
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  while ((opt = getopt(argc, argv, "pmhnis")) != -1) {
+    switch (opt) {
+    case 'p':
+      args->nof_prb = atoi(argv[optind]);
+      break;
+    case 'm':
+      args->mcs = atoi(argv[optind]);
+      break;
+    case 'h':
+      args->max_helpers = atoi(argv[optind]);
+      break;
+    case 'n':
+      args->nof_tb = atoi(argv[optind]);
+      break;
+    case 'i':
+      args->max_its = atoi(argv[optind]);
+      break;
+    case 's':
+      args->snr_db = atof(argv[optind]);
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+static uint64_t now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+  parse_args(&prog_args, argc, argv);
+
+  // PDSCH of a subframe without PBCH/SS, CFI=2 and one antenna port: 138 RE per PRB
+  srslte_pdsch_cfg_t cfg; 
+  bzero(&cfg, sizeof(srslte_pdsch_cfg_t));
+  if (srslte_ra_mcs_from_idx_dl(prog_args.mcs, prog_args.nof_prb, &cfg.grant.mcs)) {
+    fprintf(stderr, "Invalid MCS %d\n", prog_args.mcs);
+    exit(-1);
+  }
+  uint32_t Qm = srslte_mod_bits_x_symbol(cfg.grant.mcs.mod);
+  cfg.grant.nof_prb    = prog_args.nof_prb; 
+  cfg.nbits.nof_re     = 138*prog_args.nof_prb; 
+  cfg.nbits.nof_bits   = cfg.nbits.nof_re*Qm; 
+  cfg.rv               = 0; 
+  if (srslte_cbsegm(&cfg.cb_segm, cfg.grant.mcs.tbs)) {
+    fprintf(stderr, "Error computing code block segmentation\n");
+    exit(-1);
+  }
+
+  srslte_sch_t           sch; 
+  srslte_softbuffer_tx_t softbuffer_tx; 
+  srslte_softbuffer_rx_t softbuffer_rx; 
+  srslte_sch_init(&sch);
+  srslte_softbuffer_tx_init(&softbuffer_tx, prog_args.nof_prb);
+  srslte_softbuffer_rx_init(&softbuffer_rx, prog_args.nof_prb);
+
+  std::vector<uint8_t> data(cfg.grant.mcs.tbs/8+1), data_rx(cfg.grant.mcs.tbs/8+1);
+  std::vector<uint8_t> e_bits(cfg.nbits.nof_bits);
+  std::vector<float>   llr(cfg.nbits.nof_bits), llr_noisy(cfg.nbits.nof_bits);
+  for (uint32_t i=0;i<data.size();i++) {
+    data[i] = rand()&0xff; 
+  }
+  if (srslte_dlsch_encode(&sch, &cfg, &softbuffer_tx, &data[0], &e_bits[0])) {
+    fprintf(stderr, "Error encoding transport block\n");
+    exit(-1);
+  }
+  for (uint32_t i=0;i<cfg.nbits.nof_bits;i++) {
+    llr[i] = e_bits[i] ? 1.0 : -1.0; 
+  }
+  srslte_ch_awgn_f(&llr[0], &llr_noisy[0], pow(10, -prog_args.snr_db/10), cfg.nbits.nof_bits);
+
+  printf("TBS=%d bits, %d code blocks (K1=%d, K2=%d), Qm=%d, %d soft bits\n", 
+         cfg.grant.mcs.tbs, cfg.cb_segm.C, cfg.cb_segm.K1, cfg.cb_segm.K2, Qm, cfg.nbits.nof_bits);
+  printf("Helpers   p50 (us)   p99 (us)   max (us)   Iterations   CRC errors\n");
+
+  std::vector<uint64_t> lat(prog_args.nof_tb);
+  for (uint32_t h=0;h<=prog_args.max_helpers;h++) {
+    srslte::helper_pool pool(1);
+    srslte::log_stdout  log("PHY");
+    srsue::pdsch_par    dec; 
+    if (h > 0 && !pool.init(h)) {
+      fprintf(stderr, "Error starting %d helpers\n", h);
+      exit(-1);
+    }
+    if (!dec.init(&pool, &log, 1, prog_args.max_its)) {
+      fprintf(stderr, "Error initiating decoder\n");
+      exit(-1);
+    }
+    uint32_t errors = 0; 
+    float    its    = 0; 
+    for (uint32_t n=0;n<prog_args.nof_tb;n++) {
+      srslte_softbuffer_rx_reset(&softbuffer_rx);
+      uint64_t t0  = now_ns();
+      int      ret = dec.decode_tb(0, &cfg.cb_segm, Qm, cfg.rv, cfg.nbits.nof_bits, &llr_noisy[0], 
+                                   &softbuffer_rx, &data_rx[0]);
+      lat[n] = now_ns() - t0; 
+      its   += dec.last_noi(0);
+      if (ret || memcmp(&data[0], &data_rx[0], cfg.grant.mcs.tbs/8)) {
+        errors++; 
+      }
+    }
+    pool.stop();
+    std::sort(lat.begin(), lat.end());
+    printf("%7d   %8.1f   %8.1f   %8.1f   %10.2f   %10d\n", h, 
+           lat[lat.size()/2]/1e3, lat[lat.size()*99/100]/1e3, lat[lat.size()-1]/1e3, 
+           its/prog_args.nof_tb, errors);
+  }
+
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  srslte_sch_free(&sch);
+  exit(0);
+}
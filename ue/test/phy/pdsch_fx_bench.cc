@@ -0,0 +1,287 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         pdsch_fx_bench.cc
+ *  Description:  Checks and times the fixed-point PDSCH kernels of pdsch_fx
+ *                with every instruction set the CPU supports. Demodulation
+ *                must match the rounded float reference of the demapper
+ *                and, within a tolerance, the LLRs of the srsLTE soft
+ *                demodulator used by the float PDSCH, descrambling srslte_scrambling_f_offset() and in-place soft
+ *                combining of a first transmission and a retransmission,
+ *                with and without filler bits, srslte_rm_turbo_rx() on the
+ *                same soft bits scaled to float. Any mismatch fails.
+ *                Reports the time per symbol or soft bit of each kernel.
+ *****************************************************************************/
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <vector>
+
+#include "srslte/srslte.h"
+#include "phy/pdsch_fx.h"
+#include "common/softbuffer_fx.h"
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+
+typedef struct {
+  uint32_t nof_prb; 
+  uint32_t nof_reps; 
+}prog_args_t;
+
+prog_args_t prog_args; 
+
+void args_default(prog_args_t *args) {
+  args->nof_prb  = 100; 
+  args->nof_reps = 1000; 
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [pn]\n", prog);
+  printf("\t-p number of PRB [Default %d]\n", args->nof_prb);
+  printf("\t-n repetitions of each timed kernel [Default %d]\n", args->nof_reps);
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  while ((opt = getopt(argc, argv, "pn")) != -1) {
+    switch (opt) {
+    case 'p':
+      args->nof_prb = atoi(argv[optind]);
+      break;
+    case 'n':
+      args->nof_reps = atoi(argv[optind]);
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+using namespace srsue;
+
+static uint64_t now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+static void check(bool cond, const char *what, const char *isa)
+{
+  if (!cond) {
+    printf("%s mismatch with %s kernels\n", what, isa);
+    exit(-1);
+  }
+}
+
+static float urand()
+{
+  return (float) rand()/RAND_MAX; 
+}
+
+static int16_t sat16(float x)
+{
+  return (int16_t) lrintf(fmaxf(fminf(x, 32767), -32767));
+}
+
+const static srslte_mod_t mods[3]     = {SRSLTE_MOD_QPSK, SRSLTE_MOD_16QAM, SRSLTE_MOD_64QAM}; 
+const static char        *mod_str[3]  = {"QPSK", "16QAM", "64QAM"}; 
+
+/* Tolerance against the srsLTE soft demodulator, in units of the float LLRs: the int16 rounding 
+ * plus a relative error. The Tosato-Bisaglia metrics equal max-log up to |LLR| = 16a^2, a being 
+ * the constellation step, and are less confident beyond it with the same hard decision. 
+ * Saturated LLRs and the outlier symbols are not compared */
+#define LLR_TOL_ABS   (1.0/softbuffer_fx::SCALE_16)
+#define LLR_TOL_REL   0.01
+#define LLR_MAX_SYMB  1.5
+const static float llr_exact[3] = {1e9, 16.0/10, 16.0/42}; 
+
+// Code block sizes and filler bits of the rate dematching checks
+const static uint32_t rm_K[5] = {40, 512, 1056, 4160, 6144}; 
+const static uint32_t rm_F[5] = {0,  16,  0,    56,   0}; 
+
+int main(int argc, char *argv[])
+{
+  parse_args(&prog_args, argc, argv);
+  srand(0);
+
+  uint32_t nof_re = prog_args.nof_prb*SRSLTE_NRE*12; 
+  uint32_t max_e  = 6*nof_re; 
+
+  // Equalized symbols with a few outliers to exercise saturation
+  std::vector<cf_t>    symbols(nof_re);
+  float               *sym_f = (float*) &symbols[0]; 
+  for (uint32_t i=0;i<2*nof_re;i++) {
+    sym_f[i] = i%97 ? 2.5*(urand()-0.5) : 400*(urand()-0.5); 
+  }
+
+  std::vector<float>   llr_ref(max_e);
+  std::vector<int16_t> llr(max_e);
+  std::vector<float>   llr_f(max_e);
+
+  // LLRs of the float PDSCH, srslte_demod_soft_demodulator() with the settings of pdsch_par
+  std::vector<float>   llr_srs[3]; 
+  srslte_demod_soft_t  demod; 
+  if (srslte_demod_soft_init(&demod, nof_re)) {
+    printf("Error initiating soft demodulator\n");
+    exit(-1);
+  }
+  srslte_demod_soft_alg_set(&demod, SRSLTE_DEMOD_SOFT_ALG_APPROX);
+  srslte_demod_soft_sigma_set(&demod, sqrt(0.5));
+  for (uint32_t m=0;m<3;m++) {
+    srslte_modem_table_t table; 
+    bzero(&table, sizeof(srslte_modem_table_t));
+    if (srslte_modem_table_lte(&table, mods[m], true)) {
+      printf("Error initiating %s modem table\n", mod_str[m]);
+      exit(-1);
+    }
+    llr_srs[m].resize(max_e);
+    srslte_demod_soft_table_set(&demod, &table);
+    srslte_demod_soft_demodulator(&demod, &symbols[0], &llr_srs[m][0], nof_re);
+    srslte_modem_table_free(&table);
+  }
+  srslte_demod_soft_free(&demod);
+
+  srslte_sequence_t seq; 
+  bzero(&seq, sizeof(srslte_sequence_t));
+  if (srslte_sequence_LTE_pr(&seq, max_e, 0x1234)) {
+    printf("Error initiating sequence\n");
+    exit(-1);
+  }
+
+  std::vector<int16_t> e16(2*softbuffer_fx::CB_LEN);
+  std::vector<float>   ef(2*softbuffer_fx::CB_LEN);
+  std::vector<int16_t> w16(softbuffer_fx::CB_LEN);
+  std::vector<float>   wf(softbuffer_fx::CB_LEN);
+  std::vector<float>   d(3*SRSLTE_TCOD_MAX_LEN_CB+12);
+  std::vector<float>   d_ref(3*SRSLTE_TCOD_MAX_LEN_CB+12);
+
+  printf("%-8s %10s %10s %10s %12s %12s\n", "ISA", "QPSK", "16QAM", "64QAM", "descramble", "rm_combine");
+  printf("%-8s %10s %10s %10s %12s %12s\n", "", "ns/symb", "ns/symb", "ns/symb", "ns/bit", "ns/bit");
+
+  for (uint32_t isa=0;isa<pdsch_fx::NOF_ISA;isa++) {
+    pdsch_fx fx; 
+    if (!fx.init((pdsch_fx::isa_t) isa)) {
+      printf("%-8s not supported\n", pdsch_fx::isa_string((pdsch_fx::isa_t) isa));
+      continue; 
+    }
+    const char *name = pdsch_fx::isa_string(fx.get_isa()); 
+    float t_demod[3]; 
+
+    for (uint32_t m=0;m<3;m++) {
+      uint32_t Qm = srslte_mod_bits_x_symbol(mods[m]); 
+      pdsch_fx::demod_ref(mods[m], &symbols[0], &llr_ref[0], nof_re);
+      // Odd lengths check the scalar tails of the vector loops
+      uint32_t n = nof_re - isa%3; 
+      fx.demod(mods[m], &symbols[0], &llr[0], n);
+      for (uint32_t i=0;i<n*Qm;i++) {
+        check(llr[i] == sat16(llr_ref[i]), mod_str[m], name);
+        float x = sym_f[2*(i/Qm) + i%2]; 
+        if (fabsf(x) < LLR_MAX_SYMB && abs(llr[i]) < 32767) {
+          float l   = (float) llr[i]/softbuffer_fx::SCALE_16; 
+          float r   = llr_srs[m][i]; 
+          float tol = LLR_TOL_ABS + LLR_TOL_REL*fabsf(r); 
+          if (fabsf(r) <= llr_exact[m]) {
+            check(fabsf(l - r) <= tol, "srsLTE soft demodulator", name);
+          } else {
+            check(l*r > 0 && fabsf(l) <= fabsf(r) + tol, "srsLTE soft demodulator", name);
+          }
+        }
+      }
+      uint64_t t0 = now_ns(); 
+      for (uint32_t r=0;r<prog_args.nof_reps;r++) {
+        fx.demod(mods[m], &symbols[0], &llr[0], nof_re);
+      }
+      t_demod[m] = (float) (now_ns() - t0)/prog_args.nof_reps/nof_re; 
+    }
+
+    // 64QAM soft bits from the last demodulation
+    uint32_t n_bits = 6*nof_re - isa%7; 
+    for (uint32_t i=0;i<n_bits;i++) {
+      llr_f[i] = llr[i]; 
+    }
+    srslte_scrambling_f_offset(&seq, &llr_f[0], 0, n_bits);
+    fx.descramble(&llr[0], seq.c, n_bits);
+    for (uint32_t i=0;i<n_bits;i++) {
+      check(llr[i] == (int16_t) llr_f[i], "Descrambling", name);
+    }
+    uint64_t t0 = now_ns(); 
+    for (uint32_t r=0;r<prog_args.nof_reps;r++) {
+      fx.descramble(&llr[0], seq.c, 6*nof_re);
+    }
+    float t_descramble = (float) (now_ns() - t0)/prog_args.nof_reps/(6*nof_re); 
+
+    /* First transmission with RV 0 and a retransmission with RV 2, shorter and longer 
+     * than the circular buffer. Soft bits are small enough for the sums not to saturate */
+    for (uint32_t k=0;k<5;k++) {
+      uint32_t K    = rm_K[k]; 
+      uint32_t F    = rm_F[k]; 
+      uint32_t N_cb = softbuffer_fx::cb_w_len(K); 
+      uint32_t n_e[2] = {N_cb/3 + k, 2*N_cb - k}; 
+      for (uint32_t t=0;t<2;t++) {
+        for (uint32_t i=0;i<N_cb;i++) {
+          w16[i] = softbuffer_fx::NULL_16; 
+          wf[i]  = SRSLTE_RX_NULL; 
+        }
+        for (uint32_t rv=0;rv<=2;rv+=2) {
+          for (uint32_t i=0;i<n_e[t];i++) {
+            e16[i] = (int16_t) (8000*(urand()-0.5)); 
+            ef[i]  = (float) e16[i]/softbuffer_fx::SCALE_16; 
+          }
+          check(!fx.rm_combine(&w16[0], &e16[0], n_e[t], K, rv, F), "Rate dematching call", name);
+          srslte_rm_turbo_rx(&wf[0], softbuffer_fx::CB_LEN, &ef[0], n_e[t], &d_ref[0], 3*K+12, rv, F);
+        }
+        check(!fx.rm_output(&w16[0], &d[0], K), "Rate dematching output call", name);
+        for (uint32_t i=0;i<3*K+12;i++) {
+          check(d[i] == d_ref[i], "Rate dematching", name);
+        }
+      }
+    }
+    uint32_t K    = SRSLTE_TCOD_MAX_LEN_CB; 
+    uint32_t n_e  = softbuffer_fx::cb_w_len(K); 
+    t0 = now_ns(); 
+    for (uint32_t r=0;r<prog_args.nof_reps;r++) {
+      fx.rm_combine(&w16[0], &e16[0], n_e, K, r%4, 0);
+      fx.rm_output(&w16[0], &d[0], K);
+    }
+    float t_rm = (float) (now_ns() - t0)/prog_args.nof_reps/n_e; 
+
+    printf("%-8s %10.2f %10.2f %10.2f %12.3f %12.3f\n", name, t_demod[0], t_demod[1], t_demod[2], 
+           t_descramble, t_rm);
+  }
+
+  srslte_sequence_free(&seq);
+  printf("Ok\n");
+  exit(0);
+}
@@ -0,0 +1,169 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <pthread.h>
+#include "common/log_stdout.h"
+#include "phy/phch_meas.h"
+#include "phy/phch_common.h"
+
+#define NOF_WRITERS 4
+#define NOF_PUSHES  1000
+#define RX_GAIN     50
+#define RS_POWER    10
+
+using namespace srsue;
+
+// No RSSI readings, the RX gain offset is the radio gain
+class radio_dummy : public srslte::radio
+{
+public:
+  void get_time(srslte_timestamp_t *now) { bzero(now, sizeof(srslte_timestamp_t)); }
+  bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time) { return true; }
+  bool tx_end() { return true; }
+  bool rx_now(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time) { return false; }
+  bool rx_at(void *buffer, uint32_t nof_samples, srslte_timestamp_t rx_time) { return false; }
+  void set_tx_gain(float gain) {}
+  void set_rx_gain(float gain) {}
+  double set_rx_gain_th(float gain) { return gain; }
+  void set_tx_freq(float freq) {}
+  void set_rx_freq(float freq) {}
+  void set_master_clock_rate(float rate) {}
+  void set_tx_srate(float srate) {}
+  void set_rx_srate(float srate) {}
+  void start_rx() {}
+  void stop_rx() {}
+  float get_tx_gain() { return 0; }
+  float get_rx_gain() { return RX_GAIN; }
+  float get_max_tx_power() { return 0; }
+  float set_tx_power(float power_dbm) { return power_dbm; }
+  float get_rssi() { return 0; }
+  bool  has_rssi() { return false; }
+  void set_tti(uint32_t tti) {}
+  void tx_offset(int offset) {}
+  void set_tti_len(uint32_t sf_len) {}
+  uint32_t get_tti_len() { return 0; }
+};
+
+radio_dummy radio;
+phy_params  params;
+phch_common common;
+phch_meas   meas;
+
+void check(bool cond, const char *what)
+{
+  if(!cond) {
+    printf("%s\n", what);
+    exit(-1);
+  }
+}
+
+// Sample with an RSRP of rsrp_dbm once the RX gain offset is applied
+phch_meas::sample_t sample(uint32_t tti, float rsrp_dbm)
+{
+  phch_meas::sample_t s;
+  bzero(&s, sizeof(phch_meas::sample_t));
+  s.tti    = tti;
+  s.rsrp   = powf(10, (rsrp_dbm - 30 + RX_GAIN)/10);
+  s.rssi   = s.rsrp*100;
+  s.rsrq   = 0.1;
+  s.snr    = 100;
+  s.dl_mcs = 10;
+  s.ul.mcs = 20;
+  return s;
+}
+
+bool near(float a, float b, float tol = 0.01)
+{
+  return fabsf(a - b) < tol;
+}
+
+// Waits for the measurement thread to filter the samples pushed so far
+bool wait_rsrp(float rsrp_dbm)
+{
+  for(int i=0;i<1000 && !near(common.rsrp_filtered, rsrp_dbm);i++)
+    usleep(1000);
+  return near(common.rsrp_filtered, rsrp_dbm);
+}
+
+// Retries while the queue is full, like a worker that never waits would drop them
+void* writer(void *arg)
+{
+  for(uint32_t i=0;i<NOF_PUSHES;i++) {
+    while(!meas.push(sample(i, -80)))
+      usleep(100);
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  srslte::log_stdout log("PHY");
+  params.set_param(phy_interface_params::PDSCH_RSPOWER, RS_POWER);
+  params.set_param(phy_interface_params::MEAS_FILTER_COEFF, 8);
+  common.init(&params, &log, &radio, NULL, NULL);
+  check(meas.init(&common, &radio, &params, &log, -1), "Error starting measurement thread");
+
+  // First sample sets the gain offset, the filter and the pathloss
+  check(meas.push(sample(0, -80)), "Push");
+  check(wait_rsrp(-80), "First RSRP");
+  check(near(common.rx_gain_offset, RX_GAIN), "RX gain offset");
+  check(near(common.pathloss, RS_POWER + 80), "Pathloss");
+
+  // k=8, a=1/4: F = 3/4*F + 1/4*M
+  float f = -80;
+  for(uint32_t i=1;i<4;i++) {
+    check(meas.push(sample(i, -70)), "Push");
+    f = 0.75*f + 0.25*(-70);
+    check(wait_rsrp(f), "L3 filter");
+  }
+
+  // Concurrent workers, the queue never blocks them
+  dl_metrics_t dl;
+  ul_metrics_t ul;
+  common.get_dl_metrics(dl);
+  common.get_ul_metrics(ul);
+  pthread_t threads[NOF_WRITERS];
+  for(uint32_t i=0;i<NOF_WRITERS;i++)
+    pthread_create(&threads[i], NULL, writer, NULL);
+  for(uint32_t i=0;i<NOF_WRITERS;i++)
+    pthread_join(threads[i], NULL);
+  check(wait_rsrp(-80), "RSRP after concurrent pushes");
+  usleep(2*phch_meas::PERIOD_US);
+  common.get_dl_metrics(dl);
+  common.get_ul_metrics(ul);
+  // Averages include the first samples, filtered from the previous RSRP
+  check(near(dl.rsrp, -80, 0.1) && near(dl.pathloss, RS_POWER + 80, 0.1) && near(dl.rssi, -60), "DL metrics");
+  check(near(dl.mcs, 10) && near(dl.sinr, 20) && near(ul.mcs, 20), "Worker metrics");
+
+  meas.stop();
+  printf("Ok\n");
+  exit(0);
+}
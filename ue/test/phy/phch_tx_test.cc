@@ -0,0 +1,204 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include "common/log_stdout.h"
+#include "phy/phch_tx.h"
+#include "phy/phch_common.h"
+
+#define NOF_SAMPLES 1920
+
+using namespace srsue;
+
+// Records what the TX thread hands to the radio. tx_time.full_secs carries the sequence number.
+class radio_dummy : public srslte::radio
+{
+public:
+  radio_dummy() : nof_tx_end(0), bad_samples(0) { sent.reserve(64); }
+  void get_time(srslte_timestamp_t *now) { bzero(now, sizeof(srslte_timestamp_t)); }
+  bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time) {
+    cf_t *s = (cf_t*) buffer;
+    if(nof_samples != NOF_SAMPLES || __real__ s[0] != (float) tx_time.full_secs)
+      bad_samples++;
+    sent.push_back(tx_time.full_secs);
+    return true;
+  }
+  bool tx_end() { nof_tx_end++; return true; }
+  bool rx_now(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time) { return false; }
+  bool rx_at(void *buffer, uint32_t nof_samples, srslte_timestamp_t rx_time) { return false; }
+  void set_tx_gain(float gain) {}
+  void set_rx_gain(float gain) {}
+  double set_rx_gain_th(float gain) { return gain; }
+  void set_tx_freq(float freq) {}
+  void set_rx_freq(float freq) {}
+  void set_master_clock_rate(float rate) {}
+  void set_tx_srate(float srate) {}
+  void set_rx_srate(float srate) {}
+  void start_rx() {}
+  void stop_rx() {}
+  float get_tx_gain() { return 0; }
+  float get_rx_gain() { return 0; }
+  float get_max_tx_power() { return 0; }
+  float set_tx_power(float power_dbm) { return power_dbm; }
+  float get_rssi() { return 0; }
+  bool  has_rssi() { return false; }
+  void set_tti(uint32_t tti) {}
+  void tx_offset(int offset) {}
+  void set_tti_len(uint32_t sf_len) {}
+  uint32_t get_tti_len() { return NOF_SAMPLES; }
+
+  std::vector<uint32_t> sent;
+  volatile uint32_t     nof_tx_end;
+  uint32_t              bad_samples;
+};
+
+radio_dummy radio;
+phy_params  params;
+phch_tx     tx;
+cf_t        sf[NOF_SAMPLES];
+
+static uint64_t now_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+uint32_t reserve(uint32_t seq_expected, uint64_t deadline_ns) {
+  srslte_timestamp_t t;
+  bzero(&t, sizeof(srslte_timestamp_t));
+  t.full_secs = seq_expected;
+  uint32_t seq = tx.reserve(t, NOF_SAMPLES, deadline_ns);
+  if(seq != seq_expected) {
+    printf("Reserved %d, expected %d\n", seq, seq_expected);
+    exit(-1);
+  }
+  return seq;
+}
+
+void push(uint32_t seq) {
+  bzero(sf, sizeof(sf));
+  __real__ sf[0] = seq;
+  tx.push(seq, seq, true, sf, NOF_SAMPLES);
+}
+
+bool wait_sent(uint32_t n) {
+  for(int i=0;i<1000 && radio.sent.size() < n;i++)
+    usleep(1000);
+  return radio.sent.size() == n;
+}
+
+int main(int argc, char **argv)
+{
+  srslte::log_stdout log("PHY");
+  if(!tx.init(&radio, &params, &log, -1)) {
+    printf("Error starting TX thread\n");
+    exit(-1);
+  }
+
+  // Workers finishing out of order are sent in reservation order
+  uint64_t far = now_ns() + 10000000000ULL;
+  reserve(0, far);
+  reserve(1, far);
+  reserve(2, far);
+  push(2);
+  push(1);
+  usleep(10000);
+  if(radio.sent.size() != 0) {
+    printf("Sent before the first subframe was ready\n");
+    exit(-1);
+  }
+  push(0);
+  if(!wait_sent(3) || radio.sent[0] != 0 || radio.sent[1] != 1 || radio.sent[2] != 2) {
+    printf("Wrong TX order\n");
+    exit(-1);
+  }
+
+  // A late worker is dropped, the next subframe goes out without waiting for it
+  reserve(3, now_ns() + 2000000);
+  reserve(4, far);
+  push(4);
+  if(!wait_sent(4) || radio.sent[3] != 4) {
+    printf("Pipeline blocked by a late subframe\n");
+    exit(-1);
+  }
+  // The burst was active when the subframe was dropped
+  if(tx.get_late() != 1 || radio.nof_tx_end != 1) {
+    printf("Late subframe not counted\n");
+    exit(-1);
+  }
+  // The late worker releases its slot
+  push(3);
+
+  // The whole ring is usable again
+  for(uint32_t i=5;i<5+phch_tx::NOF_SLOTS;i++)
+    reserve(i, far);
+  for(uint32_t i=5;i<5+phch_tx::NOF_SLOTS;i++)
+    push(i);
+  if(!wait_sent(4+phch_tx::NOF_SLOTS) || tx.get_overflow() != 0) {
+    printf("Slots not released\n");
+    exit(-1);
+  }
+  for(uint32_t i=4;i<radio.sent.size();i++) {
+    if(radio.sent[i] != i+1) {
+      printf("Wrong TX order after a drop\n");
+      exit(-1);
+    }
+  }
+  // Deadline of a subframe received now with 0.5 ms time advance, it goes on air 2.5 ms later
+  uint64_t rx_ns  = now_ns();
+  uint64_t air_ns = rx_ns + 2500000;
+  uint64_t deadline_ns = phch_common::tx_deadline_ns(rx_ns, 0.0005);
+  if(deadline_ns + phch_common::TX_MARGIN_NS != air_ns) {
+    printf("Deadline not before air time\n");
+    exit(-1);
+  }
+  // Ready after air time, but before TTI+4: dropped, not sent late
+  uint32_t seq = 5+phch_tx::NOF_SLOTS;
+  tx.get_late();
+  reserve(seq, deadline_ns);
+  while(now_ns() < air_ns + 200000)
+    usleep(100);
+  push(seq);
+  reserve(seq+1, far);
+  push(seq+1);
+  if(!wait_sent(seq) || radio.sent.back() != seq+1 || tx.get_late() != 1) {
+    printf("Subframe ready after its air time not dropped\n");
+    exit(-1);
+  }
+
+  if(radio.bad_samples) {
+    printf("%d subframes with wrong samples\n", radio.bad_samples);
+    exit(-1);
+  }
+
+  tx.stop();
+  printf("Ok\n");
+  exit(0);
+}
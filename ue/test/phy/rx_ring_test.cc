@@ -0,0 +1,112 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "phy/rx_ring.h"
+
+using namespace srsue;
+
+void check(bool cond, const char *what)
+{
+  if(!cond) {
+    printf("%s\n", what);
+    exit(-1);
+  }
+}
+
+// Receives a subframe in the next slot, the first sample marks its TTI
+void receive(rx_ring *r, uint32_t tti)
+{
+  rx_ring::slot_t *s = r->next();
+  check(s != NULL, "No free slot");
+  s->buffer[0] = (float) tti;
+  s->tti       = tti;
+  s->tx_seq    = tti;
+  r->push();
+}
+
+int main(int argc, char **argv)
+{
+  rx_ring r;
+
+  // Disabled
+  check(r.init(0, 16), "Init disabled");
+  check(r.get_nof_slots() == 0 && r.is_full() && !r.next() && !r.front(), "Disabled ring");
+
+  check(r.init(4, 16), "Init");
+  check(!r.front() && !r.is_full(), "Empty ring");
+
+  // Pending subframes come out in reception order, across the wrap
+  uint32_t tti = 0;
+  for(uint32_t n=0;n<10;n++) {
+    receive(&r, tti++);
+    receive(&r, tti++);
+    receive(&r, tti++);
+    for(uint32_t i=0;i<3;i++) {
+      rx_ring::slot_t *s = r.front();
+      check(s && s->tti == tti-3+i && s->buffer[0] == (float) s->tti, "Order");
+      r.pop();
+    }
+    check(!r.front() && r.get_nof_pending() == 0, "Drained");
+  }
+
+  // Full: no next slot until the oldest is popped
+  for(uint32_t i=0;i<4;i++) {
+    receive(&r, tti++);
+  }
+  check(r.is_full() && !r.next() && r.get_nof_pending() == 4, "Full");
+  r.push();
+  check(r.get_nof_pending() == 4, "Push on full");
+  r.pop();
+  check(!r.is_full() && r.front()->tti == tti-3, "Pop oldest");
+  receive(&r, tti++);
+  check(r.front()->tti == tti-4, "Oldest after refill");
+
+  // A worker takes the slot buffer and leaves its own, which the slot reuses
+  cf_t *worker_buffer = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*16);
+  rx_ring::slot_t *s  = r.front();
+  cf_t *rx_buffer     = s->buffer;
+  cf_t *old           = s->buffer;
+  s->buffer     = worker_buffer;
+  worker_buffer = old;
+  r.pop();
+  check(worker_buffer == rx_buffer && worker_buffer[0] == (float) (tti-4), "Swap");
+  while(r.front()) {
+    r.pop();
+  }
+  r.pop();
+  check(r.get_nof_pending() == 0, "Pop on empty");
+  for(uint32_t i=0;i<4;i++) {
+    receive(&r, tti++);
+  }
+  free(worker_buffer);
+  r.free_buffers();
+  check(r.get_nof_slots() == 0 && r.get_nof_pending() == 0, "Free");
+
+  printf("Ok\n");
+  exit(0);
+}
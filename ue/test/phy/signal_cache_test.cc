@@ -0,0 +1,126 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phy/signal_cache.h"
+
+using namespace srsue;
+
+void check(bool cond, const char *what)
+{
+  if(!cond) {
+    printf("%s\n", what);
+    exit(-1);
+  }
+}
+
+// Inserts and publishes an entry of nof_bytes filled with its RNTI, not held afterwards
+bool add(signal_cache *c, uint16_t rnti, uint32_t nof_bytes)
+{
+  signal_cache::key_t    key = signal_cache::crnti_key(1, 50, 0, rnti);
+  signal_cache::entry_t *e   = c->insert(&key, nof_bytes);
+  if(!e) {
+    return false;
+  }
+  memset(e->data, rnti, nof_bytes);
+  c->publish(e);
+  c->release(e);
+  return true;
+}
+
+bool has(signal_cache *c, uint16_t rnti)
+{
+  signal_cache::key_t    key = signal_cache::crnti_key(1, 50, 0, rnti);
+  signal_cache::entry_t *e   = c->acquire(&key);
+  if(!e) {
+    return false;
+  }
+  check(e->data[0] == (uint8_t) rnti && e->data[e->nof_bytes-1] == (uint8_t) rnti, "Wrong data");
+  c->release(e);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  signal_cache c;
+  c.set_max_bytes(1000);
+
+  // Keys differ in every field the signals depend on
+  signal_cache::key_t k1 = signal_cache::prach_key(50, 3, false, 5, 2, 22);
+  signal_cache::key_t k2 = signal_cache::prach_key(50, 3, true,  5, 2, 22);
+  signal_cache::key_t k3 = signal_cache::crnti_key(1, 50, 0, 0x46);
+  signal_cache::key_t k4 = signal_cache::crnti_key(2, 50, 0, 0x46);
+  signal_cache::key_t k5 = signal_cache::crnti_key(1, 50, 1, 0x46);
+  check(memcmp(&k1, &k2, sizeof(k1)) && memcmp(&k3, &k4, sizeof(k3)) && memcmp(&k3, &k5, sizeof(k3)), "Keys");
+
+  // Not visible until published, and inserted only once
+  signal_cache::entry_t *e = c.insert(&k1, 100);
+  check(e != NULL, "Insert");
+  check(c.acquire(&k1) == NULL, "Acquired before publish");
+  check(c.insert(&k1, 100) == NULL, "Inserted twice");
+  c.publish(e);
+  signal_cache::entry_t *e2 = c.acquire(&k1);
+  check(e2 == e, "Acquire");
+  c.release(e2);
+  c.release(e);
+
+  // Released before publish is dropped
+  e = c.insert(&k2, 100);
+  check(e != NULL, "Insert 2");
+  c.release(e);
+  check(c.get_nof_entries() == 1 && c.get_nof_bytes() == 100, "Unpublished kept");
+
+  // Larger than the cap
+  check(!add(&c, 1, 1001), "Over the cap");
+
+  // Least recently used evicted first
+  check(add(&c, 1, 300) && add(&c, 2, 300) && add(&c, 3, 300), "Fill");
+  check(c.get_nof_bytes() == 1000, "Size");
+  check(has(&c, 1), "Hit 1");
+  check(add(&c, 4, 300), "Evict");
+  check(c.acquire(&k1) == NULL, "Least recent not evicted");
+  check(has(&c, 1) && !has(&c, 2) && has(&c, 3) && has(&c, 4), "Evicted the wrong entry");
+  check(c.get_nof_bytes() <= 1000, "Over the cap after eviction");
+
+  // Held entries are never evicted
+  signal_cache::key_t k = signal_cache::crnti_key(1, 50, 0, 1);
+  e = c.acquire(&k);
+  check(e != NULL, "Hold");
+  c.set_max_bytes(400);
+  check(has(&c, 1) && c.get_nof_entries() == 1, "Held entry evicted");
+  check(!add(&c, 5, 200), "Evicted a held entry");
+  c.release(e);
+  check(add(&c, 5, 200) && !has(&c, 1), "Released entry not evicted");
+
+  c.clear();
+  check(c.get_nof_entries() == 0 && c.get_nof_bytes() == 0, "Clear");
+  check(c.get_nof_hits() > 0 && c.get_nof_misses() > 0 && c.get_nof_evicted() > 0, "Counters");
+
+  printf("Ok\n");
+  exit(0);
+}
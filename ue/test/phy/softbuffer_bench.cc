@@ -0,0 +1,297 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+/******************************************************************************
+ *  File:         softbuffer_bench.cc
+ *  Description:  Compares the DL HARQ soft buffers stored as float, int16
+ *                and int8. 8 HARQ processes plus the BCCH one are sized for
+ *                the cell bandwidth, and transport blocks are sent to them
+ *                round robin, a first transmission with RV 0 and a
+ *                retransmission with RV 2, and decoded with
+ *                pdsch_par::decode_tb(). Fixed-point processes are expanded
+ *                into one float softbuffer like the PHY workers do.
+ *                Reports the soft buffer memory, the decoding time and the
+ *                last level cache misses per transmission (perf events,
+ *                n/a if not permitted) and the block error rate after the
+ *                retransmission.
+ *****************************************************************************/
+
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <vector>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+
+#include "srslte/srslte.h"
+#include "common/helper_pool.h"
+#include "common/log_stdout.h"
+#include "phy/pdsch_par.h"
+#include "common/softbuffer_fx.h"
+
+#define NOF_PROC     9
+#define NOF_NOISE    4
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+
+typedef struct {
+  uint32_t nof_prb; 
+  uint32_t mcs; 
+  uint32_t nof_tb; 
+  uint32_t max_its; 
+  float    snr_db; 
+}prog_args_t;
+
+prog_args_t prog_args; 
+
+void args_default(prog_args_t *args) {
+  args->nof_prb = 100; 
+  args->mcs     = 28; 
+  args->nof_tb  = 2000; 
+  args->max_its = 4; 
+  args->snr_db  = 3; 
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [pmnis]\n", prog);
+  printf("\t-p number of PRB [Default %d]\n", args->nof_prb);
+  printf("\t-m PDSCH MCS [Default %d]\n", args->mcs);
+  printf("\t-n transport blocks per soft buffer format [Default %d]\n", args->nof_tb);
+  printf("\t-i maximum turbo decoder iterations [Default %d]\n", args->max_its);
+  printf("\t-s SNR of the soft bits of each transmission in dB [Default %.1f]\n", args->snr_db);
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  while ((opt = getopt(argc, argv, "pmnis")) != -1) {
+    switch (opt) {
+    case 'p':
+      args->nof_prb = atoi(argv[optind]);
+      break;
+    case 'm':
+      args->mcs = atoi(argv[optind]);
+      break;
+    case 'n':
+      args->nof_tb = atoi(argv[optind]);
+      break;
+    case 'i':
+      args->max_its = atoi(argv[optind]);
+      break;
+    case 's':
+      args->snr_db = atof(argv[optind]);
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+static uint64_t now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+// Last level cache misses of this thread, -1 if perf events are not available
+static int cache_open()
+{
+  struct perf_event_attr pe; 
+  bzero(&pe, sizeof(struct perf_event_attr));
+  pe.type           = PERF_TYPE_HARDWARE; 
+  pe.size           = sizeof(struct perf_event_attr);
+  pe.config         = PERF_COUNT_HW_CACHE_MISSES; 
+  pe.disabled       = 1; 
+  pe.exclude_kernel = 1; 
+  pe.exclude_hv     = 1; 
+  return syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+}
+
+static int64_t cache_read(int fd)
+{
+  int64_t n; 
+  if (fd < 0 || read(fd, &n, sizeof(int64_t)) != sizeof(int64_t)) {
+    return -1; 
+  }
+  return n; 
+}
+
+int main(int argc, char *argv[])
+{
+  parse_args(&prog_args, argc, argv);
+
+  // PDSCH of a subframe without PBCH/SS, CFI=2 and one antenna port: 138 RE per PRB
+  srslte_pdsch_cfg_t cfg; 
+  bzero(&cfg, sizeof(srslte_pdsch_cfg_t));
+  if (srslte_ra_mcs_from_idx_dl(prog_args.mcs, prog_args.nof_prb, &cfg.grant.mcs)) {
+    fprintf(stderr, "Invalid MCS %d\n", prog_args.mcs);
+    exit(-1);
+  }
+  uint32_t Qm = srslte_mod_bits_x_symbol(cfg.grant.mcs.mod);
+  cfg.grant.nof_prb    = prog_args.nof_prb; 
+  cfg.nbits.nof_re     = 138*prog_args.nof_prb; 
+  cfg.nbits.nof_bits   = cfg.nbits.nof_re*Qm; 
+  if (srslte_cbsegm(&cfg.cb_segm, cfg.grant.mcs.tbs)) {
+    fprintf(stderr, "Error computing code block segmentation\n");
+    exit(-1);
+  }
+
+  srslte_sch_t           sch; 
+  srslte_softbuffer_tx_t softbuffer_tx; 
+  srslte_sch_init(&sch);
+  srslte_softbuffer_tx_init(&softbuffer_tx, prog_args.nof_prb);
+
+  // Noisy soft bits of RV 0 and RV 2
+  uint32_t nof_bits = cfg.nbits.nof_bits; 
+  std::vector<uint8_t> data(cfg.grant.mcs.tbs/8+1), data_rx(cfg.grant.mcs.tbs/8+1);
+  std::vector<uint8_t> e_bits(nof_bits);
+  std::vector<float>   llr(nof_bits); 
+  std::vector<float>   llr_noisy[2][NOF_NOISE]; 
+  for (uint32_t i=0;i<data.size();i++) {
+    data[i] = rand()&0xff; 
+  }
+  for (uint32_t r=0;r<2;r++) {
+    cfg.rv = 2*r; 
+    srslte_softbuffer_tx_reset(&softbuffer_tx);
+    if (srslte_dlsch_encode(&sch, &cfg, &softbuffer_tx, &data[0], &e_bits[0])) {
+      fprintf(stderr, "Error encoding transport block\n");
+      exit(-1);
+    }
+    for (uint32_t i=0;i<nof_bits;i++) {
+      llr[i] = e_bits[i] ? 1.0 : -1.0; 
+    }
+    for (uint32_t k=0;k<NOF_NOISE;k++) {
+      llr_noisy[r][k].resize(nof_bits);
+      srslte_ch_awgn_f(&llr[0], &llr_noisy[r][k][0], pow(10, -prog_args.snr_db/10), nof_bits);
+    }
+  }
+
+  printf("TBS=%d bits, %d code blocks, %d PRB cell, %d HARQ processes, SNR %.1f dB per transmission\n", 
+         cfg.grant.mcs.tbs, cfg.cb_segm.C, prog_args.nof_prb, NOF_PROC, prog_args.snr_db);
+  printf("Bits   HARQ (kB)   Worker (kB)   us/TX   LLC miss/TX   BLER 1st TX   BLER 2nd TX\n");
+
+  srslte::helper_pool pool(1);
+  srslte::log_stdout  log("PHY");
+  srsue::pdsch_par    dec; 
+  if (!dec.init(&pool, &log, 1, prog_args.max_its)) {
+    fprintf(stderr, "Error initiating decoder\n");
+    exit(-1);
+  }
+  int fd = cache_open();
+
+  uint32_t formats[3] = {32, 16, 8}; 
+  for (uint32_t f=0;f<3;f++) {
+    uint32_t bits = formats[f]; 
+    srslte_softbuffer_rx_t sb[NOF_PROC], sb_tmp; 
+    srsue::softbuffer_fx   fx[NOF_PROC]; 
+    size_t harq_bytes = 0, worker_bytes = 0; 
+    for (uint32_t p=0;p<NOF_PROC;p++) {
+      if (bits == 32) {
+        srslte_softbuffer_rx_init(&sb[p], prog_args.nof_prb);
+        harq_bytes += (size_t) sb[p].max_cb*sb[p].buff_size*sizeof(float);
+      } else {
+        fx[p].init(prog_args.nof_prb, bits);
+        harq_bytes += fx[p].get_nof_bytes();
+      }
+    }
+    if (bits != 32) {
+      srslte_softbuffer_rx_init(&sb_tmp, prog_args.nof_prb);
+      worker_bytes = (size_t) sb_tmp.max_cb*sb_tmp.buff_size*sizeof(float);
+    }
+
+    uint32_t errors[2] = {0, 0}, nof_tx = 0; 
+    bool     ok[NOF_PROC]; 
+    uint64_t t_ns = 0; 
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    // Rounds of NOF_PROC new TBs followed by their retransmissions
+    for (uint32_t n=0;n<prog_args.nof_tb;n+=NOF_PROC) {
+      for (uint32_t r=0;r<2;r++) {
+        for (uint32_t p=0;p<NOF_PROC;p++) {
+          if (r == 1 && ok[p]) {
+            continue; 
+          }
+          float *e = &llr_noisy[r][(n/NOF_PROC+p)%NOF_NOISE][0]; 
+          srslte_softbuffer_rx_t *s = bits == 32 ? &sb[p] : &sb_tmp; 
+          uint64_t t0 = now_ns();
+          if (r == 0) {
+            if (bits == 32) {
+              srslte_softbuffer_rx_reset_tbs(&sb[p], cfg.grant.mcs.tbs);
+            } else {
+              fx[p].reset();
+            }
+          }
+          if (bits != 32) {
+            fx[p].expand(&cfg.cb_segm, s);
+          }
+          ok[p] = !dec.decode_tb(0, &cfg.cb_segm, Qm, 2*r, nof_bits, e, s, &data_rx[0]) && 
+                  !memcmp(&data[0], &data_rx[0], cfg.grant.mcs.tbs/8);
+          if (bits != 32 && !ok[p]) {
+            fx[p].compress(&cfg.cb_segm, s);
+          }
+          t_ns += now_ns() - t0; 
+          nof_tx++; 
+          if (!ok[p]) {
+            errors[r]++; 
+          }
+        }
+      }
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    int64_t misses = cache_read(fd);
+    uint32_t nof_tb = ((prog_args.nof_tb+NOF_PROC-1)/NOF_PROC)*NOF_PROC; 
+
+    printf("%4d   %9.0f   %11.0f   %5.0f   ", bits, harq_bytes/1024.0, worker_bytes/1024.0, (float) t_ns/nof_tx/1e3);
+    if (misses >= 0) {
+      printf("%11.0f   ", (float) misses/nof_tx);
+    } else {
+      printf("%11s   ", "n/a");
+    }
+    printf("%11.3f   %11.3f\n", (float) errors[0]/nof_tb, (float) errors[1]/nof_tb);
+
+    for (uint32_t p=0;p<NOF_PROC;p++) {
+      if (bits == 32) {
+        srslte_softbuffer_rx_free(&sb[p]);
+      }
+    }
+    if (bits != 32) {
+      srslte_softbuffer_rx_free(&sb_tmp);
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  pool.stop();
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_sch_free(&sch);
+  exit(0);
+}
@@ -31,6 +31,7 @@
 #include "common/log_stdout.h"
 #include "common/mac_interface.h"
 #include "radio/radio_uhd.h"
+#include "radio/radio_file.h"
 
 
 /**********************************************************************
@@ -40,6 +41,8 @@
 typedef struct {
   float uhd_freq; 
   float uhd_gain;
+  char *input_file; 
+  float file_srate; 
 }prog_args_t;
 
 uint32_t srsapps_verbose = 0; 
@@ -49,19 +52,29 @@ prog_args_t prog_args;
 void args_default(prog_args_t *args) {
   args->uhd_freq = -1.0;
   args->uhd_gain = -1.0; 
+  args->input_file = NULL; 
+  args->file_srate = 0; 
 }
 
 void usage(prog_args_t *args, char *prog) {
   printf("Usage: %s [gv] -f rx_frequency (in Hz)\n", prog);
   printf("\t-g UHD RX gain [Default AGC]\n");
+  printf("\t-i read samples from IQ file (complex float) instead of UHD, as fast as possible\n");
+  printf("\t-s IQ file sample rate [Default rate requested by PHY]\n");
   printf("\t-v [increase verbosity, default none]\n");
 }
 
 void parse_args(prog_args_t *args, int argc, char **argv) {
   int opt;
   args_default(args);
-  while ((opt = getopt(argc, argv, "gfv")) != -1) {
+  while ((opt = getopt(argc, argv, "gfisv")) != -1) {
     switch (opt) {
+    case 'i':
+      args->input_file = argv[optind];
+      break;
+    case 's':
+      args->file_srate = atof(argv[optind]);
+      break;
     case 'g':
       args->uhd_gain = atof(argv[optind]);
       break;
@@ -76,7 +89,7 @@ void parse_args(prog_args_t *args, int argc, char **argv) {
       exit(-1);
     }
   }
-  if (args->uhd_freq < 0) {
+  if (args->uhd_freq < 0 && !args->input_file) {
     usage(args, argv[0]);
     exit(-1);
   }
@@ -143,6 +156,7 @@ public:
 
 testmac         my_mac;
 srslte::radio_uhd radio_uhd; 
+srslte::radio_file radio_file; 
 
 
 
@@ -154,13 +168,20 @@ int main(int argc, char *argv[])
   parse_args(&prog_args, argc, argv);
 
   // Init Radio and PHY
-  if (prog_args.uhd_gain > 0) {
+  srslte::radio *radio = &radio_uhd; 
+  if (prog_args.input_file) {
+    if (!radio_file.init(prog_args.input_file, "", srslte::RADIO_FILE_FC32, prog_args.file_srate, true, false)) {
+      exit(-1);
+    }
+    radio = &radio_file; 
+    my_phy.init(radio, &my_mac, &log);
+  } else if (prog_args.uhd_gain > 0) {
     radio_uhd.init();
     radio_uhd.set_rx_gain(prog_args.uhd_gain);    
-    my_phy.init(&radio_uhd, &my_mac, &log);
+    my_phy.init(radio, &my_mac, &log);
   } else {
     radio_uhd.init_agc();
-    my_phy.init_agc(&radio_uhd, &my_mac, &log);
+    my_phy.init_agc(radio, &my_mac, &log);
   }
   
   if (srsapps_verbose == 1) {
@@ -176,7 +197,7 @@ int main(int argc, char *argv[])
   sleep(1);
     
   // Set RX freq and gain
-  radio_uhd.set_rx_freq(prog_args.uhd_freq);
+  radio->set_rx_freq(prog_args.uhd_freq);
   
   my_phy.sync_start();
   
@@ -196,15 +217,19 @@ int main(int argc, char *argv[])
       if (srslte_verbose == SRSLTE_VERBOSE_NONE && srsapps_verbose == 0) {
         float gain = prog_args.uhd_gain; 
         if (gain < 0) {
-          gain = radio_uhd.get_rx_gain();
+          gain = radio->get_rx_gain();
         }
-        printf("PDCCH BLER %.1f \%% PDSCH BLER %.1f \%% (total pkts: %5u) Gain: %.1f dB\r", 
+        printf("PDCCH BLER %.1f \%% PDSCH BLER %.1f \%% (total pkts: %5u) Gain: %.1f dB", 
             100-(float) 100*total_dci/total_pkts, 
             (float) 100*(1 - total_oks/total_pkts), 
             total_pkts, gain);   
+        if (prog_args.input_file) {
+          printf(" File: %.1f Msamples", (float) radio_file.get_nof_rx_samples()/1e6);
+        }
+        printf("\r");
       }
     }
   }
   my_phy.stop();
-  radio_uhd.stop_rx();
+  radio->stop_rx();
 }
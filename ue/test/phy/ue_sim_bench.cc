@@ -0,0 +1,276 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         ue_sim_bench.cc
+ *  Description:  Runs the PHY against the simulated eNodeB radio without
+ *                real-time pacing. Decodes the scripted PDSCH stream for the
+ *                simulated C-RNTI, checks every PDU and reports DL
+ *                throughput, CPU time per TTI and the uplink timing checks.
+ *****************************************************************************/
+
+#include <unistd.h>
+#include <time.h>
+
+#include "srslte/utils/debug.h"
+#include "phy/phy.h"
+#include "common/log_stdout.h"
+#include "common/mac_interface.h"
+#include "radio/radio_sim.h"
+
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+
+typedef struct {
+  srslte::radio_sim_args_t sim; 
+  uint32_t nof_workers; 
+  uint32_t duration; 
+}prog_args_t;
+
+uint32_t srsapps_verbose = 0; 
+
+prog_args_t prog_args; 
+
+void args_default(prog_args_t *args) {
+  args->sim.nof_prb      = 25; 
+  args->sim.cell_id      = 1; 
+  args->sim.cfi          = 2; 
+  args->sim.rnti         = 0x46; 
+  args->sim.mcs          = 10; 
+  args->sim.grant_period = 1; 
+  args->sim.awgn         = false; 
+  args->sim.snr_db       = 20; 
+  args->sim.cfo_hz       = 0; 
+  args->sim.realtime     = false; 
+  args->nof_workers      = 2; 
+  args->duration         = 10; 
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [pmgsctwrv]\n", prog);
+  printf("\t-p number of PRB [Default %d]\n", args->sim.nof_prb);
+  printf("\t-m PDSCH MCS [Default %d]\n", args->sim.mcs);
+  printf("\t-g subframes between PDSCH grants [Default %d]\n", args->sim.grant_period);
+  printf("\t-s add AWGN with this SNR in dB [Default no noise]\n");
+  printf("\t-c carrier frequency offset in Hz [Default %.0f]\n", args->sim.cfo_hz);
+  printf("\t-t duration in seconds after synchronization [Default %d]\n", args->duration);
+  printf("\t-w number of PHY workers [Default %d]\n", args->nof_workers);
+  printf("\t-r pace the downlink in real time [Default as fast as possible]\n");
+  printf("\t-v [increase verbosity, default none]\n");
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  while ((opt = getopt(argc, argv, "pmgsctwrv")) != -1) {
+    switch (opt) {
+    case 'p':
+      args->sim.nof_prb = atoi(argv[optind]);
+      break;
+    case 'm':
+      args->sim.mcs = atoi(argv[optind]);
+      break;
+    case 'g':
+      args->sim.grant_period = atoi(argv[optind]);
+      break;
+    case 's':
+      args->sim.awgn   = true; 
+      args->sim.snr_db = atof(argv[optind]);
+      break;
+    case 'c':
+      args->sim.cfo_hz = atof(argv[optind]);
+      break;
+    case 't':
+      args->duration = atoi(argv[optind]);
+      break;
+    case 'w':
+      args->nof_workers = atoi(argv[optind]);
+      break;
+    case 'r':
+      args->sim.realtime = true; 
+      break;
+    case 'v':
+      srsapps_verbose++;
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+srsue::phy my_phy;
+srslte::radio_sim radio_sim; 
+bool bch_decoded = false; 
+volatile uint32_t nof_ttis = 0; 
+uint32_t total_dci  = 0;
+uint32_t total_oks  = 0;
+uint32_t total_errs = 0; 
+uint32_t total_bad  = 0; 
+uint64_t total_bytes = 0; 
+uint8_t  payload[8][SRSLTE_MAX_BUFFER_SIZE_BYTES]; 
+uint32_t payload_len[8]; 
+srslte_softbuffer_rx_t softbuffer[8]; 
+
+/******** MAC Interface implementation */
+class testmac : public srsue::mac_interface_phy
+{
+public:
+  void new_grant_ul(mac_grant_t grant, tb_action_ul_t *action) {
+    printf("New grant UL\n");
+  }
+  void new_grant_ul_ack(mac_grant_t grant, bool ack, tb_action_ul_t *action) {
+    printf("New grant UL ACK\n");    
+  }
+
+  void harq_recv(uint32_t tti, bool ack, tb_action_ul_t *action) {
+    printf("harq recv\n");    
+  }
+
+  // Every grant is a new transmission with rv=0, ACKs are sent on PUCCH
+  void new_grant_dl(mac_grant_t grant, tb_action_dl_t *action) {
+    total_dci++; 
+    uint32_t pid = grant.pid%8; 
+    payload_len[pid] = grant.n_bytes; 
+    srslte_softbuffer_rx_reset(&softbuffer[pid]);
+
+    action->decode_enabled = true; 
+    action->default_ack = false; 
+    action->generate_ack = true; 
+    action->payload_ptr = payload[pid]; 
+    memcpy(&action->phy_grant, &grant.phy_grant, sizeof(srslte_phy_grant_t));
+    action->rv = grant.rv;
+    action->softbuffer = &softbuffer[pid];
+    action->rnti = grant.rnti; 
+  }
+  
+  void tb_decoded(bool ack, srslte_rnti_type_t rnti, uint32_t harq_pid) {
+    uint32_t pid = harq_pid%8; 
+    if (ack) {
+      total_oks++;     
+      total_bytes += payload_len[pid]; 
+      if (!srslte::radio_sim::check_pdu(payload[pid], payload_len[pid])) {
+        total_bad++; 
+      }
+    } else {
+      total_errs++; 
+    }
+  }
+
+  void bch_decoded_ok(uint8_t *payload, uint32_t len) {
+    printf("BCH decoded\n");
+    srslte_cell_t cell; 
+    my_phy.get_current_cell(&cell); 
+    for (int i=0;i<8;i++) {
+      srslte_softbuffer_rx_init(&softbuffer[i], cell.nof_prb);
+    }
+    bch_decoded = true; 
+  }
+  void tti_clock(uint32_t tti) {
+    nof_ttis++; 
+  }
+};
+
+
+testmac         my_mac;
+
+static double cpu_secs()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static double wall_secs()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+  srslte::log_stdout log("PHY");
+  
+  parse_args(&prog_args, argc, argv);
+
+  if (!radio_sim.init(&prog_args.sim)) {
+    exit(-1);
+  }
+  my_phy.init(&radio_sim, &my_mac, &log, prog_args.nof_workers);
+  
+  if (srsapps_verbose == 1) {
+    log.set_level(srslte::LOG_LEVEL_INFO);
+    printf("Log level info\n");
+  }
+  if (srsapps_verbose == 2) {
+    log.set_level(srslte::LOG_LEVEL_DEBUG);
+    printf("Log level debug\n");
+  }
+    
+  // Give it time to create thread 
+  sleep(1);
+  
+  my_phy.sync_start();
+  while(!bch_decoded || !my_phy.status_is_sync()) {
+    usleep(10000);
+  }
+  my_phy.set_crnti(prog_args.sim.rnti);
+  my_phy.pdcch_dl_search(SRSLTE_RNTI_USER, prog_args.sim.rnti);
+
+  uint32_t tti_start  = nof_ttis; 
+  double   cpu_start  = cpu_secs(); 
+  double   wall_start = wall_secs(); 
+  for (uint32_t t=0;t<prog_args.duration;t++) {
+    sleep(1);
+    uint32_t ttis = nof_ttis - tti_start; 
+    double   wall = wall_secs() - wall_start; 
+    if (ttis > 0 && srsapps_verbose == 0) {
+      printf("TTIs: %6d (%4.1fx real time), DCI: %6d, BLER: %4.1f%%, DL: %6.2f Mbps, CPU: %5.1f us/TTI\r", 
+             ttis, ttis/(wall*1000), total_dci, 
+             100*(float) total_errs/SRSLTE_MAX(total_oks+total_errs, 1), 
+             (float) total_bytes*8/wall/1e6, 
+             (cpu_secs()-cpu_start)*1e6/ttis);
+      fflush(stdout);
+    }
+  }
+  my_phy.stop();
+
+  srslte::radio_sim_metrics_t m; 
+  radio_sim.get_metrics(&m);
+  uint32_t ttis = nof_ttis - tti_start; 
+  printf("\n\nDL: %d TTIs, %d grants sent, %d DCI found, %d TB ok, %d TB errors, %d corrupted PDUs\n", 
+         ttis, (int) m.dl_grants, total_dci, total_oks, total_errs, total_bad);
+  printf("CPU: %.1f us/TTI, throughput %.2f Mbps\n", 
+         (cpu_secs()-cpu_start)*1e6/SRSLTE_MAX(ttis, 1), 
+         (float) total_bytes*8/(wall_secs()-wall_start)/1e6);
+  printf("UL: %d subframes, %d bursts, %d late, %d wrong length\n", 
+         (int) m.ul_chunks, (int) m.ul_bursts, (int) m.ul_late, (int) m.ul_bad_len);
+
+  exit((total_bad > 0 || m.ul_late > 0 || m.ul_bad_len > 0) ? -1 : 0);
+}
@@ -0,0 +1,96 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "phy/worker_scaler.h"
+
+using namespace srsue;
+
+worker_scaler scaler;
+
+// Runs nof_tti TTIs with a constant processing time, returns the number of workers at the end
+uint32_t run(uint32_t nof_tti, uint32_t busy_us, uint64_t wait_ns = 0)
+{
+  uint32_t n = 0;
+  for(uint32_t i=0;i<nof_tti;i++) {
+    scaler.add_tti((uint64_t) busy_us*1000);
+    n = scaler.step(0, wait_ns);
+  }
+  return n;
+}
+
+void check(uint32_t n, uint32_t expected, const char *what)
+{
+  if(n != expected) {
+    printf("%s: %d workers, expected %d\n", what, n, expected);
+    exit(-1);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const uint32_t W = worker_scaler::WINDOW;
+  const uint32_t P = worker_scaler::EVAL_PERIOD;
+
+  check(worker_scaler::workers_needed(300), 2, "Needed 300us");
+  check(worker_scaler::workers_needed(950), 3, "Needed 950us");
+  check(worker_scaler::workers_needed(2500), 4, "Needed 2500us");
+
+  // The TX advance limits the pipeline depth, not the number of workers available
+  scaler.init(1, 8, 1);
+  check(scaler.workers_max(0), 4, "Max workers");
+  check(run(P, 5000), 4, "Capped by the TX advance");
+
+  scaler.init(2, 4, 2);
+  check(run(2*W, 300), 2, "Light load");
+
+  // Grows within one evaluation period
+  check(run(P, 1500), 3, "Grow to 3");
+  check(run(P, 2500), 4, "Grow to 4");
+  check(run(P, 3500), 4, "Grow above the maximum");
+
+  // Shrinks one worker at a time, once the whole window fits in fewer
+  check(run(W-P, 300), 4, "Shrink before the window is clean");
+  check(run(2*P, 300), 3, "Shrink to 3");
+  check(run(W-2*P, 300), 3, "Shrink twice in one window");
+  check(run(2*P, 300), 2, "Shrink to 2");
+  check(run(4*W, 300), 2, "Shrink below the minimum");
+
+  // A single slow TTI in the window prevents shrinking
+  check(run(P, 1500), 3, "Grow on a spike");
+  run(W/2, 300);
+  run(1, 1500);
+  check(run(W/2, 300), 3, "Shrink with a spike in the window");
+
+  // Waiting for a worker grows at once and holds off shrinking
+  scaler.init(2, 4, 2);
+  check(run(1, 300, 2*worker_scaler::STARVED_NS), 3, "Grow on starvation");
+  check(run(worker_scaler::STARVED_HOLD*W - P, 300), 3, "Shrink after starvation");
+  check(run(2*P, 300), 2, "Shrink after the hold");
+
+  printf("Ok\n");
+  exit(0);
+}